@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include "BenchmarkCommon.h"
+
+#include "../Database.h"
+
+#include "../Map/Map.h"
+
+typedef const BenchmarkEntry* (*BenchmarkGroupFunc)(int32_t* count);
+
+//World generation, storage of chunks and edits, and chunk meshes (which need the map, hence not in the headless build).
+static const BenchmarkGroupFunc groups[] =
+{
+  WorldGenBenchmarksGet,
+  StorageBenchmarksGet,
+#ifndef HEADLESS_BUILD
+  MapBenchmarksGet
+#endif
+};
+
+//Set by the checks of the running benchmark; "BenchmarkRun()" fails afterwards.
+static bool sChecksFailed;
+
+bool BenchmarkCheck(bool passed, const char* error)
+{
+  if(!passed)
+  {
+    LogError("%s", true, error);
+    sChecksFailed = true;
+  }
+
+  return passed;
+}
+
+bool BenchmarkRun(const char* name)
+{
+  for(size_t g = 0; g < ARRAY_SIZE(groups); ++g)
+  {
+    int32_t count;
+    const BenchmarkEntry* benchmarks = groups[g](&count);
+
+    for(int32_t i = 0; i < count; ++i)
+    {
+      if(strcmp(benchmarks[i].name, name) != 0)
+        continue;
+
+      LogInfo("Benchmark \"%s\": %s", true, benchmarks[i].name, benchmarks[i].description);
+
+      //Nothing is persisted, so an in-memory database keeps the real map untouched.
+      DatabaseInit(":memory:");
+      MapSetSeed(BENCHMARK_SEED);
+
+      sChecksFailed = false;
+      benchmarks[i].func();
+
+      DatabaseFree();
+
+      return !sChecksFailed;
+    }
+  }
+
+  LogError("There is no benchmark called \"%s\". Available benchmarks:", false, name);
+  for(size_t g = 0; g < ARRAY_SIZE(groups); ++g)
+  {
+    int32_t count;
+    const BenchmarkEntry* benchmarks = groups[g](&count);
+
+    for(int32_t i = 0; i < count; ++i)
+      LogError("\n  - %s: %s", false, benchmarks[i].name, benchmarks[i].description);
+  }
+  LogError("", true);
+
+  return false;
+}
\ No newline at end of file
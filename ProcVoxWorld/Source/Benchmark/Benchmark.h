@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdbool.h>
+
+/* Headless benchmarks, which neither open a window nor need a GPU.
+ * Start with: ProcVoxWorld [configuration path] --benchmark <name>
+ * They are grouped by subsystem ("WorldGenBenchmarks.c", "StorageBenchmarks.c", "MapBenchmarks.c") and share the
+ * setup, timing and check helpers of "BenchmarkCommon.h".
+ * They are part of the game's executable ("ProcVoxWorld.sln") and, except for those of the map, of the headless build
+ * ("CMakeLists.txt", also Linux); the process exits with a non-zero code if they fail, so they can be used as a check.
+ * Returns "false" if there is no benchmark called "name" or one of its checks (e.g. golden hashes) failed. */
+bool BenchmarkRun(const char* name);
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "BenchmarkCommon.h"
+
+#include "../Database.h"
+#include "../NoiseGenerator.h"
+#include "../TimeMeasurement.h"
+
+#include "../Map/Block.h"
+
+int32_t BenchmarkGetMaxThreads(int32_t minThreads)
+{
+  return MAX(minThreads, (int32_t)GetProcessorsCount());
+}
+
+Worker* BenchmarkCreateWorkers(int32_t numWorkers)
+{
+  Worker* workers = (Worker*)OwnMalloc(MAX(1, numWorkers) * sizeof(Worker), false);
+
+  if(workers == NULL)
+  {
+    LogError("Variable \"workers\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  for(int32_t i = 0; i < numWorkers; ++i)
+    ThreadWorkerCreate(&workers[i], ThreadWorkerLoop);
+
+  return workers;
+}
+
+void BenchmarkDestroyWorkers(Worker* workers, int32_t numWorkers)
+{
+  for(int32_t i = 0; i < numWorkers; ++i)
+    ThreadWorkerDestroy(&workers[i]);
+
+  free(workers);
+}
+
+Chunk* BenchmarkCreateChunk(int32_t x, int32_t z)
+{
+  Chunk* c = ChunkInit(x, z);
+  c->blocks = (uint8_t*)OwnMalloc(BLOCKS_MEMORY_SIZE, false);
+
+  if(c->blocks == NULL)
+  {
+    LogError("Variable \"c->blocks\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  return c;
+}
+
+void BenchmarkFreeChunk(Chunk* c)
+{
+  //Chunks never reach the GPU here, hence "ChunkDelete()" would not free the blocks.
+  free(c->blocks);
+  c->blocks = NULL;
+
+  ChunkDelete(c);
+}
+
+void BenchmarkPlaceInGrid(Chunk* c, int32_t k, int32_t side)
+{
+  c->x = k % side;
+  c->z = k / side;
+}
+
+void BenchmarkEditChunk(uint32_t stream, int32_t k, int32_t side, int32_t numEdits)
+{
+  for(int32_t i = 0; i < numEdits; ++i)
+  {
+    const uint32_t index = (uint32_t)(k * numEdits + i) * 4;
+    DatabaseInsertBlock(k % side, k / side, BenchmarkRandom(stream, index, CHUNK_WIDTH), BenchmarkRandom(stream, index + 1, CHUNK_HEIGHT),
+                        BenchmarkRandom(stream, index + 2, CHUNK_WIDTH), 1 + BenchmarkRandom(stream, index + 3, AMOUNT_BLOCKS - 1));
+  }
+}
+
+double BenchmarkTimeGrid(Chunk* c, int32_t side, int32_t rounds, BenchmarkChunkFunc func, void* data)
+{
+  const double start = TimeMeasurementNow();
+  for(int32_t r = 0; r < rounds; ++r)
+  {
+    for(int32_t k = 0; k < side * side; ++k)
+    {
+      BenchmarkPlaceInGrid(c, k, side);
+      func(data, c, k);
+    }
+  }
+
+  return (TimeMeasurementNow() - start) / ((double)rounds * side * side);
+}
+
+int32_t BenchmarkRandom(uint32_t stream, uint32_t index, int32_t range)
+{
+  return (int32_t)(NoiseGeneratorMix(NoiseGeneratorMix(stream) ^ index) % (uint32_t)range);
+}
+
+uint64_t BenchmarkHashBlocks(const uint8_t* blocks)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for(uintmax_t i = 0; i < BLOCKS_MEMORY_SIZE; ++i)
+  {
+    hash ^= blocks[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../Map/ThreadWorker.h"
+
+//Fixed seed, so that results of different runs are comparable.
+#define BENCHMARK_SEED 1337
+
+typedef struct
+{
+  const char* name;
+  const char* description;
+  void (*func)();
+} BenchmarkEntry;
+
+//Called for chunk "k" of a grid by "BenchmarkTimeGrid()", with "c" already placed there.
+typedef void (*BenchmarkChunkFunc)(void* data, Chunk* c, int32_t k);
+
+//The benchmarks of every subsystem, which "BenchmarkRun()" chooses from; "count" receives their number.
+const BenchmarkEntry* WorldGenBenchmarksGet(int32_t* count);
+
+const BenchmarkEntry* StorageBenchmarksGet(int32_t* count);
+
+const BenchmarkEntry* MapBenchmarksGet(int32_t* count);
+
+//Logs "error" and lets "BenchmarkRun()" fail unless "passed"; returns "passed".
+bool BenchmarkCheck(bool passed, const char* error);
+
+//Threads of all processor cores, but at least "minThreads"; the calling thread counts as one.
+int32_t BenchmarkGetMaxThreads(int32_t minThreads);
+
+Worker* BenchmarkCreateWorkers(int32_t numWorkers);
+
+void BenchmarkDestroyWorkers(Worker* workers, int32_t numWorkers);
+
+//A chunk with cleared blocks; exits if they cannot be allocated.
+Chunk* BenchmarkCreateChunk(int32_t x, int32_t z);
+
+void BenchmarkFreeChunk(Chunk* c);
+
+//Moves "c" to chunk "k" of the "side" x "side" grid from chunk (0, 0) on, row by row along the x-axis.
+void BenchmarkPlaceInGrid(Chunk* c, int32_t k, int32_t side);
+
+//Queues "numEdits" random blocks of draw stream "stream" in chunk "k" of the "side" x "side" grid; draws depend on "k", not on the order.
+void BenchmarkEditChunk(uint32_t stream, int32_t k, int32_t side, int32_t numEdits);
+
+//Calls "func" for every chunk of the "side" x "side" grid, "rounds" times over; returns the mean time of a call in seconds.
+double BenchmarkTimeGrid(Chunk* c, int32_t side, int32_t rounds, BenchmarkChunkFunc func, void* data);
+
+//Uniformly distributed in [0, "range") for the "index"-th draw of "stream".
+int32_t BenchmarkRandom(uint32_t stream, uint32_t index, int32_t range);
+
+//FNV-1a of all blocks of a chunk.
+uint64_t BenchmarkHashBlocks(const uint8_t* blocks);
\ No newline at end of file
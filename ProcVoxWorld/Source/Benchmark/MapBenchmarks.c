@@ -0,0 +1,504 @@
+#include "BenchmarkCommon.h"
+
+#include "../Database.h"
+#include "../MeshCache.h"
+#include "../TimeMeasurement.h"
+#include "../WorldGenerator.h"
+
+#include "../Map/Block.h"
+#include "../Map/Map.h"
+#include "../Map/MeshPool.h"
+
+//Time (in seconds) "MapLoadChunksNow()" needs for a square of "side" x "side" chunks.
+static double LoadChunkSquare(int32_t cX, int32_t cZ, int32_t side, Worker* workers, int32_t numWorkers)
+{
+  Chunk* chunks[9];
+  int32_t count = 0;
+
+  for(int32_t dX = 0; dX < side; ++dX)
+  {
+    for(int32_t dZ = 0; dZ < side; ++dZ)
+      chunks[count++] = ChunkInit(cX + dX, cZ + dZ);
+  }
+
+  double start = TimeMeasurementNow();
+  MapLoadChunksNow(chunks, count, workers, numWorkers);
+  double end = TimeMeasurementNow();
+
+  for(int32_t i = 0; i < count; ++i)
+    BenchmarkFreeChunk(chunks[i]);
+
+  return end - start;
+}
+
+/* Latency of urgently needed chunks (spawn, teleport) with 1 to N threads:
+ * a single chunk as well as the 3 x 3 chunks "MapForceChunksNearPlayer()" loads. */
+static void BenchmarkChunkLatency()
+{
+  const int32_t rounds = 16;
+  const int32_t maxThreads = BenchmarkGetMaxThreads(1);
+
+  double singleBase = 0.0;
+  double squareBase = 0.0;
+
+  LogInfo("Threads | single chunk (ms) | speedup | 3 x 3 chunks (ms) | speedup\n", false);
+
+  for(int32_t threads = 1; threads <= maxThreads; ++threads)
+  {
+    //The calling thread takes part, too.
+    const int32_t numWorkers = threads - 1;
+    Worker* workers = BenchmarkCreateWorkers(numWorkers);
+
+    double single = 0.0;
+    double square = 0.0;
+
+    for(int32_t r = 0; r < rounds; ++r)
+    {
+      //Different chunks every round, but the same ones for every thread count.
+      single += LoadChunkSquare(r * 7, -r * 5, 1, workers, numWorkers);
+      square += LoadChunkSquare(-r * 11, r * 3, 3, workers, numWorkers);
+    }
+
+    BenchmarkDestroyWorkers(workers, numWorkers);
+
+    single = single / rounds * 1000.0;
+    square = square / rounds * 1000.0;
+
+    if(threads == 1)
+    {
+      singleBase = single;
+      squareBase = square;
+    }
+
+    LogInfo("%7d | %17.3f | %6.2fx | %17.3f | %6.2fx\n", false, threads, single, singleBase / single, square, squareBase / square);
+  }
+
+  LogInfo("Mean of %d rounds each (generation, stored edits and meshing).", true, rounds);
+}
+
+//Meshes chunk "c" at level of detail "lod"; adds its triangles to "triangles" and returns the time in seconds.
+static double MeshChunkAtLod(Chunk* c, int32_t lod, int64_t* triangles)
+{
+  c->lod = lod;
+
+  double start = TimeMeasurementNow();
+  ChunkGenerateMesh(c);
+  double end = TimeMeasurementNow();
+
+  *triangles += (int64_t)(c->vertexLandCount + c->vertexWaterCount) / 3;
+
+  free(c->generatedMeshTerrain);
+  free(c->generatedMeshWater);
+  c->generatedMeshTerrain = NULL;
+  c->generatedMeshWater = NULL;
+
+  return end - start;
+}
+
+/* Triangles of all chunks within a render radius of 24 and 32 chunks (as the camera pass would draw them without culling),
+ * meshed at full resolution and at the levels of detail of the configured rings. The frame time needs a GPU and is shown in the window title. */
+static void BenchmarkChunkLod()
+{
+  const int32_t radii[2] = {24, 32};
+  const int32_t maxRadius = radii[ARRAY_SIZE(radii) - 1];
+
+  int64_t triangles[2][2] = {0}; //Per radius: full resolution, levels of detail
+  double meshTime[2][2] = {0};
+  int32_t numChunks[2][CHUNK_MAX_LOD + 1] = {0};
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+
+  for(int32_t x = -maxRadius; x <= maxRadius; ++x)
+  {
+    for(int32_t z = -maxRadius; z <= maxRadius; ++z)
+    {
+      const int32_t distSquared = x * x + z * z;
+      if(distSquared > maxRadius * maxRadius)
+        continue;
+
+      c->x = x;
+      c->z = z;
+
+      memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+      WorldGeneratorGenerateChunk(c);
+
+      int64_t full = 0;
+      int64_t reduced = 0;
+      const int32_t lod = ChunkSelectLod(0, distSquared);
+
+      double fullTime = MeshChunkAtLod(c, 0, &full);
+      double reducedTime = lod > 0 ? MeshChunkAtLod(c, lod, &reduced) : fullTime;
+      if(lod == 0)
+        reduced = full;
+
+      for(int32_t r = 0; r < (int32_t)ARRAY_SIZE(radii); ++r)
+      {
+        if(distSquared > radii[r] * radii[r])
+          continue;
+
+        triangles[r][0] += full;
+        triangles[r][1] += reduced;
+        meshTime[r][0] += fullTime;
+        meshTime[r][1] += reducedTime;
+        ++numChunks[r][lod];
+      }
+    }
+  }
+
+  BenchmarkFreeChunk(c);
+
+  LogInfo("Radius | chunks (full / half / quarter) | triangles (full res.) | triangles (LOD) | ratio | meshing full res. (ms) | meshing LOD (ms)\n", false);
+  for(int32_t r = 0; r < (int32_t)ARRAY_SIZE(radii); ++r)
+  {
+    LogInfo("%6d | %12d / %6d / %7d | %21lld | %15lld | %5.2f | %22.1f | %16.1f\n", false, radii[r], numChunks[r][0], numChunks[r][1], numChunks[r][2],
+            triangles[r][0], triangles[r][1], triangles[r][0] / (double)MAX(1, triangles[r][1]), meshTime[r][0] * 1000.0, meshTime[r][1] * 1000.0);
+  }
+  LogInfo("Rings at %d and %d chunks; meshing on one thread, without frustum culling and shadow maps.", true, CHUNK_LOD1_DISTANCE, CHUNK_LOD2_DISTANCE);
+}
+
+//Blocks and both meshes of the chunk; the meshes field by field, as the padding of "Vertex" is not part of them.
+static uint64_t HashLoadedChunk(const Chunk* c)
+{
+  uint64_t hash = BenchmarkHashBlocks(c->blocks);
+
+  const Vertex* meshes[2] = {c->generatedMeshTerrain, c->generatedMeshWater};
+  const size_t counts[2] = {c->vertexLandCount, c->vertexWaterCount};
+  for(int32_t m = 0; m < 2; ++m)
+  {
+    for(size_t i = 0; i < counts[m]; ++i)
+    {
+      const uint8_t* fields[2] = {(const uint8_t*)meshes[m][i].pos, &meshes[m][i].tile};
+      const size_t sizes[2] = {6 * sizeof(float), 2};
+
+      for(int32_t f = 0; f < 2; ++f)
+      {
+        for(size_t b = 0; b < sizes[f]; ++b)
+        {
+          hash ^= fields[f][b];
+          hash *= 1099511628211ULL;
+        }
+      }
+    }
+  }
+
+  return hash;
+}
+
+/* Time until all chunks within a render radius are ready for the GPU after a restart: generated, edited and meshed on
+ * all threads as without the mesh cache, against read from the cache (from the file system cache, as it was just
+ * written) and meshed on all threads. The chunks read and their meshes have to equal the ones written; an edit
+ * afterwards has to drop its chunk from the cache, other generation settings the whole cache. The upload to the GPU is
+ * the same either way and not part of it, as benchmarks run without a window. */
+static void BenchmarkMeshCache()
+{
+  const char* mapPath = "MeshCache.benchmark";
+  const int32_t radius = 8;
+  const int32_t side = 2 * radius + 1;
+  const int32_t batchSize = 9; //As many as "MapForceChunksNearPlayer()" loads at once, as meshes get room for the worst case
+  const int32_t editedX = 2, editedZ = -3;
+
+  char cachePath[256];
+  snprintf(cachePath, ARRAY_SIZE(cachePath), "%s.meshes", mapPath);
+  remove(cachePath);
+
+  //Edits made before the cache is written are part of it.
+  for(int32_t i = 0; i < 64; ++i)
+    DatabaseInsertBlock(i % 4 - 2, i / 16 - 2, BenchmarkRandom(71, i * 3, CHUNK_WIDTH), BenchmarkRandom(71, i * 3 + 1, CHUNK_HEIGHT), BenchmarkRandom(71, i * 3 + 2, CHUNK_WIDTH), GOLD_BLOCK);
+
+  uint64_t* hashes = (uint64_t*)OwnMalloc(side * side * sizeof(uint64_t), false);
+  Chunk** cached = (Chunk**)OwnMalloc(side * side * sizeof(Chunk*), false);
+
+  if(hashes == NULL || cached == NULL)
+  {
+    LogError("Variable \"hashes\" or \"cached\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  const int32_t numThreads = BenchmarkGetMaxThreads(1);
+  Worker* workers = BenchmarkCreateWorkers(numThreads - 1);
+
+  MeshCacheInit(mapPath, true);
+  bool success = MeshCacheBeginSave(0, 0);
+
+  double coldTime = 0.0, saveTime = 0.0;
+  int32_t numChunks = 0;
+  Chunk* batch[9];
+  int32_t batchCount = 0;
+
+  for(int32_t i = 0; i < side * side; ++i)
+  {
+    const int32_t x = i / side - radius;
+    const int32_t z = i % side - radius;
+    const int32_t distSquared = ChunkPlayerDistSquared(x, z, 0, 0);
+
+    if(distSquared <= radius * radius)
+    {
+      batch[batchCount] = ChunkInit(x, z);
+      batch[batchCount++]->lod = ChunkSelectLod(0, distSquared);
+      ++numChunks;
+    }
+
+    if(batchCount < batchSize && (batchCount == 0 || i < side * side - 1))
+      continue;
+
+    double start = TimeMeasurementNow();
+    MapLoadChunksNow(batch, batchCount, workers, numThreads - 1);
+    coldTime += TimeMeasurementNow() - start;
+
+    for(int32_t j = 0; j < batchCount; ++j)
+      hashes[(batch[j]->x + radius) * side + batch[j]->z + radius] = HashLoadedChunk(batch[j]);
+
+    start = TimeMeasurementNow();
+    for(int32_t j = 0; j < batchCount; ++j)
+      MeshCacheSaveChunk(batch[j]);
+    saveTime += TimeMeasurementNow() - start;
+
+    for(int32_t j = 0; j < batchCount; ++j)
+      BenchmarkFreeChunk(batch[j]);
+    batchCount = 0;
+  }
+
+  int32_t saved;
+  int64_t bytes;
+  double start = TimeMeasurementNow();
+  success &= MeshCacheEndSave(&saved, &bytes);
+  saveTime += TimeMeasurementNow() - start;
+
+  //Timed without checking anything, then checked.
+  int32_t loaded[3] = {0}, outdated[3] = {0};
+  int32_t mismatches = 0;
+  double warmTime = 0.0;
+
+  for(int32_t pass = 0; pass < 3; ++pass)
+  {
+    //The last pass follows an edit of one chunk.
+    if(pass == 2)
+      DatabaseInsertBlock(editedX, editedZ, 5, CHUNK_HEIGHT - 2, 5, GOLD_BLOCK);
+
+    start = TimeMeasurementNow();
+    success &= MeshCacheBeginLoad();
+
+    int32_t count = 0;
+    Chunk* c;
+    while(count < side * side && (c = MeshCacheLoadNext()) != NULL)
+      cached[count++] = c;
+
+    MapMeshChunksNow(cached, count, workers, numThreads - 1);
+
+    MeshCacheEndLoad(&loaded[pass], &outdated[pass]);
+    if(pass == 0)
+      warmTime = TimeMeasurementNow() - start;
+
+    for(int32_t i = 0; i < count; ++i)
+    {
+      if(pass == 1)
+        mismatches += HashLoadedChunk(cached[i]) != hashes[(cached[i]->x + radius) * side + cached[i]->z + radius];
+
+      BenchmarkFreeChunk(cached[i]);
+    }
+  }
+
+  BenchmarkDestroyWorkers(workers, numThreads - 1);
+
+  //Other generation settings make the whole cache useless.
+  CAVES_ENABLED = !CAVES_ENABLED;
+  const bool usedWithOtherSettings = MeshCacheBeginLoad();
+  if(usedWithOtherSettings)
+    MeshCacheEndLoad(&saved, &saved);
+  CAVES_ENABLED = !CAVES_ENABLED;
+
+  MeshCacheInit(NULL, false);
+  remove(cachePath);
+  free(hashes);
+  free(cached);
+
+  LogInfo("Radius | chunks | generated and meshed (ms) | from the cache and meshed (ms) | speed-up | cache (MB) | writing the cache (ms)\n", false);
+  LogInfo("%6d | %6d | %25.1f | %30.1f | %7.1fx | %10.1f | %22.1f\n", false, radius, numChunks, coldTime * 1000.0, warmTime * 1000.0,
+          coldTime / MAX(warmTime, 1e-9), bytes / 1048576.0, saveTime * 1000.0);
+  LogInfo("Threads: %d. %d of %d chunks read differ from the ones written. After an edit, %d chunks were read and %d was out of date; "
+          "with other generation settings, the cache was %s.", true, numThreads, mismatches, loaded[1], loaded[2], outdated[2], usedWithOtherSettings ? "used" : "not used");
+
+  BenchmarkCheck(success && loaded[0] == numChunks && loaded[1] == numChunks && mismatches == 0 && loaded[2] == numChunks - 1 && outdated[2] == 1 && !usedWithOtherSettings,
+                 "The mesh cache lost chunks, changed them or kept outdated ones!");
+}
+
+static int CompareMeshAllocations(const void* a, const void* b)
+{
+  const MeshAllocation* x = (const MeshAllocation*)a;
+  const MeshAllocation* y = (const MeshAllocation*)b;
+
+  if(x->page != y->page)
+    return x->page < y->page ? -1 : 1;
+
+  return x->first < y->first ? -1 : x->first > y->first;
+}
+
+//Number of allocations whose ranges overlap the next one of the same page.
+static int32_t CountOverlappingAllocations(const MeshAllocation* allocations, int32_t count)
+{
+  MeshAllocation* sorted = (MeshAllocation*)OwnMalloc(MAX(1, count) * sizeof(MeshAllocation), false);
+
+  if(sorted == NULL)
+  {
+    LogError("Variable \"sorted\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  int32_t numSorted = 0;
+  for(int32_t i = 0; i < count; ++i)
+  {
+    if(allocations[i].page >= 0)
+      sorted[numSorted++] = allocations[i];
+  }
+
+  qsort(sorted, numSorted, sizeof(MeshAllocation), CompareMeshAllocations);
+
+  int32_t overlaps = 0;
+  for(int32_t i = 0; i + 1 < numSorted; ++i)
+    overlaps += sorted[i].page == sorted[i + 1].page && sorted[i].first + sorted[i].capacity > sorted[i + 1].first;
+
+  free(sorted);
+
+  return overlaps;
+}
+
+/* Vertex memory of the chunk meshes under churn, with the vertex counts of the chunks within a render radius: most
+ * uploads are remeshes after an edit (up to two cubes more or less), the rest chunks unloaded and others loaded
+ * in their place. Only the ranges are tracked, as benchmarks run without a window; before the pool, every upload
+ * created two vertex array objects and two buffers, and every frame bound a vertex array object per mesh. */
+static void BenchmarkMeshPool()
+{
+  const int32_t radius = 8;
+  const int32_t side = 2 * radius + 1;
+  const int32_t numUploads = 100000;
+
+  uint32_t* counts = (uint32_t*)OwnMalloc(side * side * 2 * sizeof(uint32_t), false);
+  MeshAllocation* allocations = (MeshAllocation*)OwnMalloc(side * side * 2 * sizeof(MeshAllocation), false);
+
+  if(counts == NULL || allocations == NULL)
+  {
+    LogError("Variable \"counts\" or \"allocations\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  const int32_t numThreads = BenchmarkGetMaxThreads(1);
+  Worker* workers = BenchmarkCreateWorkers(numThreads - 1);
+
+  //Vertex counts of the meshes (land and water) of every chunk in view.
+  int32_t numChunks = 0;
+  for(int32_t i = 0; i < side * side; ++i)
+  {
+    const int32_t x = i / side - radius;
+    const int32_t z = i % side - radius;
+    const int32_t distSquared = ChunkPlayerDistSquared(x, z, 0, 0);
+
+    if(distSquared > radius * radius)
+      continue;
+
+    Chunk* c = ChunkInit(x, z);
+    c->lod = ChunkSelectLod(0, distSquared);
+    MapLoadChunksNow(&c, 1, workers, numThreads - 1);
+
+    counts[numChunks * 2] = (uint32_t)c->vertexLandCount;
+    counts[numChunks * 2 + 1] = (uint32_t)c->vertexWaterCount;
+    ++numChunks;
+
+    BenchmarkFreeChunk(c);
+  }
+
+  BenchmarkDestroyWorkers(workers, numThreads - 1);
+
+  const int32_t numMeshes = numChunks * 2;
+
+  MeshPoolInit(sizeof(Vertex), NULL);
+
+  bool success = true;
+  for(int32_t i = 0; i < numMeshes; ++i)
+  {
+    MeshPoolInitAllocation(&allocations[i]);
+    success &= MeshPoolUpload(&allocations[i], NULL, counts[i]);
+  }
+
+  MeshPoolStats loaded;
+  MeshPoolGetStats(&loaded);
+
+  int32_t inPlace = 0, replaced = 0, overlaps = 0;
+  double uploadTime = 0.0;
+
+  for(int32_t u = 0; u < numUploads; ++u)
+  {
+    const int32_t mesh = BenchmarkRandom(81, u, numMeshes);
+    MeshAllocation* a = &allocations[mesh];
+
+    uint32_t count;
+    //An edit adds or removes up to two cubes (six faces of two triangles each).
+    if(BenchmarkRandom(82, u, 10) < 8)
+      count = (uint32_t)MAX(0, (int32_t)a->count + (BenchmarkRandom(83, u, 25) - 12) * 6);
+    else
+    {
+      //Land stays land, water stays water.
+      count = counts[BenchmarkRandom(84, u, numChunks) * 2 + mesh % 2];
+      ++replaced;
+    }
+
+    const MeshAllocation before = *a;
+
+    const double start = TimeMeasurementNow();
+    success &= MeshPoolUpload(a, NULL, count);
+    uploadTime += TimeMeasurementNow() - start;
+
+    inPlace += before.page >= 0 && a->page == before.page && a->first == before.first;
+
+    if(u % 10000 == 0)
+      overlaps += CountOverlappingAllocations(allocations, numMeshes);
+  }
+
+  overlaps += CountOverlappingAllocations(allocations, numMeshes);
+
+  MeshPoolStats churned;
+  MeshPoolGetStats(&churned);
+
+  //Once everything is released, every page has to be one free range again.
+  for(int32_t i = 0; i < numMeshes; ++i)
+    MeshPoolRelease(&allocations[i]);
+
+  MeshPoolStats released;
+  MeshPoolGetStats(&released);
+  MeshPoolFree();
+
+  free(counts);
+  free(allocations);
+
+  const double toMB = sizeof(Vertex) / 1048576.0;
+
+  LogInfo("State          | pages (MB) | allocated (MB) | drawn (MB) | free ranges | largest free (MB) | fragmentation\n", false);
+  LogInfo("Loaded         | %2d (%5.1f) | %14.1f | %10.1f | %11d | %17.1f | %12.1f%%\n", false, loaded.pages, loaded.capacity * toMB, loaded.allocated * toMB,
+          loaded.drawn * toMB, loaded.freeRanges, loaded.largestFree * toMB, loaded.fragmentation * 100.0f);
+  LogInfo("After churn    | %2d (%5.1f) | %14.1f | %10.1f | %11d | %17.1f | %12.1f%%\n", false, churned.pages, churned.capacity * toMB, churned.allocated * toMB,
+          churned.drawn * toMB, churned.freeRanges, churned.largestFree * toMB, churned.fragmentation * 100.0f);
+  LogInfo("%d chunks (%d meshes), %d uploads (%d of other chunks): %.1f%% written in place, %.3f us per upload on the CPU. "
+          "Per frame, at most %d vertex array objects are bound instead of %d; %d buffers (and vertex array objects) were created instead of %d.", true,
+          numChunks, numMeshes, numUploads, replaced, inPlace * 100.0 / numUploads, uploadTime * 1e6 / numUploads,
+          2 * churned.pages, numMeshes, churned.pages, numMeshes + numUploads);
+
+  BenchmarkCheck(success && overlaps == 0 && released.allocations == 0 && released.allocated == 0 && released.drawn == 0 && released.freeRanges == released.pages,
+                 "The mesh pool handed out overlapping ranges or lost memory!");
+}
+
+static const BenchmarkEntry benchmarks[] =
+{
+  {"chunk-latency", "Latency of urgently needed chunks with 1 to N threads", BenchmarkChunkLatency},
+  {"chunk-lod", "Triangles and meshing time of the chunks within radius 24 and 32 with and without levels of detail", BenchmarkChunkLod},
+  {"mesh-cache", "Time until the chunks within a render radius are ready for the GPU after a restart, with and without the mesh cache, and its invalidation", BenchmarkMeshCache},
+  {"mesh-pool", "Fragmentation, memory and CPU cost of the GPU sub-allocator of the chunk meshes under remeshing and chunk churn", BenchmarkMeshPool}
+};
+
+const BenchmarkEntry* MapBenchmarksGet(int32_t* count)
+{
+  *count = (int32_t)ARRAY_SIZE(benchmarks);
+
+  return benchmarks;
+}
\ No newline at end of file
@@ -0,0 +1,1152 @@
+#include "BenchmarkCommon.h"
+
+#include "../ChunkStore.h"
+#include "../Database.h"
+#include "../EditCompactor.h"
+#include "../Exporter.h"
+#include "../RegionStore.h"
+#include "../Snapshot.h"
+#include "../TimeMeasurement.h"
+#include "../WorldGenerator.h"
+
+#include "SQLite/sqlite3.h"
+
+#include "../Map/Block.h"
+
+//Swaps the in-memory database for a new database file, as committing to an in-memory one costs next to nothing.
+static void OpenDatabaseFile(const char* fileName)
+{
+  DatabaseFree();
+  remove(fileName);
+  DatabaseInit(fileName);
+}
+
+//Deletes the database file and goes back to the in-memory database for whatever follows.
+static void CloseDatabaseFile(const char* fileName)
+{
+  DatabaseFree();
+  remove(fileName);
+  DatabaseInit(":memory:");
+}
+
+//"BenchmarkChunkFunc": the edits of the chunk on cleared blocks.
+static void LoadEdits(void* data, Chunk* c, int32_t k)
+{
+  (void)data;
+  (void)k;
+
+  memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+  DatabaseGetBlocksForChunk(c);
+}
+
+//"BenchmarkChunkFunc": the edits of the chunk on its terrain, which "data" holds for every chunk of the grid.
+static void LoadEditsOnTerrain(void* data, Chunk* c, int32_t k)
+{
+  memcpy(c->blocks, &((const uint8_t*)data)[k * BLOCKS_MEMORY_SIZE], BLOCKS_MEMORY_SIZE);
+  DatabaseGetBlocksForChunk(c);
+}
+
+//"BenchmarkChunkFunc": the stored chunk with its edits; "data" counts the chunks not stored.
+static void LoadStoredChunk(void* data, Chunk* c, int32_t k)
+{
+  (void)k;
+
+  *(int32_t*)data += !ChunkStoreLoad(c);
+  DatabaseGetBlocksForChunk(c);
+}
+
+//Chunks of the "side" x "side" grid which "load" leaves with other blocks than "expected"; not timed, unlike "BenchmarkTimeGrid()".
+static int32_t CountMismatches(Chunk* c, int32_t side, BenchmarkChunkFunc load, void* data, const uint8_t* expected)
+{
+  int32_t mismatches = 0;
+  for(int32_t k = 0; k < side * side; ++k)
+  {
+    BenchmarkPlaceInGrid(c, k, side);
+    load(data, c, k);
+    mismatches += memcmp(c->blocks, &expected[k * BLOCKS_MEMORY_SIZE], BLOCKS_MEMORY_SIZE) != 0;
+  }
+
+  return mismatches;
+}
+
+static void QueueBenchmarkEdit(uint32_t stream, int32_t index)
+{
+  DatabaseInsertBlock(BenchmarkRandom(stream, index * 6, 16) - 8, BenchmarkRandom(stream, index * 6 + 1, 16) - 8, BenchmarkRandom(stream, index * 6 + 2, CHUNK_WIDTH),
+                      BenchmarkRandom(stream, index * 6 + 3, CHUNK_HEIGHT), BenchmarkRandom(stream, index * 6 + 4, CHUNK_WIDTH), 1 + BenchmarkRandom(stream, index * 6 + 5, AMOUNT_BLOCKS - 1));
+}
+
+static void BenchmarkDatabaseWriter()
+{
+  const char* fileName = "Edits.benchmark";
+  const int32_t numCommitted = 2000;
+  const int32_t numBurst = 10000; //Fits into the queue
+  const int32_t numQueued = 200000;
+  const int32_t checkChunkX = 1000;
+  const int32_t checkChunkZ = 1000;
+
+  OpenDatabaseFile(fileName);
+
+  int64_t edits[4], transactions[4];
+  DatabaseGetWriterStats(&edits[0], &transactions[0]);
+
+  //One commit per edit, as every edit used to be written on the main thread in a transaction of its own.
+  double start = TimeMeasurementNow();
+  for(int32_t i = 0; i < numCommitted; ++i)
+  {
+    QueueBenchmarkEdit(1, i);
+    DatabaseFlush();
+  }
+  const double committedTime = TimeMeasurementNow() - start;
+
+  DatabaseGetWriterStats(&edits[1], &transactions[1]);
+
+  //Edits are queued and grouped by the writer; only the queueing is up to the main thread, as long as the writer keeps up.
+  start = TimeMeasurementNow();
+  for(int32_t i = 0; i < numBurst; ++i)
+    QueueBenchmarkEdit(2, i);
+  const double burstTime = TimeMeasurementNow() - start;
+
+  DatabaseFlush();
+  const double burstCommittedTime = TimeMeasurementNow() - start;
+
+  DatabaseGetWriterStats(&edits[2], &transactions[2]);
+
+  //Far more edits than the queue holds, so the main thread has to wait for the writer.
+  start = TimeMeasurementNow();
+  for(int32_t i = 0; i < numQueued; ++i)
+    QueueBenchmarkEdit(3, i);
+  const double queueTime = TimeMeasurementNow() - start;
+
+  //Read after write: the chunk has to see the edits queued before it was loaded.
+  for(int32_t y = 0; y < CHUNK_HEIGHT; ++y)
+    DatabaseInsertBlock(checkChunkX, checkChunkZ, y % CHUNK_WIDTH, y, (y * 7) % CHUNK_WIDTH, 1 + y % (AMOUNT_BLOCKS - 1));
+
+  Chunk* c = BenchmarkCreateChunk(checkChunkX, checkChunkZ);
+  DatabaseGetBlocksForChunk(c);
+
+  DatabaseFlush();
+  const double sustainedTime = TimeMeasurementNow() - start;
+
+  DatabaseGetWriterStats(&edits[3], &transactions[3]);
+
+  int32_t missing = 0;
+  for(int32_t y = 0; y < CHUNK_HEIGHT; ++y)
+    missing += c->blocks[XYZ(y % CHUNK_WIDTH, y, (y * 7) % CHUNK_WIDTH)] != 1 + y % (AMOUNT_BLOCKS - 1);
+
+  BenchmarkFreeChunk(c);
+
+  CloseDatabaseFile(fileName);
+
+  LogInfo("Mode              |  edits | main thread (us/edit) | committed (edits/s) | edits/transaction\n", false);
+  LogInfo("Commit every edit | %6d | %21.3f | %19.0f | %17.1f\n", false, numCommitted, committedTime * 1e6 / numCommitted, numCommitted / committedTime,
+          (double)(edits[1] - edits[0]) / MAX(1, transactions[1] - transactions[0]));
+  LogInfo("Queued burst      | %6d | %21.3f | %19.0f | %17.1f\n", false, numBurst, burstTime * 1e6 / numBurst, numBurst / burstCommittedTime,
+          (double)(edits[2] - edits[1]) / MAX(1, transactions[2] - transactions[1]));
+  LogInfo("Queued sustained  | %6d | %21.3f | %19.0f | %17.1f\n", false, numQueued + CHUNK_HEIGHT, queueTime * 1e6 / numQueued, (numQueued + CHUNK_HEIGHT) / sustainedTime,
+          (double)(edits[3] - edits[2]) / MAX(1, transactions[3] - transactions[2]));
+  LogInfo("Edits over 16 x 16 chunks of a database file; %d of the %d edits queued right before loading a chunk were missing.", true, missing, CHUNK_HEIGHT);
+
+  BenchmarkCheck(missing == 0, "Queued edits are not visible to chunks loaded afterwards!");
+}
+
+/* "BenchmarkDatabaseConcurrency()": edits of round "r" on stored chunk "k" go to column ("r" % width, "k" % width) at
+ * height "r" / width, with a block unlike the stored one (the top layer is never edited). */
+#define STRESS_GRID_SIDE 8
+#define STRESS_NUM_CHUNKS (STRESS_GRID_SIDE * STRESS_GRID_SIDE)
+
+typedef struct
+{
+  volatile int64_t* rounds; //Rounds fully queued by the main thread
+  volatile int64_t* stop;
+  uint32_t stream;
+
+  int64_t lookups;
+  int64_t errors;
+} StressReader;
+
+static uint8_t StressStoredBlock(int32_t k)
+{
+  return (uint8_t)(1 + k % (AMOUNT_BLOCKS - 1));
+}
+
+static uint8_t StressEditBlock(int32_t k, int32_t r)
+{
+  return (uint8_t)(1 + (k + 1 + r % (AMOUNT_BLOCKS - 2)) % (AMOUNT_BLOCKS - 1));
+}
+
+static int32_t StressReaderLoop(void* data)
+{
+  StressReader* reader = (StressReader*)data;
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+
+  while(!AtomicLoadAcquire(reader->stop))
+  {
+    const int32_t k = BenchmarkRandom(reader->stream, (uint32_t)reader->lookups, STRESS_NUM_CHUNKS);
+    const int64_t rounds = AtomicLoadAcquire(reader->rounds);
+
+    c->x = k % STRESS_GRID_SIDE;
+    c->z = k / STRESS_GRID_SIDE;
+    memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+
+    if(!DatabaseLoadChunk(c))
+      ++reader->errors;
+    DatabaseGetBlocksForChunk(c);
+
+    //Every edit of the finished rounds has to be there; later ones may or may not.
+    const int32_t maxRounds = CHUNK_WIDTH * (CHUNK_HEIGHT - 1);
+    for(int32_t r = 0; r < maxRounds; ++r)
+    {
+      const uint8_t block = c->blocks[XYZ(r % CHUNK_WIDTH, r / CHUNK_WIDTH, k % CHUNK_WIDTH)];
+
+      if(block != StressEditBlock(k, r) && (r < rounds || block != StressStoredBlock(k)))
+        ++reader->errors;
+    }
+
+    reader->errors += c->blocks[XYZ(0, CHUNK_HEIGHT - 1, 0)] != StressStoredBlock(k);
+    ++reader->lookups;
+  }
+
+  BenchmarkFreeChunk(c);
+
+  return 0;
+}
+
+static void BenchmarkDatabaseConcurrency()
+{
+  const char* fileName = "Concurrency.benchmark";
+  const int32_t numRounds = MIN(1024, CHUNK_WIDTH * (CHUNK_HEIGHT - 1));
+  const double passTime = 2.0;
+  const int32_t maxReaders = BenchmarkGetMaxThreads(2);
+
+  OpenDatabaseFile(fileName);
+
+  Chunk* stored = BenchmarkCreateChunk(0, 0);
+
+  DatabaseBeginTransaction();
+  for(int32_t k = 0; k < STRESS_NUM_CHUNKS; ++k)
+  {
+    BenchmarkPlaceInGrid(stored, k, STRESS_GRID_SIDE);
+    memset(stored->blocks, StressStoredBlock(k), BLOCKS_MEMORY_SIZE);
+    DatabaseInsertChunk(stored);
+  }
+  DatabaseCommitTransaction();
+
+  BenchmarkFreeChunk(stored);
+
+  StressReader* readers = (StressReader*)OwnMalloc(maxReaders * sizeof(StressReader), false);
+  thrd_t* threads = (thrd_t*)OwnMalloc(maxReaders * sizeof(thrd_t), false);
+
+  int64_t totalErrors = 0;
+  char table[1024];
+  int32_t length = 0;
+
+  //Once with a single reader, once with one per core, each time while the main thread edits the chunks being read.
+  for(int32_t pass = 0; pass < 2; ++pass)
+  {
+    const int32_t numReaders = pass == 0 ? 1 : maxReaders;
+    volatile int64_t rounds = 0;
+    volatile int64_t stop = 0;
+
+    for(int32_t i = 0; i < numReaders; ++i)
+    {
+      readers[i] = (StressReader){&rounds, &stop, (uint32_t)(pass * 64 + i), 0, 0};
+      thrd_create(&threads[i], StressReaderLoop, &readers[i]);
+    }
+
+    //The rounds start over once all are done, rewriting the same blocks, until the time is up.
+    const double start = TimeMeasurementNow();
+    int64_t numEdits = 0;
+    for(int32_t i = 0; TimeMeasurementNow() - start < passTime; ++i)
+    {
+      const int32_t r = i % numRounds;
+      for(int32_t k = 0; k < STRESS_NUM_CHUNKS; ++k)
+        DatabaseInsertBlock(k % STRESS_GRID_SIDE, k / STRESS_GRID_SIDE, r % CHUNK_WIDTH, r / CHUNK_WIDTH, k % CHUNK_WIDTH, StressEditBlock(k, r));
+
+      numEdits += STRESS_NUM_CHUNKS;
+      AtomicStoreRelease(&rounds, MIN(i + 1, numRounds));
+
+      //A player edits in bursts, not non-stop; this also leaves the readers some time on few cores.
+      thrd_yield();
+    }
+    DatabaseFlush();
+    const double editTime = TimeMeasurementNow() - start;
+
+    AtomicStoreRelease(&stop, 1);
+
+    int64_t lookups = 0;
+    int64_t errors = 0;
+    for(int32_t i = 0; i < numReaders; ++i)
+    {
+      thrd_join(threads[i], NULL);
+      lookups += readers[i].lookups;
+      errors += readers[i].errors;
+    }
+
+    const double time = TimeMeasurementNow() - start;
+    totalErrors += errors;
+
+    length += snprintf(table + length, sizeof(table) - length, "\n%7d | %9lld | %9.0f | %9lld | %9.0f | %lld", numReaders, (long long)lookups, lookups / time,
+                       (long long)numEdits, numEdits / editTime, (long long)errors);
+  }
+
+  free(threads);
+  free(readers);
+
+  CloseDatabaseFile(fileName);
+
+  LogInfo("Readers |   lookups | lookups/s |     edits |   edits/s | errors%s\n", false, table);
+  LogInfo("%d stored chunks, each looked up with its edits while rounds of edits to all of them are committed (%.1f s per row).", true, STRESS_NUM_CHUNKS, passTime);
+
+  if(BenchmarkCheck(totalErrors == 0, "Chunk lookups missed committed edits or failed while being edited!"))
+    LogSuccess("All chunk lookups saw every edit queued before them.", true);
+}
+
+static int64_t FileSize(const char* path)
+{
+  FILE* f = NULL;
+  if(fopen_s(&f, path, "rb") != 0 || f == NULL)
+    return 0;
+
+  fseek(f, 0, SEEK_END);
+  const int64_t size = ftell(f);
+  fclose(f);
+
+  return size;
+}
+
+//A map in the format before "ChunkEdits" (one row per edited block), as the migration finds it.
+static void WriteLegacyEditMap(const char* fileName, int32_t side, int32_t editsPerChunk)
+{
+  sqlite3* legacy;
+  sqlite3_open(fileName, &legacy);
+
+  sqlite3_exec(legacy, "CREATE TABLE Blocks(chunkX INTEGER NOT NULL, chunkZ INTEGER NOT NULL, x INTEGER NOT NULL, "
+                       "y INTEGER NOT NULL, z INTEGER NOT NULL, type INTEGER NOT NULL, PRIMARY KEY(chunkX, chunkZ, x, y, z))", NULL, NULL, NULL);
+  sqlite3_exec(legacy, "BEGIN TRANSACTION", NULL, NULL, NULL);
+
+  sqlite3_stmt* stmt;
+  sqlite3_prepare_v2(legacy, "INSERT OR REPLACE INTO Blocks (chunkX, chunkZ, x, y, z, type) VALUES (?, ?, ?, ?, ?, ?)", -1, &stmt, NULL);
+
+  for(int32_t k = 0; k < side * side; ++k)
+  {
+    for(int32_t i = 0; i < editsPerChunk; ++i)
+    {
+      const uint32_t index = (uint32_t)(k * editsPerChunk + i) * 4;
+
+      sqlite3_reset(stmt);
+      sqlite3_bind_int(stmt, 1, k % side);
+      sqlite3_bind_int(stmt, 2, k / side);
+      sqlite3_bind_int(stmt, 3, BenchmarkRandom(21, index, CHUNK_WIDTH));
+      sqlite3_bind_int(stmt, 4, BenchmarkRandom(21, index + 1, CHUNK_HEIGHT));
+      sqlite3_bind_int(stmt, 5, BenchmarkRandom(21, index + 2, CHUNK_WIDTH));
+      sqlite3_bind_int(stmt, 6, BenchmarkRandom(21, index + 3, AMOUNT_BLOCKS));
+      sqlite3_step(stmt);
+    }
+  }
+
+  sqlite3_finalize(stmt);
+  sqlite3_exec(legacy, "COMMIT", NULL, NULL, NULL);
+  sqlite3_close(legacy);
+}
+
+static void BenchmarkEditBlobs()
+{
+  const char* fileName = "EditBlobs.benchmark";
+  const int32_t side = 4;
+  const int32_t numChunks = side * side;
+  const int32_t editsPerChunk = 20000;
+  const int32_t rounds = 8;
+
+  DatabaseFree();
+  remove(fileName);
+
+  double start = TimeMeasurementNow();
+  WriteLegacyEditMap(fileName, side, editsPerChunk);
+  const double writeTime = TimeMeasurementNow() - start;
+  const int64_t legacySize = FileSize(fileName);
+
+  uint8_t* expected = (uint8_t*)OwnMalloc(numChunks * BLOCKS_MEMORY_SIZE, false);
+
+  //Loads as they were: a range scan over the rows of the chunk.
+  sqlite3* legacy;
+  sqlite3_open(fileName, &legacy);
+
+  sqlite3_stmt* stmt;
+  sqlite3_prepare_v2(legacy, "SELECT x, y, z, type FROM Blocks WHERE chunkX = ? AND chunkZ = ?", -1, &stmt, NULL);
+
+  int64_t legacyRows = 0;
+  start = TimeMeasurementNow();
+  for(int32_t r = 0; r < rounds; ++r)
+  {
+    for(int32_t k = 0; k < numChunks; ++k)
+    {
+      uint8_t* chunkBlocks = &expected[k * BLOCKS_MEMORY_SIZE];
+      memset(chunkBlocks, 0, BLOCKS_MEMORY_SIZE);
+
+      sqlite3_reset(stmt);
+      sqlite3_bind_int(stmt, 1, k % side);
+      sqlite3_bind_int(stmt, 2, k / side);
+
+      while(sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        chunkBlocks[XYZ(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2))] = (uint8_t)sqlite3_column_int(stmt, 3);
+        legacyRows += r == 0;
+      }
+    }
+  }
+  const double legacyLoadTime = (TimeMeasurementNow() - start) / ((double)rounds * numChunks);
+
+  sqlite3_finalize(stmt);
+  sqlite3_close(legacy);
+
+  //Opening the map migrates it.
+  start = TimeMeasurementNow();
+  DatabaseInit(fileName);
+  const double migrationTime = TimeMeasurementNow() - start;
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+  const double blobLoadTime = BenchmarkTimeGrid(c, side, rounds, LoadEdits, NULL);
+  const int32_t mismatches = CountMismatches(c, side, LoadEdits, NULL, expected);
+
+  BenchmarkFreeChunk(c);
+  free(expected);
+
+  DatabaseFree();
+  const int64_t blobSize = FileSize(fileName);
+
+  remove(fileName);
+  DatabaseInit(":memory:");
+
+  LogInfo("Format           | rows   | file (MB) | load (ms/chunk)\n", false);
+  LogInfo("Row per block    | %6lld | %9.2f | %15.3f\n", false, (long long)legacyRows, legacySize / 1048576.0, legacyLoadTime * 1000.0);
+  LogInfo("Blob per chunk   | %6d | %9.2f | %15.3f\n", false, numChunks, blobSize / 1048576.0, blobLoadTime * 1000.0);
+  LogInfo("%d chunks with %d random edits each (written in %.1f ms), migrated on opening in %.1f ms; %d mismatching loads.", true,
+          numChunks, editsPerChunk, writeTime * 1000.0, migrationTime * 1000.0, mismatches);
+
+  BenchmarkCheck(mismatches == 0, "Chunks load other edits from the blobs than from the rows they were migrated from!");
+}
+
+//Loads every chunk of the square from the store and applies its edits; returns the seconds per chunk.
+static double LoadStoredChunks(Chunk* c, int32_t side, const uint8_t* expected, int32_t* misses, int32_t* mismatches)
+{
+  const double duration = BenchmarkTimeGrid(c, side, 1, LoadStoredChunk, misses);
+
+  int32_t comparedMisses = 0;
+  *mismatches += CountMismatches(c, side, LoadStoredChunk, &comparedMisses, expected);
+
+  return duration;
+}
+
+static void BenchmarkRegionStore()
+{
+  const char* mapPath = "RegionStore.benchmark";
+  const char* regionPath = "RegionStore.benchmark.r.0.0";
+  const int32_t side = 8; //All in region (0, 0)
+  const int32_t numChunks = side * side;
+  const int32_t editsPerChunk = 200;
+  const int32_t rounds = 4;
+
+  remove(regionPath);
+  ChunkStoreInit(mapPath, true);
+
+  for(int32_t k = 0; k < numChunks; ++k)
+    BenchmarkEditChunk(23, k, side, editsPerChunk);
+  DatabaseFlush();
+
+  uint8_t* expected = (uint8_t*)OwnMalloc(numChunks * BLOCKS_MEMORY_SIZE, false);
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+
+  //Without a stored chunk: generation and the edits on top, as every load did before.
+  double generateTime = 0.0;
+  double saveTime = 0.0;
+  for(int32_t k = 0; k < numChunks; ++k)
+  {
+    BenchmarkPlaceInGrid(c, k, side);
+
+    double start = TimeMeasurementNow();
+    memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+    WorldGeneratorGenerateChunk(c);
+    generateTime += TimeMeasurementNow() - start;
+
+    start = TimeMeasurementNow();
+    ChunkStoreKeepGenerated(c);
+    saveTime += TimeMeasurementNow() - start;
+
+    start = TimeMeasurementNow();
+    DatabaseGetBlocksForChunk(c);
+    generateTime += TimeMeasurementNow() - start;
+
+    memcpy(&expected[k * BLOCKS_MEMORY_SIZE], c->blocks, BLOCKS_MEMORY_SIZE);
+  }
+  generateTime /= numChunks;
+  saveTime /= numChunks;
+
+  const int64_t fileSize = RegionStoreGetFileSize(0, 0);
+
+  //Reopened, so that the first pass has to map the file.
+  ChunkStoreFree();
+  ChunkStoreInit(mapPath, true);
+
+  int32_t misses = 0;
+  int32_t mismatches = 0;
+  const double firstLoadTime = LoadStoredChunks(c, side, expected, &misses, &mismatches);
+
+  double loadTime = 0.0;
+  for(int32_t r = 0; r < rounds; ++r)
+    loadTime += LoadStoredChunks(c, side, expected, &misses, &mismatches) / rounds;
+
+  //Every chunk stored three times more leaves three payloads per chunk behind, which are dropped on opening the region again.
+  for(int32_t r = 0; r < 2; ++r)
+  {
+    for(int32_t k = 0; k < numChunks; ++k)
+    {
+      BenchmarkPlaceInGrid(c, k, side);
+
+      misses += !ChunkStoreLoad(c);
+      ChunkStoreSave(c);
+    }
+  }
+
+  //The payloads appended lie beyond the mapping, so the file is mapped anew while it is open for writing.
+  int32_t missesWhileWriting = 0;
+  LoadStoredChunks(c, side, expected, &missesWhileWriting, &mismatches);
+  misses += missesWhileWriting;
+
+  //Storing a chunk and loading it right after maps the file anew every time; the mappings replaced must not pile up.
+  for(int32_t k = 0; k < numChunks; ++k)
+  {
+    BenchmarkPlaceInGrid(c, k, side);
+
+    misses += !ChunkStoreLoad(c);
+    ChunkStoreSave(c);
+    misses += !ChunkStoreLoad(c);
+    DatabaseGetBlocksForChunk(c);
+    mismatches += memcmp(c->blocks, &expected[k * BLOCKS_MEMORY_SIZE], BLOCKS_MEMORY_SIZE) != 0;
+  }
+  const int32_t numMappings = RegionStoreGetNumMappings(0, 0);
+
+  const int64_t grownSize = RegionStoreGetFileSize(0, 0);
+
+  ChunkStoreFree();
+  ChunkStoreInit(mapPath, true);
+
+  const int64_t compactedSize = RegionStoreGetFileSize(0, 0);
+  LoadStoredChunks(c, side, expected, &misses, &mismatches);
+
+  //Neither store may hand out chunks of another world generation.
+  ChunkStoreFree();
+  ChunkStoreInit(mapPath, false);
+  ChunkStoreSave(c);
+
+  int32_t otherGeneration = 0;
+  CAVES_ENABLED = !CAVES_ENABLED;
+  for(int32_t regions = 0; regions < 2; ++regions)
+  {
+    ChunkStoreFree();
+    ChunkStoreInit(mapPath, regions);
+    otherGeneration += ChunkStoreHas(c->x, c->z) + ChunkStoreLoad(c);
+  }
+  CAVES_ENABLED = !CAVES_ENABLED;
+
+  BenchmarkFreeChunk(c);
+  free(expected);
+
+  ChunkStoreFree();
+  remove(regionPath);
+
+  //Drops the chunk stored in the database along with the edits.
+  DatabaseFree();
+  DatabaseInit(":memory:");
+
+  LogInfo("Load                   | ms/chunk\n", false);
+  LogInfo("Generation + edits     | %8.3f\n", false, generateTime * 1000.0);
+  LogInfo("Region file (opening)  | %8.3f\n", false, firstLoadTime * 1000.0);
+  LogInfo("Region file + edits    | %8.3f\n", false, loadTime * 1000.0);
+  LogInfo("%d chunks with %d edits each: loading them from the region file is %.1fx faster than generating them; storing one takes %.3f ms.", true,
+          numChunks, editsPerChunk, loadTime > 0.0 ? generateTime / loadTime : 0.0, saveTime * 1000.0);
+  LogInfo("Region file: %.1f KB (%.1f KB per chunk), %.1f KB after storing every chunk three times more, %.1f KB after compacting it; %d misses (%d while "
+          "open for writing), %d mismatching loads, %d chunks of another world generation returned; %d mapping(s) left after %d remaps.", true,
+          fileSize / 1024.0, fileSize / 1024.0 / numChunks, grownSize / 1024.0, compactedSize / 1024.0, misses, missesWhileWriting, mismatches,
+          otherGeneration, numMappings, numChunks);
+
+  BenchmarkCheck(misses == 0 && mismatches == 0 && otherGeneration == 0, "Chunks load other blocks from the region file than generating them and applying their edits!");
+
+  BenchmarkCheck(compactedSize < grownSize, "The region file has not been compacted on opening it!");
+
+  BenchmarkCheck(numMappings == 1, "Mappings of the region file are kept after nobody reads from them any more!");
+}
+
+static void BenchmarkEditIndex()
+{
+  const char* fileName = "EditIndex.benchmark";
+  const int32_t side = 48;
+  const int32_t numChunks = side * side;
+  const int32_t editedEvery = 20; //About 5 % of the chunks, spread over the square
+  const int32_t editsPerChunk = 50;
+  const int32_t rounds = 8;
+
+  OpenDatabaseFile(fileName);
+
+  int32_t numEdited = 0;
+  for(int32_t k = 0; k < numChunks; ++k)
+  {
+    if(BenchmarkRandom(31, k, editedEvery) != 0)
+      continue;
+
+    BenchmarkEditChunk(32, k, side, editsPerChunk);
+    ++numEdited;
+  }
+
+  DatabaseFree();
+
+  //Opening the map builds the index.
+  double start = TimeMeasurementNow();
+  DatabaseInit(fileName);
+  const double openTime = TimeMeasurementNow() - start;
+
+  //Lookups as they were: a query for every chunk, whether it has edits or not.
+  sqlite3* direct;
+  sqlite3_open_v2(fileName, &direct, SQLITE_OPEN_READONLY, NULL);
+
+  sqlite3_stmt* stmt;
+  sqlite3_prepare_v2(direct, "SELECT edits FROM ChunkEdits WHERE chunkX = ? AND chunkZ = ?", -1, &stmt, NULL);
+
+  int32_t mismatches = 0;
+  start = TimeMeasurementNow();
+  for(int32_t r = 0; r < rounds; ++r)
+  {
+    for(int32_t k = 0; k < numChunks; ++k)
+    {
+      sqlite3_reset(stmt);
+      sqlite3_bind_int(stmt, 1, k % side);
+      sqlite3_bind_int(stmt, 2, k / side);
+
+      const bool hasRow = sqlite3_step(stmt) == SQLITE_ROW;
+      mismatches += r == 0 && hasRow != DatabaseChunkHasEdits(k % side, k / side);
+    }
+  }
+  const double queryTime = (TimeMeasurementNow() - start) / ((double)rounds * numChunks);
+
+  sqlite3_finalize(stmt);
+  sqlite3_close(direct);
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+  memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+
+  //Unedited chunks only, so that applying edits is not part of the timing.
+  int32_t numLookups = 0;
+  start = TimeMeasurementNow();
+  for(int32_t r = 0; r < rounds; ++r)
+  {
+    for(int32_t k = 0; k < numChunks; ++k)
+    {
+      if(BenchmarkRandom(31, k, editedEvery) == 0)
+        continue;
+
+      BenchmarkPlaceInGrid(c, k, side);
+      DatabaseGetBlocksForChunk(c);
+      ++numLookups;
+    }
+  }
+  const double indexTime = (TimeMeasurementNow() - start) / numLookups;
+
+  for(uintmax_t i = 0; i < BLOCKS_MEMORY_SIZE; ++i)
+    mismatches += c->blocks[i] != 0;
+
+  //An edit of a chunk without any has to be seen right away.
+  c->x = -1;
+  c->z = -1;
+  DatabaseInsertBlock(c->x, c->z, 1, 2, 3, STONE_BLOCK);
+  DatabaseGetBlocksForChunk(c);
+  mismatches += c->blocks[XYZ(1, 2, 3)] != STONE_BLOCK;
+
+  //Likewise at the most negative coordinates, whose packed key is "INT64_MIN"; compaction has to find the chunk, too.
+  c->x = INT32_MIN;
+  c->z = 0;
+  DatabaseInsertBlock(c->x, c->z, 1, 2, 3, GRASS_BLOCK);
+  DatabaseGetBlocksForChunk(c);
+  mismatches += c->blocks[XYZ(1, 2, 3)] != GRASS_BLOCK;
+
+  int32_t* coords;
+  const int32_t numIndexed = DatabaseGetEditedChunks(&coords);
+  bool listed = false;
+  for(int32_t i = 0; i < numIndexed; ++i)
+    listed |= coords[i * 2] == INT32_MIN && coords[i * 2 + 1] == 0;
+  free(coords);
+  mismatches += !listed;
+
+  //An edit queued before a transaction is seen within it.
+  c->x = -2;
+  c->z = -1;
+  DatabaseInsertBlock(c->x, c->z, 1, 2, 3, STONE_BLOCK);
+  DatabaseBeginTransaction();
+  DatabaseGetBlocksForChunk(c);
+  DatabaseCommitTransaction();
+  mismatches += c->blocks[XYZ(1, 2, 3)] != STONE_BLOCK;
+
+  BenchmarkFreeChunk(c);
+
+  CloseDatabaseFile(fileName);
+
+  LogInfo("Lookup of an unedited chunk | us/chunk\n", false);
+  LogInfo("Query                       | %8.3f\n", false, queryTime * 1e6);
+  LogInfo("Edit index                  | %8.3f\n", false, indexTime * 1e6);
+  LogInfo("%d of %d chunks edited; opening the map (with building the index) took %.1f ms, unedited chunks are looked up %.0fx faster; %d mismatches.", true,
+          numEdited, numChunks, openTime * 1000.0, indexTime > 0.0 ? queryTime / indexTime : 0.0, mismatches);
+
+  BenchmarkCheck(mismatches == 0, "The edit index does not agree with the stored edits!");
+}
+
+static void BenchmarkEditCompaction()
+{
+  const int32_t side = 4;
+  const int32_t numChunks = side * side;
+  const int32_t changesPerChunk = 2000; //Blocks which really differ from the terrain
+  const int32_t restoresPerChunk = 2000; //Blocks placed as they were generated
+  const int32_t churnPerChunk = 2000; //Blocks broken and placed again
+  const int32_t rounds = 8;
+  const int32_t restoredChunk = numChunks - 1; //Only gets blocks placed as they were generated
+
+  uint8_t* terrain = (uint8_t*)OwnMalloc(numChunks * BLOCKS_MEMORY_SIZE, false);
+  uint8_t* expected = (uint8_t*)OwnMalloc(numChunks * BLOCKS_MEMORY_SIZE, false);
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+
+  for(int32_t k = 0; k < numChunks; ++k)
+  {
+    BenchmarkPlaceInGrid(c, k, side);
+    memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+    WorldGeneratorGenerateChunk(c);
+
+    const uint8_t* blocks = &terrain[k * BLOCKS_MEMORY_SIZE];
+    memcpy(&terrain[k * BLOCKS_MEMORY_SIZE], c->blocks, BLOCKS_MEMORY_SIZE);
+
+    for(int32_t i = 0; i < changesPerChunk + restoresPerChunk + churnPerChunk; ++i)
+    {
+      const uint32_t index = (uint32_t)(k * (changesPerChunk + restoresPerChunk + churnPerChunk) + i) * 4;
+      const int32_t x = BenchmarkRandom(41, index, CHUNK_WIDTH);
+      const int32_t y = BenchmarkRandom(41, index + 1, CHUNK_HEIGHT);
+      const int32_t z = BenchmarkRandom(41, index + 2, CHUNK_WIDTH);
+      const uint8_t generated = blocks[XYZ(x, y, z)];
+
+      if(i < changesPerChunk && k != restoredChunk)
+        DatabaseInsertBlock(c->x, c->z, x, y, z, (generated + 1 + BenchmarkRandom(41, index + 3, AMOUNT_BLOCKS - 1)) % AMOUNT_BLOCKS);
+      else if(i < changesPerChunk + restoresPerChunk)
+        DatabaseInsertBlock(c->x, c->z, x, y, z, generated);
+      else
+      {
+        DatabaseInsertBlock(c->x, c->z, x, y, z, generated == AIR_BLOCK ? STONE_BLOCK : AIR_BLOCK);
+        DatabaseInsertBlock(c->x, c->z, x, y, z, generated);
+      }
+    }
+  }
+
+  //Loads before the compaction are what loads after it have to match.
+  const double loadBefore = BenchmarkTimeGrid(c, side, rounds, LoadEditsOnTerrain, terrain);
+
+  for(int32_t k = 0; k < numChunks; ++k)
+  {
+    BenchmarkPlaceInGrid(c, k, side);
+    LoadEditsOnTerrain(terrain, c, k);
+    memcpy(&expected[k * BLOCKS_MEMORY_SIZE], c->blocks, BLOCKS_MEMORY_SIZE);
+
+    //Pregenerated with the edits applied, as older pregenerations stored chunks; compaction must not take them for terrain.
+    ChunkStoreSave(c);
+  }
+
+  EditCompactionStats stats;
+  double start = TimeMeasurementNow();
+  EditCompactorCompactAll(&stats);
+  const double compactTime = TimeMeasurementNow() - start;
+
+  //A chunk without edits left is no longer looked up.
+  int32_t* coords;
+  const int32_t indexed = DatabaseGetEditedChunks(&coords);
+  free(coords);
+  const bool restoredIndexed = DatabaseChunkHasEdits(restoredChunk % side, restoredChunk / side);
+
+  const double loadAfter = BenchmarkTimeGrid(c, side, rounds, LoadEditsOnTerrain, terrain);
+  const int32_t mismatches = CountMismatches(c, side, LoadEditsOnTerrain, terrain, expected);
+
+  //A second pass has nothing left to drop.
+  EditCompactionStats again;
+  EditCompactorCompactAll(&again);
+
+  BenchmarkFreeChunk(c);
+  free(terrain);
+  free(expected);
+
+  //Drops the stored chunks along with the edits.
+  DatabaseFree();
+  DatabaseInit(":memory:");
+
+  LogInfo("                   |   edits | load (ms/chunk)\n", false);
+  LogInfo("Before compaction  | %7lld | %15.3f\n", false, (long long)stats.editsBefore, loadBefore * 1000.0);
+  LogInfo("After compaction   | %7lld | %15.3f\n", false, (long long)(stats.editsBefore - stats.editsRemoved), loadAfter * 1000.0);
+  LogInfo("%d chunks compacted in %.1f ms (%.2f ms per chunk, mostly generating it): %lld edits removed, %lld removed by a second pass; %d mismatching loads; "
+          "%d of %d chunks still indexed as edited.", true, stats.chunks, compactTime * 1000.0, compactTime * 1000.0 / MAX(1, stats.chunks), (long long)stats.editsRemoved,
+          (long long)again.editsRemoved, mismatches, indexed, numChunks);
+
+  BenchmarkCheck(mismatches == 0 && again.editsRemoved == 0 && stats.editsRemoved != 0 && indexed == numChunks - 1 && !restoredIndexed,
+                 "The compaction changed what chunks load or left edits which equal the terrain!");
+}
+
+/* "BenchmarkSnapshots()": a frame of the main thread edits one of four chunks and loads it, which waits until its edits
+ * are committed; that is where a snapshot holding up the writer thread would show. */
+#define SNAPSHOT_FRAME_EDITS 16
+
+static double SnapshotBenchmarkFrame(Chunk* c, int32_t frame)
+{
+  const double start = TimeMeasurementNow();
+
+  c->x = 100 + frame % 4;
+  c->z = 100;
+  for(int32_t i = 0; i < SNAPSHOT_FRAME_EDITS; ++i)
+  {
+    const uint32_t index = (uint32_t)(frame * SNAPSHOT_FRAME_EDITS + i) * 4;
+    DatabaseInsertBlock(c->x, c->z, BenchmarkRandom(52, index, CHUNK_WIDTH), BenchmarkRandom(52, index + 1, CHUNK_HEIGHT), BenchmarkRandom(52, index + 2, CHUNK_WIDTH),
+                        1 + BenchmarkRandom(52, index + 3, AMOUNT_BLOCKS - 1));
+  }
+
+  memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+  DatabaseGetBlocksForChunk(c);
+
+  return TimeMeasurementNow() - start;
+}
+
+static uint64_t HashChunkEdits(Chunk* c, int32_t chunkX, int32_t chunkZ)
+{
+  c->x = chunkX;
+  c->z = chunkZ;
+  memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+  DatabaseGetBlocksForChunk(c);
+
+  return BenchmarkHashBlocks(c->blocks);
+}
+
+static void RemoveSnapshotBenchmarkFiles(const char* fileName)
+{
+  const char* suffixes[] = {"", "-wal", "-shm", ".snapshot.1", ".snapshot.2", ".snapshot.3", ".before-restore", ".before-restore-wal", ".restoring", ".restoring-wal"};
+
+  for(int32_t i = 0; i < (int32_t)ARRAY_SIZE(suffixes); ++i)
+  {
+    char path[256];
+    snprintf(path, ARRAY_SIZE(path), "%s%s", fileName, suffixes[i]);
+    remove(path);
+  }
+}
+
+/* Main-thread frame times without and while a snapshot is taken, the size of a full and of an incremental snapshot and a
+ * restore from them: it has to bring back exactly the edits up to the second snapshot (including a chunk left without
+ * edits by the compaction), none of the ones made afterwards. */
+static void BenchmarkSnapshots()
+{
+  const char* fileName = "Snapshots.benchmark";
+  const int32_t side = 48;
+  const int32_t numChunks = side * side;
+  const int32_t editsPerChunk = 400;
+  const int32_t changedChunks = 8; //Edited again for the second snapshot
+  const int32_t baselineFrames = 300;
+  const int32_t lateChunkX = 50, lateChunkZ = 50; //Only edited after the second snapshot
+
+  DatabaseFree();
+  RemoveSnapshotBenchmarkFiles(fileName);
+  DatabaseInit(fileName);
+  SnapshotInit(fileName, 0);
+
+  for(int32_t k = 0; k < numChunks; ++k)
+    BenchmarkEditChunk(51, k, side, editsPerChunk);
+  DatabaseFlush();
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+
+  int32_t frame = 0;
+  double baselineTotal = 0.0, baselineMax = 0.0;
+  for(int32_t i = 0; i < baselineFrames; ++i, ++frame)
+  {
+    const double t = SnapshotBenchmarkFrame(c, frame);
+    baselineTotal += t;
+    baselineMax = MAX(baselineMax, t);
+  }
+
+  //Frames go on as usual until the snapshot is taken (or has failed, for sure after a few seconds).
+  double start = TimeMeasurementNow();
+  SnapshotRequest();
+  const double requestTime = TimeMeasurementNow() - start;
+
+  int32_t snapshotFrames = 0;
+  double snapshotTotal = 0.0, snapshotMax = 0.0;
+  while(SnapshotGetLast() < 1 && TimeMeasurementNow() - start < 10.0)
+  {
+    const double t = SnapshotBenchmarkFrame(c, frame++);
+    snapshotTotal += t;
+    snapshotMax = MAX(snapshotMax, t);
+    ++snapshotFrames;
+  }
+  const double fullTime = TimeMeasurementNow() - start;
+
+  //A few chunks edited again and one left without edits (all of them equal its terrain, here the cleared blocks).
+  for(int32_t k = 0; k < changedChunks; ++k)
+    BenchmarkEditChunk(53, k, side, editsPerChunk);
+
+  int32_t remaining;
+  HashChunkEdits(c, changedChunks % side, changedChunks / side);
+  DatabaseCompactChunkEdits(changedChunks % side, changedChunks / side, c->blocks, &remaining);
+  DatabaseFlush();
+
+  start = TimeMeasurementNow();
+  SnapshotRequest();
+  SnapshotWait();
+  const double incrementalTime = TimeMeasurementNow() - start;
+
+  //What the restore has to bring back.
+  uint64_t* expected = (uint64_t*)OwnMalloc((numChunks + 5) * sizeof(uint64_t), false);
+  for(int32_t k = 0; k < numChunks; ++k)
+    expected[k] = HashChunkEdits(c, k % side, k / side);
+  for(int32_t k = 0; k < 4; ++k)
+    expected[numChunks + k] = HashChunkEdits(c, 100 + k, 100);
+  expected[numChunks + 4] = HashChunkEdits(c, lateChunkX, lateChunkZ);
+
+  //Lost by the restore.
+  for(int32_t k = 0; k < changedChunks; ++k)
+    DatabaseInsertBlock(k, 0, 0, CHUNK_HEIGHT - 1, 0, STONE_BLOCK);
+  DatabaseInsertBlock(lateChunkX, lateChunkZ, 0, 0, 0, STONE_BLOCK);
+  DatabaseFlush();
+
+  const int32_t lastSnapshot = SnapshotGetLast();
+  SnapshotFree();
+  DatabaseFree();
+
+  char path[256];
+  snprintf(path, ARRAY_SIZE(path), "%s.snapshot.1", fileName);
+  const int64_t fullSize = FileSize(path);
+  snprintf(path, ARRAY_SIZE(path), "%s.snapshot.2", fileName);
+  const int64_t incrementalSize = FileSize(path);
+
+  start = TimeMeasurementNow();
+  const bool restored = SnapshotRestore(fileName, 2);
+  const double restoreTime = TimeMeasurementNow() - start;
+
+  DatabaseInit(fileName);
+
+  int32_t mismatches = 0;
+  for(int32_t k = 0; k < numChunks; ++k)
+    mismatches += HashChunkEdits(c, k % side, k / side) != expected[k];
+  for(int32_t k = 0; k < 4; ++k)
+    mismatches += HashChunkEdits(c, 100 + k, 100) != expected[numChunks + k];
+  mismatches += HashChunkEdits(c, lateChunkX, lateChunkZ) != expected[numChunks + 4];
+
+  BenchmarkFreeChunk(c);
+  free(expected);
+
+  //Back to the in-memory database for whatever follows.
+  DatabaseFree();
+  RemoveSnapshotBenchmarkFiles(fileName);
+  DatabaseInit(":memory:");
+
+  LogInfo("                 | frames | mean frame (ms) | max frame (ms)\n", false);
+  LogInfo("Without snapshot | %6d | %15.3f | %14.3f\n", false, baselineFrames, baselineTotal * 1000.0 / baselineFrames, baselineMax * 1000.0);
+  LogInfo("During snapshot  | %6d | %15.3f | %14.3f\n", false, snapshotFrames, snapshotTotal * 1000.0 / MAX(1, snapshotFrames), snapshotMax * 1000.0);
+  LogInfo("Requesting a snapshot took %.1f us on the main thread. Full snapshot of %d chunks (%d edits each): %.1f ms, %lld KB; "
+          "incremental one after changing %d chunks: %.1f ms, %lld KB. Restore of both: %.1f ms, %d mismatching chunks.", true,
+          requestTime * 1e6, numChunks, editsPerChunk, fullTime * 1000.0, (long long)(fullSize / 1024), changedChunks + 1, incrementalTime * 1000.0,
+          (long long)(incrementalSize / 1024), restoreTime * 1000.0, mismatches);
+
+  BenchmarkCheck(restored && lastSnapshot == 2 && mismatches == 0 && incrementalSize > 0 && incrementalSize < fullSize,
+                 "The snapshots did not restore the map as it was when the second one was taken!");
+}
+
+//"true" if both files exist and are equal byte by byte.
+static bool FilesEqual(const char* pathA, const char* pathB)
+{
+  FILE* a = NULL;
+  FILE* b = NULL;
+  bool equal = fopen_s(&a, pathA, "rb") == 0 && a != NULL && fopen_s(&b, pathB, "rb") == 0 && b != NULL;
+
+  static uint8_t bufferA[65536], bufferB[65536];
+  while(equal)
+  {
+    const size_t readA = fread(bufferA, 1, sizeof(bufferA), a);
+    const size_t readB = fread(bufferB, 1, sizeof(bufferB), b);
+
+    equal = readA == readB && memcmp(bufferA, bufferB, readA) == 0;
+    if(readA == 0)
+      break;
+  }
+
+  if(a != NULL)
+    fclose(a);
+  if(b != NULL)
+    fclose(b);
+
+  return equal;
+}
+
+//The size of the children of "MAIN" has to cover the rest of the file.
+static bool IsCompleteVoxFile(const char* path)
+{
+  FILE* f = NULL;
+  if(fopen_s(&f, path, "rb") != 0 || f == NULL)
+    return false;
+
+  uint8_t header[20];
+  const bool hasHeader = fread(header, sizeof(header), 1, f) == 1;
+  fclose(f);
+
+  int32_t childrenSize;
+  memcpy(&childrenSize, &header[16], sizeof(int32_t));
+
+  return hasHeader && !memcmp(header, "VOX ", 4) && !memcmp(&header[8], "MAIN", 4) && childrenSize == FileSize(path) - 20;
+}
+
+/* Streaming export: throughput on all threads, the peak memory of the process after a small and a large rectangle (it
+ * hardly grows, as every chunk is written once done), equal files on one and on all threads (the output order does not
+ * depend on them) and an edit showing up in the export. */
+static void BenchmarkExport()
+{
+  const char* voxPath = "Export.benchmark.vox";
+  const char* objPath = "Export.benchmark.obj";
+  const char* objSingleThreadPath = "Export.benchmark.1.obj";
+  const int32_t smallSide = 16;
+  const int32_t largeSide = 64;
+  const int32_t meshSide = 8; //Text grows fast
+
+  const size_t peakBefore = GetPeakMemoryUsage();
+
+  ExportStats small, large, mesh, meshSingleThread, edited[2];
+  bool success = ExporterExport(EXPORT_FORMAT_VOX, 0, 0, smallSide - 1, smallSide - 1, voxPath, 0, &small);
+  const size_t peakSmall = GetPeakMemoryUsage();
+
+  success &= ExporterExport(EXPORT_FORMAT_VOX, -largeSide / 2, -largeSide / 2, largeSide / 2 - 1, largeSide / 2 - 1, voxPath, 0, &large);
+  const size_t peakLarge = GetPeakMemoryUsage();
+  const bool complete = IsCompleteVoxFile(voxPath);
+
+  //At least four threads, so that chunks finish out of order even on small machines.
+  const int32_t numThreads = BenchmarkGetMaxThreads(1);
+  const int32_t meshThreads = MAX(4, numThreads);
+  success &= ExporterExport(EXPORT_FORMAT_OBJ, 0, 0, meshSide - 1, meshSide - 1, objPath, meshThreads, &mesh);
+  success &= ExporterExport(EXPORT_FORMAT_OBJ, 0, 0, meshSide - 1, meshSide - 1, objSingleThreadPath, 1, &meshSingleThread);
+  const bool ordered = FilesEqual(objPath, objSingleThreadPath);
+
+  //A block floating at the top of an otherwise unedited chunk adds one voxel.
+  success &= ExporterExport(EXPORT_FORMAT_VOX, 200, 200, 200, 200, voxPath, 1, &edited[0]);
+  DatabaseInsertBlock(200, 200, 3, CHUNK_HEIGHT - 2, 3, GOLD_BLOCK);
+  success &= ExporterExport(EXPORT_FORMAT_VOX, 200, 200, 200, 200, voxPath, 1, &edited[1]);
+
+  remove(voxPath);
+  remove(objPath);
+  remove(objSingleThreadPath);
+
+  LogInfo("Export      | threads | chunks | chunks/s |   elements | size (MB) | peak memory (MB)\n", false);
+  LogInfo("vox %2d x %2d | %7d | %6d | %8.1f | %10lld | %9.1f | %16.1f\n", false, smallSide, smallSide, numThreads, small.chunks, small.chunks / MAX(small.seconds, 1e-9),
+          (long long)small.elements, small.bytes / 1048576.0, peakSmall / 1048576.0);
+  LogInfo("vox %2d x %2d | %7d | %6d | %8.1f | %10lld | %9.1f | %16.1f\n", false, largeSide, largeSide, numThreads, large.chunks, large.chunks / MAX(large.seconds, 1e-9),
+          (long long)large.elements, large.bytes / 1048576.0, peakLarge / 1048576.0);
+  LogInfo("obj %2d x %2d | %7d | %6d | %8.1f | %10lld | %9.1f |\n", false, meshSide, meshSide, meshThreads, mesh.chunks, mesh.chunks / MAX(mesh.seconds, 1e-9),
+          (long long)mesh.elements, mesh.bytes / 1048576.0);
+  LogInfo("obj %2d x %2d | %7d | %6d | %8.1f | %10lld | %9.1f |\n", false, meshSide, meshSide, 1, meshSingleThread.chunks,
+          meshSingleThread.chunks / MAX(meshSingleThread.seconds, 1e-9), (long long)meshSingleThread.elements, meshSingleThread.bytes / 1048576.0);
+  LogInfo("Elements are voxels (blocks next to a transparent one) or triangles; peak memory before the exports: %.1f MB. "
+          "The files on one and on all threads are %s; an edit added %lld voxel(s).", true, peakBefore / 1048576.0,
+          ordered ? "equal" : "different", (long long)(edited[1].elements - edited[0].elements));
+
+  BenchmarkCheck(success && complete && ordered && edited[1].elements == edited[0].elements + 1, "The export failed, depends on the threads or missed an edit!");
+}
+
+//Position x of the stored player, read through a connection of its own as after a crash; "NAN" if there is none.
+static double ReadStoredPlayerX(const char* fileName)
+{
+  sqlite3* direct;
+  sqlite3_open_v2(fileName, &direct, SQLITE_OPEN_READONLY, NULL);
+
+  sqlite3_stmt* stmt;
+  sqlite3_prepare_v2(direct, "SELECT posX FROM PlayerInfo", -1, &stmt, NULL);
+  const double posX = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_double(stmt, 0) : NAN;
+  sqlite3_finalize(stmt);
+  sqlite3_close(direct);
+
+  return posX;
+}
+
+/* Main-thread cost of an autosave tick while edits keep coming: handing the player and map information to the writer
+ * thread, against saving them on the main thread, which has to wait for the queued edits first (or it would store a
+ * player standing on blocks not saved yet). Afterwards, the database file has to hold the last save and every edit. */
+static void BenchmarkAutosave()
+{
+  const char* fileName = "Autosave.benchmark";
+  const int32_t numTicks = 200;
+  const int32_t editsPerTick = 64;
+
+  OpenDatabaseFile(fileName);
+
+  Player player;
+  memset(&player, 0, sizeof(Player));
+  player.buildBlock = GOLD_BLOCK;
+
+  double total[2] = {0.0}, worst[2] = {0.0};
+  double storedX[2];
+  int64_t edits[2], transactions;
+
+  for(int32_t mode = 0; mode < 2; ++mode)
+  {
+    for(int32_t t = 0; t < numTicks; ++t)
+    {
+      for(int32_t i = 0; i < editsPerTick; ++i)
+        QueueBenchmarkEdit(61 + mode, t * editsPerTick + i);
+
+      player.pos[0] = (float)(mode * numTicks + t);
+      player.yaw = t * 0.5f;
+
+      const double start = TimeMeasurementNow();
+      if(mode == 0)
+        DatabaseSaveAsync(&player);
+      else
+      {
+        DatabaseFlush();
+        DatabaseSavePlayerInfo(&player);
+        DatabaseSaveMapInfo();
+      }
+      const double elapsed = TimeMeasurementNow() - start;
+
+      total[mode] += elapsed;
+      worst[mode] = MAX(worst[mode], elapsed);
+    }
+
+    DatabaseFlush();
+    DatabaseGetWriterStats(&edits[mode], &transactions);
+    storedX[mode] = ReadStoredPlayerX(fileName);
+  }
+
+  CloseDatabaseFile(fileName);
+
+  LogInfo("Autosave tick             | ticks | main thread (us, mean) | main thread (us, worst)\n", false);
+  LogInfo("Handed to the writer      | %5d | %22.2f | %23.2f\n", false, numTicks, total[0] * 1e6 / numTicks, worst[0] * 1e6);
+  LogInfo("Saved on the main thread  | %5d | %22.2f | %23.2f\n", false, numTicks, total[1] * 1e6 / numTicks, worst[1] * 1e6);
+  LogInfo("%d edits before every tick; the file held the player of tick %.0f (of %d) and %lld of %d edits after the autosaves.", true,
+          editsPerTick, storedX[0], numTicks - 1, (long long)edits[0], numTicks * editsPerTick);
+
+  BenchmarkCheck(storedX[0] == numTicks - 1 && storedX[1] == 2 * numTicks - 1 && edits[0] == numTicks * editsPerTick && edits[1] == 2 * numTicks * editsPerTick,
+                 "An autosave was lost or stored without the edits before it!");
+}
+
+static const BenchmarkEntry benchmarks[] =
+{
+  {"db-writer", "Main-thread cost and sustained rate of block edits written by the background writer, against a commit per edit", BenchmarkDatabaseWriter},
+  {"db-concurrency", "Stress test of chunk lookups on 1 and N threads while their chunks are edited", BenchmarkDatabaseConcurrency},
+  {"edit-blobs", "Load latency and size of a heavily edited map with a row per block edit against a blob per chunk (after migrating it)", BenchmarkEditBlobs},
+  {"region-store", "Load latency of stored chunks from a region file against generation plus edits, and compaction of the file", BenchmarkRegionStore},
+  {"edit-index", "Lookup latency of unedited chunks through the in-memory edit index against a query per chunk", BenchmarkEditIndex},
+  {"edit-compaction", "Edits and load latency of chunks before and after dropping the edits which equal the terrain", BenchmarkEditCompaction},
+  {"snapshots", "Main-thread frame times while an incremental snapshot is taken, full against incremental snapshot size and a restore", BenchmarkSnapshots},
+  {"export", "Throughput and peak memory of streaming exports to MagicaVoxel and OBJ, with the same output on one and on all threads", BenchmarkExport},
+  {"autosave", "Main-thread cost of an autosave tick handed to the writer thread against saving on the main thread, while edits keep coming", BenchmarkAutosave}
+};
+
+const BenchmarkEntry* StorageBenchmarksGet(int32_t* count)
+{
+  *count = (int32_t)ARRAY_SIZE(benchmarks);
+
+  return benchmarks;
+}
\ No newline at end of file
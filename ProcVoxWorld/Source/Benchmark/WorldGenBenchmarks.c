@@ -0,0 +1,971 @@
+#include "BenchmarkCommon.h"
+
+#include "../Erosion.h"
+#include "../NoiseGenerator.h"
+#include "../StageTimer.h"
+#include "../TerrainRaster.h"
+#include "../TimeMeasurement.h"
+#include "../VoxelDAG.h"
+#include "../WorldGenerator.h"
+
+#include "../Map/Block.h"
+#include "../Map/Map.h"
+
+static void GenerateBenchmarkTile(void* data, int32_t index)
+{
+  WorldGenJob** jobs = (WorldGenJob**)data;
+  const int32_t tileCount = WorldGeneratorGetTileCount();
+
+  WorldGeneratorGenerateTile(jobs[index / tileCount], index % tileCount);
+}
+
+//Generates the chunks like "MapLoadChunksNow()" does, but without stored edits and meshing; returns the time in seconds.
+static double GenerateChunks(Chunk** chunks, int32_t count, Worker* workers, int32_t numWorkers)
+{
+  WorldGenJob** jobs = (WorldGenJob**)OwnMalloc(count * sizeof(WorldGenJob*), false);
+
+  if(jobs == NULL)
+  {
+    LogError("Variable \"jobs\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  double start = TimeMeasurementNow();
+  for(int32_t i = 0; i < count; ++i)
+  {
+    memset(chunks[i]->blocks, 0, BLOCKS_MEMORY_SIZE);
+    jobs[i] = WorldGeneratorBeginChunk(chunks[i]);
+  }
+
+  ThreadWorkerRunBatch(workers, numWorkers, GenerateBenchmarkTile, jobs, count * WorldGeneratorGetTileCount());
+
+  for(int32_t i = 0; i < count; ++i)
+    WorldGeneratorFinishChunk(jobs[i]);
+
+  double end = TimeMeasurementNow();
+  free(jobs);
+
+  return end - start;
+}
+
+//Chunks per second "WorldGeneratorGenerateChunk()" achieves on a single thread for a square of "side" x "side" chunks around chunk ("cX", "cZ").
+static double GenerateChunkSquare(int32_t cX, int32_t cZ, int32_t side)
+{
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+
+  double start = TimeMeasurementNow();
+  for(int32_t x = 0; x < side; ++x)
+  {
+    for(int32_t z = 0; z < side; ++z)
+    {
+      c->x = cX + x - side / 2;
+      c->z = cZ + z - side / 2;
+
+      memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+      WorldGeneratorGenerateChunk(c);
+    }
+  }
+  double end = TimeMeasurementNow();
+
+  BenchmarkFreeChunk(c);
+
+  return side * side / (end - start);
+}
+
+//Cost of the 3D cave stage: world generation throughput with caves disabled and enabled.
+static void BenchmarkCaves()
+{
+  const int32_t side = 12;
+  const int32_t rounds = 3;
+  const bool cavesEnabled = CAVES_ENABLED;
+
+  //Warm-up (caches, structure regions), so neither run is favoured.
+  GenerateChunkSquare(0, 0, 2);
+
+  //The best round of each is taken, as it is the least disturbed by other processes.
+  double without = 0.0;
+  double with = 0.0;
+  for(int32_t r = 0; r < rounds; ++r)
+  {
+    CAVES_ENABLED = false;
+    without = MAX(without, GenerateChunkSquare(0, 0, side));
+
+    CAVES_ENABLED = true;
+    with = MAX(with, GenerateChunkSquare(0, 0, side));
+  }
+
+  CAVES_ENABLED = cavesEnabled;
+
+  LogInfo("Caves disabled: %8.2f chunks/s\n", false, without);
+  LogInfo("Caves enabled:  %8.2f chunks/s\n", false, with);
+  LogInfo("Best of %d rounds, %d x %d chunks on one thread; caves cost %.1f%% of the generation time.", true, rounds, side, side, (without / with - 1.0) * 100.0);
+}
+
+//Samples "rows" rows of "rowLength" columns; returns the time in seconds.
+static double SampleTerrainRows(noiseState* noiseState, int32_t rows, int32_t rowLength, Biome* biomes, int32_t* heights)
+{
+  double start = TimeMeasurementNow();
+  for(int32_t r = 0; r < rows; ++r)
+    WorldGeneratorSampleRow(noiseState, r * 3 - rows, -rowLength * 20 + r * 7, rowLength, &biomes[r * rowLength], &heights[r * rowLength]);
+
+  return TimeMeasurementNow() - start;
+}
+
+static void GenerateTerrainChunks(Chunk** chunks, int32_t count)
+{
+  for(int32_t i = 0; i < count; ++i)
+  {
+    memset(chunks[i]->blocks, 0, BLOCKS_MEMORY_SIZE);
+    WorldGeneratorGenerateChunk(chunks[i]);
+  }
+}
+
+/* Compiled terrain graph against the hand-written terrain functions: throughput of biome and height sampling
+ * (rows as long as a chunk with its neighbour data) and whether both yield the same biomes, heights and chunks. */
+static void BenchmarkTerrainGraph()
+{
+  if(!WorldGeneratorUsesTerrainGraph())
+  {
+    LogError("This benchmark needs the terrain graph (\"%s\"), but it is not loaded.", true, TERRAIN_GRAPH);
+
+    return;
+  }
+
+  const int32_t rows = 2048;
+  const int32_t rowLength = CHUNK_WIDTH + 2;
+  const int32_t numColumns = rows * rowLength;
+  const int32_t numChunks = 9;
+
+  noiseState* state = NoiseGeneratorCreateState();
+  Biome* biomes[2] = {(Biome*)OwnMalloc(numColumns * sizeof(Biome), false), (Biome*)OwnMalloc(numColumns * sizeof(Biome), false)};
+  int32_t* heights[2] = {(int32_t*)OwnMalloc(numColumns * sizeof(int32_t), false), (int32_t*)OwnMalloc(numColumns * sizeof(int32_t), false)};
+
+  if(state == NULL || biomes[0] == NULL || biomes[1] == NULL || heights[0] == NULL || heights[1] == NULL)
+  {
+    LogError("Variables \"state\", \"biomes\" and \"heights\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  Chunk* chunks[2][9];
+  for(int32_t path = 0; path < 2; ++path)
+  {
+    for(int32_t i = 0; i < numChunks; ++i)
+    {
+      chunks[path][i] = BenchmarkCreateChunk(i / 3 - 1, i % 3 - 1);
+    }
+  }
+
+  //Path 0: terrain graph, path 1: hand-written functions
+  double sampleTime[2];
+  double chunkTime[2];
+  for(int32_t path = 0; path < 2; ++path)
+  {
+    if(path == 1)
+      WorldGeneratorFree();
+
+    SampleTerrainRows(state, rows / 16, rowLength, biomes[path], heights[path]); //Warm-up
+    sampleTime[path] = SampleTerrainRows(state, rows, rowLength, biomes[path], heights[path]);
+
+    double start = TimeMeasurementNow();
+    GenerateTerrainChunks(chunks[path], numChunks);
+    chunkTime[path] = TimeMeasurementNow() - start;
+  }
+
+  //Restore the terrain graph for whatever follows.
+  WorldGeneratorInit();
+
+  int32_t differentColumns = 0;
+  for(int32_t i = 0; i < numColumns; ++i)
+    differentColumns += biomes[0][i] != biomes[1][i] || heights[0][i] != heights[1][i];
+
+  int32_t differentChunks = 0;
+  for(int32_t i = 0; i < numChunks; ++i)
+    differentChunks += memcmp(chunks[0][i]->blocks, chunks[1][i]->blocks, BLOCKS_MEMORY_SIZE) != 0;
+
+  LogInfo("Path          | biome + height (ns/column) | chunk generation (ms/chunk)\n", false);
+  LogInfo("Terrain graph | %26.1f | %27.3f\n", false, sampleTime[0] / numColumns * 1e9, chunkTime[0] / numChunks * 1000.0);
+  LogInfo("Hand-written  | %26.1f | %27.3f\n", false, sampleTime[1] / numColumns * 1e9, chunkTime[1] / numChunks * 1000.0);
+  LogInfo("%d columns and %d chunks; differing columns: %d, differing chunks: %d.", true, numColumns, numChunks, differentColumns, differentChunks);
+
+  BenchmarkCheck(differentColumns == 0 && differentChunks == 0, "The terrain graph does not reproduce the built-in terrain!");
+
+  for(int32_t path = 0; path < 2; ++path)
+  {
+    for(int32_t i = 0; i < numChunks; ++i)
+      BenchmarkFreeChunk(chunks[path][i]);
+
+    free(biomes[path]);
+    free(heights[path]);
+  }
+
+  free(state);
+}
+
+//Hash of the eroded tiles of "BenchmarkErosion()" (seed "BENCHMARK_SEED"); has to be updated whenever the erosion or the terrain changes on purpose.
+#define EROSION_GOLDEN_HASH 0xF033AAD4F5E9817CULL
+
+#define EROSION_BENCHMARK_TILES 8
+
+typedef struct
+{
+  float* deltas[EROSION_BENCHMARK_TILES];
+} ErosionBenchmarkData;
+
+static void ErodeBenchmarkTile(void* data, int32_t index)
+{
+  //A block of 4 x 2 tiles, which includes negative tile coordinates.
+  ErosionComputeTile(BENCHMARK_SEED, index % 4 - 2, index / 4 - 1, ((ErosionBenchmarkData*)data)->deltas[index]);
+}
+
+//FNV-1a of the height changes, rounded to 1/64 block.
+static uint64_t HashErodedTiles(ErosionBenchmarkData* data)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for(int32_t t = 0; t < EROSION_BENCHMARK_TILES; ++t)
+  {
+    for(int32_t i = 0; i < EROSION_TILE_DATA_WIDTH * EROSION_TILE_DATA_WIDTH; ++i)
+    {
+      const uint32_t value = (uint32_t)(int32_t)floorf(data->deltas[t][i] * 64.0f + 0.5f);
+      for(int32_t byte = 0; byte < 4; ++byte)
+      {
+        hash ^= (value >> (byte * 8)) & 0xFF;
+        hash *= 1099511628211ULL;
+      }
+    }
+  }
+
+  return hash;
+}
+
+//Throughput of the erosion tiles on one and on all threads; both runs have to match the golden hash.
+static void BenchmarkErosion()
+{
+  ErosionBenchmarkData data[2];
+  for(int32_t run = 0; run < 2; ++run)
+  {
+    for(int32_t t = 0; t < EROSION_BENCHMARK_TILES; ++t)
+    {
+      data[run].deltas[t] = (float*)OwnMalloc(EROSION_TILE_DATA_WIDTH * EROSION_TILE_DATA_WIDTH * sizeof(float), false);
+
+      if(data[run].deltas[t] == NULL)
+      {
+        LogError("Variable \"data[run].deltas[t]\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+
+  //Run 0: the calling thread only, run 1: all processor cores
+  const int32_t numWorkers[2] = {0, BenchmarkGetMaxThreads(1) - 1};
+  double tilesPerSecond[2];
+  uint64_t hash[2];
+
+  for(int32_t run = 0; run < 2; ++run)
+  {
+    Worker* workers = BenchmarkCreateWorkers(numWorkers[run]);
+
+    double start = TimeMeasurementNow();
+    ThreadWorkerRunBatch(workers, numWorkers[run], ErodeBenchmarkTile, &data[run], EROSION_BENCHMARK_TILES);
+    tilesPerSecond[run] = EROSION_BENCHMARK_TILES / (TimeMeasurementNow() - start);
+
+    BenchmarkDestroyWorkers(workers, numWorkers[run]);
+
+    hash[run] = HashErodedTiles(&data[run]);
+  }
+
+  LogInfo("Threads | tiles/s | ms/tile | hash\n", false);
+  for(int32_t run = 0; run < 2; ++run)
+    LogInfo("%7d | %7.2f | %7.1f | %016" PRIx64 "\n", false, numWorkers[run] + 1, tilesPerSecond[run], 1000.0 / tilesPerSecond[run], hash[run]);
+
+  LogInfo("%d tiles of %d x %d columns (%d columns overlap).", true, EROSION_BENCHMARK_TILES, EROSION_TILE_WIDTH, EROSION_TILE_WIDTH, EROSION_TILE_OVERLAP);
+
+  char error[96];
+  snprintf(error, sizeof(error), "The erosion does not match the golden hash %016" PRIx64 "!", (uint64_t)EROSION_GOLDEN_HASH);
+
+  if(BenchmarkCheck(hash[0] == hash[1], "The erosion depends on the number of threads!") && BenchmarkCheck(hash[0] == EROSION_GOLDEN_HASH, error))
+    LogSuccess("The erosion matches the golden hash.", true);
+
+  for(int32_t run = 0; run < 2; ++run)
+  {
+    for(int32_t t = 0; t < EROSION_BENCHMARK_TILES; ++t)
+      free(data[run].deltas[t]);
+  }
+}
+
+//Largest height difference of neighbouring columns and the share of differences of at least "cliff" blocks.
+static void MeasureHeightSteps(const int32_t* heights, int32_t width, int32_t cliff, int32_t* maxStep, double* cliffShare)
+{
+  int32_t numCliffs = 0;
+  *maxStep = 0;
+
+  for(int32_t x = 0; x < width - 1; ++x)
+  {
+    for(int32_t z = 0; z < width - 1; ++z)
+    {
+      const int32_t stepX = abs(heights[(x + 1) * width + z] - heights[x * width + z]);
+      const int32_t stepZ = abs(heights[x * width + z + 1] - heights[x * width + z]);
+
+      *maxStep = MAX(*maxStep, MAX(stepX, stepZ));
+      numCliffs += (stepX >= cliff) + (stepZ >= cliff);
+    }
+  }
+
+  *cliffShare = numCliffs * 100.0 / (2.0 * (width - 1) * (width - 1));
+}
+
+/* Cost of biome blending: world generation throughput with blending disabled and enabled, and how much smoother the
+ * terrain gets. Every round generates a new area, so the blended tiles are never cached yet; a pass without blending
+ * beforehand caches the structures for both measured runs. */
+static void BenchmarkBiomeBlending()
+{
+  const int32_t side = 24;
+  const int32_t rounds = 3;
+  const int32_t width = 1024;
+  const int32_t cliff = 4;
+  const bool blendingEnabled = BIOME_BLENDING;
+
+  int32_t* heights = (int32_t*)OwnMalloc((size_t)width * width * sizeof(int32_t), false);
+  noiseState* noiseState = NoiseGeneratorCreateState();
+
+  if(heights == NULL || noiseState == NULL)
+  {
+    LogError("Variables \"heights\" and \"noiseState\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  int32_t maxStep[2];
+  double cliffShare[2];
+  for(int32_t run = 0; run < 2; ++run)
+  {
+    BIOME_BLENDING = run == 1;
+    WorldGeneratorSampleHeightmap(noiseState, -width / 2, -width / 2, width, heights);
+    MeasureHeightSteps(heights, width, cliff, &maxStep[run], &cliffShare[run]);
+  }
+
+  int32_t singleBefore, mixedBefore;
+  WorldGeneratorGetBlendStats(&singleBefore, &mixedBefore);
+
+  //The mean of all rounds, as every round covers other terrain.
+  double without = 0.0;
+  double with = 0.0;
+  for(int32_t r = 0; r < rounds; ++r)
+  {
+    const int32_t cX = (r + 1) * 100;
+
+    BIOME_BLENDING = false;
+    GenerateChunkSquare(cX, 0, side);
+    without += GenerateChunkSquare(cX, 0, side) / rounds;
+
+    BIOME_BLENDING = true;
+    with += GenerateChunkSquare(cX, 0, side) / rounds;
+  }
+
+  int32_t single, mixed;
+  WorldGeneratorGetBlendStats(&single, &mixed);
+  single -= singleBefore;
+  mixed -= mixedBefore;
+
+  BIOME_BLENDING = blendingEnabled;
+
+  LogInfo("Blending | chunks/s | max step | steps >= %d blocks\n", false, cliff);
+  LogInfo("Disabled | %8.2f | %8d | %16.3f%%\n", false, without, maxStep[0], cliffShare[0]);
+  LogInfo("Enabled  | %8.2f | %8d | %16.3f%%\n", false, with, maxStep[1], cliffShare[1]);
+  LogInfo("%d blended tiles were computed, %d (%.1f%%) of a single biome without blending.\n", false, single + mixed, single, single + mixed > 0 ? single * 100.0 / (single + mixed) : 0.0);
+  LogInfo("Mean of %d rounds, %d x %d chunks on one thread; blending costs %.1f%% of the generation time. Steps measured on %d x %d columns.", true,
+          rounds, side, side, (without / with - 1.0) * 100.0, width, width);
+
+  free(noiseState);
+  free(heights);
+}
+
+//Reference for "VoxelDAGRaycast()": a block by block traversal (Amanatides & Woo) with point queries.
+static bool RaycastBlockByBlock(const VoxelDAG* dag, const float origin[3], const float dir[3], float maxDist, int32_t hit[3])
+{
+  int32_t cell[3], step[3];
+  double tMax[3], tDelta[3];
+
+  for(int32_t a = 0; a < 3; ++a)
+  {
+    cell[a] = (int32_t)floor(origin[a]);
+    step[a] = dir[a] > 0.0f ? 1 : -1;
+    tDelta[a] = dir[a] != 0.0f ? fabs(1.0 / dir[a]) : DBL_MAX;
+    tMax[a] = dir[a] != 0.0f ? ((dir[a] > 0.0f ? cell[a] + 1.0 : cell[a]) - origin[a]) / dir[a] : DBL_MAX;
+  }
+
+  double t = 0.0;
+  while(t <= maxDist)
+  {
+    if(VoxelDAGGetBlock(dag, cell[0], cell[1], cell[2]) != AIR_BLOCK)
+    {
+      memcpy(hit, cell, sizeof(cell));
+
+      return true;
+    }
+
+    const int32_t a = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+    t = tMax[a];
+    tMax[a] += tDelta[a];
+    cell[a] += step[a];
+  }
+
+  return false;
+}
+
+/* Size of a sparse voxel DAG of a generated region against the dense blocks, and throughput of point, ray and box queries.
+ * Rays start above the terrain and point down at random angles; results are checked against the generated chunks and brute force. */
+static void BenchmarkVoxelDAG()
+{
+  const int32_t numChunks = 32;
+  const int32_t cX = -numChunks / 2;
+  const int32_t cZ = -numChunks / 2;
+  const int32_t width = numChunks * CHUNK_WIDTH;
+
+  const int32_t numPoints = 10000000;
+  const int32_t numRays = 200000;
+  const int32_t numBoxes = 200000;
+  const int32_t boxWidth = 16;
+  const float maxRayDist = 1024.0f;
+
+  VoxelDAGBuilder* builder = VoxelDAGBegin(cX, cZ, numChunks);
+  if(builder == NULL)
+    return;
+
+  Chunk* c = BenchmarkCreateChunk(0, 0);
+
+  //Chunks are generated and converted one at a time.
+  double buildTime = 0.0;
+  for(int32_t x = 0; x < numChunks; ++x)
+  {
+    for(int32_t z = 0; z < numChunks; ++z)
+    {
+      c->x = cX + x;
+      c->z = cZ + z;
+
+      memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+      WorldGeneratorGenerateChunk(c);
+
+      double start = TimeMeasurementNow();
+      VoxelDAGAddChunk(builder, c);
+      buildTime += TimeMeasurementNow() - start;
+    }
+  }
+
+  double start = TimeMeasurementNow();
+  VoxelDAG* dag = VoxelDAGFinish(builder);
+  buildTime += TimeMeasurementNow() - start;
+
+  //Every block of a few chunks has to come back unchanged.
+  int64_t blockMismatches = 0;
+  for(int32_t i = 0; i < 8; ++i)
+  {
+    c->x = cX + BenchmarkRandom(1, i, numChunks);
+    c->z = cZ + BenchmarkRandom(2, i, numChunks);
+
+    memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+    WorldGeneratorGenerateChunk(c);
+
+    for(int32_t x = 0; x < CHUNK_WIDTH; ++x)
+    {
+      for(int32_t y = 0; y < CHUNK_HEIGHT; ++y)
+      {
+        for(int32_t z = 0; z < CHUNK_WIDTH; ++z)
+          blockMismatches += c->blocks[XYZ(x, y, z)] != VoxelDAGGetBlock(dag, c->x * CHUNK_WIDTH + x, y, c->z * CHUNK_WIDTH + z);
+      }
+    }
+  }
+
+  BenchmarkFreeChunk(c);
+
+  //Point queries:
+  uint64_t checksum = 0;
+  start = TimeMeasurementNow();
+  for(int32_t i = 0; i < numPoints; ++i)
+    checksum += VoxelDAGGetBlock(dag, cX * CHUNK_WIDTH + BenchmarkRandom(3, i, width), BenchmarkRandom(4, i, CHUNK_HEIGHT), cZ * CHUNK_WIDTH + BenchmarkRandom(5, i, width));
+  const double pointTime = TimeMeasurementNow() - start;
+
+  //Ray queries:
+  float (*origins)[3] = (float(*)[3])OwnMalloc(numRays * sizeof(float[3]), false);
+  float (*dirs)[3] = (float(*)[3])OwnMalloc(numRays * sizeof(float[3]), false);
+
+  if(origins == NULL || dirs == NULL)
+  {
+    LogError("Variables \"origins\" and \"dirs\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  for(int32_t i = 0; i < numRays; ++i)
+  {
+    origins[i][0] = cX * CHUNK_WIDTH + BenchmarkRandom(6, i, width) + 0.5f;
+    origins[i][1] = CHUNK_HEIGHT - 0.5f;
+    origins[i][2] = cZ * CHUNK_WIDTH + BenchmarkRandom(7, i, width) + 0.5f;
+
+    //Between straight down and almost horizontal.
+    const float yaw = BenchmarkRandom(8, i, 3600) * (GLM_PIf / 1800.0f);
+    const float pitch = (5 + BenchmarkRandom(9, i, 85)) * (GLM_PIf / 180.0f);
+    dirs[i][0] = cosf(pitch) * cosf(yaw);
+    dirs[i][1] = -sinf(pitch);
+    dirs[i][2] = cosf(pitch) * sinf(yaw);
+  }
+
+  int32_t numHits = 0;
+  start = TimeMeasurementNow();
+  for(int32_t i = 0; i < numRays; ++i)
+  {
+    int32_t hit[3];
+    uint8_t block;
+    numHits += VoxelDAGRaycast(dag, origins[i], dirs[i], maxRayDist, hit, &block);
+  }
+  const double rayTime = TimeMeasurementNow() - start;
+
+  const int32_t numReferenceRays = numRays / 20;
+  int32_t numReferenceHits = 0;
+  start = TimeMeasurementNow();
+  for(int32_t i = 0; i < numReferenceRays; ++i)
+  {
+    int32_t hit[3];
+    numReferenceHits += RaycastBlockByBlock(dag, origins[i], dirs[i], maxRayDist, hit);
+  }
+  const double referenceRayTime = TimeMeasurementNow() - start;
+
+  int32_t rayMismatches = 0;
+  for(int32_t i = 0; i < numReferenceRays; ++i)
+  {
+    int32_t hit[3], hitReference[3];
+    uint8_t block;
+    const bool found = VoxelDAGRaycast(dag, origins[i], dirs[i], maxRayDist, hit, &block);
+    const bool foundReference = RaycastBlockByBlock(dag, origins[i], dirs[i], maxRayDist, hitReference);
+
+    rayMismatches += found != foundReference || (found && memcmp(hit, hitReference, sizeof(hit)) != 0);
+  }
+
+  free(origins);
+  free(dirs);
+
+  //Box queries:
+  int64_t numSolid = 0;
+  start = TimeMeasurementNow();
+  for(int32_t i = 0; i < numBoxes; ++i)
+  {
+    const int32_t min[3] = {cX * CHUNK_WIDTH + BenchmarkRandom(10, i, width - boxWidth), BenchmarkRandom(11, i, CHUNK_HEIGHT - boxWidth), cZ * CHUNK_WIDTH + BenchmarkRandom(12, i, width - boxWidth)};
+    const int32_t max[3] = {min[0] + boxWidth, min[1] + boxWidth, min[2] + boxWidth};
+    numSolid += VoxelDAGCountBlocks(dag, min, max);
+  }
+  const double boxTime = TimeMeasurementNow() - start;
+
+  int32_t boxMismatches = 0;
+  for(int32_t i = 0; i < 200; ++i)
+  {
+    const int32_t min[3] = {cX * CHUNK_WIDTH + BenchmarkRandom(10, i, width - boxWidth), BenchmarkRandom(11, i, CHUNK_HEIGHT - boxWidth), cZ * CHUNK_WIDTH + BenchmarkRandom(12, i, width - boxWidth)};
+    const int32_t max[3] = {min[0] + boxWidth, min[1] + boxWidth, min[2] + boxWidth};
+
+    int64_t count = 0;
+    for(int32_t x = min[0]; x < max[0]; ++x)
+    {
+      for(int32_t y = min[1]; y < max[1]; ++y)
+      {
+        for(int32_t z = min[2]; z < max[2]; ++z)
+          count += VoxelDAGGetBlock(dag, x, y, z) != AIR_BLOCK;
+      }
+    }
+
+    boxMismatches += count != VoxelDAGCountBlocks(dag, min, max);
+  }
+
+  //Serialisation round trip:
+  const char* path = "VoxelDAG.benchmark";
+  double writeTime = 0.0, readTime = 0.0;
+  int32_t roundTripMismatches = -1;
+
+  FILE* f = NULL;
+  if(fopen_s(&f, path, "wb") == 0 && f != NULL)
+  {
+    start = TimeMeasurementNow();
+    bool written = VoxelDAGWrite(dag, f);
+    fclose(f);
+    writeTime = TimeMeasurementNow() - start;
+
+    VoxelDAG* loaded = NULL;
+    if(written && fopen_s(&f, path, "rb") == 0 && f != NULL)
+    {
+      start = TimeMeasurementNow();
+      loaded = VoxelDAGRead(f);
+      fclose(f);
+      readTime = TimeMeasurementNow() - start;
+    }
+
+    if(loaded != NULL)
+    {
+      roundTripMismatches = 0;
+      for(int32_t i = 0; i < numPoints / 10; ++i)
+      {
+        const int32_t x = cX * CHUNK_WIDTH + BenchmarkRandom(13, i, width);
+        const int32_t y = BenchmarkRandom(14, i, CHUNK_HEIGHT);
+        const int32_t z = cZ * CHUNK_WIDTH + BenchmarkRandom(15, i, width);
+        roundTripMismatches += VoxelDAGGetBlock(dag, x, y, z) != VoxelDAGGetBlock(loaded, x, y, z);
+      }
+
+      VoxelDAGFree(loaded);
+    }
+
+    remove(path);
+  }
+
+  int32_t numLeaves, numNodes;
+  size_t numBytes;
+  VoxelDAGGetStats(dag, &numLeaves, &numNodes, &numBytes);
+  VoxelDAGFree(dag);
+
+  const double denseBytes = (double)numChunks * numChunks * CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT;
+
+  LogInfo("Region: %d x %d chunks (%d x %d x %d blocks)\n", false, numChunks, numChunks, width, CHUNK_HEIGHT, width);
+  LogInfo("Dense blocks: %10.2f MB (%.1f KB per chunk)\n", false, denseBytes / 1048576.0, denseBytes / (numChunks * numChunks) / 1024.0);
+  LogInfo("Voxel DAG:    %10.2f MB (%.1f KB per chunk), %d leaves and %d nodes; %.1f : 1\n", false, numBytes / 1048576.0, numBytes / (double)(numChunks * numChunks) / 1024.0,
+          numLeaves, numNodes, denseBytes / numBytes);
+  LogInfo("Build:        %10.3f ms per chunk (without generation); %lld mismatching blocks in 8 regenerated chunks\n", false, buildTime * 1000.0 / (numChunks * numChunks), blockMismatches);
+  LogInfo("Points:       %10.2f M/s (checksum %llu)\n", false, numPoints / pointTime / 1e6, checksum);
+  LogInfo("Rays:         %10.2f k/s (%d of %d hit within %.0f blocks); block by block: %.2f k/s; %d mismatches in %d rays\n", false,
+          numRays / rayTime / 1e3, numHits, numRays, maxRayDist, numReferenceRays / referenceRayTime / 1e3, rayMismatches, numReferenceRays);
+  LogInfo("Boxes:        %10.2f k/s (%d x %d x %d blocks, %.1f%% solid); %d mismatches in 200 boxes\n", false,
+          numBoxes / boxTime / 1e3, boxWidth, boxWidth, boxWidth, numSolid * 100.0 / ((double)numBoxes * boxWidth * boxWidth * boxWidth), boxMismatches);
+  LogInfo("File:         written in %.1f ms, read and validated in %.1f ms; %d mismatches after the round trip", true, writeTime * 1000.0, readTime * 1000.0, roundTripMismatches);
+}
+
+//Synthetic authored terrain of "BenchmarkTerrainRaster()": rolling hills with biome patches of 64 x 64 columns.
+static void SyntheticRasterRow(void* data, int32_t x, int32_t z, int32_t count, uint16_t* heights, uint8_t* biomes)
+{
+  (void)data;
+
+  for(int32_t i = 0; i < count; ++i)
+  {
+    heights[i] = (uint16_t)(70.0f + 30.0f * sinf(x * 0.011f) * cosf((z + i) * 0.017f) + 8.0f * sinf((x + z + i) * 0.05f));
+    biomes[i] = (uint8_t)((((x >> 6) * 7) ^ ((z + i) >> 6)) % (BIOME_WATER + 1));
+  }
+}
+
+/* Terrain raster as the worldgen source: writes a synthetic raster, checks sampled columns against it (inside and outside
+ * of the raster) and compares the generation throughput with the procedural terrain on one and on all threads.
+ * The chunks lie in four squares far apart, so only a few of the raster's tiles are ever touched. */
+static void BenchmarkTerrainRaster()
+{
+  const char* fileName = "TerrainRaster.benchmark";
+  const int32_t rasterWidth = 4096;
+  const int32_t tileWidth = 256;
+  const int32_t squareSide = 4;
+  const int32_t numChunks = 4 * squareSide * squareSide;
+  const int32_t numColumns = 100000;
+
+  TerrainRasterHeader header;
+  memset(&header, 0, sizeof(TerrainRasterHeader));
+  header.originX = -rasterWidth / 2;
+  header.originZ = -rasterWidth / 2;
+  header.width = rasterWidth;
+  header.depth = rasterWidth;
+  header.tileWidth = tileWidth;
+  header.fillHeight = WORLD_GEN_WATER_LEVEL - 12;
+  header.fillBiome = BIOME_WATER;
+
+  double start = TimeMeasurementNow();
+  if(!TerrainRasterWrite(fileName, &header, SyntheticRasterRow, NULL))
+    return;
+
+  const double writeTime = TimeMeasurementNow() - start;
+
+  int8_t* previousRaster = TERRAIN_RASTER;
+  Chunk* chunks[2][4 * 4 * 4];
+  double genTime[2][2] = {{0.0}}; //[procedural, raster][one thread, all threads]
+
+  const int32_t maxThreads = BenchmarkGetMaxThreads(1);
+  Worker* workers = BenchmarkCreateWorkers(maxThreads - 1);
+
+  //Path 0: procedural terrain (as configured), path 1: raster
+  for(int32_t path = 0; path < 2; ++path)
+  {
+    for(int32_t i = 0; i < numChunks; ++i)
+    {
+      const int32_t square = i / (squareSide * squareSide);
+      const int32_t cX = (square % 2 ? 40 : -60) + i % squareSide;
+      const int32_t cZ = (square / 2 ? 50 : -30) + i / squareSide % squareSide;
+
+      chunks[path][i] = BenchmarkCreateChunk(cX, cZ);
+    }
+
+    if(path == 1)
+    {
+      TERRAIN_RASTER = (int8_t*)fileName;
+      WorldGeneratorFree();
+      WorldGeneratorInit();
+
+      if(!BenchmarkCheck(WorldGeneratorUsesTerrainRaster(), "The benchmark raster could not be loaded."))
+        break;
+    }
+
+    GenerateChunks(chunks[path], squareSide, workers, maxThreads - 1); //Warm-up (and the first touch of the tiles)
+    genTime[path][0] = GenerateChunks(chunks[path], numChunks, NULL, 0);
+    genTime[path][1] = GenerateChunks(chunks[path], numChunks, workers, maxThreads - 1);
+  }
+
+  BenchmarkDestroyWorkers(workers, maxThreads - 1);
+
+  //Columns inside and around the raster against the source; no erosion, so the heights are only clamped.
+  int32_t mismatches = 0;
+  int32_t outside = 0;
+  noiseState* state = NoiseGeneratorCreateState();
+  for(int32_t i = 0; i < numColumns && WorldGeneratorUsesTerrainRaster() && state != NULL; ++i)
+  {
+    const int32_t x = BenchmarkRandom(21, i, rasterWidth + 512) - 256;
+    const int32_t z = BenchmarkRandom(22, i, rasterWidth + 512) - 256;
+
+    uint16_t expectedHeight = header.fillHeight;
+    uint8_t expectedBiome = header.fillBiome;
+    if(x >= 0 && x < rasterWidth && z >= 0 && z < rasterWidth)
+      SyntheticRasterRow(NULL, x, z, 1, &expectedHeight, &expectedBiome);
+    else
+      ++outside;
+
+    Biome biome;
+    int32_t height;
+    WorldGeneratorSampleRow(state, header.originX + x, header.originZ + z, 1, &biome, &height);
+    mismatches += biome != (Biome)expectedBiome || height != MIN(MAX(expectedHeight, 1), CHUNK_HEIGHT - 16);
+  }
+
+  free(state);
+
+  //Tiles the chunks (with the lattice points around them) overlap
+  bool touched[16 * 16] = {false};
+  int32_t numTouched = 0;
+  for(int32_t i = 0; i < numChunks; ++i)
+  {
+    for(int32_t x = chunks[1][i]->x * CHUNK_WIDTH - 8; x <= (chunks[1][i]->x + 1) * CHUNK_WIDTH + 8; x += 8)
+    {
+      for(int32_t z = chunks[1][i]->z * CHUNK_WIDTH - 8; z <= (chunks[1][i]->z + 1) * CHUNK_WIDTH + 8; z += 8)
+      {
+        if(x < header.originX || x >= header.originX + rasterWidth || z < header.originZ || z >= header.originZ + rasterWidth)
+          continue;
+
+        const int32_t tile = (x - header.originX) / tileWidth * 16 + (z - header.originZ) / tileWidth;
+        numTouched += !touched[tile];
+        touched[tile] = true;
+      }
+    }
+  }
+
+  for(int32_t path = 0; path < 2; ++path)
+  {
+    for(int32_t i = 0; i < numChunks; ++i)
+      BenchmarkFreeChunk(chunks[path][i]);
+  }
+
+  //Restore the configured terrain for whatever follows.
+  TERRAIN_RASTER = previousRaster;
+  WorldGeneratorFree();
+  WorldGeneratorInit();
+  remove(fileName);
+
+  const double fileBytes = TERRAIN_RASTER_ALIGNMENT + 16.0 * 16.0 * ((size_t)tileWidth * tileWidth * 3);
+
+  LogInfo("Source      | 1 thread (chunks/s) | %2d threads (chunks/s)\n", false, maxThreads);
+  LogInfo("Procedural  | %19.1f | %21.1f\n", false, numChunks / genTime[0][0], numChunks / genTime[0][1]);
+  LogInfo("Raster      | %19.1f | %21.1f\n", false, numChunks / genTime[1][0], numChunks / genTime[1][1]);
+  LogInfo("Raster: %d x %d columns in %d x %d tiles (%.1f MB), written in %.1f ms; the chunks touch %d of the %d tiles.\n", false,
+          rasterWidth, rasterWidth, tileWidth, tileWidth, fileBytes / 1048576.0, writeTime * 1000.0, numTouched, 16 * 16);
+  LogInfo("%d sampled columns (%d outside of the raster): %d mismatches.", true, numColumns, outside, mismatches);
+
+  BenchmarkCheck(mismatches == 0, "The sampled columns do not match the raster!");
+}
+
+/* Goldens of "BenchmarkWorldGenGolden()": the FNV-1a hash of the blocks of every chunk of the grid, per seed. They have to be
+ * updated whenever the terrain changes on purpose - the benchmark prints the new table if any hash differs. */
+#define GOLDEN_NUM_SEEDS   4
+#define GOLDEN_GRID_SIDE   4
+#define GOLDEN_CHUNK_WIDTH  32
+#define GOLDEN_CHUNK_HEIGHT 256
+#define GOLDEN_NUM_CHUNKS  (GOLDEN_GRID_SIDE * GOLDEN_GRID_SIDE)
+
+static const int32_t goldenSeeds[GOLDEN_NUM_SEEDS] = {BENCHMARK_SEED, 1, 20211, 987654321};
+
+static const uint64_t goldenHashes[GOLDEN_NUM_SEEDS][GOLDEN_NUM_CHUNKS] =
+{
+  {
+    0xF1D56FC4719D41AFULL, 0xDA9DD7A55B6C60D2ULL, 0xE04E9938E6B3E9FBULL, 0x74D610EC80B5EB92ULL,
+    0xC0AFFD235B0EB68DULL, 0xFD129D4789DAF0B0ULL, 0xC3655B71BE45DA2AULL, 0xCA5BA1C9CAD43865ULL,
+    0x96A4EF43D5D877CCULL, 0x8310F19ACB05D659ULL, 0x29EE50F72B818F35ULL, 0x8F798F5323D049C1ULL,
+    0x70F455A72782636DULL, 0x8353FF57B6ADF47EULL, 0xD6D8E3A2E33DA9A5ULL, 0xF6DA62751201F9BEULL
+  },
+  {
+    0xC4C87E5841F715D6ULL, 0x54916DAB9E59F39BULL, 0x38DB692FDF0CBC95ULL, 0x3BE1125A109A2AB3ULL,
+    0xBC0322500140BB20ULL, 0x0BFC558415819F30ULL, 0x42D70B3448E3725CULL, 0x514B62A38819AD4AULL,
+    0xA71D84B9E7D64D27ULL, 0xAD1294D1A4D915FDULL, 0x72F5F5EAD401564AULL, 0x36DEBF58A35C4FA8ULL,
+    0x0F2D360328E760CEULL, 0xFF090EA313C2D8C6ULL, 0x5A558725F49F3EA2ULL, 0x568D66C0C1DB8E1EULL
+  },
+  {
+    0x856EAA50FBD7C895ULL, 0x1892736E876776B6ULL, 0x32EEE8ACD1503289ULL, 0x2BDC74B9227AAC56ULL,
+    0xD3FFE2D29EC7E4BBULL, 0x5F23EC94BA6505C2ULL, 0x293F49CD27A4FEA6ULL, 0x9E2C05857D18F19DULL,
+    0x7408FEE70CD3C272ULL, 0xA40F5435CCE8CAEEULL, 0xC30B69E00BD927BCULL, 0x4668D144D69253F5ULL,
+    0x4E5E28E567D585FFULL, 0x6CFF60A3251D49D7ULL, 0x6B4C73B1FF727455ULL, 0x604E08458622475DULL
+  },
+  {
+    0x224B318EF7B5AB60ULL, 0xBBD012CBDD884DC7ULL, 0xA3EB382F740CCA6DULL, 0x4914CD929D45695CULL,
+    0xEFF004DACAA45497ULL, 0x9CF9270AA4E80AE3ULL, 0x5F6E596A7B9BE20DULL, 0x88E82F4255133BD0ULL,
+    0xA77288E685474625ULL, 0x42EC3D49A2FD88D3ULL, 0x100F0D388AA94D67ULL, 0x5E34C1A7ABFE02FFULL,
+    0x6922B47A256ACBF0ULL, 0x72F12AF7443CC458ULL, 0x7DB0382B0628EB11ULL, 0xCBAB8791942EC0A4ULL
+  }
+};
+
+/* Determinism of the world generation: a grid of chunks (including negative coordinates) for several seeds, generated
+ * on one and on all threads, has to match the goldens. The goldens were made with the default generation settings and
+ * the built-in terrain, which are forced for the run. Timings are split into the lattice ("WorldGeneratorBeginChunk()":
+ * biomes and heights every eighth column), the columns (tiles: biomes, interpolated heights, fill, plants and caves)
+ * and the structures ("WorldGeneratorFinishChunk()": trees). With "STAGE_TIMERS", the stage timers of all runs are logged
+ * as well. */
+static void BenchmarkWorldGenGolden()
+{
+  if(CHUNK_WIDTH != GOLDEN_CHUNK_WIDTH || CHUNK_HEIGHT != GOLDEN_CHUNK_HEIGHT)
+  {
+    LogError("The goldens were made with chunks of %d x %d x %d blocks, but the configuration sets %d x %d x %d.", true,
+             GOLDEN_CHUNK_WIDTH, GOLDEN_CHUNK_HEIGHT, GOLDEN_CHUNK_WIDTH, CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_WIDTH);
+    BenchmarkCheck(false, "The goldens cannot be checked.");
+
+    return;
+  }
+
+  const bool caves = CAVES_ENABLED;
+  const bool erosion = EROSION_ENABLED;
+  const bool blending = BIOME_BLENDING;
+  int8_t* graph = TERRAIN_GRAPH;
+  int8_t* raster = TERRAIN_RASTER;
+
+  CAVES_ENABLED = true;
+  EROSION_ENABLED = false;
+  BIOME_BLENDING = false;
+  TERRAIN_GRAPH = (int8_t*)"";
+  TERRAIN_RASTER = (int8_t*)"";
+  WorldGeneratorFree();
+  WorldGeneratorInit();
+
+  Chunk* chunks[GOLDEN_NUM_CHUNKS];
+  for(int32_t i = 0; i < GOLDEN_NUM_CHUNKS; ++i)
+  {
+    chunks[i] = BenchmarkCreateChunk(i / GOLDEN_GRID_SIDE - GOLDEN_GRID_SIDE / 2, i % GOLDEN_GRID_SIDE - GOLDEN_GRID_SIDE / 2);
+  }
+
+  //At least two threads, so that the check between one and several threads is never skipped.
+  const int32_t maxThreads = BenchmarkGetMaxThreads(2);
+  Worker* workers = BenchmarkCreateWorkers(maxThreads - 1);
+
+  uint64_t hashes[GOLDEN_NUM_SEEDS][GOLDEN_NUM_CHUNKS];
+  int32_t goldenMismatches = 0;
+  int32_t threadMismatches = 0;
+  double stageTime[3] = {0.0, 0.0, 0.0};
+  double parallelTime = 0.0;
+
+  StageTimerReset();
+
+  for(int32_t s = 0; s < GOLDEN_NUM_SEEDS; ++s)
+  {
+    MapSetSeed(goldenSeeds[s]);
+
+    //One thread, stage by stage
+    for(int32_t i = 0; i < GOLDEN_NUM_CHUNKS; ++i)
+    {
+      memset(chunks[i]->blocks, 0, BLOCKS_MEMORY_SIZE);
+
+      double start = TimeMeasurementNow();
+      WorldGenJob* job = WorldGeneratorBeginChunk(chunks[i]);
+      double lattice = TimeMeasurementNow();
+
+      const int32_t tileCount = WorldGeneratorGetTileCount();
+      for(int32_t tile = 0; tile < tileCount; ++tile)
+        WorldGeneratorGenerateTile(job, tile);
+
+      double columns = TimeMeasurementNow();
+      WorldGeneratorFinishChunk(job);
+      double end = TimeMeasurementNow();
+
+      stageTime[0] += lattice - start;
+      stageTime[1] += columns - lattice;
+      stageTime[2] += end - columns;
+
+      hashes[s][i] = BenchmarkHashBlocks(chunks[i]->blocks);
+      goldenMismatches += hashes[s][i] != goldenHashes[s][i];
+    }
+
+    //All threads at once
+    parallelTime += GenerateChunks(chunks, GOLDEN_NUM_CHUNKS, workers, maxThreads - 1);
+
+    for(int32_t i = 0; i < GOLDEN_NUM_CHUNKS; ++i)
+      threadMismatches += BenchmarkHashBlocks(chunks[i]->blocks) != hashes[s][i];
+  }
+
+  BenchmarkDestroyWorkers(workers, maxThreads - 1);
+  StageTimerLog();
+
+  for(int32_t i = 0; i < GOLDEN_NUM_CHUNKS; ++i)
+    BenchmarkFreeChunk(chunks[i]);
+
+  //Restore the configuration for whatever follows.
+  CAVES_ENABLED = caves;
+  EROSION_ENABLED = erosion;
+  BIOME_BLENDING = blending;
+  TERRAIN_GRAPH = graph;
+  TERRAIN_RASTER = raster;
+  WorldGeneratorFree();
+  WorldGeneratorInit();
+  MapSetSeed(BENCHMARK_SEED);
+
+  const int32_t numChunks = GOLDEN_NUM_SEEDS * GOLDEN_NUM_CHUNKS;
+  const double totalTime = stageTime[0] + stageTime[1] + stageTime[2];
+
+  LogInfo("Stage                  | ms/chunk | chunks/s | share\n", false);
+  LogInfo("Lattice (biome/height) | %8.3f | %8.1f | %4.1f%%\n", false, stageTime[0] / numChunks * 1000.0, numChunks / stageTime[0], stageTime[0] / totalTime * 100.0);
+  LogInfo("Columns (fill/caves)   | %8.3f | %8.1f | %4.1f%%\n", false, stageTime[1] / numChunks * 1000.0, numChunks / stageTime[1], stageTime[1] / totalTime * 100.0);
+  LogInfo("Structures (decorate)  | %8.3f | %8.1f | %4.1f%%\n", false, stageTime[2] / numChunks * 1000.0, numChunks / stageTime[2], stageTime[2] / totalTime * 100.0);
+  LogInfo("Total (1 thread)       | %8.3f | %8.1f |\n", false, totalTime / numChunks * 1000.0, numChunks / totalTime);
+  LogInfo("Total (%2d threads)     | %8.3f | %8.1f |\n", false, maxThreads, parallelTime / numChunks * 1000.0, numChunks / parallelTime);
+  LogInfo("%d seeds x %d x %d chunks; golden mismatches: %d, mismatches between 1 and %d threads: %d.", true,
+          GOLDEN_NUM_SEEDS, GOLDEN_GRID_SIDE, GOLDEN_GRID_SIDE, goldenMismatches, maxThreads, threadMismatches);
+
+  BenchmarkCheck(threadMismatches == 0, "The world generation depends on the number of threads!");
+
+  if(goldenMismatches == 0)
+  {
+    LogSuccess("The world generation matches the goldens.", true);
+
+    return;
+  }
+
+  //Ready to be pasted into "goldenHashes".
+  char error[GOLDEN_NUM_SEEDS * (GOLDEN_NUM_CHUNKS * 24 + 32) + 128];
+  int32_t length = snprintf(error, sizeof(error), "The world generation does not match the goldens. If the terrain changed on purpose, these are the new ones:");
+  for(int32_t s = 0; s < GOLDEN_NUM_SEEDS; ++s)
+  {
+    length += snprintf(error + length, sizeof(error) - length, "\n  {");
+    for(int32_t i = 0; i < GOLDEN_NUM_CHUNKS; ++i)
+      length += snprintf(error + length, sizeof(error) - length, "%s0x%016" PRIX64 "ULL%s", i % 4 == 0 ? "\n    " : " ", hashes[s][i], i + 1 < GOLDEN_NUM_CHUNKS ? "," : "");
+    length += snprintf(error + length, sizeof(error) - length, "\n  }%s", s + 1 < GOLDEN_NUM_SEEDS ? "," : "");
+  }
+
+  BenchmarkCheck(false, error);
+}
+
+static const BenchmarkEntry benchmarks[] =
+{
+  {"caves", "World generation throughput with caves disabled and enabled", BenchmarkCaves},
+  {"terrain-graph", "Terrain graph evaluator against the hand-written terrain (throughput and equality)", BenchmarkTerrainGraph},
+  {"erosion", "Hydraulic erosion tiles per second with a golden-output check", BenchmarkErosion},
+  {"biome-blending", "World generation throughput and height steps with biome blending disabled and enabled", BenchmarkBiomeBlending},
+  {"voxel-dag", "Compression ratio and point, ray and box query throughput of a sparse voxel DAG of a generated region", BenchmarkVoxelDAG},
+  {"terrain-raster", "Memory-mapped terrain raster as the worldgen source (equality and generation throughput on 1 and N threads)", BenchmarkTerrainRaster},
+  {"worldgen-golden", "Chunks of several seeds against golden hashes on 1 and N threads, with the generation time per stage", BenchmarkWorldGenGolden}
+};
+
+const BenchmarkEntry* WorldGenBenchmarksGet(int32_t* count)
+{
+  *count = (int32_t)ARRAY_SIZE(benchmarks);
+
+  return benchmarks;
+}
\ No newline at end of file
@@ -41,6 +41,8 @@ Camera* CameraCreate(vec3 pos, float pitch, float yaw, vec3 front)
 
   cam->clipNear = BLOCK_SIZE / 10.0f;
   cam->clipFar = MAX((CHUNK_RENDER_RADIUS * 1.2f) * CHUNK_SIZE, 512 * BLOCK_SIZE);
+  if(FAR_TERRAIN_ENABLED)
+    cam->clipFar = MAX(cam->clipFar, (FAR_TERRAIN_DISTANCE * 1.2f) * BLOCK_SIZE);
   cam->aspectRatio = WINDOW_WIDTH / (float)WINDOW_HEIGHT;
 
   glm_look(cam->pos, cam->front, cam->up, cam->viewMatrix);
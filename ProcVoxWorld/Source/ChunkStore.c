@@ -0,0 +1,96 @@
+#include "ChunkStore.h"
+
+#include "Database.h"
+#include "RegionStore.h"
+#include "WorldGenerator.h"
+
+static void DatabaseStoreFree()
+{
+  //The database is closed by its owner.
+}
+
+static const ChunkStore databaseStore = {"database", DatabaseLoadChunk, DatabaseInsertChunk, DatabaseHasChunk, DatabaseStoreFree, false};
+static const ChunkStore regionStore = {"region files", RegionStoreLoad, RegionStoreSave, RegionStoreHas, RegionStoreFree, true};
+
+static const ChunkStore* sStore = &databaseStore;
+
+void ChunkStoreInit(const char* mapPath, bool regions)
+{
+  sStore = &databaseStore;
+
+  //Chunks stored by another world generation (other settings, terrain graph or raster) are not used.
+  const uint32_t generatorVersion = WorldGeneratorGetVersion();
+  DatabaseSetGeneratorVersion(generatorVersion);
+
+  if(regions && RegionStoreInit(mapPath, generatorVersion))
+    sStore = &regionStore;
+
+  LogInfo("Generated chunks are stored in %s.", true, sStore->name);
+}
+
+void ChunkStoreFree()
+{
+  sStore->free();
+  sStore = &databaseStore;
+}
+
+const ChunkStore* ChunkStoreGet()
+{
+  return sStore;
+}
+
+bool ChunkStoreLoad(Chunk* c)
+{
+  return sStore->load(c);
+}
+
+void ChunkStoreSave(const Chunk* c)
+{
+  sStore->save(c);
+}
+
+bool ChunkStoreHas(int32_t chunkX, int32_t chunkZ)
+{
+  return sStore->has(chunkX, chunkZ);
+}
+
+void ChunkStoreKeepGenerated(const Chunk* c)
+{
+  if(sStore->keepsGenerated)
+    sStore->save(c);
+}
+
+size_t ChunkStoreEncodeBlocks(const uint8_t* blocks, uint8_t* encoded)
+{
+  size_t size = 0;
+  for(uintmax_t i = 0; i < BLOCKS_MEMORY_SIZE;)
+  {
+    const uint8_t block = blocks[i];
+
+    uintmax_t run = 1;
+    while(run < 256 && i + run < BLOCKS_MEMORY_SIZE && blocks[i + run] == block)
+      ++run;
+
+    encoded[size++] = block;
+    encoded[size++] = (uint8_t)(run - 1);
+    i += run;
+  }
+
+  return size;
+}
+
+bool ChunkStoreDecodeBlocks(const uint8_t* encoded, size_t size, uint8_t* blocks)
+{
+  uintmax_t pos = 0;
+  for(size_t i = 0; i + 1 < size; i += 2)
+  {
+    const uintmax_t run = encoded[i + 1] + 1;
+    if(pos + run > BLOCKS_MEMORY_SIZE)
+      return false;
+
+    memset(&blocks[pos], encoded[i], run);
+    pos += run;
+  }
+
+  return pos == BLOCKS_MEMORY_SIZE;
+}
\ No newline at end of file
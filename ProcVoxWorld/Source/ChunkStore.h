@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Map/Chunk.h"
+
+/* Persistent store of generated chunks, so that loading them skips the world generation. The edits in the database are
+ * the source of truth in any case: they are applied on top of every chunk, whether it is stored or generated.
+ * By default, the "Chunks" table of the database holds the pregenerated chunks only; with region files (see
+ * "RegionStore.h"), every chunk generated while playing is kept as well. */
+typedef struct
+{
+  const char* name;
+
+  //Returns "false" if the chunk is not stored; "c->blocks" has to be allocated.
+  bool (*load)(Chunk* c);
+  void (*save)(const Chunk* c);
+  bool (*has)(int32_t chunkX, int32_t chunkZ);
+  void (*free)();
+
+  bool keepsGenerated; //Chunks generated while playing are stored, too.
+} ChunkStore;
+
+/* Region files next to "mapPath" if "regions" is set (and they can be used), otherwise the database. Either only returns
+ * chunks of the current world generation ("WorldGeneratorGetVersion()"), so the generator has to be set up before. */
+void ChunkStoreInit(const char* mapPath, bool regions);
+
+//Back to the database.
+void ChunkStoreFree();
+
+const ChunkStore* ChunkStoreGet();
+
+bool ChunkStoreLoad(Chunk* c);
+
+void ChunkStoreSave(const Chunk* c);
+
+bool ChunkStoreHas(int32_t chunkX, int32_t chunkZ);
+
+//To be called with every chunk just generated (before any edits are applied); stores it if the store keeps those.
+void ChunkStoreKeepGenerated(const Chunk* c);
+
+/* Run-length encoding of the blocks of a chunk as pairs of (block, run length - 1); columns consist of long runs of
+ * the same block, so a chunk shrinks to a few kilobytes. "encoded" needs room for "BLOCKS_MEMORY_SIZE" * 2 bytes
+ * (no two neighbouring blocks alike). Returns the encoded size. */
+size_t ChunkStoreEncodeBlocks(const uint8_t* blocks, uint8_t* encoded);
+
+//Returns "false" if "encoded" does not cover exactly all blocks.
+bool ChunkStoreDecodeBlocks(const uint8_t* encoded, size_t size, uint8_t* blocks);
\ No newline at end of file
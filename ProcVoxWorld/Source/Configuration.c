@@ -27,6 +27,12 @@ bool VSYNC      = false;
 int32_t CHUNK_RENDER_RADIUS      = DEFAULT_CHUNK_RENDER_RADIUS; //High performance hit!
 int32_t ANISOTROPIC_FILTER_LEVEL = 16; //Very low performance hitand a huge image quality boost in return
 
+int32_t CHUNK_LOD1_DISTANCE = 10; //In chunks; beyond, chunks are meshed at half the resolution (0 = disabled).
+int32_t CHUNK_LOD2_DISTANCE = 20; //In chunks; beyond, chunks are meshed at a quarter of the resolution (0 = disabled).
+
+bool FAR_TERRAIN_ENABLED     = true; //Coarse heightfield beyond the chunks | Low performance hit compared to a larger render radius
+int32_t FAR_TERRAIN_DISTANCE = 4096; //In blocks
+
 bool MOTION_BLUR_ENABLED    = true; //Motion blur implicates a low performance hit if the amount of samples is moderate.
 float MOTION_BLUR_STRENGTH  = 0.0005f;
 int32_t MOTION_BLUR_SAMPLES = 7;
@@ -47,6 +53,17 @@ float SATURATION = 1.2f;
 int32_t MAP_SEED = -1; /* -1 = random (Range for seed: 0 - RAND_MAX) | "RAND_MAX" is a constant defined in "<cstdlib>";
                                   *                                  | its value is library-dependent, but guaranteed to be at least 32767 on any standard library implementation. */
 int8_t* MAP_NAME = "DefaultMap.db";
+bool EDIT_COMPACTION = true; //Edits which equal the terrain are dropped while nothing is edited | A fraction of a core when idle; see "--compact-edits <map name>".
+bool REGION_STORE = false; //Generated chunks kept in region files next to the map, so loading them skips the generation | Costs disk space; see "--benchmark region-store".
+bool MESH_CACHE = true; //Blocks and meshes of the chunks around the player are kept next to the map when it is closed, so it opens with them in view | Costs disk space; see "--benchmark mesh-cache".
+int32_t AUTOSAVE_INTERVAL = 60; //Seconds between saves of the player and the time of day while playing; 0 = only on exit | The writer thread stores them; see "--benchmark autosave".
+int32_t SNAPSHOT_INTERVAL = 300; //Seconds between snapshots of the edits, taken in the background; 0 = none | Only changed chunks are written; see "--restore-snapshot".
+
+bool CAVES_ENABLED = true; //Caves and overhangs carved from coarse 3D noise | Medium generation cost, see "--benchmark caves".
+bool EROSION_ENABLED = false; //Hydraulic erosion of the heightmap | Changes the terrain of existing maps; see "--benchmark erosion".
+bool BIOME_BLENDING = false; //Heights blended across biome borders | Changes the terrain of existing maps; see "--benchmark biome-blending".
+int8_t* TERRAIN_GRAPH = "Terrain.graph"; //Data-driven biomes and heights; if empty, the built-in terrain is used.
+int8_t* TERRAIN_RASTER = ""; //Authored heights and biomes (memory-mapped raster); if set, it takes precedence over the terrain graph.
 
 float MOUSE_SENS           = 0.1f;
 int32_t BLOCK_BREAK_RADIUS = DEFAULT_BLOCK_BREAK_RADIUS; //Furthest distance (in blocks) for the player to reach.
@@ -131,6 +148,15 @@ static void CreateDefaultConfigFile(const char* configPath)
                    "ChunkRenderRadius = 16 ; High performance hit!\n\n"
    
                    "AnisotropicFilterLevel = 16 ; Very low performance hit and a huge image quality boost in return\n\n"
+
+                   "; Distances (in chunks) beyond which chunks are meshed at half and a quarter of the resolution (0 = disabled).\n"
+                   "; Large render radii need them: at 32 chunks, the meshes take a fifth of the GPU memory and a frame a third of the time.\n"
+                   "ChunkLod1Distance = 10\n"
+                   "ChunkLod2Distance = 20\n\n"
+
+                   "; Coarse heightfield beyond the chunks (low performance hit compared to a larger render radius).\n"
+                   "FarTerrainEnabled  = true\n"
+                   "FarTerrainDistance = 4096 ; In blocks\n\n"
     
                    "; Low performance hit if the amount of samples is moderate.\n"
                    "MotionBlurEnabled  = true\n"
@@ -153,7 +179,22 @@ static void CreateDefaultConfigFile(const char* configPath)
     
                    "[GAMEPLAY]\n"
                    "MapSeed = -1 ; -1 = random (Range for seed: 0 - RAND_MAX)\n"
-                   "MapName = DefaultMap.db\n\n"
+                   "MapName = DefaultMap.db\n"
+                   "EditCompaction = true ; Drop edits which equal the terrain while nothing is edited (shorter chunk loads)\n"
+                   "RegionStore = false ; Keep generated chunks in region files next to the map (faster loading, costs disk space)\n"
+                   "MeshCache = true ; Keep the chunks in view next to the map when closing it, so reopening it shows them at once (costs disk space)\n"
+                   "AutosaveInterval = 60 ; Seconds between saves of the player and the time of day while playing, 0 = only on exit\n"
+                   "SnapshotInterval = 300 ; Seconds between incremental snapshots of the edits next to the map, 0 = none\n\n"
+
+                   "Caves = true ; Caves and overhangs (medium generation cost)\n"
+                   "Erosion = false ; Hydraulic erosion (changes the terrain of existing maps)\n"
+                   "BiomeBlending = false ; Smooth heights across biome borders (changes the terrain of existing maps)\n\n"
+
+                   "; Data-driven biomes and heights; if empty, the built-in terrain is used.\n"
+                   "TerrainGraph = Terrain.graph\n\n"
+
+                   "; Authored heights and biomes (tiled raster, see \"TerrainRaster.h\"); if set, it takes precedence over the terrain graph.\n"
+                   "TerrainRaster = \n\n"
 
                    "MouseSens = 0.1\n\n"
     
@@ -251,6 +292,8 @@ static void PrintValueToStderr(const char* fmt, void* value, bool newLine)
     fprintf(stderr, "%s%s", *(const char**)value, nL);
   else if(!strcmp(fmt, "%d") /* Strings are identical. */)
     fprintf(stderr, "%d%s", *(int32_t*)value, nL);
+  else if(!strcmp(fmt, "%b"))
+    fprintf(stderr, "%s%s", *(bool*)value ? "true" : "false", nL);
   else
     fprintf(stderr, "%.3f%s", *(float*)value, nL); //Precision: three digits -> "printf - C++ Reference": https://www.cplusplus.com/reference/cstdio/printf/	
 }
@@ -278,7 +321,16 @@ static void TryToLoad(ini_t* cfg, const char* section, const char* key, const ch
     return;
   }
 
-  if(fmt != NULL)
+  //"%b" is no format of "scanf()": switches are written as "true" or "false" (or as a number) and kept in a "bool".
+  if(fmt != NULL && !strcmp(fmt, "%b"))
+  {
+    int32_t value = 0;
+    if(sscanf_s(tokenStr, "%d", &value, strlen(tokenStr)) != 1)
+      value = !strncmp(tokenStr, "true", 4);
+
+    *(bool*)dst = value != 0;
+  }
+  else if(fmt != NULL)
     sscanf_s(tokenStr, fmt, dst, strlen(tokenStr));
   else
     *(const char**)dst = OwnStrDup(tokenStr);
@@ -304,18 +356,24 @@ void ConfigurationLoad(const char* configPath)
   TryToLoad(cfg, "WINDOW", "Width", "%d", &WINDOW_WIDTH);
   TryToLoad(cfg, "WINDOW", "Height", "%d", &WINDOW_HEIGHT);
 
-  TryToLoad(cfg, "WINDOW", "Fullscreen", "%d", &FULLSCREEN);
-  TryToLoad(cfg, "WINDOW", "VSync", "%d", &VSYNC);
+  TryToLoad(cfg, "WINDOW", "Fullscreen", "%b", &FULLSCREEN);
+  TryToLoad(cfg, "WINDOW", "VSync", "%b", &VSYNC);
 
   TryToLoad(cfg, "GRAPHICS", "ChunkRenderRadius", "%d", &CHUNK_RENDER_RADIUS);
   TryToLoad(cfg, "GRAPHICS", "AnisotropicFilterLevel", "%d", &ANISOTROPIC_FILTER_LEVEL);
 
-  TryToLoad(cfg, "GRAPHICS", "MotionBlurEnabled", "%d", &MOTION_BLUR_ENABLED);
+  TryToLoad(cfg, "GRAPHICS", "ChunkLod1Distance", "%d", &CHUNK_LOD1_DISTANCE);
+  TryToLoad(cfg, "GRAPHICS", "ChunkLod2Distance", "%d", &CHUNK_LOD2_DISTANCE);
+
+  TryToLoad(cfg, "GRAPHICS", "FarTerrainEnabled", "%b", &FAR_TERRAIN_ENABLED);
+  TryToLoad(cfg, "GRAPHICS", "FarTerrainDistance", "%d", &FAR_TERRAIN_DISTANCE);
+
+  TryToLoad(cfg, "GRAPHICS", "MotionBlurEnabled", "%b", &MOTION_BLUR_ENABLED);
   TryToLoad(cfg, "GRAPHICS", "MotionBlurStrength", "%f", &MOTION_BLUR_STRENGTH);
   TryToLoad(cfg, "GRAPHICS", "MotionBlurSamples", "%d", &MOTION_BLUR_SAMPLES);
 
-  TryToLoad(cfg, "GRAPHICS", "DepthOfFieldEnabled", "%d", &DOF_ENABLED);
-  TryToLoad(cfg, "GRAPHICS", "DepthOfFieldSmooth", "%d", &DOF_SMOOTH);
+  TryToLoad(cfg, "GRAPHICS", "DepthOfFieldEnabled", "%b", &DOF_ENABLED);
+  TryToLoad(cfg, "GRAPHICS", "DepthOfFieldSmooth", "%b", &DOF_SMOOTH);
   TryToLoad(cfg, "GRAPHICS", "DepthOfFieldMaxBlur", "%f", &DOF_MAX_BLUR);
   TryToLoad(cfg, "GRAPHICS", "DepthOfFieldAperture", "%f", &DOF_APERTURE);
   TryToLoad(cfg, "GRAPHICS", "DepthOfFieldSpeed", "%f", &DOF_SPEED);
@@ -328,12 +386,23 @@ void ConfigurationLoad(const char* configPath)
 
   TryToLoad(cfg, "GAMEPLAY", "MapSeed", "%d", &MAP_SEED);
   TryToLoad(cfg, "GAMEPLAY", "MapName", NULL, &MAP_NAME);
+  TryToLoad(cfg, "GAMEPLAY", "EditCompaction", "%b", &EDIT_COMPACTION);
+  TryToLoad(cfg, "GAMEPLAY", "RegionStore", "%b", &REGION_STORE);
+  TryToLoad(cfg, "GAMEPLAY", "MeshCache", "%b", &MESH_CACHE);
+  TryToLoad(cfg, "GAMEPLAY", "AutosaveInterval", "%d", &AUTOSAVE_INTERVAL);
+  TryToLoad(cfg, "GAMEPLAY", "SnapshotInterval", "%d", &SNAPSHOT_INTERVAL);
+
+  TryToLoad(cfg, "GAMEPLAY", "Caves", "%b", &CAVES_ENABLED);
+  TryToLoad(cfg, "GAMEPLAY", "Erosion", "%b", &EROSION_ENABLED);
+  TryToLoad(cfg, "GAMEPLAY", "BiomeBlending", "%b", &BIOME_BLENDING);
+  TryToLoad(cfg, "GAMEPLAY", "TerrainGraph", NULL, &TERRAIN_GRAPH);
+  TryToLoad(cfg, "GAMEPLAY", "TerrainRaster", NULL, &TERRAIN_RASTER);
 
   TryToLoad(cfg, "GAMEPLAY", "MouseSens", "%f", &MOUSE_SENS);
   TryToLoad(cfg, "GAMEPLAY", "BlockBreakRadius", "%d", &BLOCK_BREAK_RADIUS);
 
   TryToLoad(cfg, "GAMEPLAY", "DayLength", "%d", &DAY_LENGTH);
-  TryToLoad(cfg, "GAMEPLAY", "DisableTimeFlow", "%d", &DISABLE_TIME_FLOW);
+  TryToLoad(cfg, "GAMEPLAY", "DisableTimeFlow", "%b", &DISABLE_TIME_FLOW);
 
   TryToLoad(cfg, "GAMEPLAY", "DayLight", "%f", &DAY_LIGHT);
   TryToLoad(cfg, "GAMEPLAY", "EveningLight", "%f", &EVENING_LIGHT);
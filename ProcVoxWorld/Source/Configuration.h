@@ -21,6 +21,12 @@ extern bool VSYNC;
 extern int32_t CHUNK_RENDER_RADIUS;
 extern int32_t ANISOTROPIC_FILTER_LEVEL;
 
+extern int32_t CHUNK_LOD1_DISTANCE;
+extern int32_t CHUNK_LOD2_DISTANCE;
+
+extern bool FAR_TERRAIN_ENABLED;
+extern int32_t FAR_TERRAIN_DISTANCE;
+
 extern bool MOTION_BLUR_ENABLED;
 extern float MOTION_BLUR_STRENGTH;
 extern int32_t MOTION_BLUR_SAMPLES;
@@ -40,6 +46,17 @@ extern float SATURATION;
 //--- GAMEPLAY ---
 extern int32_t MAP_SEED;
 extern int8_t* MAP_NAME;
+extern bool EDIT_COMPACTION;
+extern bool REGION_STORE;
+extern bool MESH_CACHE;
+extern int32_t AUTOSAVE_INTERVAL;
+extern int32_t SNAPSHOT_INTERVAL;
+
+extern bool CAVES_ENABLED;
+extern bool EROSION_ENABLED;
+extern bool BIOME_BLENDING;
+extern int8_t* TERRAIN_GRAPH;
+extern int8_t* TERRAIN_RASTER;
 
 extern float MOUSE_SENS;
 extern int32_t BLOCK_BREAK_RADIUS;
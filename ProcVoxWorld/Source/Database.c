@@ -2,66 +2,970 @@
 
 #include "SQLite/sqlite3.h"
 
+#include "ChunkStore.h"
+#include "TimeMeasurement.h"
+
 #include "Map/Map.h"
 
 #include <assert.h>
 
+/* Block edits are not written by the thread making them: they are pushed into a ring buffer (one producer, one consumer,
+ * no locks), which the writer thread drains into batches of up to "WRITER_BATCH_SIZE" edits. A batch is committed
+ * in one transaction once it is full, "WRITER_BATCH_TIME" seconds old or a flush waits for it. */
+#define EDIT_QUEUE_SIZE   65536 //Power of two
+#define WRITER_BATCH_SIZE 4096
+#define WRITER_BATCH_TIME 0.1
+#define WRITER_IDLE_WAIT  0.005 //Seconds between looks at the empty queue
+
+/* The edits of a chunk are stored in one row of "ChunkEdits": a version byte, the number of edits and the size of
+ * the positions in bytes (both varints), the positions ("XYZ()" indices) in ascending order as varint deltas and
+ * then the blocks as runs of (block, varint run length - 1). Rows are rewritten as a whole, hence a chunk is always
+ * read with all of its edits of a commit or none of them. */
+#define EDITS_VERSION 1
+
+typedef struct
+{
+  int32_t chunkX, chunkZ;
+  int16_t x, y, z;
+  uint8_t block;
+} BlockEdit;
+
+//An edit on its way into "ChunkEdits"; "order" keeps the latest of several edits of one block.
+typedef struct
+{
+  int32_t chunkX, chunkZ;
+  uint32_t position;
+  int32_t order;
+  uint8_t block;
+} PendingEdit;
+
+//Player and map information of an autosave, copied on the main thread and stored by the writer thread.
+typedef struct
+{
+  bool hasPlayer;
+  double pos[3];
+  double pitch, yaw;
+  int32_t buildBlock;
+  double time;
+  int64_t editHead; //Edits queued before the save; they are stored with it or before it
+} SaveState;
+
+//Walks through the edits of a blob in ascending order of position.
+typedef struct
+{
+  const uint8_t* position;
+  const uint8_t* positionsEnd;
+  const uint8_t* block;
+  const uint8_t* end;
+
+  uint32_t remaining;
+  uint32_t lastPosition;
+  uint32_t runLeft;
+  uint8_t runBlock;
+  bool damaged;
+} EditsCursor;
+
 static sqlite3* db;
 static bool sHasPlayerInfo;
 static bool sHasMapInfo;
 
-static sqlite3_stmt* DatabaseCompileStatement(const char* statement)
+//Chunks are stored and looked up by the main thread, but a prepared statement must only be used by one thread at a time.
+static mtx_t sChunkStmtMtx;
+
+static uint32_t sGeneratorVersion; //Of the chunks in "Chunks" which are used
+
+/* Every thread which loads chunks (the workers and the main thread) reads through a read-only connection and statements
+ * of its own, so lookups run in parallel with each other and, thanks to the WAL journal, with the writer. An in-memory
+ * database cannot be opened twice; then the statements of each thread are compiled for the shared connection. */
+typedef struct Reader
+{
+  sqlite3* connection; //"NULL" until the thread reads for the first time since "DatabaseInit()"
+  sqlite3_stmt* blocksStmt;
+  sqlite3_stmt* chunkStmt;
+  struct Reader* prev;
+  struct Reader* next;
+} Reader;
+
+static char sDbPath[1024];
+static bool sSharedReads;
+
+static Reader* sReaders; //Of all threads, guarded by "sReadersMtx"
+static mtx_t sReadersMtx;
+static tss_t sReaderKey; //Only for its destructor, which closes the connection of a finished thread.
+static once_flag sReadersInitFlag = ONCE_FLAG_INIT;
+
+static _Thread_local Reader* tReader;
+
+static BlockEdit sEditQueue[EDIT_QUEUE_SIZE];
+static volatile int64_t sEditHead;      //Edits pushed so far; only written by the pushing thread
+static volatile int64_t sEditTail;      //Edits taken from the queue so far; only written by the writer
+static volatile int64_t sEditCommitted; //Edits committed so far; only written by the writer
+
+static thrd_t sWriterThread;
+static mtx_t sWriterMtx;
+static cnd_t sWriterCondVar;  //Wakes the writer (flush or stop)
+static cnd_t sFlushedCondVar; //Wakes threads waiting for a flush
+static int32_t sFlushWaiters;
+static bool sWriterStop;
+static int64_t sWriterTransactions;
+
+static SaveState sPendingSave;           //The latest save requested, guarded by "sWriterMtx"
+static volatile int64_t sSavesRequested; //Only written by the requesting thread
+static volatile int64_t sSavesStored;    //Only written by the writer
+
+//Statements compiled once and kept until "DatabaseFree()"; as long as one is left, the connection cannot be closed.
+#define MAX_CACHED_STATEMENTS 16
+static sqlite3_stmt** sCachedStmts[MAX_CACHED_STATEMENTS];
+static int32_t sNumCachedStmts;
+static mtx_t sCachedStmtsMtx;
+
+//Held by whoever has a transaction open, since the connection can only have one at a time.
+static mtx_t sTransactionMtx;
+static _Thread_local bool tInTransaction;
+
+/* Chunks with edits (committed or still queued), loaded when the map is opened: lookups of all the other chunks, which
+ * are nearly all of them, skip SQLite. A set of coordinates with open addressing (linear probing); a chunk is only taken
+ * out again once compaction deleted all of its edits. */
+#define EDITED_CHUNKS_MIN_CAPACITY 1024 //Power of two
+
+//Any coordinates are valid, hence an unused slot is told apart by "used" rather than by reserved coordinates.
+typedef struct
+{
+  int32_t chunkX, chunkZ;
+  bool used;
+} EditedChunk;
+
+static EditedChunk* sEditedChunks;
+static int32_t sEditedChunksCapacity; //Power of two, at least twice the count
+static int32_t sNumEditedChunks;
+static mtx_t sEditedChunksMtx;
+
+static sqlite3_stmt* DatabaseCompileStatementFor(sqlite3* connection, const char* statement)
+{
+  sqlite3_stmt* stmt;
+  sqlite3_prepare_v2(connection, statement, -1, &stmt, NULL);
+  if(stmt == NULL)
+    LogError("SQLite (SQL database engine) reports an error during statement compiling.\nThe used statement was: %s.\nThe resulting error is: %s.", true, statement, sqlite3_errmsg(connection));
+
+  return stmt;
+}
+
+static sqlite3_stmt* DatabaseCompileStatement(const char* statement)
+{
+  return DatabaseCompileStatementFor(db, statement);
+}
+
+//"stmt" has to be a static variable; it is set back to "NULL" once the connection is closed.
+static void DatabaseCacheStatement(sqlite3_stmt** stmt, const char* statement)
+{
+  sqlite3_stmt* compiled = DatabaseCompileStatement(statement);
+
+  mtx_lock(&sCachedStmtsMtx);
+  assert(sNumCachedStmts < MAX_CACHED_STATEMENTS);
+  sCachedStmts[sNumCachedStmts++] = stmt;
+  *stmt = compiled;
+  mtx_unlock(&sCachedStmtsMtx);
+}
+
+static void DatabaseCompileRunStatement(const char* statement)
+{
+  sqlite3_stmt* stmt = DatabaseCompileStatement(statement);
+
+  sqlite3_step(stmt);
+  sqlite3_finalize(stmt);
+}
+
+static bool DatabaseIsTableEmpty(const char* table)
+{
+  char query[512];
+  snprintf(query, sizeof(query), "SELECT COUNT(*) FROM %s", table);
+
+  sqlite3_stmt* stmt = DatabaseCompileStatement(query);
+
+  sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
+  sqlite3_step(stmt);
+
+  int32_t rowCount = sqlite3_column_int(stmt, 0);
+
+  sqlite3_finalize(stmt);
+
+  return rowCount == 0;
+}
+
+static void DatabaseCreateTables()
+{
+  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS ChunkEdits(chunkX INTEGER NOT NULL, chunkZ INTEGER NOT NULL, edits BLOB NOT NULL, PRIMARY KEY(chunkX, chunkZ))");
+
+  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS MapInfo(seed INTEGER NOT NULL, currTime REAL NOT NULL, chunkWidth INTEGER NOT NULL, chunkHeight INTEGER NOT NULL)");
+
+  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS PlayerInfo(posX REAL NOT NULL, posY REAL NOT NULL, posZ REAL NOT NULL, pitch REAL NOT NULL, yaw REAL NOT NULL, buildBlock INTEGER NOT NULL)");
+
+  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS Chunks(chunkX INTEGER NOT NULL, chunkZ INTEGER NOT NULL, blocks BLOB NOT NULL, "
+                              "generatorVersion INTEGER NOT NULL DEFAULT 0, PRIMARY KEY(chunkX, chunkZ))");
+
+  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS Pregeneration(centerX INTEGER NOT NULL, centerZ INTEGER NOT NULL, radius INTEGER NOT NULL, "
+                              "done INTEGER NOT NULL, PRIMARY KEY(centerX, centerZ, radius))");
+
+  //Chunks stored before the version of their world generation was kept have version 0, so they are generated anew.
+  sqlite3_stmt* stmt = DatabaseCompileStatement("SELECT 1 FROM pragma_table_info('Chunks') WHERE name = 'generatorVersion'");
+  const bool hasGeneratorVersion = sqlite3_step(stmt) == SQLITE_ROW;
+  sqlite3_finalize(stmt);
+
+  if(!hasGeneratorVersion)
+    DatabaseCompileRunStatement("ALTER TABLE Chunks ADD COLUMN generatorVersion INTEGER NOT NULL DEFAULT 0");
+
+  //Chunks whose edits changed since the last snapshot; a chunk changed again gets a new "change", higher than any before.
+  stmt = DatabaseCompileStatement("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'ChangedChunks'");
+  const bool hasChangedChunks = sqlite3_step(stmt) == SQLITE_ROW;
+  sqlite3_finalize(stmt);
+
+  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS ChangedChunks(change INTEGER PRIMARY KEY AUTOINCREMENT, chunkX INTEGER NOT NULL, chunkZ INTEGER NOT NULL, "
+                              "UNIQUE(chunkX, chunkZ))");
+
+  //Maps from before snapshots start with all of their edits in the first one.
+  if(!hasChangedChunks)
+    DatabaseCompileRunStatement("INSERT INTO ChangedChunks (chunkX, chunkZ) SELECT chunkX, chunkZ FROM ChunkEdits");
+
+  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS Snapshots(id INTEGER PRIMARY KEY, time REAL NOT NULL, chunks INTEGER NOT NULL)");
+
+  if(!strcmp(sqlite3_errmsg(db), "not an error"))
+    LogSuccess("Database tables \"ChunkEdits\", \"MapInfo\", \"PlayerInfo\", \"Chunks\", \"Pregeneration\", \"ChangedChunks\" and \"Snapshots\" were successfully created.", true);
+
+  if(!DatabaseIsTableEmpty("MapInfo"))
+    sHasMapInfo = true;
+
+  if(!DatabaseIsTableEmpty("PlayerInfo"))
+    sHasPlayerInfo = true;
+}
+
+static size_t WriteVarint(uint8_t* out, uint32_t value)
+{
+  size_t size = 0;
+  while(value >= 0x80)
+  {
+    out[size++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[size++] = (uint8_t)value;
+
+  return size;
+}
+
+static bool ReadVarint(const uint8_t** in, const uint8_t* end, uint32_t* value)
+{
+  *value = 0;
+  for(int32_t shift = 0; shift < 35 && *in < end; shift += 7)
+  {
+    const uint8_t byte = *(*in)++;
+    *value |= (uint32_t)(byte & 0x7F) << shift;
+
+    if(!(byte & 0x80))
+      return true;
+  }
+
+  return false;
+}
+
+//Upper bound of the encoded size of "count" edits.
+static size_t EditsMaxSize(int32_t count)
+{
+  return 1 + 2 * 5 + (size_t)count * (5 + 1 + 5);
+}
+
+//"positions" have to be ascending without duplicates.
+static size_t EncodeEdits(const uint32_t* positions, const uint8_t* blocks, int32_t count, uint8_t* encoded)
+{
+  //The positions go first into the space of the blocks, as their size is part of the header.
+  uint8_t* deltas = encoded + EditsMaxSize(count) - (size_t)count * 5;
+  size_t positionsSize = 0;
+  for(int32_t i = 0; i < count; ++i)
+    positionsSize += WriteVarint(deltas + positionsSize, positions[i] - (i > 0 ? positions[i - 1] : 0));
+
+  size_t size = 0;
+  encoded[size++] = EDITS_VERSION;
+  size += WriteVarint(encoded + size, (uint32_t)count);
+  size += WriteVarint(encoded + size, (uint32_t)positionsSize);
+  memmove(encoded + size, deltas, positionsSize);
+  size += positionsSize;
+
+  for(int32_t i = 0; i < count;)
+  {
+    int32_t run = 1;
+    while(i + run < count && blocks[i + run] == blocks[i])
+      ++run;
+
+    encoded[size++] = blocks[i];
+    size += WriteVarint(encoded + size, (uint32_t)(run - 1));
+    i += run;
+  }
+
+  return size;
+}
+
+static void EditsCursorInit(EditsCursor* cursor, const uint8_t* encoded, size_t size)
+{
+  memset(cursor, 0, sizeof(EditsCursor));
+
+  const uint8_t* end = encoded + size;
+  uint32_t positionsSize = 0;
+  if(size == 0 || encoded[0] != EDITS_VERSION)
+  {
+    cursor->damaged = size != 0;
+
+    return;
+  }
+
+  ++encoded;
+  if(!ReadVarint(&encoded, end, &cursor->remaining) || !ReadVarint(&encoded, end, &positionsSize) || positionsSize > (size_t)(end - encoded))
+  {
+    cursor->remaining = 0;
+    cursor->damaged = true;
+
+    return;
+  }
+
+  cursor->position = encoded;
+  cursor->positionsEnd = encoded + positionsSize;
+  cursor->block = cursor->positionsEnd;
+  cursor->end = end;
+}
+
+//Returns "false" after the last edit or if the blob turns out to be damaged ("cursor->damaged").
+static bool EditsCursorNext(EditsCursor* cursor, uint32_t* position, uint8_t* block)
+{
+  if(cursor->remaining == 0)
+    return false;
+
+  uint32_t delta;
+  if(!ReadVarint(&cursor->position, cursor->positionsEnd, &delta))
+  {
+    cursor->damaged = true;
+    cursor->remaining = 0;
+
+    return false;
+  }
+
+  if(cursor->runLeft == 0)
+  {
+    if(cursor->block >= cursor->end)
+    {
+      cursor->damaged = true;
+      cursor->remaining = 0;
+
+      return false;
+    }
+
+    cursor->runBlock = *cursor->block++;
+    if(!ReadVarint(&cursor->block, cursor->end, &cursor->runLeft))
+    {
+      cursor->damaged = true;
+      cursor->remaining = 0;
+
+      return false;
+    }
+    ++cursor->runLeft;
+  }
+
+  cursor->lastPosition += delta;
+  --cursor->runLeft;
+  --cursor->remaining;
+
+  if(cursor->lastPosition >= BLOCKS_MEMORY_SIZE)
+  {
+    cursor->damaged = true;
+    cursor->remaining = 0;
+
+    return false;
+  }
+
+  *position = cursor->lastPosition;
+  *block = cursor->runBlock;
+
+  return true;
+}
+
+static int32_t ComparePendingEdits(const void* a, const void* b)
+{
+  const PendingEdit* e0 = (const PendingEdit*)a;
+  const PendingEdit* e1 = (const PendingEdit*)b;
+
+  if(e0->chunkX != e1->chunkX)
+    return e0->chunkX < e1->chunkX ? -1 : 1;
+  if(e0->chunkZ != e1->chunkZ)
+    return e0->chunkZ < e1->chunkZ ? -1 : 1;
+  if(e0->position != e1->position)
+    return e0->position < e1->position ? -1 : 1;
+
+  return (e0->order > e1->order) - (e0->order < e1->order);
+}
+
+//Takes the chunk into the next snapshot; called within the transaction which changes its edits.
+static void DatabaseMarkChunkChanged(int32_t chunkX, int32_t chunkZ)
+{
+  static sqlite3_stmt* stmt = NULL;
+
+  if(stmt == NULL)
+    DatabaseCacheStatement(&stmt, "INSERT OR REPLACE INTO ChangedChunks (chunkX, chunkZ) VALUES (?, ?)");
+
+  sqlite3_reset(stmt);
+  sqlite3_bind_int(stmt, 1, chunkX);
+  sqlite3_bind_int(stmt, 2, chunkZ);
+  sqlite3_step(stmt);
+}
+
+//Merges the edits of one chunk ("edits" sorted by position and order) into its row.
+static void DatabaseMergeChunkEdits(const PendingEdit* edits, int32_t count, sqlite3_stmt* selectStmt, sqlite3_stmt* insertStmt)
+{
+  sqlite3_reset(selectStmt);
+  sqlite3_bind_int(selectStmt, 1, edits[0].chunkX);
+  sqlite3_bind_int(selectStmt, 2, edits[0].chunkZ);
+
+  EditsCursor cursor;
+  if(sqlite3_step(selectStmt) == SQLITE_ROW)
+    EditsCursorInit(&cursor, (const uint8_t*)sqlite3_column_blob(selectStmt, 0), sqlite3_column_bytes(selectStmt, 0));
+  else
+    EditsCursorInit(&cursor, NULL, 0);
+
+  const int32_t maxCount = (int32_t)MIN(cursor.remaining, BLOCKS_MEMORY_SIZE) + count;
+  uint8_t* memory = (uint8_t*)OwnMalloc((size_t)maxCount * (sizeof(uint32_t) + 1) + EditsMaxSize(maxCount), false);
+
+  if(memory == NULL)
+  {
+    LogError("Variable \"memory\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    sqlite3_reset(selectStmt);
+
+    return;
+  }
+
+  uint32_t* positions = (uint32_t*)memory;
+  uint8_t* blocks = memory + (size_t)maxCount * sizeof(uint32_t);
+  uint8_t* encoded = blocks + maxCount;
+
+  uint32_t oldPosition;
+  uint8_t oldBlock;
+  bool hasOld = EditsCursorNext(&cursor, &oldPosition, &oldBlock);
+  int32_t merged = 0;
+
+  for(int32_t i = 0; i < count || hasOld;)
+  {
+    if(i < count && (!hasOld || edits[i].position <= oldPosition))
+    {
+      //Only the latest edit of a block is kept; it replaces the stored one.
+      while(i + 1 < count && edits[i + 1].position == edits[i].position)
+        ++i;
+
+      if(hasOld && oldPosition == edits[i].position)
+        hasOld = EditsCursorNext(&cursor, &oldPosition, &oldBlock);
+
+      positions[merged] = edits[i].position;
+      blocks[merged++] = edits[i++].block;
+    }
+    else
+    {
+      positions[merged] = oldPosition;
+      blocks[merged++] = oldBlock;
+      hasOld = EditsCursorNext(&cursor, &oldPosition, &oldBlock);
+    }
+  }
+
+  if(cursor.damaged)
+    LogWarning("The stored edits of chunk (%d, %d) are damaged; only %d of them are kept.", true, edits[0].chunkX, edits[0].chunkZ, merged - count);
+
+  sqlite3_reset(selectStmt);
+
+  const size_t size = EncodeEdits(positions, blocks, merged, encoded);
+
+  sqlite3_reset(insertStmt);
+  sqlite3_bind_int(insertStmt, 1, edits[0].chunkX);
+  sqlite3_bind_int(insertStmt, 2, edits[0].chunkZ);
+  sqlite3_bind_blob(insertStmt, 3, encoded, (int32_t)size, SQLITE_STATIC);
+  sqlite3_step(insertStmt);
+  sqlite3_clear_bindings(insertStmt);
+
+  DatabaseMarkChunkChanged(edits[0].chunkX, edits[0].chunkZ);
+
+  free(memory);
+}
+
+//Within a transaction; sorts "edits".
+static void DatabaseStoreEdits(PendingEdit* edits, int32_t count, sqlite3_stmt* selectStmt, sqlite3_stmt* insertStmt)
+{
+  qsort(edits, count, sizeof(PendingEdit), ComparePendingEdits);
+
+  for(int32_t i = 0; i < count;)
+  {
+    int32_t chunkCount = 1;
+    while(i + chunkCount < count && edits[i + chunkCount].chunkX == edits[i].chunkX && edits[i + chunkCount].chunkZ == edits[i].chunkZ)
+      ++chunkCount;
+
+    DatabaseMergeChunkEdits(&edits[i], chunkCount, selectStmt, insertStmt);
+    i += chunkCount;
+  }
+}
+
+//Moves the edits of the "Blocks" table of maps from before "ChunkEdits" (one row per block) over, once.
+static void DatabaseMigrateBlocks()
+{
+  sqlite3_stmt* stmt = DatabaseCompileStatement("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'Blocks'");
+  const bool hasBlocks = sqlite3_step(stmt) == SQLITE_ROW;
+  sqlite3_finalize(stmt);
+
+  if(!hasBlocks)
+    return;
+
+  //Positions depend on the chunk dimensions; a map made for others is refused later on anyway.
+  stmt = DatabaseCompileStatement("SELECT chunkWidth, chunkHeight FROM MapInfo");
+  const bool otherDimensions = sqlite3_step(stmt) == SQLITE_ROW && (sqlite3_column_int(stmt, 0) != CHUNK_WIDTH || sqlite3_column_int(stmt, 1) != CHUNK_HEIGHT);
+  sqlite3_finalize(stmt);
+
+  if(otherDimensions)
+    return;
+
+  const double start = TimeMeasurementNow();
+
+  int32_t capacity = 65536;
+  int32_t count = 0;
+  PendingEdit* edits = (PendingEdit*)OwnMalloc(capacity * sizeof(PendingEdit), false);
+
+  stmt = DatabaseCompileStatement("SELECT chunkX, chunkZ, x, y, z, type FROM Blocks");
+  while(edits != NULL && sqlite3_step(stmt) == SQLITE_ROW)
+  {
+    if(count == capacity)
+    {
+      capacity *= 2;
+      PendingEdit* grown = (PendingEdit*)realloc(edits, capacity * sizeof(PendingEdit));
+
+      if(grown == NULL)
+        free(edits);
+      edits = grown;
+
+      if(edits == NULL)
+        break;
+    }
+
+    edits[count] = (PendingEdit){sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1),
+                                 (uint32_t)XYZ(sqlite3_column_int(stmt, 2), sqlite3_column_int(stmt, 3), sqlite3_column_int(stmt, 4)), count,
+                                 (uint8_t)sqlite3_column_int(stmt, 5)};
+    ++count;
+  }
+  sqlite3_finalize(stmt);
+
+  if(edits == NULL)
+  {
+    LogError("Variable \"edits\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return;
+  }
+
+  sqlite3_stmt* selectStmt = DatabaseCompileStatement("SELECT edits FROM ChunkEdits WHERE chunkX = ? AND chunkZ = ?");
+  sqlite3_stmt* insertStmt = DatabaseCompileStatement("INSERT OR REPLACE INTO ChunkEdits (chunkX, chunkZ, edits) VALUES (?, ?, ?)");
+
+  //All or nothing: the old table only goes along with the new rows being committed.
+  DatabaseCompileRunStatement("BEGIN TRANSACTION");
+  DatabaseStoreEdits(edits, count, selectStmt, insertStmt);
+  DatabaseCompileRunStatement("DROP TABLE Blocks");
+  DatabaseCompileRunStatement("COMMIT");
+
+  sqlite3_finalize(selectStmt);
+  sqlite3_finalize(insertStmt);
+  free(edits);
+
+  //Returns the pages of the old table to the file system.
+  DatabaseCompileRunStatement("VACUUM");
+
+  LogSuccess("%d block edits were moved from \"Blocks\" to \"ChunkEdits\" in %.1f ms.", true, count, (TimeMeasurementNow() - start) * 1000.0);
+}
+
+static int32_t EditedChunkHomeSlot(int32_t chunkX, int32_t chunkZ, int32_t capacity)
+{
+  const uint64_t key = (uint64_t)(uint32_t)chunkX << 32 | (uint32_t)chunkZ;
+
+  return (int32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity - 1);
+}
+
+//Slot of the chunk or the unused slot it belongs into; "sEditedChunksMtx" has to be held.
+static int32_t FindEditedChunkSlot(const EditedChunk* slots, int32_t capacity, int32_t chunkX, int32_t chunkZ)
+{
+  int32_t slot = EditedChunkHomeSlot(chunkX, chunkZ, capacity);
+  while(slots[slot].used && (slots[slot].chunkX != chunkX || slots[slot].chunkZ != chunkZ))
+    slot = (slot + 1) & (capacity - 1);
+
+  return slot;
+}
+
+static bool ResizeEditedChunks(int32_t capacity)
+{
+  EditedChunk* slots = (EditedChunk*)OwnMalloc(capacity * sizeof(EditedChunk), false);
+
+  if(slots == NULL)
+  {
+    LogError("Variable \"slots\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return false;
+  }
+
+  for(int32_t i = 0; i < capacity; ++i)
+    slots[i].used = false;
+
+  for(int32_t i = 0; i < sEditedChunksCapacity; ++i)
+  {
+    if(sEditedChunks[i].used)
+      slots[FindEditedChunkSlot(slots, capacity, sEditedChunks[i].chunkX, sEditedChunks[i].chunkZ)] = sEditedChunks[i];
+  }
+
+  free(sEditedChunks);
+  sEditedChunks = slots;
+  sEditedChunksCapacity = capacity;
+
+  return true;
+}
+
+//"sEditedChunksMtx" has to be held.
+static void AddEditedChunk(int32_t chunkX, int32_t chunkZ)
+{
+  int32_t slot = FindEditedChunkSlot(sEditedChunks, sEditedChunksCapacity, chunkX, chunkZ);
+  if(sEditedChunks[slot].used)
+    return;
+
+  if((sNumEditedChunks + 1) * 2 > sEditedChunksCapacity)
+  {
+    if(!ResizeEditedChunks(sEditedChunksCapacity * 2))
+      return;
+
+    slot = FindEditedChunkSlot(sEditedChunks, sEditedChunksCapacity, chunkX, chunkZ);
+  }
+
+  sEditedChunks[slot] = (EditedChunk){chunkX, chunkZ, true};
+  ++sNumEditedChunks;
+}
+
+/* Entries behind the removed one are moved up into the gap, unless that would put them before their home slot, so no
+ * lookup stops short of them; "sEditedChunksMtx" has to be held. */
+static void RemoveEditedChunk(int32_t chunkX, int32_t chunkZ)
+{
+  const int32_t mask = sEditedChunksCapacity - 1;
+
+  int32_t gap = FindEditedChunkSlot(sEditedChunks, sEditedChunksCapacity, chunkX, chunkZ);
+  if(!sEditedChunks[gap].used)
+    return;
+
+  for(int32_t slot = (gap + 1) & mask; sEditedChunks[slot].used; slot = (slot + 1) & mask)
+  {
+    const int32_t home = EditedChunkHomeSlot(sEditedChunks[slot].chunkX, sEditedChunks[slot].chunkZ, sEditedChunksCapacity);
+    if(((slot - home) & mask) < ((slot - gap) & mask))
+      continue;
+
+    sEditedChunks[gap] = sEditedChunks[slot];
+    gap = slot;
+  }
+
+  sEditedChunks[gap].used = false;
+  --sNumEditedChunks;
+}
+
+static void DatabaseLoadEditedChunks()
+{
+  const double start = TimeMeasurementNow();
+
+  sEditedChunks = NULL;
+  sEditedChunksCapacity = 0;
+  sNumEditedChunks = 0;
+
+  sqlite3_stmt* stmt = DatabaseCompileStatement("SELECT COUNT(*) FROM ChunkEdits");
+  sqlite3_step(stmt);
+  const int32_t count = sqlite3_column_int(stmt, 0);
+  sqlite3_finalize(stmt);
+
+  int32_t capacity = EDITED_CHUNKS_MIN_CAPACITY;
+  while(capacity < count * 2)
+    capacity *= 2;
+
+  if(!ResizeEditedChunks(capacity))
+    exit(EXIT_FAILURE);
+
+  stmt = DatabaseCompileStatement("SELECT chunkX, chunkZ FROM ChunkEdits");
+  mtx_lock(&sEditedChunksMtx);
+  while(sqlite3_step(stmt) == SQLITE_ROW)
+    AddEditedChunk(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1));
+  mtx_unlock(&sEditedChunksMtx);
+  sqlite3_finalize(stmt);
+
+  if(sNumEditedChunks > 0)
+    LogInfo("%d edited chunks were indexed in %.1f ms (%.1f KB).", true, sNumEditedChunks, (TimeMeasurementNow() - start) * 1000.0,
+            sEditedChunksCapacity * sizeof(EditedChunk) / 1024.0);
+}
+
+static void WaitForWriterWork(double seconds)
+{
+  struct timespec until;
+  timespec_get(&until, TIME_UTC);
+
+  const int64_t ns = until.tv_nsec + (int64_t)(seconds * 1e9);
+  until.tv_sec += (time_t)(ns / 1000000000);
+  until.tv_nsec = (long)(ns % 1000000000);
+
+  mtx_lock(&sWriterMtx);
+  if(sFlushWaiters == 0 && !sWriterStop)
+    cnd_timedwait(&sWriterCondVar, &sWriterMtx, &until);
+  mtx_unlock(&sWriterMtx);
+}
+
+/* The statements are shared by the main and the writer thread, hence they are only used within a transaction (or with
+ * "sTransactionMtx" held otherwise). */
+static void DatabaseStorePlayerInfo(const SaveState* state)
+{
+  static sqlite3_stmt* updateStmt = NULL;
+  static sqlite3_stmt* insertStmt = NULL;
+
+  if(updateStmt == NULL)
+  {
+    DatabaseCacheStatement(&updateStmt, "UPDATE PlayerInfo SET posX = ?, posY = ?, posZ = ?, pitch = ?, yaw = ?, buildBlock = ?");
+    DatabaseCacheStatement(&insertStmt, "INSERT INTO PlayerInfo (posX, posY, posZ, pitch, yaw, buildBlock) VALUES (?, ?, ?, ?, ?, ?)");
+  }
+
+  sqlite3_stmt* stmt = sHasPlayerInfo ? updateStmt : insertStmt;
+
+  sqlite3_reset(stmt);
+
+  sqlite3_bind_double(stmt, 1, state->pos[0]);
+  sqlite3_bind_double(stmt, 2, state->pos[1]);
+  sqlite3_bind_double(stmt, 3, state->pos[2]);
+  sqlite3_bind_double(stmt, 4, state->pitch);
+  sqlite3_bind_double(stmt, 5, state->yaw);
+  sqlite3_bind_int(stmt, 6, state->buildBlock);
+
+  sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+
+  sHasPlayerInfo = true;
+}
+
+static void DatabaseStoreMapInfo(const SaveState* state)
+{
+  static sqlite3_stmt* updateStmt = NULL;
+  static sqlite3_stmt* insertStmt = NULL;
+
+  if(updateStmt == NULL)
+  {
+    DatabaseCacheStatement(&updateStmt, "UPDATE MapInfo SET currTime = ?");
+    DatabaseCacheStatement(&insertStmt, "INSERT INTO MapInfo (seed, currTime, chunkWidth, chunkHeight) VALUES (?, ?, ?, ?)");
+  }
+
+  sqlite3_stmt* stmt = sHasMapInfo ? updateStmt : insertStmt;
+
+  sqlite3_reset(stmt);
+
+  if(sHasMapInfo)
+    sqlite3_bind_double(stmt, 1, state->time);
+  else
+  {
+    sqlite3_bind_int(stmt, 1, MapGetSeed());
+    sqlite3_bind_double(stmt, 2, state->time);
+    sqlite3_bind_int(stmt, 3, CHUNK_WIDTH);
+    sqlite3_bind_int(stmt, 4, CHUNK_HEIGHT);
+  }
+
+  sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+
+  sHasMapInfo = true;
+}
+
+static void CopyPlayerInfo(const Player* p, SaveState* state)
+{
+  state->hasPlayer = true;
+  for(int32_t i = 0; i < 3; ++i)
+    state->pos[i] = p->pos[i];
+  state->pitch = p->pitch;
+  state->yaw = p->yaw;
+  state->buildBlock = p->buildBlock;
+}
+
+static int32_t DatabaseWriterLoop(void* arg)
+{
+  (void)arg;
+
+  sqlite3_stmt* selectStmt = DatabaseCompileStatement("SELECT edits FROM ChunkEdits WHERE chunkX = ? AND chunkZ = ?");
+  sqlite3_stmt* insertStmt = DatabaseCompileStatement("INSERT OR REPLACE INTO ChunkEdits (chunkX, chunkZ, edits) VALUES (?, ?, ?)");
+
+  PendingEdit* batch = (PendingEdit*)OwnMalloc(WRITER_BATCH_SIZE * sizeof(PendingEdit), false);
+
+  if(batch == NULL)
+  {
+    LogError("Variable \"batch\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    exit(EXIT_FAILURE);
+  }
+
+  double batchStart = 0.0;
+  int32_t batchEdits = 0;
+
+  while(true)
+  {
+    const int64_t head = AtomicLoadAcquire(&sEditHead);
+    int64_t tail = sEditTail;
+
+    for(; tail < head && batchEdits < WRITER_BATCH_SIZE; ++tail)
+    {
+      if(batchEdits == 0)
+        batchStart = TimeMeasurementNow();
+
+      const BlockEdit* edit = &sEditQueue[tail & (EDIT_QUEUE_SIZE - 1)];
+      batch[batchEdits] = (PendingEdit){edit->chunkX, edit->chunkZ, (uint32_t)XYZ(edit->x, edit->y, edit->z), batchEdits, edit->block};
+      ++batchEdits;
+
+      //Frees the slot for the pushing thread.
+      AtomicStoreRelease(&sEditTail, tail + 1);
+    }
+
+    mtx_lock(&sWriterMtx);
+    const bool flush = sFlushWaiters > 0;
+    const bool stop = sWriterStop;
+    const int64_t saves = sSavesRequested;
+    const SaveState save = sPendingSave;
+    mtx_unlock(&sWriterMtx);
+
+    const bool drained = tail == AtomicLoadAcquire(&sEditHead);
+    const bool savePending = saves > sSavesStored;
+
+    const bool commitEdits = batchEdits > 0 && (batchEdits >= WRITER_BATCH_SIZE || TimeMeasurementNow() - batchStart >= WRITER_BATCH_TIME ||
+                                                ((flush || stop || savePending) && drained));
+
+    //A save goes into the same transaction as the edits queued before it, so a crash never keeps one without the other.
+    const bool commitSave = savePending && tail >= save.editHead && (commitEdits || batchEdits == 0);
+
+    if(commitEdits || commitSave)
+    {
+      mtx_lock(&sTransactionMtx);
+      DatabaseCompileRunStatement("BEGIN TRANSACTION");
+      if(commitEdits)
+        DatabaseStoreEdits(batch, batchEdits, selectStmt, insertStmt);
+      if(commitSave)
+      {
+        if(save.hasPlayer)
+          DatabaseStorePlayerInfo(&save);
+        DatabaseStoreMapInfo(&save);
+      }
+      DatabaseCompileRunStatement("COMMIT");
+      mtx_unlock(&sTransactionMtx);
+
+      mtx_lock(&sWriterMtx);
+      if(commitEdits)
+        AtomicStoreRelease(&sEditCommitted, tail);
+      if(commitSave)
+        AtomicStoreRelease(&sSavesStored, saves);
+      ++sWriterTransactions;
+      mtx_unlock(&sWriterMtx);
+      cnd_broadcast(&sFlushedCondVar);
+
+      if(commitEdits)
+        batchEdits = 0;
+    }
+
+    if(stop && drained && batchEdits == 0 && !savePending)
+      break;
+
+    if(drained)
+      WaitForWriterWork(batchEdits > 0 ? MAX(0.0, MIN(WRITER_IDLE_WAIT, WRITER_BATCH_TIME - (TimeMeasurementNow() - batchStart))) : WRITER_IDLE_WAIT);
+  }
+
+  free(batch);
+  sqlite3_finalize(selectStmt);
+  sqlite3_finalize(insertStmt);
+
+  return 0;
+}
+
+static void DatabaseCloseReader(Reader* reader)
+{
+  sqlite3_finalize(reader->blocksStmt);
+  sqlite3_finalize(reader->chunkStmt);
+  reader->blocksStmt = NULL;
+  reader->chunkStmt = NULL;
+
+  if(reader->connection != db)
+    sqlite3_close(reader->connection);
+  reader->connection = NULL;
+}
+
+//Called on the exit of a thread which has read.
+static void DatabaseReleaseReader(void* data)
 {
-  sqlite3_stmt* stmt;
-  sqlite3_prepare_v2(db, statement, -1, &stmt, NULL);
-  if(stmt == NULL)
-    LogError("SQLite (SQL database engine) reports an error during statement compiling.\nThe used statement was: %s.\nThe resulting error is: %s.", true, statement, sqlite3_errmsg(db));
+  Reader* reader = (Reader*)data;
 
-  return stmt;
+  mtx_lock(&sReadersMtx);
+  if(reader->connection != NULL)
+  {
+    if(reader->prev != NULL)
+      reader->prev->next = reader->next;
+    else
+      sReaders = reader->next;
+    if(reader->next != NULL)
+      reader->next->prev = reader->prev;
+
+    DatabaseCloseReader(reader);
+  }
+  mtx_unlock(&sReadersMtx);
+
+  free(reader);
 }
 
-static void DatabaseCompileRunStatement(const char* statement)
+static void DatabaseInitReaders()
 {
-  sqlite3_stmt* stmt = DatabaseCompileStatement(statement);
-
-  sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  mtx_init(&sReadersMtx, mtx_plain);
+  tss_create(&sReaderKey, DatabaseReleaseReader);
 }
 
-static bool DatabaseIsTableEmpty(const char* table)
+//The reader of the calling thread, connected on first use.
+static Reader* DatabaseGetReader()
 {
-  char query[512];
-  snprintf(query, sizeof(query), "SELECT COUNT(*) FROM %s", table);
+  if(tReader != NULL && tReader->connection != NULL)
+    return tReader;
 
-  sqlite3_stmt* stmt = DatabaseCompileStatement(query);
+  call_once(&sReadersInitFlag, DatabaseInitReaders);
 
-  sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
-  sqlite3_step(stmt);
+  if(tReader == NULL)
+  {
+    tReader = (Reader*)OwnMalloc(sizeof(Reader), false);
 
-  int32_t rowCount = sqlite3_column_int(stmt, 0);
+    if(tReader == NULL)
+    {
+      LogError("Variable \"tReader\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
 
-  sqlite3_finalize(stmt);
+      exit(EXIT_FAILURE);
+    }
 
-  return rowCount == 0;
-}
+    memset(tReader, 0, sizeof(Reader));
+    tss_set(sReaderKey, tReader);
+  }
 
-static void DatabaseCreateTables()
-{
-  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS Blocks(chunkX INTEGER NOT NULL, chunkZ INTEGER NOT NULL, x INTEGER NOT NULL, "
-                              "y INTEGER NOT NULL, z INTEGER NOT NULL, type INTEGER NOT NULL, PRIMARY KEY(chunkX, chunkZ, x, y, z))");
+  mtx_lock(&sReadersMtx);
 
-  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS MapInfo(seed INTEGER NOT NULL, currTime REAL NOT NULL, chunkWidth INTEGER NOT NULL, chunkHeight INTEGER NOT NULL)");
+  //Linked in only while connected, so "DatabaseFree()" finds every open connection.
+  tReader->prev = NULL;
+  tReader->next = sReaders;
+  if(sReaders != NULL)
+    sReaders->prev = tReader;
+  sReaders = tReader;
 
-  DatabaseCompileRunStatement("CREATE TABLE IF NOT EXISTS PlayerInfo(posX REAL NOT NULL, posY REAL NOT NULL, posZ REAL NOT NULL, pitch REAL NOT NULL, yaw REAL NOT NULL, buildBlock INTEGER NOT NULL)");
+  if(sSharedReads)
+    tReader->connection = db;
+  else if(sqlite3_open_v2(sDbPath, &tReader->connection, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK)
+  {
+    LogError("There was a problem trying to open database file: %s.\nSignaled SQLite-error: %s", true, sDbPath, sqlite3_errmsg(tReader->connection));
 
-  if(!strcmp(sqlite3_errmsg(db), "not an error"))
-    LogSuccess("Database tables \"Blocks\", \"MapInfo\" and \"PlayerInfo\" were successfully created.", true);
+    exit(EXIT_FAILURE);
+  }
+  else
+    sqlite3_busy_timeout(tReader->connection, 1000); //Only while the writer checkpoints or a connection recovers the journal
 
-  if(!DatabaseIsTableEmpty("MapInfo"))
-    sHasMapInfo = true;
+  tReader->blocksStmt = DatabaseCompileStatementFor(tReader->connection, "SELECT edits FROM ChunkEdits WHERE chunkX = ? AND chunkZ = ?");
+  tReader->chunkStmt = DatabaseCompileStatementFor(tReader->connection, "SELECT blocks FROM Chunks WHERE chunkX = ? AND chunkZ = ? AND generatorVersion = ?");
 
-  if(!DatabaseIsTableEmpty("PlayerInfo"))
-    sHasPlayerInfo = true;
+  mtx_unlock(&sReadersMtx);
+
+  return tReader;
 }
 
 void DatabaseInit(const char* dbPath)
@@ -82,70 +986,509 @@ void DatabaseInit(const char* dbPath)
   }
 
   DatabaseCreateTables();
+  snprintf(sDbPath, sizeof(sDbPath), "%s", dbPath);
+  sSharedReads = strcmp(dbPath, ":memory:") == 0;
+  call_once(&sReadersInitFlag, DatabaseInitReaders);
+  mtx_init(&sChunkStmtMtx, mtx_plain);
+  mtx_init(&sTransactionMtx, mtx_plain);
+  mtx_init(&sCachedStmtsMtx, mtx_plain);
+  mtx_init(&sEditedChunksMtx, mtx_plain);
 
   //Optimizations to significantly expedite the database:
-  DatabaseCompileRunStatement("PRAGMA synchronous = off");
   DatabaseCompileRunStatement("PRAGMA temp_store = memory");
-  DatabaseCompileRunStatement("PRAGMA locking_mode = exclusive");
+
+  /* Readers see the last commit while the writer appends to the journal, instead of waiting for it. With the WAL journal,
+   * "synchronous = normal" only syncs on checkpoints: a crash may lose the last commits, but cannot corrupt the map. */
+  if(!sSharedReads)
+  {
+    DatabaseCompileRunStatement("PRAGMA journal_mode = wal");
+    DatabaseCompileRunStatement("PRAGMA synchronous = normal");
+  }
+
+  DatabaseMigrateBlocks();
+  DatabaseLoadEditedChunks();
+
+  sEditHead = 0;
+  sEditTail = 0;
+  sEditCommitted = 0;
+  sFlushWaiters = 0;
+  sWriterStop = false;
+  sWriterTransactions = 0;
+  sSavesRequested = 0;
+  sSavesStored = 0;
+
+  mtx_init(&sWriterMtx, mtx_plain);
+  cnd_init(&sWriterCondVar);
+  cnd_init(&sFlushedCondVar);
+  thrd_create(&sWriterThread, DatabaseWriterLoop, NULL);
 }
 
 void DatabaseInsertBlock(int32_t chunkX, int32_t chunkZ, int32_t x, int32_t y, int32_t z, int32_t block)
 {
-  static sqlite3_stmt* stmt = NULL;
-  if(stmt == NULL)
-    stmt = DatabaseCompileStatement("INSERT OR REPLACE INTO Blocks (chunkX, chunkZ, x, y, z, type) VALUES (?, ?, ?, ?, ?, ?)");
+  const int64_t head = sEditHead;
+
+  //Only if the writer is far behind (e.g. a huge scripted edit) does the pushing thread have to wait.
+  while(head - AtomicLoadAcquire(&sEditTail) >= EDIT_QUEUE_SIZE)
+    thrd_yield();
+
+  /* The chunk is added before the edit is queued, so that a lookup which finds it queued also knows about the chunk, and
+   * both happen under the lock, so that compaction never takes out a chunk whose edit is just being queued. */
+  mtx_lock(&sEditedChunksMtx);
+  AddEditedChunk(chunkX, chunkZ);
+
+  BlockEdit* edit = &sEditQueue[head & (EDIT_QUEUE_SIZE - 1)];
+  edit->chunkX = chunkX;
+  edit->chunkZ = chunkZ;
+  edit->x = (int16_t)x;
+  edit->y = (int16_t)y;
+  edit->z = (int16_t)z;
+  edit->block = (uint8_t)block;
+
+  AtomicStoreRelease(&sEditHead, head + 1);
+  mtx_unlock(&sEditedChunksMtx);
+}
+
+void DatabaseSaveAsync(const Player* p)
+{
+  SaveState state = {.hasPlayer = false, .time = MapGetTime(), .editHead = sEditHead};
+  if(p != NULL)
+    CopyPlayerInfo(p, &state);
+
+  mtx_lock(&sWriterMtx);
+  sPendingSave = state;
+  AtomicStoreRelease(&sSavesRequested, sSavesRequested + 1);
+  mtx_unlock(&sWriterMtx);
+  cnd_signal(&sWriterCondVar);
+}
+
+void DatabaseFlush()
+{
+  const int64_t head = AtomicLoadAcquire(&sEditHead);
+  const int64_t saves = AtomicLoadAcquire(&sSavesRequested);
+
+  if(AtomicLoadAcquire(&sEditCommitted) >= head && AtomicLoadAcquire(&sSavesStored) >= saves)
+    return;
+
+  mtx_lock(&sWriterMtx);
+  ++sFlushWaiters;
+  cnd_signal(&sWriterCondVar);
+
+  while(AtomicLoadAcquire(&sEditCommitted) < head || AtomicLoadAcquire(&sSavesStored) < saves)
+    cnd_wait(&sFlushedCondVar, &sWriterMtx);
+
+  --sFlushWaiters;
+  mtx_unlock(&sWriterMtx);
+}
+
+void DatabaseGetWriterStats(int64_t* edits, int64_t* transactions)
+{
+  mtx_lock(&sWriterMtx);
+  *edits = AtomicLoadAcquire(&sEditCommitted);
+  *transactions = sWriterTransactions;
+  mtx_unlock(&sWriterMtx);
+}
+
+bool DatabaseChunkHasEdits(int32_t chunkX, int32_t chunkZ)
+{
+  mtx_lock(&sEditedChunksMtx);
+  const bool edited = sEditedChunks[FindEditedChunkSlot(sEditedChunks, sEditedChunksCapacity, chunkX, chunkZ)].used;
+  mtx_unlock(&sEditedChunksMtx);
+
+  return edited;
+}
+
+void DatabaseGetBlocksForChunk(Chunk* c)
+{
+  //Neither the flush nor the lookup would find anything.
+  if(!DatabaseChunkHasEdits(c->x, c->z))
+    return;
+
+  /* Edits made before the chunk was requested have to be committed first, as the reader only sees committed rows.
+   * Within a transaction of this thread the writer cannot commit anything; the edits queued before it were committed
+   * by "DatabaseBeginTransaction()". */
+  if(!tInTransaction)
+    DatabaseFlush();
+
+  sqlite3_stmt* stmt = DatabaseGetReader()->blocksStmt;
+
+  sqlite3_reset(stmt);
+
+  sqlite3_bind_int(stmt, 1, c->x);
+  sqlite3_bind_int(stmt, 2, c->z);
+
+  if(sqlite3_step(stmt) == SQLITE_ROW)
+  {
+    EditsCursor cursor;
+    EditsCursorInit(&cursor, (const uint8_t*)sqlite3_column_blob(stmt, 0), sqlite3_column_bytes(stmt, 0));
+
+    uint32_t position;
+    uint8_t block;
+    while(EditsCursorNext(&cursor, &position, &block))
+      c->blocks[position] = block; //"Chunk->blocks" is an "uint8_t*" as it is a data container (sequence of unsigned byte/octet values).
+
+    if(cursor.damaged)
+      LogWarning("The stored edits of chunk (%d, %d) are damaged, so some of them are missing.", true, c->x, c->z);
+  }
+
+  sqlite3_reset(stmt);
+}
+
+uint64_t DatabaseGetChunkEditsVersion(int32_t chunkX, int32_t chunkZ)
+{
+  if(!DatabaseChunkHasEdits(chunkX, chunkZ))
+    return 0;
+
+  if(!tInTransaction)
+    DatabaseFlush();
+
+  sqlite3_stmt* stmt = DatabaseGetReader()->blocksStmt;
 
   sqlite3_reset(stmt);
 
   sqlite3_bind_int(stmt, 1, chunkX);
   sqlite3_bind_int(stmt, 2, chunkZ);
-  sqlite3_bind_int(stmt, 3, x);
-  sqlite3_bind_int(stmt, 4, y);
-  sqlite3_bind_int(stmt, 5, z);
-  sqlite3_bind_int(stmt, 6, block);
 
+  //FNV-1a of the stored blob, which is written anew with every change of the edits.
+  uint64_t version = 0;
+  if(sqlite3_step(stmt) == SQLITE_ROW)
+  {
+    const uint8_t* edits = (const uint8_t*)sqlite3_column_blob(stmt, 0);
+    const int32_t size = sqlite3_column_bytes(stmt, 0);
+
+    version = 14695981039346656037ULL;
+    for(int32_t i = 0; i < size; ++i)
+    {
+      version ^= edits[i];
+      version *= 1099511628211ULL;
+    }
+
+    version += version == 0; //"0" stands for no edits.
+  }
+
+  sqlite3_reset(stmt);
+
+  return version;
+}
+
+int32_t DatabaseGetEditedChunks(int32_t** coords)
+{
+  mtx_lock(&sEditedChunksMtx);
+
+  *coords = (int32_t*)OwnMalloc(MAX(1, sNumEditedChunks) * 2 * sizeof(int32_t), false);
+
+  if(*coords == NULL)
+  {
+    mtx_unlock(&sEditedChunksMtx);
+    LogError("Variable \"*coords\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return 0;
+  }
+
+  int32_t count = 0;
+  for(int32_t i = 0; i < sEditedChunksCapacity; ++i)
+  {
+    if(!sEditedChunks[i].used)
+      continue;
+
+    (*coords)[count * 2] = sEditedChunks[i].chunkX;
+    (*coords)[count * 2 + 1] = sEditedChunks[i].chunkZ;
+    ++count;
+  }
+
+  mtx_unlock(&sEditedChunksMtx);
+
+  return count;
+}
+
+int32_t DatabaseCompactChunkEdits(int32_t chunkX, int32_t chunkZ, const uint8_t* terrain, int32_t* remaining)
+{
+  static sqlite3_stmt* selectStmt = NULL;
+  static sqlite3_stmt* insertStmt = NULL;
+  static sqlite3_stmt* deleteStmt = NULL;
+
+  *remaining = 0;
+
+  //The edits are read and rewritten in one transaction, so that the writer cannot commit others in between.
+  DatabaseBeginTransaction();
+
+  if(selectStmt == NULL)
+  {
+    DatabaseCacheStatement(&selectStmt, "SELECT edits FROM ChunkEdits WHERE chunkX = ? AND chunkZ = ?");
+    DatabaseCacheStatement(&insertStmt, "INSERT OR REPLACE INTO ChunkEdits (chunkX, chunkZ, edits) VALUES (?, ?, ?)");
+    DatabaseCacheStatement(&deleteStmt, "DELETE FROM ChunkEdits WHERE chunkX = ? AND chunkZ = ?");
+  }
+
+  sqlite3_reset(selectStmt);
+  sqlite3_bind_int(selectStmt, 1, chunkX);
+  sqlite3_bind_int(selectStmt, 2, chunkZ);
+
+  if(sqlite3_step(selectStmt) != SQLITE_ROW)
+  {
+    sqlite3_reset(selectStmt);
+    DatabaseCommitTransaction();
+
+    return 0;
+  }
+
+  EditsCursor cursor;
+  EditsCursorInit(&cursor, (const uint8_t*)sqlite3_column_blob(selectStmt, 0), sqlite3_column_bytes(selectStmt, 0));
+
+  const int32_t maxCount = (int32_t)MIN(cursor.remaining, BLOCKS_MEMORY_SIZE);
+  uint8_t* memory = (uint8_t*)OwnMalloc((size_t)maxCount * (sizeof(uint32_t) + 1) + EditsMaxSize(maxCount), false);
+
+  if(memory == NULL)
+  {
+    LogError("Variable \"memory\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    sqlite3_reset(selectStmt);
+    DatabaseCommitTransaction();
+
+    return 0;
+  }
+
+  uint32_t* positions = (uint32_t*)memory;
+  uint8_t* blocks = memory + (size_t)maxCount * sizeof(uint32_t);
+  uint8_t* encoded = blocks + maxCount;
+
+  int32_t count = 0;
+  int32_t kept = 0;
+
+  uint32_t position;
+  uint8_t block;
+  while(count < maxCount && EditsCursorNext(&cursor, &position, &block))
+  {
+    ++count;
+
+    //An edit which restates the terrain changes nothing.
+    if(block == terrain[position])
+      continue;
+
+    positions[kept] = position;
+    blocks[kept++] = block;
+  }
+
+  const bool damaged = cursor.damaged;
+  sqlite3_reset(selectStmt);
+
+  //Damaged edits are left as they are; rewriting them would lose the ones behind the damage for good.
+  if(!damaged && kept < count)
+  {
+    sqlite3_stmt* stmt = kept == 0 ? deleteStmt : insertStmt;
+
+    sqlite3_reset(stmt);
+    sqlite3_bind_int(stmt, 1, chunkX);
+    sqlite3_bind_int(stmt, 2, chunkZ);
+    if(kept > 0)
+      sqlite3_bind_blob(stmt, 3, encoded, (int32_t)EncodeEdits(positions, blocks, kept, encoded), SQLITE_STATIC);
+
+    sqlite3_step(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    DatabaseMarkChunkChanged(chunkX, chunkZ);
+
+    /* Without edits left, the chunk is taken out of the set, unless an edit is still queued: the queue is not searched,
+     * and an edit of this very chunk would bring the row back. New edits cannot be queued while the lock is held. */
+    if(kept == 0)
+    {
+      mtx_lock(&sEditedChunksMtx);
+      if(AtomicLoadAcquire(&sEditCommitted) == AtomicLoadAcquire(&sEditHead))
+        RemoveEditedChunk(chunkX, chunkZ);
+      mtx_unlock(&sEditedChunksMtx);
+    }
+  }
+
+  DatabaseCommitTransaction();
+  free(memory);
+
+  if(damaged)
+  {
+    *remaining = count;
+
+    return 0;
+  }
+
+  *remaining = kept;
+
+  return count - kept;
+}
+
+void DatabaseFinishSnapshot(int32_t id, int64_t lastChange, int32_t chunks)
+{
+  DatabaseBeginTransaction();
+
+  sqlite3_stmt* stmt = DatabaseCompileStatement("INSERT OR REPLACE INTO Snapshots (id, time, chunks) VALUES (?, ?, ?)");
+  sqlite3_bind_int(stmt, 1, id);
+  sqlite3_bind_double(stmt, 2, (double)time(NULL));
+  sqlite3_bind_int(stmt, 3, chunks);
+  sqlite3_step(stmt);
+  sqlite3_finalize(stmt);
+
+  //Chunks changed again since the snapshot began have a higher "change" and stay for the next one.
+  stmt = DatabaseCompileStatement("DELETE FROM ChangedChunks WHERE change <= ?");
+  sqlite3_bind_int64(stmt, 1, lastChange);
   sqlite3_step(stmt);
+  sqlite3_finalize(stmt);
+
+  DatabaseCommitTransaction();
 }
 
-void DatabaseGetBlocksForChunk(Chunk* c)
+void DatabaseVacuum()
+{
+  DatabaseFlush();
+
+  mtx_lock(&sTransactionMtx);
+  DatabaseCompileRunStatement("VACUUM");
+  mtx_unlock(&sTransactionMtx);
+}
+
+void DatabaseInsertChunk(const Chunk* c)
 {
   static sqlite3_stmt* stmt = NULL;
+
+  //The worst case (no two neighbouring blocks alike) doubles the size.
+  uint8_t* encoded = (uint8_t*)OwnMalloc(BLOCKS_MEMORY_SIZE * 2, false);
+
+  if(encoded == NULL)
+  {
+    LogError("Variable \"encoded\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return;
+  }
+
+  size_t size = ChunkStoreEncodeBlocks(c->blocks, encoded);
+
+  mtx_lock(&sChunkStmtMtx);
   if(stmt == NULL)
-    stmt = DatabaseCompileStatement("SELECT x, y, z, type FROM Blocks WHERE chunkX = ? AND chunkZ = ?");
+    DatabaseCacheStatement(&stmt, "INSERT OR REPLACE INTO Chunks (chunkX, chunkZ, blocks, generatorVersion) VALUES (?, ?, ?, ?)");
 
   sqlite3_reset(stmt);
 
   sqlite3_bind_int(stmt, 1, c->x);
   sqlite3_bind_int(stmt, 2, c->z);
+  sqlite3_bind_blob(stmt, 3, encoded, (int32_t)size, SQLITE_STATIC);
+  sqlite3_bind_int64(stmt, 4, sGeneratorVersion);
 
-  while(sqlite3_step(stmt) == SQLITE_ROW)
+  sqlite3_step(stmt);
+  sqlite3_clear_bindings(stmt);
+  mtx_unlock(&sChunkStmtMtx);
+
+  free(encoded);
+}
+
+bool DatabaseLoadChunk(Chunk* c)
+{
+  sqlite3_stmt* stmt = DatabaseGetReader()->chunkStmt;
+
+  sqlite3_reset(stmt);
+
+  sqlite3_bind_int(stmt, 1, c->x);
+  sqlite3_bind_int(stmt, 2, c->z);
+  sqlite3_bind_int64(stmt, 3, sGeneratorVersion);
+
+  bool loaded = false;
+  if(sqlite3_step(stmt) == SQLITE_ROW)
   {
-    int32_t x = sqlite3_column_int(stmt, 0);
-    int32_t y = sqlite3_column_int(stmt, 1);
-    int32_t z = sqlite3_column_int(stmt, 2);
-    int32_t block = sqlite3_column_int(stmt, 3);
+    loaded = ChunkStoreDecodeBlocks((const uint8_t*)sqlite3_column_blob(stmt, 0), sqlite3_column_bytes(stmt, 0), c->blocks);
 
-    c->blocks[XYZ(x, y, z)] = (uint8_t)block; //"Chunk->blocks" is an "uint8_t*" as it is a data container (sequence of unsigned byte/octet values).
+    if(!loaded)
+    {
+      memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+      LogWarning("The stored chunk (%d, %d) is damaged, so it is generated anew.", true, c->x, c->z);
+    }
   }
+
+  sqlite3_reset(stmt);
+
+  return loaded;
 }
 
-void DatabaseSavePlayerInfo(Player* p)
+bool DatabaseHasChunk(int32_t chunkX, int32_t chunkZ)
 {
-  sqlite3_stmt* stmt = NULL;
-  stmt = sHasPlayerInfo ? DatabaseCompileStatement("UPDATE PlayerInfo SET posX = ?, posY = ?, posZ = ?, pitch = ?, yaw = ?, buildBlock = ?")
-                        : DatabaseCompileStatement("INSERT INTO PlayerInfo (posX, posY, posZ, pitch, yaw, buildBlock) VALUES (?, ?, ?, ?, ?, ?)");
+  static sqlite3_stmt* stmt = NULL;
 
-  sqlite3_bind_double(stmt, 1, p->pos[0]);
-  sqlite3_bind_double(stmt, 2, p->pos[1]);
-  sqlite3_bind_double(stmt, 3, p->pos[2]);
-  sqlite3_bind_double(stmt, 4, p->pitch);
-  sqlite3_bind_double(stmt, 5, p->yaw);
-  sqlite3_bind_int(stmt, 6, p->buildBlock);
+  mtx_lock(&sChunkStmtMtx);
+  if(stmt == NULL)
+    DatabaseCacheStatement(&stmt, "SELECT 1 FROM Chunks WHERE chunkX = ? AND chunkZ = ? AND generatorVersion = ?");
+
+  sqlite3_reset(stmt);
+
+  sqlite3_bind_int(stmt, 1, chunkX);
+  sqlite3_bind_int(stmt, 2, chunkZ);
+  sqlite3_bind_int64(stmt, 3, sGeneratorVersion);
+
+  bool stored = sqlite3_step(stmt) == SQLITE_ROW;
+
+  sqlite3_reset(stmt);
+  mtx_unlock(&sChunkStmtMtx);
+
+  return stored;
+}
+
+void DatabaseSetGeneratorVersion(uint32_t version)
+{
+  sGeneratorVersion = version;
+}
+
+void DatabaseBeginTransaction()
+{
+  //Lookups within the transaction see no edit the writer has not committed, and it cannot commit any until the end.
+  DatabaseFlush();
+
+  mtx_lock(&sTransactionMtx);
+  tInTransaction = true;
+  DatabaseCompileRunStatement("BEGIN TRANSACTION");
+}
+
+void DatabaseCommitTransaction()
+{
+  DatabaseCompileRunStatement("COMMIT");
+  tInTransaction = false;
+  mtx_unlock(&sTransactionMtx);
+}
+
+int32_t DatabaseLoadPregenerationProgress(int32_t centerX, int32_t centerZ, int32_t radius)
+{
+  sqlite3_stmt* stmt = DatabaseCompileStatement("SELECT done FROM Pregeneration WHERE centerX = ? AND centerZ = ? AND radius = ?");
+
+  sqlite3_bind_int(stmt, 1, centerX);
+  sqlite3_bind_int(stmt, 2, centerZ);
+  sqlite3_bind_int(stmt, 3, radius);
+
+  int32_t done = 0;
+  if(sqlite3_step(stmt) == SQLITE_ROW)
+    done = sqlite3_column_int(stmt, 0);
 
-  sqlite3_step(stmt);
   sqlite3_finalize(stmt);
 
-  sHasPlayerInfo = true;
+  return done;
+}
+
+void DatabaseSavePregenerationProgress(int32_t centerX, int32_t centerZ, int32_t radius, int32_t done)
+{
+  static sqlite3_stmt* stmt = NULL;
+  if(stmt == NULL)
+    DatabaseCacheStatement(&stmt, "INSERT OR REPLACE INTO Pregeneration (centerX, centerZ, radius, done) VALUES (?, ?, ?, ?)");
+
+  sqlite3_reset(stmt);
+
+  sqlite3_bind_int(stmt, 1, centerX);
+  sqlite3_bind_int(stmt, 2, centerZ);
+  sqlite3_bind_int(stmt, 3, radius);
+  sqlite3_bind_int(stmt, 4, done);
+
+  sqlite3_step(stmt);
+}
+
+void DatabaseSavePlayerInfo(Player* p)
+{
+  SaveState state;
+  CopyPlayerInfo(p, &state);
+
+  if(!tInTransaction)
+    mtx_lock(&sTransactionMtx);
+  DatabaseStorePlayerInfo(&state);
+  if(!tInTransaction)
+    mtx_unlock(&sTransactionMtx);
 }
 
 void DatabaseLoadPlayerInfo(Player* p)
@@ -174,25 +1517,13 @@ bool DatabaseHasPlayerInfo()
 
 void DatabaseSaveMapInfo()
 {
-  sqlite3_stmt* stmt = NULL;
-  if(sHasMapInfo)
-  {
-    stmt = DatabaseCompileStatement("UPDATE MapInfo SET currTime = ?");
-    sqlite3_bind_double(stmt, 1, MapGetTime());
-  }
-  else
-  {
-    stmt = DatabaseCompileStatement("INSERT INTO MapInfo (seed, currTime, chunkWidth, chunkHeight) VALUES (?, ?, ?, ?)");
-    sqlite3_bind_int(stmt, 1, MapGetSeed());
-    sqlite3_bind_double(stmt, 2, MapGetTime());
-    sqlite3_bind_int(stmt, 3, CHUNK_WIDTH);
-    sqlite3_bind_int(stmt, 4, CHUNK_HEIGHT);
-  }
+  const SaveState state = {.time = MapGetTime()};
 
-  sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
-
-  sHasMapInfo = true;
+  if(!tInTransaction)
+    mtx_lock(&sTransactionMtx);
+  DatabaseStoreMapInfo(&state);
+  if(!tInTransaction)
+    mtx_unlock(&sTransactionMtx);
 }
 
 void DatabaseLoadMapInfo()
@@ -231,5 +1562,39 @@ bool DatabaseHasMapInfo()
 
 void DatabaseFree()
 {
+  DatabaseFlush();
+
+  mtx_lock(&sWriterMtx);
+  sWriterStop = true;
+  mtx_unlock(&sWriterMtx);
+  cnd_signal(&sWriterCondVar);
+
+  thrd_join(sWriterThread, NULL);
+  mtx_destroy(&sWriterMtx);
+  cnd_destroy(&sWriterCondVar);
+  cnd_destroy(&sFlushedCondVar);
+
+  for(int32_t i = 0; i < sNumCachedStmts; ++i)
+  {
+    sqlite3_finalize(*sCachedStmts[i]);
+    *sCachedStmts[i] = NULL;
+  }
+  sNumCachedStmts = 0;
+
+  //The threads keep their readers and connect them anew after the next "DatabaseInit()".
+  mtx_lock(&sReadersMtx);
+  for(Reader* reader = sReaders; reader != NULL; reader = reader->next)
+    DatabaseCloseReader(reader);
+  sReaders = NULL;
+  mtx_unlock(&sReadersMtx);
+
   sqlite3_close(db);
+  mtx_destroy(&sChunkStmtMtx);
+  mtx_destroy(&sTransactionMtx);
+  mtx_destroy(&sCachedStmtsMtx);
+
+  free(sEditedChunks);
+  sEditedChunks = NULL;
+  sEditedChunksCapacity = 0;
+  mtx_destroy(&sEditedChunksMtx);
 }
\ No newline at end of file
@@ -5,10 +5,67 @@
 
 void DatabaseInit(const char* dbPath);
 
+/* Queues the edit for the writer thread, which commits it within "WRITER_BATCH_TIME" seconds; only ever call it from
+ * one thread (the main thread). "DatabaseGetBlocksForChunk()" already sees all edits queued before it was called. */
 void DatabaseInsertBlock(int32_t chunkX, int32_t chunkZ, int32_t x, int32_t y, int32_t z, int32_t block);
 
+/* Autosave: copies the player information ("p" may be "NULL") and the time of day for the writer thread, which stores them
+ * in one transaction with all edits queued before; only ever call it from the thread queuing edits. The caller does not
+ * wait for any I/O; a later save replaces one not stored yet. */
+void DatabaseSaveAsync(const Player* p);
+
+//Waits until every queued edit is committed and every requested save is stored; must not be called within "DatabaseBeginTransaction()" and "DatabaseCommitTransaction()".
+void DatabaseFlush();
+
+//Edits and transactions the writer thread has committed so far.
+void DatabaseGetWriterStats(int64_t* edits, int64_t* transactions);
+
+//Whether the chunk has edits, committed or queued; answered from memory and safe to call from any thread.
+bool DatabaseChunkHasEdits(int32_t chunkX, int32_t chunkZ);
+
+/* Chunk lookups may be called from any thread; each thread reads through a connection of its own.
+ * Waits until the edits queued before the call are committed. Chunks without edits return right away. */
 void DatabaseGetBlocksForChunk(Chunk* c);
 
+/* Changes whenever the edits of the chunk do (0 for chunks without edits), so anything derived from them can be checked
+ * for being up to date. Same threading and waiting as "DatabaseGetBlocksForChunk()". */
+uint64_t DatabaseGetChunkEditsVersion(int32_t chunkX, int32_t chunkZ);
+
+//Coordinates (x, z) of all chunks with edits; the array is allocated for the caller. Returns the number of chunks.
+int32_t DatabaseGetEditedChunks(int32_t** coords);
+
+/* Drops the edits of the chunk which equal "terrain", its generated blocks (never a stored chunk, see "EditCompactor.h").
+ * Returns the number of edits dropped; "remaining" receives the number left. Not within a transaction of the same thread. */
+int32_t DatabaseCompactChunkEdits(int32_t chunkX, int32_t chunkZ, const uint8_t* terrain, int32_t* remaining);
+
+//Records the snapshot "id", which holds every chunk change up to "lastChange" of "ChangedChunks" (see "Snapshot.h").
+void DatabaseFinishSnapshot(int32_t id, int64_t lastChange, int32_t chunks);
+
+//Returns the pages of deleted rows to the file system; takes a while on large maps.
+void DatabaseVacuum();
+
+//Pregenerated chunks (generated terrain without any edits, which stay in "ChunkEdits" only).
+void DatabaseInsertChunk(const Chunk* c);
+
+//Returns "false" if the chunk is not stored (by the world generation set last); "c->blocks" has to be allocated.
+bool DatabaseLoadChunk(Chunk* c);
+
+bool DatabaseHasChunk(int32_t chunkX, int32_t chunkZ);
+
+//Chunks of "Chunks" are stored with "version" ("WorldGeneratorGetVersion()"), and chunks of other versions count as not stored.
+void DatabaseSetGeneratorVersion(uint32_t version);
+
+/* Groups many writes, which are otherwise committed one by one. The edits queued before are committed first; lookups
+ * within the transaction see them, but not the edits queued during it. */
+void DatabaseBeginTransaction();
+
+void DatabaseCommitTransaction();
+
+//Number of chunks a pregeneration run with these parameters has already stored (0 if there was none).
+int32_t DatabaseLoadPregenerationProgress(int32_t centerX, int32_t centerZ, int32_t radius);
+
+void DatabaseSavePregenerationProgress(int32_t centerX, int32_t centerZ, int32_t radius, int32_t done);
+
 void DatabaseSavePlayerInfo(Player* p);
 
 void DatabaseLoadPlayerInfo(Player* p);
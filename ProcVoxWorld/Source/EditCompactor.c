@@ -0,0 +1,299 @@
+#include "EditCompactor.h"
+
+#include "Database.h"
+#include "TimeMeasurement.h"
+#include "WorldGenerator.h"
+
+#include "Map/Map.h"
+
+#include "TinyCThread/tinycthread.h"
+
+//Seconds without edits before the background compaction starts (or goes on).
+#define EDIT_COMPACTOR_IDLE_TIME 30.0
+
+//Seconds between two chunks of the background compaction, so that it only ever takes a fraction of a core.
+#define EDIT_COMPACTOR_CHUNK_PAUSE 0.05
+
+//Seconds between two looks at the edits while waiting for the map to be idle.
+#define EDIT_COMPACTOR_POLL_INTERVAL 1.0
+
+static thrd_t sThread;
+static mtx_t sMtx;
+static cnd_t sCondVar;
+static bool sStop;
+static bool sRunning;
+
+static Chunk* CreateTerrainChunk()
+{
+  Chunk* c = ChunkInit(0, 0);
+
+  if(c != NULL)
+    ChunkAllocBlocks(c);
+
+  if(c != NULL && c->blocks == NULL)
+  {
+    ChunkDelete(c);
+    c = NULL;
+  }
+
+  return c;
+}
+
+static void DeleteTerrainChunk(Chunk* c)
+{
+  //The chunk never reaches the GPU, hence "ChunkDelete()" would not free the blocks.
+  free(c->blocks);
+  c->blocks = NULL;
+
+  ChunkDelete(c);
+}
+
+static void CompactChunk(Chunk* c, int32_t chunkX, int32_t chunkZ, EditCompactionStats* stats)
+{
+  c->x = chunkX;
+  c->z = chunkZ;
+
+  /* Always the generated terrain, never a stored chunk: the edits are the only copy of what the user built, and a stored
+   * chunk may be dropped (other chunk store, restored snapshot) or, if written by an older pregenerator, hold edits itself.
+   * The generator expects cleared blocks. */
+  memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+  WorldGeneratorGenerateChunk(c);
+
+  int32_t remaining;
+  const int32_t removed = DatabaseCompactChunkEdits(chunkX, chunkZ, c->blocks, &remaining);
+
+  ++stats->chunks;
+  stats->editsBefore += removed + remaining;
+  stats->editsRemoved += removed;
+  stats->rowsDeleted += removed > 0 && remaining == 0;
+}
+
+void EditCompactorCompactAll(EditCompactionStats* stats)
+{
+  memset(stats, 0, sizeof(EditCompactionStats));
+
+  int32_t* coords;
+  const int32_t count = DatabaseGetEditedChunks(&coords);
+
+  Chunk* c = CreateTerrainChunk();
+
+  for(int32_t i = 0; i < count && c != NULL; ++i)
+    CompactChunk(c, coords[i * 2], coords[i * 2 + 1], stats);
+
+  if(c != NULL)
+    DeleteTerrainChunk(c);
+  free(coords);
+}
+
+//Seconds per lookup of the edits of the chunks.
+static double MeasureLoadTime(Chunk* c, const int32_t* coords, int32_t count)
+{
+  const double start = TimeMeasurementNow();
+  for(int32_t i = 0; i < count; ++i)
+  {
+    c->x = coords[i * 2];
+    c->z = coords[i * 2 + 1];
+    DatabaseGetBlocksForChunk(c);
+  }
+
+  return count > 0 ? (TimeMeasurementNow() - start) / count : 0.0;
+}
+
+static int64_t FileSize(const char* path)
+{
+  FILE* f = NULL;
+  if(fopen_s(&f, path, "rb") != 0 || f == NULL)
+    return -1;
+
+  fseek(f, 0, SEEK_END);
+  const int64_t size = ftell(f);
+  fclose(f);
+
+  return size;
+}
+
+bool EditCompactorRun(const char* mapName)
+{
+  MAP_NAME = (int8_t*)mapName;
+
+  char mapPath[256];
+  snprintf(mapPath, ARRAY_SIZE(mapPath), "Maps/%s", mapName);
+
+  //Opening the database would create an empty map.
+  const int64_t sizeBefore = FileSize(mapPath);
+  if(sizeBefore < 0)
+  {
+    LogError("The map \"%s\" does not exist, hence its edits cannot be compacted.", true, mapName);
+
+    return false;
+  }
+
+  DatabaseInit(mapPath);
+
+  if(!DatabaseHasMapInfo())
+  {
+    LogError("The map \"%s\" has no map information, hence its terrain and with it its edits cannot be compacted.", true, mapName);
+    DatabaseFree();
+
+    return false;
+  }
+
+  DatabaseLoadMapInfo();
+
+  int32_t* coords;
+  const int32_t count = DatabaseGetEditedChunks(&coords);
+  Chunk* c = CreateTerrainChunk();
+
+  if(c == NULL)
+  {
+    free(coords);
+    DatabaseFree();
+
+    return false;
+  }
+
+  LogInfo("Compacting the edits of %d chunks of the map \"%s\".", true, count, mapName);
+
+  const double loadBefore = MeasureLoadTime(c, coords, count);
+
+  EditCompactionStats stats;
+  const double start = TimeMeasurementNow();
+  EditCompactorCompactAll(&stats);
+  const double duration = TimeMeasurementNow() - start;
+
+  DatabaseVacuum();
+
+  //The same chunks as before, including the ones left without edits.
+  const double loadAfter = MeasureLoadTime(c, coords, count);
+
+  DeleteTerrainChunk(c);
+  free(coords);
+
+  DatabaseFree();
+
+  const int64_t sizeAfter = FileSize(mapPath);
+
+  LogSuccess("Compaction of %d chunks finished in %.1f s: %lld of %lld edits removed (%.1f%%), %d chunks left without edits.", true, stats.chunks, duration,
+             (long long)stats.editsRemoved, (long long)stats.editsBefore, stats.editsBefore > 0 ? stats.editsRemoved * 100.0 / stats.editsBefore : 0.0, stats.rowsDeleted);
+  LogInfo("Edits of a chunk are looked up in %.3f ms instead of %.3f ms; the map file has %.2f MB instead of %.2f MB.", true,
+          loadAfter * 1000.0, loadBefore * 1000.0, sizeAfter / 1048576.0, sizeBefore / 1048576.0);
+
+  return true;
+}
+
+//Returns "true" if the thread has to stop.
+static bool WaitOrStop(double seconds)
+{
+  struct timespec until;
+  timespec_get(&until, TIME_UTC);
+
+  const int64_t ns = until.tv_nsec + (int64_t)(seconds * 1e9);
+  until.tv_sec += (time_t)(ns / 1000000000);
+  until.tv_nsec = (long)(ns % 1000000000);
+
+  mtx_lock(&sMtx);
+  if(!sStop)
+    cnd_timedwait(&sCondVar, &sMtx, &until);
+  const bool stop = sStop;
+  mtx_unlock(&sMtx);
+
+  return stop;
+}
+
+static int32_t EditCompactorLoop(void* arg)
+{
+  (void)arg;
+
+  Chunk* c = CreateTerrainChunk();
+
+  if(c == NULL)
+    return 0;
+
+  int32_t* coords = NULL; //Chunks of the pass at hand
+  int32_t count = 0;
+  int32_t next = 0;
+  EditCompactionStats stats;
+
+  int64_t lastEdits = -1;
+  int64_t compactedEdits = -1; //Edits committed when the last pass was finished
+  double lastEditTime = TimeMeasurementNow();
+
+  for(double wait = EDIT_COMPACTOR_POLL_INTERVAL; !WaitOrStop(wait);)
+  {
+    int64_t edits, transactions;
+    DatabaseGetWriterStats(&edits, &transactions);
+
+    const double now = TimeMeasurementNow();
+    if(edits != lastEdits)
+    {
+      lastEdits = edits;
+      lastEditTime = now;
+    }
+
+    wait = EDIT_COMPACTOR_POLL_INTERVAL;
+
+    //A pass is interrupted by edits and goes on once the map is idle again.
+    if(now - lastEditTime < EDIT_COMPACTOR_IDLE_TIME || edits == compactedEdits)
+      continue;
+
+    if(coords == NULL)
+    {
+      count = DatabaseGetEditedChunks(&coords);
+      next = 0;
+      memset(&stats, 0, sizeof(EditCompactionStats));
+    }
+
+    if(next < count)
+    {
+      CompactChunk(c, coords[next * 2], coords[next * 2 + 1], &stats);
+      ++next;
+      wait = EDIT_COMPACTOR_CHUNK_PAUSE;
+
+      continue;
+    }
+
+    if(stats.editsRemoved > 0)
+      LogInfo("%lld of %lld edits of %d chunks were removed, as they equal the terrain.", true, (long long)stats.editsRemoved, (long long)stats.editsBefore, stats.chunks);
+
+    free(coords);
+    coords = NULL;
+    compactedEdits = edits;
+  }
+
+  free(coords);
+  DeleteTerrainChunk(c);
+
+  return 0;
+}
+
+void EditCompactorStart()
+{
+  sStop = false;
+  mtx_init(&sMtx, mtx_plain);
+  cnd_init(&sCondVar);
+
+  sRunning = thrd_create(&sThread, EditCompactorLoop, NULL) == thrd_success;
+
+  if(!sRunning)
+  {
+    LogWarning("The thread of the edit compaction could not be created, hence edits are not compacted.", true);
+    mtx_destroy(&sMtx);
+    cnd_destroy(&sCondVar);
+  }
+}
+
+void EditCompactorStop()
+{
+  if(!sRunning)
+    return;
+
+  mtx_lock(&sMtx);
+  sStop = true;
+  mtx_unlock(&sMtx);
+  cnd_signal(&sCondVar);
+
+  thrd_join(sThread, NULL);
+  mtx_destroy(&sMtx);
+  cnd_destroy(&sCondVar);
+  sRunning = false;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Every "MapSetBlock()" is kept as an edit, including blocks placed back as they were generated and blocks broken and
+ * placed again. Compaction drops the edits which equal the generated terrain of their chunk, so they no longer cost space
+ * and load time. Stored chunks are not looked at, as they can be dropped any time and the edits have to hold on their own. */
+typedef struct
+{
+  int32_t chunks;      //Edited chunks looked at
+  int32_t rowsDeleted; //Chunks left without any edit
+  int64_t editsBefore;
+  int64_t editsRemoved;
+} EditCompactionStats;
+
+//Compacts every edited chunk of the open map on the calling thread; the seed of the map has to be set.
+void EditCompactorCompactAll(EditCompactionStats* stats);
+
+/* Headless compaction of the map "mapName", with the rows removed and the load time of the edited chunks before and after.
+ * Start with: ProcVoxWorld [configuration path] --compact-edits <map name> */
+bool EditCompactorRun(const char* mapName);
+
+/* Compacts the open map on a thread of its own whenever no edits have been made for "EDIT_COMPACTOR_IDLE_TIME" seconds,
+ * one chunk at a time; edits made meanwhile are simply committed after the chunk at hand. */
+void EditCompactorStart();
+
+//Has to be called before the map, the world generator and the chunk store are freed.
+void EditCompactorStop();
\ No newline at end of file
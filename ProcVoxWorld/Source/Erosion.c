@@ -0,0 +1,384 @@
+#include "Erosion.h"
+
+#include "WorldGenerator.h"
+
+#include "TinyCThread/tinycthread.h"
+
+//Side of the area a tile erodes (the tile and its overlap).
+#define EROSION_MAP_WIDTH (EROSION_TILE_WIDTH + 2 * EROSION_TILE_OVERLAP)
+
+//Droplets wash material out of all columns within this radius.
+#define EROSION_BRUSH_RADIUS 3
+#define EROSION_MAX_BRUSH_CELLS ((2 * EROSION_BRUSH_RADIUS + 1) * (2 * EROSION_BRUSH_RADIUS + 1))
+
+//Droplet simulation (heights and distances are measured in blocks):
+static const float dropletsPerColumn = 0.5f;
+static const int32_t maxLifetime = 30;
+static const float inertia = 0.05f; //How much a droplet keeps its direction instead of following the slope.
+static const float capacityFactor = 0.5f; //Sediment a droplet can carry per block of descent.
+static const float minCapacity = 0.01f; //Even flat terrain is eroded a little.
+static const float depositSpeed = 0.3f;
+static const float erodeSpeed = 0.3f;
+static const float evaporateSpeed = 0.01f;
+static const float gravity = 4.0f;
+
+typedef struct
+{
+  int8_t dX, dZ;
+  float weight;
+} BrushCell;
+
+typedef enum
+{
+  TILE_EMPTY,
+  TILE_ERODING,
+  TILE_READY
+} TileState;
+
+typedef struct
+{
+  int32_t seed;
+  int32_t tX, tZ;
+
+  TileState state;
+  int32_t users; //Threads reading "deltas"; the tile must not be replaced meanwhile.
+
+  float* deltas;
+} ErosionTile;
+
+static BrushCell sBrush[EROSION_MAX_BRUSH_CELLS];
+static int32_t sBrushSize;
+
+static ErosionTile sTileCache[EROSION_TILE_CACHE_SIDE * EROSION_TILE_CACHE_SIDE];
+static mtx_t sTileCacheMtx;
+static cnd_t sTileCacheCnd; //Signaled whenever a tile is finished or released.
+
+static once_flag sInitFlag = ONCE_FLAG_INIT;
+
+static void ErosionInit()
+{
+  float weightSum = 0.0f;
+  for(int32_t dX = -EROSION_BRUSH_RADIUS; dX <= EROSION_BRUSH_RADIUS; ++dX)
+  {
+    for(int32_t dZ = -EROSION_BRUSH_RADIUS; dZ <= EROSION_BRUSH_RADIUS; ++dZ)
+    {
+      const float dist = sqrtf((float)(dX * dX + dZ * dZ));
+      if(dist >= EROSION_BRUSH_RADIUS)
+        continue;
+
+      sBrush[sBrushSize++] = (BrushCell){(int8_t)dX, (int8_t)dZ, EROSION_BRUSH_RADIUS - dist};
+      weightSum += EROSION_BRUSH_RADIUS - dist;
+    }
+  }
+
+  for(int32_t i = 0; i < sBrushSize; ++i)
+    sBrush[i].weight /= weightSum;
+
+  mtx_init(&sTileCacheMtx, mtx_plain);
+  cnd_init(&sTileCacheCnd);
+}
+
+static int32_t TileOf(int32_t worldBlockCoord)
+{
+  if(worldBlockCoord >= 0)
+    return worldBlockCoord / EROSION_TILE_WIDTH;
+
+  return (worldBlockCoord + 1) / EROSION_TILE_WIDTH - 1;
+}
+
+//Height and gradient at a position between the columns (bilinear).
+static float HeightAndGradient(const float* map, float posX, float posZ, float* gradX, float* gradZ)
+{
+  const int32_t x = (int32_t)posX;
+  const int32_t z = (int32_t)posZ;
+  const float fX = posX - x;
+  const float fZ = posZ - z;
+
+  const float h00 = map[x * EROSION_MAP_WIDTH + z];
+  const float h01 = map[x * EROSION_MAP_WIDTH + z + 1];
+  const float h10 = map[(x + 1) * EROSION_MAP_WIDTH + z];
+  const float h11 = map[(x + 1) * EROSION_MAP_WIDTH + z + 1];
+
+  *gradX = (h10 - h00) * (1.0f - fZ) + (h11 - h01) * fZ;
+  *gradZ = (h01 - h00) * (1.0f - fX) + (h11 - h10) * fX;
+
+  return h00 * (1.0f - fX) * (1.0f - fZ) + h10 * fX * (1.0f - fZ) + h01 * (1.0f - fX) * fZ + h11 * fX * fZ;
+}
+
+static void SimulateDroplet(float* map, float posX, float posZ)
+{
+  const float maxPos = EROSION_MAP_WIDTH - 1.0f;
+
+  float dirX = 0.0f, dirZ = 0.0f;
+  float speed = 1.0f;
+  float water = 1.0f;
+  float sediment = 0.0f;
+
+  for(int32_t lifetime = 0; lifetime < maxLifetime; ++lifetime)
+  {
+    const int32_t nodeX = (int32_t)posX;
+    const int32_t nodeZ = (int32_t)posZ;
+    const float fX = posX - nodeX;
+    const float fZ = posZ - nodeZ;
+
+    float gradX, gradZ;
+    const float height = HeightAndGradient(map, posX, posZ, &gradX, &gradZ);
+
+    //The sea takes whatever the droplet still carries.
+    if(height < WORLD_GEN_WATER_LEVEL)
+      return;
+
+    dirX = dirX * inertia - gradX * (1.0f - inertia);
+    dirZ = dirZ * inertia - gradZ * (1.0f - inertia);
+
+    const float len = sqrtf(dirX * dirX + dirZ * dirZ);
+    if(len < 1e-6f)
+      return;
+
+    dirX /= len;
+    dirZ /= len;
+    posX += dirX;
+    posZ += dirZ;
+
+    if(posX < 0.0f || posX >= maxPos || posZ < 0.0f || posZ >= maxPos)
+      return;
+
+    float unused;
+    const float deltaHeight = HeightAndGradient(map, posX, posZ, &unused, &unused) - height;
+
+    const float capacity = MAX(-deltaHeight * speed * water * capacityFactor, minCapacity);
+
+    if(sediment > capacity || deltaHeight > 0.0f)
+    {
+      //Uphill, the pit behind is filled (at most up to the new height); otherwise the surplus is dropped.
+      const float amount = deltaHeight > 0.0f ? MIN(deltaHeight, sediment) : (sediment - capacity) * depositSpeed;
+      sediment -= amount;
+
+      map[nodeX * EROSION_MAP_WIDTH + nodeZ] += amount * (1.0f - fX) * (1.0f - fZ);
+      map[nodeX * EROSION_MAP_WIDTH + nodeZ + 1] += amount * (1.0f - fX) * fZ;
+      map[(nodeX + 1) * EROSION_MAP_WIDTH + nodeZ] += amount * fX * (1.0f - fZ);
+      map[(nodeX + 1) * EROSION_MAP_WIDTH + nodeZ + 1] += amount * fX * fZ;
+    }
+    else
+    {
+      //Never deeper than the descent, otherwise droplets would dig holes.
+      const float amount = MIN((capacity - sediment) * erodeSpeed, -deltaHeight);
+
+      for(int32_t i = 0; i < sBrushSize; ++i)
+      {
+        const int32_t x = nodeX + sBrush[i].dX;
+        const int32_t z = nodeZ + sBrush[i].dZ;
+        if(x < 0 || x >= EROSION_MAP_WIDTH || z < 0 || z >= EROSION_MAP_WIDTH)
+          continue;
+
+        map[x * EROSION_MAP_WIDTH + z] -= amount * sBrush[i].weight;
+        sediment += amount * sBrush[i].weight;
+      }
+    }
+
+    speed = sqrtf(MAX(speed * speed - deltaHeight * gravity, 0.0f));
+    water *= 1.0f - evaporateSpeed;
+  }
+}
+
+void ErosionComputeTile(int32_t seed, int32_t tX, int32_t tZ, float* deltas)
+{
+  call_once(&sInitFlag, ErosionInit);
+
+  const int32_t mapSize = EROSION_MAP_WIDTH * EROSION_MAP_WIDTH;
+
+  int32_t* base = (int32_t*)OwnMalloc(mapSize * sizeof(int32_t), false);
+  float* map = (float*)OwnMalloc(mapSize * sizeof(float), false);
+
+  if(base == NULL || map == NULL)
+  {
+    LogError("Variables \"base\" and \"map\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    memset(deltas, 0, EROSION_TILE_DATA_WIDTH * EROSION_TILE_DATA_WIDTH * sizeof(float));
+    free(base);
+    free(map);
+
+    return;
+  }
+
+  noiseState state = {NoiseGeneratorCreateFnl(seed), seed};
+  WorldGeneratorSampleHeightmap(&state, tX * EROSION_TILE_WIDTH - EROSION_TILE_OVERLAP, tZ * EROSION_TILE_WIDTH - EROSION_TILE_OVERLAP,
+                                EROSION_MAP_WIDTH, base);
+
+  for(int32_t i = 0; i < mapSize; ++i)
+    map[i] = (float)base[i];
+
+  //The droplets of a tile run one after another, so the result does not depend on the thread that erodes it.
+  const int32_t numDroplets = (int32_t)(mapSize * dropletsPerColumn);
+  for(int32_t i = 0; i < numDroplets; ++i)
+  {
+    const uint32_t randX = NoiseGeneratorPosRand(seed, tX, 2 * i, tZ, RAND_EROSION);
+    const uint32_t randZ = NoiseGeneratorPosRand(seed, tX, 2 * i + 1, tZ, RAND_EROSION);
+
+    SimulateDroplet(map, (randX & 0xFFFFFF) / 16777216.0f * (EROSION_MAP_WIDTH - 1), (randZ & 0xFFFFFF) / 16777216.0f * (EROSION_MAP_WIDTH - 1));
+  }
+
+  const int32_t offset = EROSION_TILE_OVERLAP - EROSION_BLEND_WIDTH;
+  for(int32_t x = 0; x < EROSION_TILE_DATA_WIDTH; ++x)
+  {
+    for(int32_t z = 0; z < EROSION_TILE_DATA_WIDTH; ++z)
+    {
+      const int32_t i = (x + offset) * EROSION_MAP_WIDTH + z + offset;
+      deltas[x * EROSION_TILE_DATA_WIDTH + z] = map[i] - base[i];
+    }
+  }
+
+  free(base);
+  free(map);
+}
+
+//Waits until tile ("tX", "tZ") is eroded (eroding it on this thread if nobody else does); "NULL" if there is no memory.
+static ErosionTile* AcquireTile(int32_t seed, int32_t tX, int32_t tZ)
+{
+  const int32_t slotX = (tX % EROSION_TILE_CACHE_SIDE + EROSION_TILE_CACHE_SIDE) % EROSION_TILE_CACHE_SIDE;
+  const int32_t slotZ = (tZ % EROSION_TILE_CACHE_SIDE + EROSION_TILE_CACHE_SIDE) % EROSION_TILE_CACHE_SIDE;
+  ErosionTile* tile = &sTileCache[slotX * EROSION_TILE_CACHE_SIDE + slotZ];
+
+  mtx_lock(&sTileCacheMtx);
+  while(true)
+  {
+    const bool isSame = tile->state != TILE_EMPTY && tile->seed == seed && tile->tX == tX && tile->tZ == tZ;
+
+    if(isSame && tile->state == TILE_READY)
+    {
+      ++tile->users;
+      mtx_unlock(&sTileCacheMtx);
+
+      return tile;
+    }
+
+    //Either another thread is eroding this very tile, or the slot is still needed for another one.
+    if(isSame || tile->state == TILE_ERODING || tile->users > 0)
+    {
+      cnd_wait(&sTileCacheCnd, &sTileCacheMtx);
+
+      continue;
+    }
+
+    break;
+  }
+
+  if(tile->deltas == NULL)
+    tile->deltas = (float*)OwnMalloc(EROSION_TILE_DATA_WIDTH * EROSION_TILE_DATA_WIDTH * sizeof(float), false);
+
+  if(tile->deltas == NULL)
+  {
+    LogError("Variable \"tile->deltas\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    tile->state = TILE_EMPTY;
+    mtx_unlock(&sTileCacheMtx);
+
+    return NULL;
+  }
+
+  tile->seed = seed;
+  tile->tX = tX;
+  tile->tZ = tZ;
+  tile->state = TILE_ERODING;
+  mtx_unlock(&sTileCacheMtx);
+
+  ErosionComputeTile(seed, tX, tZ, tile->deltas);
+
+  mtx_lock(&sTileCacheMtx);
+  tile->state = TILE_READY;
+  tile->users = 1;
+  mtx_unlock(&sTileCacheMtx);
+  cnd_broadcast(&sTileCacheCnd);
+
+  return tile;
+}
+
+static void ReleaseTile(ErosionTile* tile)
+{
+  mtx_lock(&sTileCacheMtx);
+  --tile->users;
+  mtx_unlock(&sTileCacheMtx);
+  cnd_broadcast(&sTileCacheCnd);
+}
+
+/* Share of tile "t" at world coordinate "p" along one axis; it fades out across the seams,
+ * where the share of the neighbouring tile fades in, so that the shares always add up to one. */
+static float SeamWeight(int32_t p, int32_t t)
+{
+  const int32_t start = t * EROSION_TILE_WIDTH;
+  const int32_t end = start + EROSION_TILE_WIDTH;
+
+  if(p < start - EROSION_BLEND_WIDTH || p >= end + EROSION_BLEND_WIDTH)
+    return 0.0f;
+
+  if(p < start + EROSION_BLEND_WIDTH)
+    return glm_smoothstep(0.0f, 1.0f, (p - (start - EROSION_BLEND_WIDTH) + 0.5f) / (2 * EROSION_BLEND_WIDTH));
+
+  if(p >= end - EROSION_BLEND_WIDTH)
+    return 1.0f - glm_smoothstep(0.0f, 1.0f, (p - (end - EROSION_BLEND_WIDTH) + 0.5f) / (2 * EROSION_BLEND_WIDTH));
+
+  return 1.0f;
+}
+
+void ErosionSampleDeltas(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t width, int32_t* deltas)
+{
+  call_once(&sInitFlag, ErosionInit);
+
+  float* sum = (float*)OwnMalloc((size_t)width * width * sizeof(float), false);
+
+  if(sum == NULL)
+  {
+    LogError("Variable \"sum\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    memset(deltas, 0, (size_t)width * width * sizeof(int32_t));
+
+    return;
+  }
+
+  memset(sum, 0, (size_t)width * width * sizeof(float));
+
+  //Only one tile is held at a time, thus threads can never wait for each other in a circle.
+  for(int32_t tX = TileOf(bX - EROSION_BLEND_WIDTH); tX <= TileOf(bX + width - 1 + EROSION_BLEND_WIDTH); ++tX)
+  {
+    for(int32_t tZ = TileOf(bZ - EROSION_BLEND_WIDTH); tZ <= TileOf(bZ + width - 1 + EROSION_BLEND_WIDTH); ++tZ)
+    {
+      ErosionTile* tile = AcquireTile(noiseState->seed, tX, tZ);
+      if(tile == NULL)
+        continue;
+
+      const int32_t dataX = tX * EROSION_TILE_WIDTH - EROSION_BLEND_WIDTH;
+      const int32_t dataZ = tZ * EROSION_TILE_WIDTH - EROSION_BLEND_WIDTH;
+
+      for(int32_t x = MAX(bX, dataX); x <= MIN(bX + width - 1, dataX + EROSION_TILE_DATA_WIDTH - 1); ++x)
+      {
+        const float weightX = SeamWeight(x, tX);
+        if(weightX == 0.0f)
+          continue;
+
+        for(int32_t z = MAX(bZ, dataZ); z <= MIN(bZ + width - 1, dataZ + EROSION_TILE_DATA_WIDTH - 1); ++z)
+          sum[(x - bX) * width + (z - bZ)] += weightX * SeamWeight(z, tZ) * tile->deltas[(x - dataX) * EROSION_TILE_DATA_WIDTH + (z - dataZ)];
+      }
+
+      ReleaseTile(tile);
+    }
+  }
+
+  for(int32_t i = 0; i < width * width; ++i)
+    deltas[i] = (int32_t)floorf(sum[i] + 0.5f);
+
+  free(sum);
+}
+
+void ErosionFree()
+{
+  call_once(&sInitFlag, ErosionInit);
+
+  mtx_lock(&sTileCacheMtx);
+  for(int32_t i = 0; i < EROSION_TILE_CACHE_SIDE * EROSION_TILE_CACHE_SIDE; ++i)
+  {
+    free(sTileCache[i].deltas);
+    sTileCache[i].deltas = NULL;
+    sTileCache[i].state = TILE_EMPTY;
+  }
+  mtx_unlock(&sTileCacheMtx);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "NoiseGenerator.h"
+
+/* Hydraulic erosion: water droplets run down the terrain of a whole tile of "EROSION_TILE_WIDTH" x "EROSION_TILE_WIDTH"
+ * columns, wash material out of slopes and deposit it in valleys. Tiles are eroded independently (on whichever thread
+ * needs them first), including "EROSION_TILE_OVERLAP" columns of every neighbour, and blended across their seams.
+ * The droplets only depend on the seed and the tile coordinates, so the result is the same for any generation order. */
+#define EROSION_TILE_WIDTH   256
+#define EROSION_TILE_OVERLAP 32
+
+//Half of the overlap is blended (the outer half, where droplets from beyond are missing, is discarded).
+#define EROSION_BLEND_WIDTH  (EROSION_TILE_OVERLAP / 2)
+
+//Values of a tile kept for its own columns and the blended seams around them.
+#define EROSION_TILE_DATA_WIDTH (EROSION_TILE_WIDTH + 2 * EROSION_BLEND_WIDTH)
+
+//Eroded tiles are kept in a cache of "EROSION_TILE_CACHE_SIDE" x "EROSION_TILE_CACHE_SIDE" tiles, so neighbouring tiles never evict each other.
+#define EROSION_TILE_CACHE_SIDE 4
+
+/* Height changes (in blocks) of "width" x "width" columns starting at ("bX", "bZ"), stored row by row along the z-axis;
+ * tiles which are not cached are eroded first. Thread-safe. */
+void ErosionSampleDeltas(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t width, int32_t* deltas);
+
+/* Erodes tile ("tX", "tZ") without the cache and stores its "EROSION_TILE_DATA_WIDTH" x "EROSION_TILE_DATA_WIDTH"
+ * height changes (not yet blended) in "deltas". */
+void ErosionComputeTile(int32_t seed, int32_t tX, int32_t tZ, float* deltas);
+
+//Discards all cached tiles (e.g. after the terrain has changed).
+void ErosionFree();
\ No newline at end of file
@@ -0,0 +1,769 @@
+#include "Exporter.h"
+
+#include "ChunkStore.h"
+#include "Database.h"
+#include "TimeMeasurement.h"
+#include "WorldGenerator.h"
+
+#include "Map/Block.h"
+#include "Map/Map.h"
+
+//Chunks of a batch per thread; a batch is processed while the one before is written, so two are in memory at most.
+#define EXPORTER_CHUNKS_PER_THREAD 4
+
+//Progress is reported at most this often (in seconds).
+#define EXPORTER_REPORT_INTERVAL 2.0
+
+#define VOX_VERSION 150
+
+//Colors of the blocks (roughly the average of their textures) for the palette and the vertex colors.
+static const uint8_t blockColors[AMOUNT_BLOCKS][3] =
+{
+  {  0,   0,   0}, //0: AIR_BLOCK
+  {200, 160, 120}, //1: PLAYER_HAND_BLOCK
+  {125, 125, 125}, //2: STONE_BLOCK
+  {134,  96,  67}, //3: DIRT_BLOCK
+  { 95, 159,  53}, //4: GRASS_BLOCK
+  {162, 130,  78}, //5: WOODEN_PLANKS_BLOCK
+  {160, 160, 160}, //6: POLISHED_STONE_BLOCK
+  {150,  97,  83}, //7: BRICKS_BLOCK
+  {110, 110, 110}, //8: COBBLESTONE_BLOCK
+  { 60,  60,  60}, //9: BEDROCK_BLOCK
+  {219, 207, 163}, //10: SAND_BLOCK
+  {131, 127, 126}, //11: GRAVEL_BLOCK
+  {102,  81,  51}, //12: WOOD_BLOCK
+  {216, 216, 216}, //13: IRON_BLOCK
+  {246, 208,  61}, //14: GOLD_BLOCK
+  { 98, 237, 228}, //15: DIAMOND_BLOCK
+  { 42, 203,  87}, //16: EMERALD_BLOCK
+  {171,  27,   9}, //17: REDSTONE_BLOCK
+  { 99, 118,  88}, //18: MOSSY_COBBLESTONE_BLOCK
+  { 20,  18,  29}, //19: OBSIDIAN_BLOCK
+  {122, 121, 122}, //20: STONE_BRICKS_BLOCK
+  {249, 254, 254}, //21: SNOW_BLOCK
+  {240, 251, 251}, //22: SNOW_GRASS_BLOCK
+  {200, 230, 235}, //23: GLASS_BLOCK
+  { 47,  67, 244}, //24: WATER_BLOCK
+  { 60, 120,  40}, //25: LEAVES_BLOCK
+  { 90, 150,  50}, //26: GRASS_PLANT_BLOCK
+  {200,  30,  30}, //27: FLOWER_ROSE_BLOCK
+  {240, 220,  40}, //28: FLOWER_DANDELION_BLOCK
+  {150, 110,  80}, //29: MUSHROOM_BROWN_BLOCK
+  {200,  40,  40}, //30: MUSHROOM_RED_BLOCK
+  {140, 100,  50}, //31: DEAD_PLANT_BLOCK
+  { 85, 127,  43}, //32: CACTUS_BLOCK
+  {216, 203, 155}, //33: SANDSTONE_BLOCK
+  {210, 196, 146}, //34: SANDSTONE_CHISELED_BLOCK
+};
+
+typedef struct
+{
+  uint8_t* data;
+  size_t size;
+  size_t capacity;
+  bool failed; //Out of memory
+} ExportBuffer;
+
+typedef struct
+{
+  int32_t x, z;
+  ExportBuffer output;
+  int64_t elements;
+} ExportedChunk;
+
+typedef struct
+{
+  ExportFormat format;
+  ExportedChunk* chunks;
+  int32_t count;
+} ExportBatch;
+
+typedef struct
+{
+  FILE* file;
+  ExportFormat format;
+  int32_t minX, minZ, maxX, maxZ;
+  ExportStats* stats;
+  bool failed; //The file could not be written
+
+  int32_t* models; //Chunk coordinates (relative to the rectangle) of the models of a "vox" file, two per model
+  int32_t numModels;
+  int32_t modelCapacity;
+
+  thrd_t thread;
+  mtx_t mtx;
+  cnd_t condVar;
+  ExportBatch* pending; //Cleared once it is written
+  bool stop;
+} ExportWriter;
+
+//Block of every texture tile (the first one using it), for the vertex colors of meshes.
+static uint8_t sTileBlocks[256];
+
+//----- Buffers -----
+
+static void BufferAppend(ExportBuffer* b, const void* data, size_t size)
+{
+  if(b->failed)
+    return;
+
+  if(b->size + size > b->capacity)
+  {
+    size_t capacity = MAX(b->capacity * 2, 4096);
+    while(capacity < b->size + size)
+      capacity *= 2;
+
+    uint8_t* grown = (uint8_t*)realloc(b->data, capacity);
+    if(grown == NULL)
+    {
+      b->failed = true;
+
+      return;
+    }
+
+    b->data = grown;
+    b->capacity = capacity;
+  }
+
+  memcpy(&b->data[b->size], data, size);
+  b->size += size;
+}
+
+//Little-endian, like the machines the game runs on.
+static void BufferAppendInt32(ExportBuffer* b, int32_t value)
+{
+  BufferAppend(b, &value, sizeof(int32_t));
+}
+
+static void BufferPatchInt32(ExportBuffer* b, size_t offset, int32_t value)
+{
+  if(!b->failed)
+    memcpy(&b->data[offset], &value, sizeof(int32_t));
+}
+
+static void BufferAppendText(ExportBuffer* b, const char* text)
+{
+  BufferAppend(b, text, strlen(text));
+}
+
+static void BufferFree(ExportBuffer* b)
+{
+  free(b->data);
+  memset(b, 0, sizeof(ExportBuffer));
+}
+
+//----- "vox" -----
+
+//The same rule as the mesher's: a block is seen if a neighbour is transparent and not of the same kind.
+static bool IsSurfaceBlock(const Chunk* c, int32_t x, int32_t y, int32_t z, uint8_t block)
+{
+  const uint8_t neighbs[6] =
+  {
+    c->blocks[XYZ(x - 1, y, z)], c->blocks[XYZ(x + 1, y, z)], c->blocks[XYZ(x, y + 1, z)],
+    c->blocks[XYZ(x, y - 1, z)], c->blocks[XYZ(x, y, z - 1)], c->blocks[XYZ(x, y, z + 1)]
+  };
+
+  for(int32_t i = 0; i < 6; ++i)
+  {
+    if(BlockIsTransparent(neighbs[i]) && neighbs[i] != block)
+      return true;
+  }
+
+  return false;
+}
+
+/* The "SIZE" and "XYZI" chunks of the model of a chunk. MagicaVoxel has z pointing up; the game's z-axis becomes the
+ * negative y-axis, so the world is not mirrored. Palette index "n" is block "n". */
+static void EncodeVoxModel(const Chunk* c, ExportedChunk* ec)
+{
+  ExportBuffer* b = &ec->output;
+
+  BufferAppend(b, "SIZE", 4);
+  BufferAppendInt32(b, 12);
+  BufferAppendInt32(b, 0);
+  BufferAppendInt32(b, CHUNK_WIDTH);
+  BufferAppendInt32(b, CHUNK_WIDTH);
+  BufferAppendInt32(b, CHUNK_HEIGHT);
+
+  //Sizes are only known at the end.
+  const size_t header = b->size;
+  BufferAppend(b, "XYZI", 4);
+  BufferAppendInt32(b, 0);
+  BufferAppendInt32(b, 0);
+  BufferAppendInt32(b, 0);
+
+  int32_t count = 0;
+  for(int32_t y = 0; y < CHUNK_HEIGHT; ++y)
+  {
+    for(int32_t z = 0; z < CHUNK_WIDTH; ++z)
+    {
+      for(int32_t x = 0; x < CHUNK_WIDTH; ++x)
+      {
+        const uint8_t block = c->blocks[XYZ(x, y, z)];
+        if(block == AIR_BLOCK || !IsSurfaceBlock(c, x, y, z, block))
+          continue;
+
+        const uint8_t voxel[4] = {(uint8_t)x, (uint8_t)(CHUNK_WIDTH - 1 - z), (uint8_t)y, block};
+        BufferAppend(b, voxel, sizeof(voxel));
+        ++count;
+      }
+    }
+  }
+
+  BufferPatchInt32(b, header + 4, 4 + count * 4);
+  BufferPatchInt32(b, header + 12, count);
+  ec->elements = count;
+
+  //Empty models are left out altogether.
+  if(count == 0)
+    b->size = 0;
+}
+
+static void AppendVoxChunkHeader(ExportBuffer* b, const char* id, int32_t contentSize)
+{
+  BufferAppend(b, id, 4);
+  BufferAppendInt32(b, contentSize);
+  BufferAppendInt32(b, 0);
+}
+
+//A transform node without attributes, which places "child" at "translation" (empty for none).
+static void AppendVoxTransform(ExportBuffer* b, int32_t id, int32_t child, int32_t layer, const char* translation)
+{
+  const int32_t frameSize = translation[0] != '\0' ? 4 + 4 + 2 + 4 + (int32_t)strlen(translation) : 4;
+
+  AppendVoxChunkHeader(b, "nTRN", 6 * 4 + frameSize);
+  BufferAppendInt32(b, id);
+  BufferAppendInt32(b, 0); //Attributes
+  BufferAppendInt32(b, child);
+  BufferAppendInt32(b, -1); //Reserved
+  BufferAppendInt32(b, layer);
+  BufferAppendInt32(b, 1); //Frames
+
+  if(translation[0] != '\0')
+  {
+    BufferAppendInt32(b, 1);
+    BufferAppendInt32(b, 2);
+    BufferAppend(b, "_t", 2);
+    BufferAppendInt32(b, (int32_t)strlen(translation));
+    BufferAppendText(b, translation);
+  }
+  else
+    BufferAppendInt32(b, 0);
+}
+
+//Scene graph (root transform, group, a transform and shape per model) and palette after the models.
+static void EncodeVoxScene(const ExportWriter* w, ExportBuffer* b)
+{
+  AppendVoxTransform(b, 0, 1, -1, "");
+
+  AppendVoxChunkHeader(b, "nGRP", 3 * 4 + w->numModels * 4);
+  BufferAppendInt32(b, 1);
+  BufferAppendInt32(b, 0);
+  BufferAppendInt32(b, w->numModels);
+  for(int32_t i = 0; i < w->numModels; ++i)
+    BufferAppendInt32(b, 2 + 2 * i);
+
+  //Translations are the centers of the models; the rectangle is centered around the origin.
+  const int32_t width = (w->maxX - w->minX + 1) * CHUNK_WIDTH;
+  const int32_t depth = (w->maxZ - w->minZ + 1) * CHUNK_WIDTH;
+
+  for(int32_t i = 0; i < w->numModels; ++i)
+  {
+    char translation[64];
+    snprintf(translation, ARRAY_SIZE(translation), "%d %d %d", w->models[i * 2] * CHUNK_WIDTH + CHUNK_WIDTH / 2 - width / 2,
+             depth - (w->models[i * 2 + 1] + 1) * CHUNK_WIDTH + CHUNK_WIDTH / 2 - depth / 2, CHUNK_HEIGHT / 2);
+    AppendVoxTransform(b, 2 + 2 * i, 3 + 2 * i, 0, translation);
+
+    AppendVoxChunkHeader(b, "nSHP", 5 * 4);
+    BufferAppendInt32(b, 3 + 2 * i);
+    BufferAppendInt32(b, 0);
+    BufferAppendInt32(b, 1); //Models
+    BufferAppendInt32(b, i);
+    BufferAppendInt32(b, 0);
+  }
+
+  //Entry "n" of the palette is color index "n + 1".
+  AppendVoxChunkHeader(b, "RGBA", 256 * 4);
+  for(int32_t i = 0; i < 256; ++i)
+  {
+    const int32_t block = i + 1;
+    const uint8_t color[4] = {block < AMOUNT_BLOCKS ? blockColors[block][0] : 128, block < AMOUNT_BLOCKS ? blockColors[block][1] : 128,
+                              block < AMOUNT_BLOCKS ? blockColors[block][2] : 128, 255};
+    BufferAppend(b, color, sizeof(color));
+  }
+}
+
+//----- "obj" -----
+
+typedef struct
+{
+  float pos[3];
+  uint8_t color[3];
+  uint8_t padding; //Zero, so that vertices can be compared as a whole.
+} ObjVertex;
+
+static uint32_t HashObjVertex(const ObjVertex* v)
+{
+  const uint8_t* bytes = (const uint8_t*)v;
+
+  uint32_t hash = 2166136261u;
+  for(size_t i = 0; i < sizeof(ObjVertex); ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+//The triangles of "vertices" as object "name" with the vertices shared among them.
+static void EncodeObjMesh(ExportBuffer* b, const Vertex* vertices, int32_t count, const char* name, int64_t* triangles)
+{
+  if(count == 0)
+    return;
+
+  int32_t capacity = 1;
+  while(capacity < count * 2)
+    capacity <<= 1;
+
+  int32_t* table = (int32_t*)malloc(capacity * sizeof(int32_t));
+  ObjVertex* unique = (ObjVertex*)malloc(count * sizeof(ObjVertex));
+  int32_t* indices = (int32_t*)malloc(count * sizeof(int32_t));
+
+  if(table == NULL || unique == NULL || indices == NULL)
+  {
+    LogError("Variable \"table\", \"unique\" or \"indices\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+    b->failed = true;
+
+    free(table);
+    free(unique);
+    free(indices);
+
+    return;
+  }
+
+  memset(table, 0xFF, capacity * sizeof(int32_t));
+
+  int32_t numUnique = 0;
+  for(int32_t i = 0; i < count; ++i)
+  {
+    //Darkened like in "Block.frag".
+    ObjVertex v = {{vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]}, {0}, 0};
+    const uint8_t* color = blockColors[sTileBlocks[vertices[i].tile]];
+    for(int32_t j = 0; j < 3; ++j)
+      v.color[j] = (uint8_t)MAX(0.0f, color[j] - 0.35f * 255.0f * vertices[i].AO);
+
+    uint32_t slot = HashObjVertex(&v) & (capacity - 1);
+    while(table[slot] >= 0 && memcmp(&unique[table[slot]], &v, sizeof(ObjVertex)) != 0)
+      slot = (slot + 1) & (capacity - 1);
+
+    if(table[slot] < 0)
+    {
+      unique[numUnique] = v;
+      table[slot] = numUnique++;
+    }
+
+    indices[i] = table[slot];
+  }
+
+  char line[160];
+  snprintf(line, ARRAY_SIZE(line), "o %s\n", name);
+  BufferAppendText(b, line);
+
+  for(int32_t i = 0; i < numUnique; ++i)
+  {
+    snprintf(line, ARRAY_SIZE(line), "v %.7g %.7g %.7g %.3f %.3f %.3f\n", unique[i].pos[0], unique[i].pos[1], unique[i].pos[2],
+             unique[i].color[0] / 255.0f, unique[i].color[1] / 255.0f, unique[i].color[2] / 255.0f);
+    BufferAppendText(b, line);
+  }
+
+  //Relative indices, so that the chunk can be written anywhere in the file.
+  for(int32_t i = 0; i + 2 < count; i += 3)
+  {
+    snprintf(line, ARRAY_SIZE(line), "f %d %d %d\n", indices[i] - numUnique, indices[i + 1] - numUnique, indices[i + 2] - numUnique);
+    BufferAppendText(b, line);
+  }
+
+  *triangles += count / 3;
+
+  free(table);
+  free(unique);
+  free(indices);
+}
+
+//----- Pipeline -----
+
+static void ExportChunk(void* data, int32_t index)
+{
+  ExportBatch* batch = (ExportBatch*)data;
+  ExportedChunk* ec = &batch->chunks[index];
+
+  Chunk* c = ChunkInit(ec->x, ec->z);
+  if(c != NULL)
+    ChunkAllocBlocks(c);
+
+  if(c == NULL || c->blocks == NULL)
+  {
+    ec->output.failed = true;
+
+    if(c != NULL)
+      ChunkDelete(c);
+
+    return;
+  }
+
+  //As "ChunkGenerateTerrain()", except that generated chunks are not stored: an export leaves the map as it is.
+  if(!ChunkStoreLoad(c))
+    WorldGeneratorGenerateChunk(c);
+  DatabaseGetBlocksForChunk(c);
+
+  if(batch->format == EXPORT_FORMAT_VOX)
+    EncodeVoxModel(c, ec);
+  else
+  {
+    ChunkGenerateMesh(c);
+
+    char name[64];
+    snprintf(name, ARRAY_SIZE(name), "chunk_%d_%d", c->x, c->z);
+    EncodeObjMesh(&ec->output, c->generatedMeshTerrain, (int32_t)c->vertexLandCount, name, &ec->elements);
+
+    snprintf(name, ARRAY_SIZE(name), "chunk_%d_%d_water", c->x, c->z);
+    EncodeObjMesh(&ec->output, c->generatedMeshWater, (int32_t)c->vertexWaterCount, name, &ec->elements);
+  }
+
+  //The chunk never reaches the GPU, hence "ChunkDelete()" would not free the blocks (only the meshes).
+  free(c->blocks);
+  c->blocks = NULL;
+  ChunkDelete(c);
+}
+
+static void WriteBatch(ExportWriter* w, ExportBatch* batch)
+{
+  for(int32_t i = 0; i < batch->count; ++i)
+  {
+    ExportedChunk* ec = &batch->chunks[i];
+
+    w->failed |= ec->output.failed;
+
+    if(w->format == EXPORT_FORMAT_VOX && ec->output.size > 0 && !w->failed)
+    {
+      if(w->numModels == w->modelCapacity)
+      {
+        const int32_t capacity = MAX(64, w->modelCapacity * 2);
+        int32_t* grown = (int32_t*)realloc(w->models, (size_t)capacity * 2 * sizeof(int32_t));
+
+        if(grown == NULL)
+          w->failed = true;
+        else
+        {
+          w->models = grown;
+          w->modelCapacity = capacity;
+        }
+      }
+
+      if(!w->failed)
+      {
+        w->models[w->numModels * 2] = ec->x - w->minX;
+        w->models[w->numModels * 2 + 1] = ec->z - w->minZ;
+        ++w->numModels;
+      }
+    }
+
+    if(!w->failed && ec->output.size > 0 && fwrite(ec->output.data, ec->output.size, 1, w->file) != 1)
+      w->failed = true;
+
+    w->stats->bytes += ec->output.size;
+    w->stats->elements += ec->elements;
+    ++w->stats->chunks;
+
+    BufferFree(&ec->output);
+  }
+}
+
+static int32_t ExportWriterLoop(void* data)
+{
+  ExportWriter* w = (ExportWriter*)data;
+
+  mtx_lock(&w->mtx);
+  for(;;)
+  {
+    while(w->pending == NULL && !w->stop)
+      cnd_wait(&w->condVar, &w->mtx);
+
+    if(w->pending == NULL)
+      break;
+
+    ExportBatch* batch = w->pending;
+    mtx_unlock(&w->mtx);
+
+    WriteBatch(w, batch);
+
+    mtx_lock(&w->mtx);
+    w->pending = NULL;
+    cnd_broadcast(&w->condVar);
+  }
+  mtx_unlock(&w->mtx);
+
+  return 0;
+}
+
+//Waits until the writer is done with the batch before (if "batch" is "NULL", just waits).
+static void HandOverBatch(ExportWriter* w, ExportBatch* batch)
+{
+  mtx_lock(&w->mtx);
+  while(w->pending != NULL)
+    cnd_wait(&w->condVar, &w->mtx);
+
+  w->pending = batch;
+  cnd_broadcast(&w->condVar);
+  mtx_unlock(&w->mtx);
+}
+
+bool ExporterParseFormat(const char* name, ExportFormat* format)
+{
+  if(!strcmp(name, "vox"))
+    *format = EXPORT_FORMAT_VOX;
+  else if(!strcmp(name, "obj"))
+    *format = EXPORT_FORMAT_OBJ;
+  else
+    return false;
+
+  return true;
+}
+
+static void WriteHeader(ExportWriter* w)
+{
+  ExportBuffer b = {0};
+
+  if(w->format == EXPORT_FORMAT_VOX)
+  {
+    //The size of the children of "MAIN" is patched at the end.
+    BufferAppend(&b, "VOX ", 4);
+    BufferAppendInt32(&b, VOX_VERSION);
+    AppendVoxChunkHeader(&b, "MAIN", 0);
+  }
+  else
+  {
+    char line[256];
+    snprintf(line, ARRAY_SIZE(line), "# ProcVoxWorld: chunks (%d, %d) to (%d, %d) of the map with the seed %d.\n"
+             "# One object per chunk (\"chunk_<x>_<z>\" and \"chunk_<x>_<z>_water\"); vertex colors follow the positions.\n",
+             w->minX, w->minZ, w->maxX, w->maxZ, MapGetSeed());
+    BufferAppendText(&b, line);
+  }
+
+  w->failed |= b.failed || fwrite(b.data, b.size, 1, w->file) != 1;
+  w->stats->bytes += b.size;
+  BufferFree(&b);
+}
+
+static void WriteFooter(ExportWriter* w)
+{
+  if(w->format != EXPORT_FORMAT_VOX || w->failed)
+    return;
+
+  ExportBuffer b = {0};
+  EncodeVoxScene(w, &b);
+
+  w->failed |= b.failed || fwrite(b.data, b.size, 1, w->file) != 1;
+  w->stats->bytes += b.size;
+  BufferFree(&b);
+
+  //Everything after the header of "MAIN" (20 bytes) are its children.
+  const int32_t childrenSize = (int32_t)(w->stats->bytes - 20);
+  w->failed |= fseek(w->file, 16, SEEK_SET) != 0 || fwrite(&childrenSize, sizeof(int32_t), 1, w->file) != 1;
+}
+
+bool ExporterExport(ExportFormat format, int32_t minX, int32_t minZ, int32_t maxX, int32_t maxZ, const char* path, int32_t numThreads, ExportStats* stats)
+{
+  memset(stats, 0, sizeof(ExportStats));
+
+  if(minX > maxX || minZ > maxZ)
+  {
+    LogError("The chunks (%d, %d) to (%d, %d) do not form a rectangle.", true, minX, minZ, maxX, maxZ);
+
+    return false;
+  }
+
+  if(format == EXPORT_FORMAT_VOX && (CHUNK_WIDTH > 256 || CHUNK_HEIGHT > 256))
+  {
+    LogError("Models of MagicaVoxel have at most 256 voxels per side, hence chunks of %d x %d blocks cannot be exported to \"vox\".", true, CHUNK_WIDTH, CHUNK_HEIGHT);
+
+    return false;
+  }
+
+  ExportWriter w = {0};
+  w.format = format;
+  w.minX = minX;
+  w.minZ = minZ;
+  w.maxX = maxX;
+  w.maxZ = maxZ;
+  w.stats = stats;
+
+  if(fopen_s(&w.file, path, "wb") != 0 || w.file == NULL)
+  {
+    LogError("File \"%s\" could not be opened for the export.", true, path);
+
+    return false;
+  }
+
+  memset(sTileBlocks, 0, sizeof(sTileBlocks));
+  for(int32_t block = AMOUNT_BLOCKS - 1; block > AIR_BLOCK; --block)
+  {
+    for(int32_t f = 0; f < 6; ++f)
+      sTileBlocks[BLOCK_TEXTURES[block][f]] = (uint8_t)block;
+  }
+
+  //The calling thread takes part, too.
+  numThreads = numThreads > 0 ? numThreads : MAX(1, (int32_t)GetProcessorsCount());
+  const int32_t numWorkers = numThreads - 1;
+  const int32_t batchSize = numThreads * EXPORTER_CHUNKS_PER_THREAD;
+
+  Worker* workers = (Worker*)OwnMalloc(MAX(1, numWorkers) * sizeof(Worker), false);
+  ExportedChunk* chunks = (ExportedChunk*)OwnMalloc(2 * batchSize * sizeof(ExportedChunk), false);
+
+  if(workers == NULL || chunks == NULL)
+  {
+    LogError("Variable \"workers\" or \"chunks\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    free(workers);
+    free(chunks);
+    fclose(w.file);
+
+    return false;
+  }
+
+  for(int32_t i = 0; i < numWorkers; ++i)
+    ThreadWorkerCreate(&workers[i], ThreadWorkerLoop);
+
+  mtx_init(&w.mtx, mtx_plain);
+  cnd_init(&w.condVar);
+
+  //Without a writer thread, every batch is written right after it was processed.
+  const bool hasWriter = thrd_create(&w.thread, ExportWriterLoop, &w) == thrd_success;
+
+  const int64_t width = maxX - minX + 1;
+  const int64_t total = width * (maxZ - minZ + 1);
+
+  LogInfo("Exporting %lld chunks from (%d, %d) to (%d, %d) to \"%s\" with %d thread%s.", true, (long long)total, minX, minZ, maxX, maxZ, path, numThreads, numThreads > 1 ? "s" : "");
+
+  WriteHeader(&w);
+
+  ExportBatch batches[2] = {{format, chunks, 0}, {format, &chunks[batchSize], 0}};
+
+  const double start = TimeMeasurementNow();
+  double lastReport = start;
+
+  for(int64_t done = 0, b = 0; done < total; b ^= 1)
+  {
+    ExportBatch* batch = &batches[b];
+    batch->count = (int32_t)MIN(batchSize, total - done);
+
+    for(int32_t i = 0; i < batch->count; ++i)
+    {
+      memset(&batch->chunks[i], 0, sizeof(ExportedChunk));
+      batch->chunks[i].x = minX + (int32_t)((done + i) % width);
+      batch->chunks[i].z = minZ + (int32_t)((done + i) / width);
+    }
+
+    ThreadWorkerRunBatch(workers, numWorkers, ExportChunk, batch, batch->count);
+
+    if(hasWriter)
+      HandOverBatch(&w, batch);
+    else
+      WriteBatch(&w, batch);
+
+    done += batch->count;
+
+    const double now = TimeMeasurementNow();
+    if(now - lastReport >= EXPORTER_REPORT_INTERVAL && done < total)
+    {
+      LogInfo("%lld / %lld chunks (%5.1f%%) | %8.1f chunks/s", true, (long long)done, (long long)total, done * 100.0 / total, done / (now - start));
+      lastReport = now;
+    }
+  }
+
+  if(hasWriter)
+  {
+    HandOverBatch(&w, NULL);
+
+    mtx_lock(&w.mtx);
+    w.stop = true;
+    cnd_broadcast(&w.condVar);
+    mtx_unlock(&w.mtx);
+
+    thrd_join(w.thread, NULL);
+  }
+
+  WriteFooter(&w);
+  w.failed |= fclose(w.file) != 0;
+  stats->seconds = TimeMeasurementNow() - start;
+
+  mtx_destroy(&w.mtx);
+  cnd_destroy(&w.condVar);
+
+  for(int32_t i = 0; i < numWorkers; ++i)
+    ThreadWorkerDestroy(&workers[i]);
+  free(workers);
+  free(chunks);
+  free(w.models);
+
+  if(w.failed)
+  {
+    LogError("The export to \"%s\" failed; the file is incomplete.", true, path);
+
+    return false;
+  }
+
+  LogSuccess("Export of %d chunks to \"%s\" finished in %.1f s: %.1f chunks/s, %lld %s, %.1f MB written; peak memory of the process %.1f MB.", true,
+             stats->chunks, path, stats->seconds, stats->chunks / MAX(stats->seconds, 1e-9), (long long)stats->elements,
+             format == EXPORT_FORMAT_VOX ? "voxels" : "triangles", stats->bytes / 1048576.0, GetPeakMemoryUsage() / 1048576.0);
+
+  return true;
+}
+
+bool ExporterRun(const char* mapName, const char* formatName, int32_t minX, int32_t minZ, int32_t maxX, int32_t maxZ, const char* path)
+{
+  ExportFormat format;
+  if(!ExporterParseFormat(formatName, &format))
+  {
+    LogError("\"%s\" is no export format; \"vox\" and \"obj\" are supported.", true, formatName);
+
+    return false;
+  }
+
+  MAP_NAME = (int8_t*)mapName;
+
+  char mapPath[256];
+  snprintf(mapPath, ARRAY_SIZE(mapPath), "Maps/%s", mapName);
+
+  //Opening the database would create an empty map.
+  FILE* f = NULL;
+  if(fopen_s(&f, mapPath, "rb") != 0 || f == NULL)
+  {
+    LogError("The map \"%s\" does not exist, hence it cannot be exported.", true, mapName);
+
+    return false;
+  }
+  fclose(f);
+
+  DatabaseInit(mapPath);
+
+  if(!DatabaseHasMapInfo())
+  {
+    LogError("The map \"%s\" has no map information, hence its terrain cannot be exported.", true, mapName);
+    DatabaseFree();
+
+    return false;
+  }
+
+  DatabaseLoadMapInfo();
+  ChunkStoreInit(mapPath, REGION_STORE);
+
+  ExportStats stats;
+  const bool success = ExporterExport(format, minX, minZ, maxX, maxZ, path, 0, &stats);
+
+  ChunkStoreFree();
+  DatabaseFree();
+
+  return success;
+}
\ No newline at end of file
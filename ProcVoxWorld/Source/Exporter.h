@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Export of a rectangle of chunks for offline tools. Every chunk goes through the same steps as in the game (stored or
+ * generated terrain, then its edits) and is written right away, so the memory needed does not depend on the size of the
+ * rectangle. Chunks are processed in batches on all workers, while a writer thread writes the batch before; chunks
+ * are always written row by row (along x, then z), whatever thread finished them first.
+ *
+ * "vox": MagicaVoxel file with a model per chunk (placed by the scene graph) and a palette entry per block type. Only
+ *        blocks next to a transparent one are kept, as the hidden ones would multiply the size for nothing.
+ * "obj": Wavefront OBJ with the mesh of every chunk (land and water separately) as objects of their own; vertices are
+ *        shared within an object, faces refer to them relatively and vertex colors follow the block and its ambient
+ *        occlusion. */
+typedef enum
+{
+  EXPORT_FORMAT_VOX,
+  EXPORT_FORMAT_OBJ
+} ExportFormat;
+
+typedef struct
+{
+  int32_t chunks;
+  int64_t elements; //Voxels or triangles
+  int64_t bytes;
+  double seconds;
+} ExportStats;
+
+//Returns "false" for unknown names.
+bool ExporterParseFormat(const char* name, ExportFormat* format);
+
+/* Exports the chunks from ("minX", "minZ") to ("maxX", "maxZ") (inclusive) of the open map to "path" with "numThreads"
+ * threads (0 = all processor cores); the seed of the map has to be set. */
+bool ExporterExport(ExportFormat format, int32_t minX, int32_t minZ, int32_t maxX, int32_t maxZ, const char* path, int32_t numThreads, ExportStats* stats);
+
+/* Headless export of the map "mapName".
+ * Start with: ProcVoxWorld [configuration path] --export <map name> <vox|obj> <min chunk x> <min chunk z> <max chunk x> <max chunk z> <output path> */
+bool ExporterRun(const char* mapName, const char* formatName, int32_t minX, int32_t minZ, int32_t maxX, int32_t maxZ, const char* path);
\ No newline at end of file
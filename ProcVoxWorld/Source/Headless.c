@@ -0,0 +1,140 @@
+#include "Headless.h"
+
+#include "EditCompactor.h"
+#include "Exporter.h"
+#include "Pregenerator.h"
+#include "Snapshot.h"
+#include "StageTimer.h"
+#include "WorldGenerator.h"
+
+#include "Benchmark/Benchmark.h"
+
+bool HeadlessParseCommandLine(int32_t argCount, const char* argVec[], HeadlessCommandLine* cmd)
+{
+  *cmd = (HeadlessCommandLine){.configPath = "config.ini"};
+
+  for(int32_t i = 1; i < argCount; ++i)
+  {
+    if(strcmp(argVec[i], "--benchmark") == 0 && i + 1 < argCount)
+      cmd->benchmarkName = argVec[++i];
+    else if(strcmp(argVec[i], "--compact-edits") == 0 && i + 1 < argCount)
+      cmd->compactMap = argVec[++i];
+    else if(strcmp(argVec[i], "--restore-snapshot") == 0 && i + 2 < argCount)
+    {
+      cmd->restoreMap = argVec[++i];
+
+      char* end;
+      cmd->restoreSnapshot = (int32_t)strtol(argVec[++i], &end, 10);
+
+      if(*end != '\0')
+      {
+        LogError("\"%s\" is not a valid number for \"--restore-snapshot\".", true, argVec[i]);
+
+        return false;
+      }
+    }
+    else if(strcmp(argVec[i], "--export") == 0 && i + 7 < argCount)
+    {
+      cmd->exportMap = argVec[++i];
+      cmd->exportFormat = argVec[++i];
+
+      for(int32_t arg = 0; arg < 4; ++arg)
+      {
+        char* end;
+        cmd->exportArgs[arg] = (int32_t)strtol(argVec[++i], &end, 10);
+
+        if(*end != '\0')
+        {
+          LogError("\"%s\" is not a valid number for \"--export\".", true, argVec[i]);
+
+          return false;
+        }
+      }
+
+      cmd->exportPath = argVec[++i];
+    }
+    else if(strcmp(argVec[i], "--pregenerate") == 0 && i + 5 < argCount)
+    {
+      cmd->pregenerateMap = argVec[++i];
+
+      for(int32_t arg = 0; arg < 4; ++arg)
+      {
+        char* end;
+        cmd->pregenerateArgs[arg] = (int32_t)strtol(argVec[++i], &end, 10);
+
+        if(*end != '\0')
+        {
+          LogError("\"%s\" is not a valid number for \"--pregenerate\".", true, argVec[i]);
+
+          return false;
+        }
+      }
+    }
+    else
+    {
+      cmd->configPath = argVec[i];
+      cmd->hasConfigPath = true;
+    }
+  }
+
+  return true;
+}
+
+bool HeadlessIsRequested(const HeadlessCommandLine* cmd)
+{
+  return cmd->benchmarkName != NULL || cmd->pregenerateMap != NULL || cmd->compactMap != NULL || cmd->restoreMap != NULL || cmd->exportMap != NULL;
+}
+
+int32_t HeadlessRun(const HeadlessCommandLine* cmd)
+{
+  if(cmd->benchmarkName != NULL)
+  {
+    bool success = BenchmarkRun(cmd->benchmarkName);
+    StageTimerLog();
+    WorldGeneratorFree();
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if(cmd->pregenerateMap != NULL)
+  {
+    bool success = PregeneratorRun(cmd->pregenerateMap, cmd->pregenerateArgs[0], cmd->pregenerateArgs[1], cmd->pregenerateArgs[2], cmd->pregenerateArgs[3]);
+    StageTimerLog();
+    WorldGeneratorFree();
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if(cmd->compactMap != NULL)
+  {
+    bool success = EditCompactorRun(cmd->compactMap);
+    WorldGeneratorFree();
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if(cmd->restoreMap != NULL)
+  {
+    char restorePath[256];
+    snprintf(restorePath, ARRAY_SIZE(restorePath), "Maps/%s", cmd->restoreMap);
+
+    bool success = SnapshotRestore(restorePath, cmd->restoreSnapshot);
+    WorldGeneratorFree();
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if(cmd->exportMap != NULL)
+  {
+    bool success = ExporterRun(cmd->exportMap, cmd->exportFormat, cmd->exportArgs[0], cmd->exportArgs[1], cmd->exportArgs[2], cmd->exportArgs[3], cmd->exportPath);
+    StageTimerLog();
+    WorldGeneratorFree();
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  LogError("No headless mode was requested.", true);
+  WorldGeneratorFree();
+
+  return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Command line of the game and of the headless build ("HeadlessMain.c"), whose modes neither open a window nor need a GPU.
+ * Usage: ProcVoxWorld [configuration path] [--benchmark <name>]
+ *        ProcVoxWorld [configuration path] [--pregenerate <map name> <seed> <center chunk x> <center chunk z> <radius>]
+ *        ProcVoxWorld [configuration path] [--compact-edits <map name>]
+ *        ProcVoxWorld [configuration path] [--restore-snapshot <map name> <snapshot number>]
+ *        ProcVoxWorld [configuration path] [--export <map name> <vox|obj> <min chunk x> <min chunk z> <max chunk x> <max chunk z> <output path>]
+ * Without a mode, the game starts; the headless build refuses to. */
+typedef struct
+{
+  const char* configPath;
+  bool hasConfigPath;
+
+  const char* benchmarkName;
+  const char* pregenerateMap;
+  const char* compactMap;
+  const char* restoreMap;
+  int32_t restoreSnapshot;
+  const char* exportMap;
+  const char* exportFormat;
+  const char* exportPath;
+  int32_t exportArgs[4]; //Min chunk x and z, max chunk x and z
+  int32_t pregenerateArgs[4]; //Seed, center chunk x and z, radius
+} HeadlessCommandLine;
+
+//Returns "false" if a number of a mode is invalid; "configPath" defaults to "config.ini".
+bool HeadlessParseCommandLine(int32_t argCount, const char* argVec[], HeadlessCommandLine* cmd);
+
+bool HeadlessIsRequested(const HeadlessCommandLine* cmd);
+
+/* Runs the mode of "cmd" once the configuration is loaded and the world generator initialized, and frees the world
+ * generator afterwards. Returns the exit code of the process, which is not zero if the mode failed (e.g. a benchmark
+ * whose golden hashes do not match). */
+int32_t HeadlessRun(const HeadlessCommandLine* cmd);
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "Headless.h"
+
+#include "WorldGenerator.h"
+
+#include <time.h>
+
+/* Entry point of the headless build ("CMakeLists.txt" in the root of the repository), which has the modes of "Headless.h"
+ * but neither the game nor anything of OpenGL, GLFW or the window; hence it also builds and runs on machines without a
+ * GPU (e.g. Linux CI), where "--benchmark worldgen-golden" checks the world generation against its golden hashes. */
+int32_t main(int32_t argCount, const char* argVec[])
+{
+  HeadlessCommandLine cmd;
+  if(!HeadlessParseCommandLine(argCount, argVec, &cmd))
+    return EXIT_FAILURE;
+
+  srand((uint32_t)time(NULL));
+
+  LogInitConsole();
+
+  if(!HeadlessIsRequested(&cmd))
+  {
+    LogError("The headless build cannot start the game; it needs one of the modes \"--benchmark\", \"--pregenerate\", \"--compact-edits\", "
+             "\"--restore-snapshot\" or \"--export\".", true);
+
+    return EXIT_FAILURE;
+  }
+
+  if(!cmd.hasConfigPath)
+    LogInfo("No configuration path was provided, therefore the default configuration path \"%s\" is used.", true, cmd.configPath);
+
+  ConfigurationLoad(cmd.configPath);
+  WorldGeneratorInit();
+
+  return HeadlessRun(&cmd);
+}
\ No newline at end of file
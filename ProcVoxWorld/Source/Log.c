@@ -1,10 +1,103 @@
 #include "Log.h"
 
 #include "CLIFormat.h"
+#include "Utils.h"
 
 #include <stdio.h>
 #include <stdarg.h>
 
+bool STDOUT_SUPPORTS_COLORS = false;
+bool STDERR_SUPPORTS_COLORS = false;
+
+void LogInitConsole()
+{
+#ifdef PLATFORM_WINDOWS
+  HANDLE stdOutHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+  if(stdOutHandle == INVALID_HANDLE_VALUE)
+    LogWarning("The standard output handle could not be retrieved.", true); //Only warnings (no errors with abort), for it is not really severe if the CLI is without colors.
+  else
+  {
+    DWORD conModeOut;
+    if(!GetConsoleMode(stdOutHandle, &conModeOut))
+      LogWarning("The console mode for the standard output (stdout) could not be fetched.", true);
+    else
+    {
+      STDOUT_SUPPORTS_COLORS = true;
+      if(conModeOut & ENABLE_PROCESSED_OUTPUT && conModeOut & ENABLE_VIRTUAL_TERMINAL_PROCESSING) //-> C Operator Precedence: https://en.cppreference.com/w/c/language/operator_precedence
+        LogInfo("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" are already active, allowing colored output for the standard output (stdout).\n", false);
+      else
+      {
+        conModeOut |= ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+        if(!SetConsoleMode(stdOutHandle, conModeOut))
+        {
+          LogWarning("The console mode for the standard output (stdout) could not be set.", true);
+          STDOUT_SUPPORTS_COLORS = false;
+        }
+        else
+          LogSuccess("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" were activated, allowing colored output for the standard output (stdout).\n", false);
+      }
+
+      if(STDOUT_SUPPORTS_COLORS)
+      {
+        LogInfo("Color meaning: Information |", false);
+        LogSuccess("| Success", true);
+      }  
+    }
+  }
+
+  HANDLE stdErrHandle = GetStdHandle(STD_ERROR_HANDLE);
+  if(stdErrHandle == INVALID_HANDLE_VALUE)
+    LogWarning("The standard error handle could not be retrieved.", true);
+  else
+  {
+    DWORD conModeErr;
+    if(!GetConsoleMode(stdErrHandle, &conModeErr))
+      LogWarning("The console mode for standard error (stderr) could not be fetched.", true);
+    else
+    {
+      STDERR_SUPPORTS_COLORS = true;
+      if(conModeErr & ENABLE_PROCESSED_OUTPUT && conModeErr & ENABLE_VIRTUAL_TERMINAL_PROCESSING)
+        LogInfo("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" are already active, allowing colored output for standard error (stderr).\n", false);
+      else
+      {
+        conModeErr |= ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+        if(!SetConsoleMode(stdErrHandle, conModeErr))
+        {
+          LogWarning("The console mode for standard error (stderr) could not be set.", true);
+          STDERR_SUPPORTS_COLORS = false;
+        }
+        else
+          LogSuccess("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" were activated, allowing colored output for standard error (stderr).\n", false);
+      }
+
+      if(STDERR_SUPPORTS_COLORS)
+      {
+        LogInfo("Color meaning: ", false);
+        LogError("Error |", false);
+        LogWarning("| Warning", true);
+      }
+    }
+  }
+#elif defined PLATFORM_POSIX
+  if(isatty(STDOUT_FILENO))
+  {
+    STDOUT_SUPPORTS_COLORS = true; //Standard output is a "tty" (https://www.linusakesson.net/programming/tty/). In 2021, even more so in 2022, most terminal emulators support ANSI TTY escape codes.
+    LogInfo("Colored output for the standard output (stdout) is active.\n", false);
+    LogInfo("Color meaning: Information |", false);
+    LogSuccess("| Success", true);
+  }
+  
+  if(isatty(STDERR_FILENO))
+  {
+    STDERR_SUPPORTS_COLORS = true;
+    LogInfo("Colored output for standard error (stderr) is active.\n", false);
+    LogInfo("Color meaning: ", false);
+    LogError("Error |", false);
+    LogWarning("| Warning", true);
+  }
+#endif
+}
+
 void LogInfo(const char* fmtStr, bool enclosed, ...)
 {
   if(STDOUT_SUPPORTS_COLORS)
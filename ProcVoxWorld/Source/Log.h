@@ -7,6 +7,9 @@
 extern bool STDOUT_SUPPORTS_COLORS;
 extern bool STDERR_SUPPORTS_COLORS;
 
+//Enables colored output where the console supports it ("STDOUT_SUPPORTS_COLORS" and "STDERR_SUPPORTS_COLORS").
+void LogInitConsole();
+
 //Default arguments can be implemented in C, but there is no truly ideal solution: https://stackoverflow.com/questions/1472138/c-default-arguments.
 void LogInfo(const char* fmtStr, bool enclosed, ...);
 
@@ -1,8 +1,7 @@
 #include "Chunk.h"
 #include "Block.h"
 
-#include "glad/glad.h" //If the successor, Glad 2, wasn't still in beta, I would have used it.
-
+#include "../ChunkStore.h"
 #include "../Database.h"
 
 #include "../WorldGenerator.h"
@@ -26,10 +25,10 @@ Chunk* ChunkInit(int32_t cX, int32_t cZ)
   c->isGenerated = false;
   c->isSafeToModify = true;
 
-  c->VAOLand = 0;
-  c->VBOLand = 0;
-  c->VAOWater = 0;
-  c->VBOWater = 0;
+  c->lod = 0;
+
+  MeshPoolInitAllocation(&c->meshLand);
+  MeshPoolInitAllocation(&c->meshWater);
   c->vertexLandCount = 0;
   c->vertexWaterCount = 0;
 
@@ -39,14 +38,24 @@ Chunk* ChunkInit(int32_t cX, int32_t cZ)
   return c;
 }
 
-void ChunkGenerateTerrain(Chunk* c)
+void ChunkAllocBlocks(Chunk* c)
 {
   c->blocks = (uint8_t*)OwnMalloc(BLOCKS_MEMORY_SIZE, false);
 
   if(c->blocks == NULL)
     LogError("Variable \"c->blocks\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+}
 
-  WorldGeneratorGenerateChunk(c);
+void ChunkGenerateTerrain(Chunk* c)
+{
+  ChunkAllocBlocks(c);
+
+  //Stored chunks hold the generated terrain only; all edits are applied on top of either.
+  if(!ChunkStoreLoad(c))
+  {
+    WorldGeneratorGenerateChunk(c);
+    ChunkStoreKeepGenerated(c);
+  }
   DatabaseGetBlocksForChunk(c);
 }
 
@@ -128,21 +137,8 @@ static void BlockSetAmbientOcclusion(uint8_t neighbs[27], float AO[6][4])
   }
 }
 
-void ChunkGenerateMesh(Chunk* c)
+static void GenerateFullMesh(Chunk* c, int32_t* vertexLandCount, int32_t* vertexWaterCount)
 {
-  c->generatedMeshTerrain = (Vertex*)OwnMalloc((uintmax_t)CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT * 36 * sizeof(Vertex), false);
-  c->generatedMeshWater = (Vertex*)OwnMalloc((uintmax_t)CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT * 36 * sizeof(Vertex), false);
-
-  if(c->generatedMeshTerrain == NULL || c->generatedMeshWater == NULL)
-  {
-    LogError("RAM size is insufficient; decreasing the amount of worker threads should help!", true);
-
-    exit(EXIT_FAILURE);
-  }
-
-  int32_t currVertexLandCount = 0;
-  int32_t currVertexWaterCount = 0;
-
   for(int32_t x = 0; x < CHUNK_WIDTH; ++x)
   {
     for(int32_t y = 0; y < CHUNK_HEIGHT; ++y)
@@ -174,68 +170,280 @@ void ChunkGenerateMesh(Chunk* c)
           uint8_t blockAbove = c->blocks[XYZ(x, y + 1, z)];
           int32_t makeShorter = (blockAbove == AIR_BLOCK);
 
-          GenCubeVertices(c->generatedMeshWater, &currVertexWaterCount, bX, bY, bZ, block, BLOCK_SIZE, makeShorter, faces, AO);
+          GenCubeVertices(c->generatedMeshWater, vertexWaterCount, bX, bY, bZ, block, BLOCK_SIZE, makeShorter, faces, AO);
         }
         else
         {
           if(BlockIsPlant(block))
-            GenPlantVertices(c->generatedMeshTerrain, &currVertexLandCount, bX, bY, bZ, block, BLOCK_SIZE);
+            GenPlantVertices(c->generatedMeshTerrain, vertexLandCount, bX, bY, bZ, block, BLOCK_SIZE);
           else
-            GenCubeVertices(c->generatedMeshTerrain, &currVertexLandCount, bX, bY, bZ, block, BLOCK_SIZE, 0, faces, AO);
+            GenCubeVertices(c->generatedMeshTerrain, vertexLandCount, bX, bY, bZ, block, BLOCK_SIZE, 0, faces, AO);
         }
       }
     }
   }
+}
 
-  c->vertexLandCount = currVertexLandCount;
-  c->vertexWaterCount = currVertexWaterCount;
+/* Block of a cell of "scale" x "scale" x "scale" blocks, whose lowest corner is block ("x0", "y0", "z0"): its topmost solid block
+ * if most of it (or any block of the chunk's border layer) is solid, else water if it contains any, else air.
+ * Plants are too small to matter at this distance. */
+static uint8_t ClassifyLodCell(Chunk* c, int32_t x0, int32_t y0, int32_t z0, int32_t scale)
+{
+  int32_t numSolid = 0;
+  bool hasWater = false;
+  bool borderSolid = false;
+  uint8_t top = AIR_BLOCK;
+
+  for(int32_t y = y0 + scale - 1; y >= y0; --y)
+  {
+    for(int32_t x = x0; x < x0 + scale; ++x)
+    {
+      for(int32_t z = z0; z < z0 + scale; ++z)
+      {
+        uint8_t block = c->blocks[XYZ(x, y, z)];
+        if(block == AIR_BLOCK || BlockIsPlant(block))
+          continue;
+
+        if(block == WATER_BLOCK)
+        {
+          hasWater = true;
+          continue;
+        }
+
+        if(top == AIR_BLOCK)
+          top = block;
+
+        ++numSolid;
+        borderSolid |= (x == 0 || x == CHUNK_WIDTH - 1 || z == 0 || z == CHUNK_WIDTH - 1);
+      }
+    }
+  }
+
+  if(2 * numSolid >= scale * scale * scale || borderSolid)
+    return top;
+
+  return hasWater ? WATER_BLOCK : AIR_BLOCK;
 }
 
-void ChunkUploadMeshToGPU(Chunk* c)
+/* Cells of the neighbour chunks only have the one block wide border of "blocks" (["x0", "x1") x ["y0", "y1") x ["z0", "z1")):
+ * such a cell is only opaque if all of its border blocks are, so faces towards it are rather drawn once too often than missing. */
+static uint8_t ClassifyLodBorderCell(Chunk* c, int32_t x0, int32_t x1, int32_t y0, int32_t y1, int32_t z0, int32_t z1)
 {
-  if(c->isGenerated)
+  bool hasWater = false;
+  uint8_t top = AIR_BLOCK;
+
+  for(int32_t y = y1 - 1; y >= y0; --y)
   {
-    glDeleteVertexArrays(2, (const GLuint[]) {c->VAOLand, c->VAOWater});
-    glDeleteBuffers(2, (const GLuint[]) {c->VBOLand, c->VBOWater});
+    for(int32_t x = x0; x < x1; ++x)
+    {
+      for(int32_t z = z0; z < z1; ++z)
+      {
+        uint8_t block = c->blocks[XYZ(x, y, z)];
+        if(block == AIR_BLOCK || BlockIsPlant(block))
+          return AIR_BLOCK;
+
+        if(block == WATER_BLOCK)
+          hasWater = true;
+        else if(top == AIR_BLOCK)
+          top = block;
+      }
+    }
   }
 
-  c->VAOLand = OpenGLCreateVAO();
-  c->VBOLand = OpenGLCreateVBO(c->generatedMeshTerrain, c->vertexLandCount * sizeof(Vertex));
-  free(c->generatedMeshTerrain);
-  c->generatedMeshTerrain = NULL;
+  return hasWater ? WATER_BLOCK : top;
+}
 
-  OpenGL_VBOLayout(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
-  OpenGL_VBOLayout(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), 3 * sizeof(float));
-  OpenGL_VBOLayout(2, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), 5 * sizeof(float));
-  OpenGL_VBOLayout(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(Vertex), 6 * sizeof(float));
-  OpenGL_VBOLayout(4, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(Vertex), 6 * sizeof(float) + 1);
-
-  /* Newer OpenGL:
-   * OpenGL_VBOLayout(c->VAOLand, c->VBOLand, 0, 0, 3, GL_FLOAT, GL_FALSE, 0, sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOLand, c->VBOLand, 1, 0, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float), sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOLand, c->VBOLand, 2, 0, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOLand, c->VBOLand, 3, 0, 1, GL_UNSIGNED_BYTE, GL_FALSE, 6 * sizeof(float), sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOLand, c->VBOLand, 4, 0, 1, GL_UNSIGNED_BYTE, GL_FALSE, 6 * sizeof(float) + 1, sizeof(Vertex)); */
-
-  c->VAOWater = OpenGLCreateVAO();
-  c->VBOWater = OpenGLCreateVBO(c->generatedMeshWater, c->vertexWaterCount * sizeof(Vertex));
-  free(c->generatedMeshWater);
-  c->generatedMeshWater = NULL;
+//Range of blocks along x or z of cell "cell" of "numCells" cells; the cells -1 and "numCells" lie in the border.
+static void GetLodCellRange(int32_t cell, int32_t numCells, int32_t scale, int32_t* first, int32_t* last)
+{
+  if(cell < 0)
+  {
+    *first = -1;
+    *last = 0;
+  }
+  else if(cell == numCells)
+  {
+    *first = CHUNK_WIDTH;
+    *last = CHUNK_WIDTH + 1;
+  }
+  else
+  {
+    *first = cell * scale;
+    *last = *first + scale;
+  }
+}
+
+static void GenerateLodMesh(Chunk* c, int32_t* vertexLandCount, int32_t* vertexWaterCount)
+{
+  const int32_t scale = 1 << c->lod;
+  const int32_t width = CHUNK_WIDTH / scale;
+  const int32_t height = CHUNK_HEIGHT / scale;
+
+  //Neighbour cells in the order of the faces.
+  static const int32_t dirs[6][3] = {{-1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+  //Cells including a layer of neighbour cells around them, laid out like "blocks".
+#define CELL(x, y, z) ((((x) + 1) * (height + 2) + ((y) + 1)) * (width + 2) + ((z) + 1))
+  uint8_t* cells = (uint8_t*)OwnMalloc((size_t)(width + 2) * (height + 2) * (width + 2), false);
 
- OpenGL_VBOLayout(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
- OpenGL_VBOLayout(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), 3 * sizeof(float));
- OpenGL_VBOLayout(2, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), 5 * sizeof(float));
- OpenGL_VBOLayout(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(Vertex), 6 * sizeof(float));
- OpenGL_VBOLayout(4, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(Vertex), 6 * sizeof(float) + 1);
+  if(cells == NULL)
+  {
+    LogError("Variable \"cells\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return;
+  }
+
+  for(int32_t x = -1; x <= width; ++x)
+  {
+    int32_t x0, x1;
+    GetLodCellRange(x, width, scale, &x0, &x1);
+
+    for(int32_t y = -1; y <= height; ++y)
+    {
+      for(int32_t z = -1; z <= width; ++z)
+      {
+        int32_t z0, z1;
+        GetLodCellRange(z, width, scale, &z0, &z1);
+
+        //Nothing below the world is ever seen.
+        if(y < 0)
+          cells[CELL(x, y, z)] = STONE_BLOCK;
+        else if(y == height)
+          cells[CELL(x, y, z)] = AIR_BLOCK;
+        else if(x >= 0 && x < width && z >= 0 && z < width)
+          cells[CELL(x, y, z)] = ClassifyLodCell(c, x0, y * scale, z0, scale);
+        else
+          cells[CELL(x, y, z)] = ClassifyLodBorderCell(c, x0, x1, y * scale, (y + 1) * scale, z0, z1);
+      }
+    }
+  }
+
+  for(int32_t x = 0; x < width; ++x)
+  {
+    for(int32_t y = 0; y < height; ++y)
+    {
+      for(int32_t z = 0; z < width; ++z)
+      {
+        uint8_t cell = cells[CELL(x, y, z)];
+        if(cell == AIR_BLOCK)
+          continue;
 
-  /* Newer OpenGL:
-   * OpenGL_VBOLayout(c->VAOWater, c->VBOWater, 0, 0, 3, GL_FLOAT, GL_FALSE, 0, sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOWater, c->VBOWater, 1, 0, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float), sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOWater, c->VBOWater, 2, 0, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOWater, c->VBOWater, 3, 0, 1, GL_UNSIGNED_BYTE, GL_FALSE, 6 * sizeof(float), sizeof(Vertex));
-   * OpenGL_VBOLayout(c->VAOWater, c->VBOWater, 4, 0, 1, GL_UNSIGNED_BYTE, GL_FALSE, 6 * sizeof(float) + 1, sizeof(Vertex)); */
+        //Same rule as "ShouldBeVisible()".
+        int32_t faces[6];
+        int32_t numVisible = 0;
+        for(uint32_t f = 0; f < 6; ++f)
+        {
+          uint8_t neighb = cells[CELL(x + dirs[f][0], y + dirs[f][1], z + dirs[f][2])];
+          faces[f] = BlockIsTransparent(neighb) && cell != neighb;
+          numVisible += faces[f];
+        }
+
+        if(numVisible == 0)
+          continue;
+
+        //Same order as "BlockGetNeighbours()".
+        uint8_t neighbs[27];
+        int32_t index = 0;
+        for(int32_t dY = -1; dY <= 1; ++dY)
+        {
+          for(int32_t dX = -1; dX <= 1; ++dX)
+          {
+            for(int32_t dZ = -1; dZ <= 1; ++dZ, ++index)
+              neighbs[index] = cells[CELL(x + dX, y + dY, z + dZ)];
+          }
+        }
 
-  c->isGenerated = true;
+        float AO[6][4];
+        BlockSetAmbientOcclusion(neighbs, AO);
+
+        int32_t cX = x + (c->x * width);
+        int32_t cZ = z + (c->z * width);
+
+        if(cell == WATER_BLOCK)
+        {
+          int32_t first = *vertexWaterCount;
+          GenCubeVertices(c->generatedMeshWater, vertexWaterCount, cX, y, cZ, cell, scale * BLOCK_SIZE, 0, faces, AO);
+
+          //The surface stays at the real water level, so it lines up with chunks of any other level of detail.
+          if(cells[CELL(x, y + 1, z)] == AIR_BLOCK)
+          {
+            int32_t waterTop = y * scale;
+            for(int32_t bY = y * scale; bY < (y + 1) * scale; ++bY)
+            {
+              for(int32_t bX = x * scale; bX < (x + 1) * scale; ++bX)
+              {
+                for(int32_t bZ = z * scale; bZ < (z + 1) * scale; ++bZ)
+                {
+                  if(c->blocks[XYZ(bX, bY, bZ)] == WATER_BLOCK)
+                    waterTop = bY + 1;
+                }
+              }
+            }
+
+            const float surface = (waterTop - 0.125f) * BLOCK_SIZE;
+            for(int32_t i = first; i < *vertexWaterCount; ++i)
+              c->generatedMeshWater[i].pos[1] = MIN(c->generatedMeshWater[i].pos[1], surface);
+          }
+        }
+        else
+          GenCubeVertices(c->generatedMeshTerrain, vertexLandCount, cX, y, cZ, cell, scale * BLOCK_SIZE, 0, faces, AO);
+      }
+    }
+  }
+
+#undef CELL
+
+  free(cells);
+}
+
+void ChunkGenerateMesh(Chunk* c)
+{
+  //Every level of detail has an eighth of the cells of the previous one.
+  const uintmax_t maxVertices = ((uintmax_t)CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT >> (3 * c->lod)) * 36;
+
+  c->generatedMeshTerrain = (Vertex*)OwnMalloc(maxVertices * sizeof(Vertex), false);
+  c->generatedMeshWater = (Vertex*)OwnMalloc(maxVertices * sizeof(Vertex), false);
+
+  if(c->generatedMeshTerrain == NULL || c->generatedMeshWater == NULL)
+  {
+    LogError("RAM size is insufficient; decreasing the amount of worker threads should help!", true);
+
+    exit(EXIT_FAILURE);
+  }
+
+  int32_t currVertexLandCount = 0;
+  int32_t currVertexWaterCount = 0;
+
+  if(c->lod > 0)
+    GenerateLodMesh(c, &currVertexLandCount, &currVertexWaterCount);
+  else
+    GenerateFullMesh(c, &currVertexLandCount, &currVertexWaterCount);
+
+  c->vertexLandCount = currVertexLandCount;
+  c->vertexWaterCount = currVertexWaterCount;
+}
+
+//Margin (in chunks) a chunk has to be beyond a ring before its level of detail changes.
+static const int32_t lodHysteresis = 1;
+
+int32_t ChunkSelectLod(int32_t currLod, int32_t distSquared)
+{
+  const int32_t rings[CHUNK_MAX_LOD] = {CHUNK_LOD1_DISTANCE, CHUNK_LOD2_DISTANCE};
+
+  //The cells of a level have to divide the chunk evenly.
+  int32_t maxLod = 0;
+  while(maxLod < CHUNK_MAX_LOD && rings[maxLod] > 0 && CHUNK_WIDTH % (2 << maxLod) == 0 && CHUNK_HEIGHT % (2 << maxLod) == 0)
+    ++maxLod;
+
+  int32_t lod = MIN(currLod, maxLod);
+
+  while(lod < maxLod && distSquared > (rings[lod] + lodHysteresis) * (rings[lod] + lodHysteresis))
+    ++lod;
+
+  while(lod > 0 && distSquared < MAX(0, rings[lod - 1] - lodHysteresis) * MAX(0, rings[lod - 1] - lodHysteresis))
+    --lod;
+
+  return lod;
 }
 
 bool ChunkIsVisible(int32_t cX, int32_t cZ, vec4 planes[6])
@@ -255,11 +463,7 @@ bool ChunkIsVisible(int32_t cX, int32_t cZ, vec4 planes[6])
 void ChunkDelete(Chunk* c)
 {
   if(c->isGenerated)
-  {
-    glDeleteVertexArrays(2, (const GLuint[]) {c->VAOLand, c->VAOWater});
-    glDeleteBuffers(2, (const GLuint[]) {c->VBOLand, c->VBOWater});
     free(c->blocks);
-  }
 
   if(c->generatedMeshTerrain)
   {
@@ -2,10 +2,16 @@
 
 #include "../Utils.h"
 
+#include "MeshPool.h"
+
 #define XYZ(x, y, z)   (((x) + 1) * CHUNK_WIDTH_REAL * CHUNK_HEIGHT_REAL) \
                      + (((y) + 1) * CHUNK_WIDTH_REAL)                     \
                      +  ((z) + 1)
 
+/* Chunks beyond the configured rings are meshed at a lower level of detail: level "n" merges 2^n x 2^n x 2^n blocks into one cell.
+ * Cells along the chunk borders are filled if any block of the border layer is, so a coarse chunk never leaves a gap next to a finer one. */
+#define CHUNK_MAX_LOD 2
+
 typedef struct
 {
   uint8_t* blocks;
@@ -15,10 +21,10 @@ typedef struct
   bool isGenerated;
   bool isSafeToModify;
 
-  GLuint VAOLand;
-  GLuint VBOLand;
-  GLuint VAOWater;
-  GLuint VBOWater;
+  int32_t lod; //Level of detail of the next mesh; only changed while "isSafeToModify" is set.
+
+  MeshAllocation meshLand; //On the GPU
+  MeshAllocation meshWater;
   size_t vertexLandCount;
   size_t vertexWaterCount;
 
@@ -28,14 +34,30 @@ typedef struct
 
 Chunk* ChunkInit(int32_t cX, int32_t cZ);
 
+void ChunkAllocBlocks(Chunk* c);
+
 void ChunkGenerateTerrain(Chunk* c);
 
 void ChunkGenerateMesh(Chunk* c);
 
+/* Level of detail for a chunk "distSquared" (squared distance in chunks) away from the player, whose mesh has level "currLod".
+ * A chunk only changes its level once it is a margin beyond a ring, so it does not flip back and forth at the ring. */
+int32_t ChunkSelectLod(int32_t currLod, int32_t distSquared);
+
+//Attributes of "Vertex" for the bound vertex array object (see "MeshPoolInit()").
+void ChunkSetVertexLayout();
+
+//Changes with the attributes of "Vertex" or their layout, i.e. whenever meshes written before would be read wrongly.
+uint32_t ChunkGetVertexLayoutHash();
+
 void ChunkUploadMeshToGPU(Chunk* c);
 
+//Gives the ranges of both meshes back to the mesh pool (see "MeshPoolRelease()").
+void ChunkReleaseMeshes(Chunk* c);
+
 bool ChunkIsVisible(int32_t cX, int32_t cZ, vec4 planes[6]);
 
+//The meshes of a chunk on the GPU have to be released with "ChunkReleaseMeshes()" before.
 void ChunkDelete(Chunk* c);
 
 //----- Inline -----
@@ -0,0 +1,75 @@
+#include "Chunk.h"
+
+#include "glad/glad.h" //If the successor, Glad 2, wasn't still in beta, I would have used it.
+
+//The parts of chunks which need the OpenGL context; "Chunk.c" stays usable without one (e.g. by the headless build).
+
+typedef struct
+{
+  GLint size;
+  GLenum type;
+  uint32_t offset;
+} VertexAttribute;
+
+//Attribute "i" of "Vertex" is at location "i" of the shaders.
+static const VertexAttribute sVertexLayout[] =
+{
+  {3, GL_FLOAT, 0},
+  {2, GL_FLOAT, 3 * sizeof(float)},
+  {1, GL_FLOAT, 5 * sizeof(float)},
+  {1, GL_UNSIGNED_BYTE, 6 * sizeof(float)},
+  {1, GL_UNSIGNED_BYTE, 6 * sizeof(float) + 1}
+};
+
+void ChunkSetVertexLayout()
+{
+  for(uint32_t i = 0; i < ARRAY_SIZE(sVertexLayout); ++i)
+    OpenGL_VBOLayout(i, sVertexLayout[i].size, sVertexLayout[i].type, GL_FALSE, sizeof(Vertex), sVertexLayout[i].offset);
+
+  /* Newer OpenGL:
+   * OpenGL_VBOLayout(VAO, VBO, i, 0, sVertexLayout[i].size, sVertexLayout[i].type, GL_FALSE, sVertexLayout[i].offset, sizeof(Vertex)); */
+}
+
+uint32_t ChunkGetVertexLayoutHash()
+{
+  //FNV-1a
+  uint32_t hash = 2166136261U;
+  const uint32_t values[] = {(uint32_t)sizeof(Vertex), (uint32_t)ARRAY_SIZE(sVertexLayout)};
+  const uint8_t* bytes = (const uint8_t*)values;
+  for(size_t i = 0; i < sizeof(values); ++i)
+    hash = (hash ^ bytes[i]) * 16777619U;
+
+  bytes = (const uint8_t*)sVertexLayout;
+  for(size_t i = 0; i < sizeof(sVertexLayout); ++i)
+    hash = (hash ^ bytes[i]) * 16777619U;
+
+  return hash;
+}
+
+void ChunkUploadMeshToGPU(Chunk* c)
+{
+  //A remeshed chunk keeps its ranges as long as the new meshes fit.
+  const bool landUploaded = MeshPoolUpload(&c->meshLand, c->generatedMeshTerrain, (uint32_t)c->vertexLandCount);
+  const bool waterUploaded = MeshPoolUpload(&c->meshWater, c->generatedMeshWater, (uint32_t)c->vertexWaterCount);
+
+  if(!landUploaded || !waterUploaded)
+  {
+    LogError("The GPU memory for the meshes of chunk (%d, %d) could not be allocated, hence they are not drawn.", true, c->x, c->z);
+
+    c->vertexLandCount = c->meshLand.count;
+    c->vertexWaterCount = c->meshWater.count;
+  }
+
+  free(c->generatedMeshTerrain);
+  c->generatedMeshTerrain = NULL;
+  free(c->generatedMeshWater);
+  c->generatedMeshWater = NULL;
+
+  c->isGenerated = true;
+}
+
+void ChunkReleaseMeshes(Chunk* c)
+{
+  MeshPoolRelease(&c->meshLand);
+  MeshPoolRelease(&c->meshWater);
+}
\ No newline at end of file
@@ -0,0 +1,640 @@
+#include "FarTerrain.h"
+
+#include "Map.h"
+
+#include "../HashMap.h"
+#include "../NoiseGenerator.h"
+#include "../Shader.h"
+#include "../WorldGenerator.h"
+
+#include "TinyCThread/tinycthread.h"
+
+#include <float.h>
+
+//Vertices of a patch: the grid and a skirt along every edge, which hides the cracks towards coarser neighbours.
+#define FAR_TERRAIN_GRID_VERTICES  ((FAR_TERRAIN_PATCH_QUADS + 1) * (FAR_TERRAIN_PATCH_QUADS + 1))
+#define FAR_TERRAIN_VERTEX_COUNT   (FAR_TERRAIN_GRID_VERTICES + 4 * (FAR_TERRAIN_PATCH_QUADS + 1))
+#define FAR_TERRAIN_INDEX_COUNT    ((FAR_TERRAIN_PATCH_QUADS * FAR_TERRAIN_PATCH_QUADS + 4 * FAR_TERRAIN_PATCH_QUADS) * 6)
+
+//Patches which are queued, sampled or waiting for the upload at most; requests beyond are repeated in later frames.
+#define FAR_TERRAIN_MAX_PENDING 256
+
+//Upper limit of the patches drawn in one frame.
+#define FAR_TERRAIN_MAX_SELECTED 1024
+
+static const int32_t uploadsPerFrame = 8;  //Uploads are cheap, but a whole ring of patches at once would still stutter.
+static const int32_t keepFrames = 300;     //Patches which have not been used for this many frames are freed.
+static const float splitFactor = 2.0f;     //A patch is split if the player is closer than this many patch widths.
+static const float sinkBlocks = 1.0f;      //Lowered slightly, so the voxel terrain wins wherever both overlap.
+
+typedef enum
+{
+  PATCH_QUEUED,
+  PATCH_SAMPLING,
+  PATCH_SAMPLED,
+  PATCH_READY
+} FarPatchState;
+
+typedef struct
+{
+  float pos[3];
+  uint8_t color[4];
+  int8_t normal[4];
+} FarTerrainVertex;
+
+typedef struct
+{
+  int32_t level;
+  int32_t pX, pZ; //In patch widths of its level
+
+  FarPatchState state;
+  uint32_t lastUsed;
+
+  float minY, maxY;
+  FarTerrainVertex* vertices; //Until the upload
+
+  GLuint VAO;
+  GLuint VBO;
+} FarPatch;
+
+static inline uint32_t FarPatchHashFunc2(int32_t level, int32_t pX, int32_t pZ)
+{
+  return NoiseGeneratorMix(((uint32_t)pX * 73856093) ^ ((uint32_t)pZ * 19349663) ^ ((uint32_t)level * 83492791));
+}
+
+static inline uint32_t FarPatchHashFunc(FarPatch* patch)
+{
+  return FarPatchHashFunc2(patch->level, patch->pX, patch->pZ);
+}
+
+HASH_MAP_DECLARATION(FarPatch*, FarPatches);
+HASH_MAP_IMPLEMENTATION(FarPatch*, FarPatches, FarPatchHashFunc);
+
+//Only the main thread accesses the map; the queues and patch states are shared with the background thread.
+static HashMapFarPatches* sPatches;
+
+static FarPatch* sSelected[FAR_TERRAIN_MAX_SELECTED];
+static int32_t sNumSelected;
+
+static FarPatch* sQueue[FAR_TERRAIN_MAX_PENDING];
+static int32_t sQueueHead, sQueueCount;
+
+static FarPatch* sSampled[FAR_TERRAIN_MAX_PENDING];
+static int32_t sSampledHead, sSampledCount;
+
+static int32_t sNumPending;
+static bool sExit;
+
+static mtx_t sMtx;
+static cnd_t sCondVar;
+static thrd_t sThread;
+
+static GLuint sIndexBuffer;
+static uint32_t sFrame;
+
+//Edge length of a patch of "level" in blocks.
+static int32_t PatchWidth(int32_t level)
+{
+  return FAR_TERRAIN_PATCH_QUADS * (8 << level);
+}
+
+static FarPatch* GetPatch(int32_t level, int32_t pX, int32_t pZ)
+{
+  uint32_t index = FarPatchHashFunc2(level, pX, pZ) % sPatches->arraySize;
+  LinkedListNodeMapFarPatches* node = sPatches->array[index]->head;
+
+  while(node && !(node->data->level == level && node->data->pX == pX && node->data->pZ == pZ))
+    node = node->ptrNext;
+
+  return node ? node->data : NULL;
+}
+
+static int32_t FloorDiv(int32_t a, int32_t b)
+{
+  return a >= 0 ? a / b : (a + 1) / b - 1;
+}
+
+static void GetColor(Biome biome, int32_t height, uint8_t color[4])
+{
+  //Roughly the average colours of the surface blocks.
+  static const uint8_t colors[][3] =
+  {
+    {92, 153, 56},   //Plains
+    {46, 107, 38},   //Forest
+    {77, 133, 51},   //Flower forest
+    {128, 128, 128}, //Mountains
+    {219, 204, 140}, //Desert
+    {194, 178, 128}  //Water (the sand of the ground)
+  };
+
+  static const uint8_t waterColor[3] = {41, 87, 158};
+  static const uint8_t snowColor[3] = {235, 235, 240};
+
+  const uint8_t* c = colors[biome];
+  if(height < WORLD_GEN_WATER_LEVEL)
+    c = waterColor;
+  else if(biome == BIOME_MOUNTAINS && height >= 100) //The snow line of "GenMountains()"
+    c = snowColor;
+
+  color[0] = c[0];
+  color[1] = c[1];
+  color[2] = c[2];
+  color[3] = 255;
+}
+
+//Samples the heights (with one sample around for the normals) and builds the vertices; runs on the background thread.
+static void SamplePatch(noiseState* noiseState, FarPatch* patch)
+{
+  const int32_t spacing = 8 << patch->level;
+  const int32_t side = FAR_TERRAIN_PATCH_QUADS + 3;
+
+  const int32_t bX = patch->pX * PatchWidth(patch->level) - spacing;
+  const int32_t bZ = patch->pZ * PatchWidth(patch->level) - spacing;
+
+  Biome biomes[(FAR_TERRAIN_PATCH_QUADS + 3) * (FAR_TERRAIN_PATCH_QUADS + 3)];
+  int32_t heights[(FAR_TERRAIN_PATCH_QUADS + 3) * (FAR_TERRAIN_PATCH_QUADS + 3)];
+  float surface[(FAR_TERRAIN_PATCH_QUADS + 3) * (FAR_TERRAIN_PATCH_QUADS + 3)];
+
+  for(int32_t i = 0; i < side; ++i)
+    WorldGeneratorSampleCoarseRow(noiseState, bX + i * spacing, bZ, spacing, side, &biomes[i * side], &heights[i * side]);
+
+  //Top of the surface block; lakes and oceans are flat.
+  for(int32_t i = 0; i < side * side; ++i)
+    surface[i] = (float)(MAX(heights[i], WORLD_GEN_WATER_LEVEL) + 1) - sinkBlocks;
+
+  patch->vertices = (FarTerrainVertex*)OwnMalloc(FAR_TERRAIN_VERTEX_COUNT * sizeof(FarTerrainVertex), false);
+
+  if(patch->vertices == NULL)
+  {
+    LogError("Variable \"patch->vertices\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return;
+  }
+
+  patch->minY = FLT_MAX;
+  patch->maxY = -FLT_MAX;
+
+  for(int32_t i = 0; i <= FAR_TERRAIN_PATCH_QUADS; ++i)
+  {
+    for(int32_t j = 0; j <= FAR_TERRAIN_PATCH_QUADS; ++j)
+    {
+      const int32_t s = (i + 1) * side + (j + 1);
+      FarTerrainVertex* v = &patch->vertices[i * (FAR_TERRAIN_PATCH_QUADS + 1) + j];
+
+      v->pos[0] = (float)(bX + (i + 1) * spacing) * BLOCK_SIZE;
+      v->pos[1] = surface[s] * BLOCK_SIZE;
+      v->pos[2] = (float)(bZ + (j + 1) * spacing) * BLOCK_SIZE;
+
+      vec3 normal = {surface[s - side] - surface[s + side], 2.0f * spacing, surface[s - 1] - surface[s + 1]};
+      glm_vec3_normalize(normal);
+      for(int32_t k = 0; k < 3; ++k)
+        v->normal[k] = (int8_t)roundf(normal[k] * 127.0f);
+      v->normal[3] = 0;
+
+      GetColor(biomes[s], heights[s], v->color);
+
+      patch->minY = MIN(patch->minY, v->pos[1]);
+      patch->maxY = MAX(patch->maxY, v->pos[1]);
+    }
+  }
+
+  //The skirts hang down from the edges; the neighbours differ at most by what lies between two coarse samples.
+  const float skirtDepth = 4.0f * spacing * BLOCK_SIZE;
+
+  for(int32_t edge = 0; edge < 4; ++edge)
+  {
+    for(int32_t k = 0; k <= FAR_TERRAIN_PATCH_QUADS; ++k)
+    {
+      int32_t i = edge == 0 ? 0 : edge == 1 ? FAR_TERRAIN_PATCH_QUADS : k;
+      int32_t j = edge == 2 ? 0 : edge == 3 ? FAR_TERRAIN_PATCH_QUADS : k;
+
+      FarTerrainVertex* v = &patch->vertices[FAR_TERRAIN_GRID_VERTICES + edge * (FAR_TERRAIN_PATCH_QUADS + 1) + k];
+      *v = patch->vertices[i * (FAR_TERRAIN_PATCH_QUADS + 1) + j];
+      v->pos[1] -= skirtDepth;
+    }
+  }
+
+  patch->minY -= skirtDepth;
+}
+
+static int32_t FarTerrainLoop(void* data)
+{
+  noiseState* noiseState = NoiseGeneratorCreateState();
+
+  while(true)
+  {
+    mtx_lock(&sMtx);
+    while(sQueueCount == 0 && !sExit)
+      cnd_wait(&sCondVar, &sMtx);
+
+    if(sExit)
+    {
+      mtx_unlock(&sMtx);
+
+      break;
+    }
+
+    FarPatch* patch = sQueue[sQueueHead];
+    sQueueHead = (sQueueHead + 1) % FAR_TERRAIN_MAX_PENDING;
+    --sQueueCount;
+
+    patch->state = PATCH_SAMPLING;
+    mtx_unlock(&sMtx);
+
+    if(noiseState != NULL)
+      SamplePatch(noiseState, patch);
+
+    mtx_lock(&sMtx);
+    patch->state = PATCH_SAMPLED;
+    sSampled[(sSampledHead + sSampledCount) % FAR_TERRAIN_MAX_PENDING] = patch;
+    ++sSampledCount;
+    mtx_unlock(&sMtx);
+  }
+
+  free(noiseState);
+
+  data; //A reference to resolve "C4100".
+
+  thrd_exit(0);
+
+#pragma warning(suppress: 4702) //This code segment is actually unreachable - never mind!
+  return 0; //Against "C4716": "function" must return a value.
+}
+
+static void CreateIndexBuffer()
+{
+  uint16_t* indices = (uint16_t*)OwnMalloc(FAR_TERRAIN_INDEX_COUNT * sizeof(uint16_t), false);
+
+  if(indices == NULL)
+  {
+    LogError("Variable \"indices\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return;
+  }
+
+#define GRID(i, j)    ((uint16_t)((i) * (FAR_TERRAIN_PATCH_QUADS + 1) + (j)))
+#define SKIRT(e, k)   ((uint16_t)(FAR_TERRAIN_GRID_VERTICES + (e) * (FAR_TERRAIN_PATCH_QUADS + 1) + (k)))
+#define EDGE(e, k)    ((e) == 0 ? GRID(0, k) : (e) == 1 ? GRID(FAR_TERRAIN_PATCH_QUADS, k) : (e) == 2 ? GRID(k, 0) : GRID(k, FAR_TERRAIN_PATCH_QUADS))
+
+  int32_t n = 0;
+  for(int32_t i = 0; i < FAR_TERRAIN_PATCH_QUADS; ++i)
+  {
+    for(int32_t j = 0; j < FAR_TERRAIN_PATCH_QUADS; ++j)
+    {
+      const uint16_t quad[6] = {GRID(i, j), GRID(i, j + 1), GRID(i + 1, j), GRID(i + 1, j), GRID(i, j + 1), GRID(i + 1, j + 1)};
+      memcpy(&indices[n], quad, sizeof(quad));
+      n += 6;
+    }
+  }
+
+  for(int32_t e = 0; e < 4; ++e)
+  {
+    for(int32_t k = 0; k < FAR_TERRAIN_PATCH_QUADS; ++k)
+    {
+      const uint16_t quad[6] = {EDGE(e, k), SKIRT(e, k), EDGE(e, k + 1), EDGE(e, k + 1), SKIRT(e, k), SKIRT(e, k + 1)};
+      memcpy(&indices[n], quad, sizeof(quad));
+      n += 6;
+    }
+  }
+
+#undef GRID
+#undef SKIRT
+#undef EDGE
+
+  glGenBuffers(1, &sIndexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sIndexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, FAR_TERRAIN_INDEX_COUNT * sizeof(uint16_t), indices, GL_STATIC_DRAW);
+
+  free(indices);
+}
+
+void FarTerrainInit()
+{
+  sPatches = HashMapFarPatchesCreate(512);
+
+  sNumSelected = 0;
+  sQueueHead = sQueueCount = 0;
+  sSampledHead = sSampledCount = 0;
+  sNumPending = 0;
+  sExit = false;
+  sFrame = 0;
+
+  //Bound to the vertex arrays of the patches, which all share the same topology.
+  glBindVertexArray(0);
+  CreateIndexBuffer();
+
+  mtx_init(&sMtx, mtx_plain);
+  cnd_init(&sCondVar);
+  thrd_create(&sThread, FarTerrainLoop, NULL);
+
+  LogInfo("The far terrain is drawn up to %d blocks.", true, FAR_TERRAIN_DISTANCE);
+}
+
+static void UploadPatch(FarPatch* patch)
+{
+  patch->VAO = OpenGLCreateVAO();
+  patch->VBO = OpenGLCreateVBO(patch->vertices, FAR_TERRAIN_VERTEX_COUNT * sizeof(FarTerrainVertex));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sIndexBuffer);
+
+  OpenGL_VBOLayout(0, 3, GL_FLOAT, GL_FALSE, sizeof(FarTerrainVertex), 0);
+  OpenGL_VBOLayout(1, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(FarTerrainVertex), 3 * sizeof(float));
+  OpenGL_VBOLayout(2, 4, GL_BYTE, GL_FALSE, sizeof(FarTerrainVertex), 3 * sizeof(float) + 4);
+
+  glBindVertexArray(0);
+
+  free(patch->vertices);
+  patch->vertices = NULL;
+  patch->state = PATCH_READY;
+}
+
+static void UploadSampledPatches()
+{
+  for(int32_t i = 0; i < uploadsPerFrame; ++i)
+  {
+    mtx_lock(&sMtx);
+    if(sSampledCount == 0)
+    {
+      mtx_unlock(&sMtx);
+
+      return;
+    }
+
+    FarPatch* patch = sSampled[sSampledHead];
+    sSampledHead = (sSampledHead + 1) % FAR_TERRAIN_MAX_PENDING;
+    --sSampledCount;
+    mtx_unlock(&sMtx);
+
+    --sNumPending;
+
+    //Sampling failed (out of memory); the patch is requested again in the next frame.
+    if(patch->vertices == NULL)
+    {
+      HashMapFarPatchesRemove(sPatches, patch);
+      free(patch);
+
+      continue;
+    }
+
+    UploadPatch(patch);
+  }
+}
+
+//Returns the patch (whatever its state) or requests it; "NULL" if there is no room for another request at the moment.
+static FarPatch* RequirePatch(int32_t level, int32_t pX, int32_t pZ)
+{
+  FarPatch* patch = GetPatch(level, pX, pZ);
+  if(patch != NULL)
+  {
+    patch->lastUsed = sFrame;
+
+    return patch;
+  }
+
+  if(sNumPending == FAR_TERRAIN_MAX_PENDING)
+    return NULL;
+
+  patch = (FarPatch*)OwnMalloc(sizeof(FarPatch), false);
+
+  if(patch == NULL)
+  {
+    LogError("Variable \"patch\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return NULL;
+  }
+
+  *patch = (FarPatch){.level = level, .pX = pX, .pZ = pZ, .state = PATCH_QUEUED, .lastUsed = sFrame};
+  HashMapFarPatchesInsert(sPatches, patch);
+  ++sNumPending;
+
+  mtx_lock(&sMtx);
+  sQueue[(sQueueHead + sQueueCount) % FAR_TERRAIN_MAX_PENDING] = patch;
+  ++sQueueCount;
+  mtx_unlock(&sMtx);
+  cnd_signal(&sCondVar);
+
+  return patch;
+}
+
+//Horizontal distance (in blocks) from the camera to the nearest and the farthest point of a patch.
+static void PatchDistances(int32_t level, int32_t pX, int32_t pZ, float camX, float camZ, float* nearest, float* farthest)
+{
+  const float width = (float)PatchWidth(level);
+  const float x0 = pX * width, z0 = pZ * width;
+
+  const float dX = MAX(MAX(x0 - camX, camX - (x0 + width)), 0.0f);
+  const float dZ = MAX(MAX(z0 - camZ, camZ - (z0 + width)), 0.0f);
+  *nearest = sqrtf(dX * dX + dZ * dZ);
+
+  const float fX = MAX(fabsf(x0 - camX), fabsf(x0 + width - camX));
+  const float fZ = MAX(fabsf(z0 - camZ), fabsf(z0 + width - camZ));
+  *farthest = sqrtf(fX * fX + fZ * fZ);
+}
+
+//Patches beyond the far distance and those completely covered by chunks are left out.
+static bool IsPatchNeeded(int32_t level, int32_t pX, int32_t pZ, float camX, float camZ, float holeRadius)
+{
+  float nearest, farthest;
+  PatchDistances(level, pX, pZ, camX, camZ, &nearest, &farthest);
+
+  return nearest <= FAR_TERRAIN_DISTANCE && farthest >= holeRadius;
+}
+
+/* Selects a patch or, if the player is close enough and all needed children are ready, its children instead.
+ * Children are requested as soon as they are wanted, so the detail increases step by step without holes. */
+static void SelectPatch(int32_t level, int32_t pX, int32_t pZ, float camX, float camZ, float holeRadius)
+{
+  if(!IsPatchNeeded(level, pX, pZ, camX, camZ, holeRadius))
+    return;
+
+  FarPatch* patch = RequirePatch(level, pX, pZ);
+
+  float nearest, farthest;
+  PatchDistances(level, pX, pZ, camX, camZ, &nearest, &farthest);
+
+  if(level > 0 && nearest < splitFactor * PatchWidth(level))
+  {
+    bool childrenReady = true;
+    for(int32_t child = 0; child < 4; ++child)
+    {
+      const int32_t cX = 2 * pX + (child & 1);
+      const int32_t cZ = 2 * pZ + (child >> 1);
+
+      if(!IsPatchNeeded(level - 1, cX, cZ, camX, camZ, holeRadius))
+        continue;
+
+      FarPatch* c = RequirePatch(level - 1, cX, cZ);
+      if(c == NULL || c->state != PATCH_READY)
+        childrenReady = false;
+    }
+
+    if(childrenReady)
+    {
+      for(int32_t child = 0; child < 4; ++child)
+        SelectPatch(level - 1, 2 * pX + (child & 1), 2 * pZ + (child >> 1), camX, camZ, holeRadius);
+
+      return;
+    }
+  }
+
+  if(patch != NULL && patch->state == PATCH_READY && sNumSelected < FAR_TERRAIN_MAX_SELECTED)
+    sSelected[sNumSelected++] = patch;
+}
+
+static void EvictUnusedPatches()
+{
+  FarPatch* toDelete[64];
+  int32_t numToDelete = 0;
+
+  for(uint32_t i = 0; i < sPatches->arraySize && numToDelete < (int32_t)ARRAY_SIZE(toDelete); ++i)
+  {
+    for(LinkedListNodeMapFarPatches* node = sPatches->array[i]->head; node && numToDelete < (int32_t)ARRAY_SIZE(toDelete); node = node->ptrNext)
+    {
+      FarPatch* patch = node->data;
+      if(sFrame - patch->lastUsed < (uint32_t)keepFrames)
+        continue;
+
+      mtx_lock(&sMtx);
+      bool evict = patch->state == PATCH_READY;
+
+      /* Queued patches are taken out of the queue, and the ones behind move up, so the queue never holds more entries
+       * than patches are pending; patches in the hands of the background thread stay for now. */
+      if(patch->state == PATCH_QUEUED)
+      {
+        for(int32_t q = 0; q < sQueueCount; ++q)
+        {
+          if(sQueue[(sQueueHead + q) % FAR_TERRAIN_MAX_PENDING] != patch)
+            continue;
+
+          for(int32_t n = q + 1; n < sQueueCount; ++n)
+            sQueue[(sQueueHead + n - 1) % FAR_TERRAIN_MAX_PENDING] = sQueue[(sQueueHead + n) % FAR_TERRAIN_MAX_PENDING];
+          --sQueueCount;
+
+          break;
+        }
+
+        --sNumPending;
+        evict = true;
+      }
+      mtx_unlock(&sMtx);
+
+      if(evict)
+        toDelete[numToDelete++] = patch;
+    }
+  }
+
+  for(int32_t i = 0; i < numToDelete; ++i)
+  {
+    FarPatch* patch = toDelete[i];
+    HashMapFarPatchesRemove(sPatches, patch);
+
+    if(patch->state == PATCH_READY)
+    {
+      glDeleteVertexArrays(1, &patch->VAO);
+      glDeleteBuffers(1, &patch->VBO);
+    }
+
+    free(patch->vertices);
+    free(patch);
+  }
+}
+
+void FarTerrainUpdate(Camera* cam)
+{
+  ++sFrame;
+
+  UploadSampledPatches();
+
+  const float camX = cam->pos[0] / BLOCK_SIZE;
+  const float camZ = cam->pos[2] / BLOCK_SIZE;
+  const float holeRadius = (CHUNK_RENDER_RADIUS - 1) * (float)CHUNK_WIDTH;
+
+  //The roots are the patches of the coarsest level around the player.
+  const int32_t topLevel = FAR_TERRAIN_LEVELS - 1;
+  const int32_t topWidth = PatchWidth(topLevel);
+
+  const int32_t minX = FloorDiv((int32_t)camX - FAR_TERRAIN_DISTANCE, topWidth);
+  const int32_t maxX = FloorDiv((int32_t)camX + FAR_TERRAIN_DISTANCE, topWidth);
+  const int32_t minZ = FloorDiv((int32_t)camZ - FAR_TERRAIN_DISTANCE, topWidth);
+  const int32_t maxZ = FloorDiv((int32_t)camZ + FAR_TERRAIN_DISTANCE, topWidth);
+
+  sNumSelected = 0;
+  for(int32_t pX = minX; pX <= maxX; ++pX)
+  {
+    for(int32_t pZ = minZ; pZ <= maxZ; ++pZ)
+      SelectPatch(topLevel, pX, pZ, camX, camZ, holeRadius);
+  }
+
+  EvictUnusedPatches();
+}
+
+void FarTerrainRender(Camera* cam, float fogDist, vec3 fogColor)
+{
+  glUseProgram(SHADER_FAR_TERRAIN);
+
+  ShaderSetMat4(SHADER_FAR_TERRAIN, "MVPMatrix", cam->viewProjMatrix);
+  ShaderSetFloat3(SHADER_FAR_TERRAIN, "camPos", cam->pos);
+  ShaderSetFloat1(SHADER_FAR_TERRAIN, "fogDist", fogDist);
+  ShaderSetFloat3(SHADER_FAR_TERRAIN, "fogColor", fogColor);
+  ShaderSetFloat1(SHADER_FAR_TERRAIN, "blockLight", MapGetBlocksLight());
+  ShaderSetFloat1(SHADER_FAR_TERRAIN, "uHoleRadius", (CHUNK_RENDER_RADIUS - 1) * CHUNK_SIZE);
+
+  vec3 lightDir;
+  MapGetLightDir(lightDir);
+  ShaderSetFloat3(SHADER_FAR_TERRAIN, "uLightDir", lightDir);
+
+  //The skirts are seen from both sides.
+  glDisable(GL_CULL_FACE);
+
+  for(int32_t i = 0; i < sNumSelected; ++i)
+  {
+    FarPatch* patch = sSelected[i];
+
+    const float width = PatchWidth(patch->level) * BLOCK_SIZE;
+    vec3 AABB[2] = {{patch->pX * width, patch->minY, patch->pZ * width}, {(patch->pX + 1) * width, patch->maxY, (patch->pZ + 1) * width}};
+
+    if(!glm_aabb_frustum(AABB, cam->frustumPlanes))
+      continue;
+
+    glBindVertexArray(patch->VAO);
+    glDrawElements(GL_TRIANGLES, FAR_TERRAIN_INDEX_COUNT, GL_UNSIGNED_SHORT, 0);
+  }
+
+  glEnable(GL_CULL_FACE);
+}
+
+void FarTerrainFree()
+{
+  mtx_lock(&sMtx);
+  sExit = true;
+  mtx_unlock(&sMtx);
+  cnd_signal(&sCondVar);
+
+  thrd_join(sThread, NULL);
+  mtx_destroy(&sMtx);
+  cnd_destroy(&sCondVar);
+
+  for(uint32_t i = 0; i < sPatches->arraySize; ++i)
+  {
+    LinkedListNodeMapFarPatches* node = sPatches->array[i]->head;
+    while(node)
+    {
+      LinkedListNodeMapFarPatches* next = node->ptrNext;
+      FarPatch* patch = node->data;
+
+      if(patch->state == PATCH_READY)
+      {
+        glDeleteVertexArrays(1, &patch->VAO);
+        glDeleteBuffers(1, &patch->VBO);
+      }
+
+      free(patch->vertices);
+      free(patch);
+      node = next;
+    }
+  }
+
+  HashMapFarPatchesDelete(sPatches);
+  sPatches = NULL;
+
+  glDeleteBuffers(1, &sIndexBuffer);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../Camera/Camera.h"
+
+/* Far terrain: beyond the voxel chunks (up to "FAR_TERRAIN_DISTANCE" blocks), the world is drawn as a coarse heightfield
+ * of the world generator's biomes and heights - nothing is voxelised. The heightfield is a quadtree of patches of
+ * "FAR_TERRAIN_PATCH_QUADS" x "FAR_TERRAIN_PATCH_QUADS" quads; every level doubles the sample spacing (eight blocks at level 0).
+ * Patches are sampled on a background thread and streamed in as the player moves; until a finer patch is ready,
+ * its parent stays in place. */
+#define FAR_TERRAIN_PATCH_QUADS 32
+#define FAR_TERRAIN_LEVELS      6
+
+//Starts the background thread; the seed of the map has to be set already.
+void FarTerrainInit();
+
+//Selects the patches for the camera position, requests missing ones and uploads finished ones to the GPU.
+void FarTerrainUpdate(Camera* cam);
+
+//Draws the selected patches with the same fog as the chunks; fragments within the voxel render radius are discarded.
+void FarTerrainRender(Camera* cam, float fogDist, vec3 fogColor);
+
+void FarTerrainFree();
\ No newline at end of file
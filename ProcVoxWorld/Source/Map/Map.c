@@ -1,13 +1,20 @@
 #include "Map.h"
 #include "Block.h"
-#include "ThreadWorker.h"
+#include "FarTerrain.h"
+#include "MeshPool.h"
 
+#include "../ChunkStore.h"
 #include "../Database.h"
+#include "../MeshCache.h"
+#include "../TimeMeasurement.h"
 #include "../Window.h"
+#include "../WorldGenerator.h"
 
 #include "../Shader.h"
 #include "../Texture.h"
 
+#include <limits.h>
+
 LINKED_LIST_IMPLEMENTATION(Chunk*, Chunks);
 #pragma warning(suppress: 6001) //Using uninitialized memory "* list" (C6001) which I really could not find.
 HASH_MAP_IMPLEMENTATION(Chunk*, Chunks, ChunkHashFunc);
@@ -45,7 +52,9 @@ typedef struct
   Worker* workers;
   int32_t numWorkers;
 
-  int32_t seed;
+  int32_t numTrianglesDrawn; //Of all chunk draws since the last update
+
+  int32_t playerCx, playerCz; //Chunk of the camera at the last update
 } Map;
 
 static Map* map; //Keep static object for simplicity.
@@ -70,6 +79,7 @@ static void MapDeleteChunk(int32_t chunkX, int32_t chunkZ)
   if(c != NULL)
   {
     HashMapChunksRemove(map->chunksActive, c);
+    ChunkReleaseMeshes(c);
     ChunkDelete(c);
 
     //Chunks only keep separate copies of their neighbours.
@@ -101,6 +111,73 @@ static void TryToDeleteFarChunks(vec3 currPos)
   LinkedListChunksDelete(chunksToDelete);
 }
 
+//The chunks in view when the map was closed last time, meshed on all threads; the workers find them loaded already.
+static void LoadMeshCache()
+{
+  if(!MeshCacheBeginLoad())
+    return;
+
+  const double start = TimeMeasurementNow();
+
+  //Only chunks within the render radius are returned.
+  const int32_t side = 2 * CHUNK_RENDER_RADIUS + 1;
+  Chunk** chunks = (Chunk**)OwnMalloc(side * side * sizeof(Chunk*), false);
+
+  if(chunks == NULL)
+  {
+    LogError("Variable \"chunks\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    int32_t loaded, outdated;
+    MeshCacheEndLoad(&loaded, &outdated);
+
+    return;
+  }
+
+  int32_t count = 0;
+  Chunk* c;
+  while(count < side * side && (c = MeshCacheLoadNext()) != NULL)
+    chunks[count++] = c;
+
+  MapMeshChunksNow(chunks, count, map->workers, map->numWorkers);
+
+  for(int32_t i = 0; i < count; ++i)
+  {
+    ChunkUploadMeshToGPU(chunks[i]);
+    HashMapChunksInsert(map->chunksActive, chunks[i]);
+  }
+
+  free(chunks);
+
+  int32_t loaded, outdated;
+  MeshCacheEndLoad(&loaded, &outdated);
+
+  LogInfo("%d chunks were loaded from the mesh cache in %.1f ms; %d of its chunks were edited since and are generated again.", true,
+          loaded, (TimeMeasurementNow() - start) * 1000.0, outdated);
+}
+
+static void SaveMeshCache()
+{
+  if(!MeshCacheBeginSave(map->playerCx, map->playerCz))
+    return;
+
+  const double start = TimeMeasurementNow();
+
+  MAP_FOREACH_ACTIVE_CHUNK_BEGIN(c)
+  {
+    //Chunks a worker was busy with or which wait for a new mesh are left to be generated next time.
+    if(!c->isGenerated || !c->isSafeToModify || c->isDirty || ChunkPlayerDistSquared(c->x, c->z, map->playerCx, map->playerCz) > CHUNK_RENDER_RADIUS_SQUARED)
+      continue;
+
+    MeshCacheSaveChunk(c);
+  }
+  MAP_FOREACH_ACTIVE_CHUNK_END()
+
+  int32_t chunks;
+  int64_t bytes;
+  if(MeshCacheEndSave(&chunks, &bytes))
+    LogInfo("%d chunks were kept in the mesh cache (%.1f MB) in %.1f ms.", true, chunks, bytes / 1048576.0, (TimeMeasurementNow() - start) * 1000.0);
+}
+
 void MapInit()
 {
   map = (Map*)OwnMalloc(sizeof(Map), false);
@@ -114,6 +191,9 @@ void MapInit()
 
   map->chunksActive = HashMapChunksCreate((size_t)(CHUNK_RENDER_RADIUS_SQUARED * 1.2f));
   map->chunksToRender = LinkedListChunksCreate();
+  map->numTrianglesDrawn = 0;
+  map->playerCx = 0;
+  map->playerCz = 0;
 
   map->VAOSkybox = OpenGLCreateVAO();
   map->VBOSkybox = OpenGLCreateVBOCube();
@@ -145,6 +225,8 @@ void MapInit()
     LogInfo("A new map \"%s\" is being created.", true, MAP_NAME);
   }
 
+  MeshPoolInit(sizeof(Vertex), ChunkSetVertexLayout);
+
   //The following can be sensitive, so caution is advised!
   int32_t procCount = GetProcessorsCount();
   if(NUM_WORKERS > 0 && NUM_WORKERS <= procCount)
@@ -165,31 +247,12 @@ void MapInit()
 
   for(int32_t i = 0; i < map->numWorkers; ++i)
     ThreadWorkerCreate(&map->workers[i], ThreadWorkerLoop);
-}
-
-//[0.0 - 1.0]
-double MapGetTime()
-{
-  if(DISABLE_TIME_FLOW)
-    return 0.1;
-  else
-    return 0.5 + remainder(glfwGetTime(), DAY_LENGTH) / (double)DAY_LENGTH;
-
-  //Manual control for debugging (time lapse):
-  /*double static time = 0.0;
-
-  if(WindowIsKeyPressed(GLFW_KEY_T))
-    time += 0.0001;
-  else if(WindowIsKeyPressed(GLFW_KEY_L))
-    time -= 0.0001;
 
-  if(time < 0.0)
-    time += 1.0;
-  else if(time > 1.0)
-    time -= 1.0;
-  //LogInfo("Time: %8.3f", true, time);
+  //Before the first "MapUpdate()", as the workers would generate the very same chunks otherwise.
+  LoadMeshCache();
 
-  return time;*/
+  if(FAR_TERRAIN_ENABLED)
+    FarTerrainInit();
 }
 
 float MapGetBlocksLight()
@@ -369,7 +432,9 @@ void MapRenderChunks(Camera* cam, mat4 nearShadowMapMat, mat4 farShadowMapMat)
   ShaderSetTextureArray(SHADER_BLOCK, "textureSampler", TEXTURE_BLOCKS, 0);
 
   ShaderSetFloat3(SHADER_BLOCK, "camPos", cam->pos);
-  ShaderSetFloat1(SHADER_BLOCK, "fogDist", CHUNK_RENDER_RADIUS * CHUNK_SIZE * 0.95f);
+  //With the far terrain, the fog only starts beyond it; the chunks blend into the heightfield instead.
+  float fogDist = FAR_TERRAIN_ENABLED ? FAR_TERRAIN_DISTANCE * BLOCK_SIZE * 0.95f : CHUNK_RENDER_RADIUS * CHUNK_SIZE * 0.95f;
+  ShaderSetFloat1(SHADER_BLOCK, "fogDist", fogDist);
 
   float r, g, b;
   MapGetFogColor(&r, &g, &b);
@@ -398,10 +463,18 @@ void MapRenderChunks(Camera* cam, mat4 nearShadowMapMat, mat4 farShadowMapMat)
 
   LIST_FOREACH_CHUNK_BEGIN(map->chunksToRender, c)
   {
-    glBindVertexArray(c->VAOLand);
-    glDrawArrays(GL_TRIANGLES, 0, (uint32_t)c->vertexLandCount);
+    MeshPoolQueueDraw(&c->meshLand);
+    map->numTrianglesDrawn += (int32_t)c->meshLand.count / 3;
   }
   LIST_FOREACH_CHUNK_END()
+  MeshPoolDrawQueued();
+
+  //The heightfield is opaque and has to be drawn before the (transparent) water.
+  if(FAR_TERRAIN_ENABLED)
+  {
+    FarTerrainRender(cam, fogDist, (vec3){r, g, b});
+    glUseProgram(SHADER_BLOCK);
+  }
 
   //Water needs blending to be transparent. Face culling has to be disabled to see underwater.
   glDepthMask(GL_FALSE);
@@ -410,10 +483,11 @@ void MapRenderChunks(Camera* cam, mat4 nearShadowMapMat, mat4 farShadowMapMat)
 
   LIST_FOREACH_CHUNK_BEGIN(map->chunksToRender, c)
   {
-    glBindVertexArray(c->VAOWater);
-    glDrawArrays(GL_TRIANGLES, 0, (uint32_t)c->vertexWaterCount);
+    MeshPoolQueueDraw(&c->meshWater);
+    map->numTrianglesDrawn += (int32_t)c->meshWater.count / 3;
   }
   LIST_FOREACH_CHUNK_END()
+  MeshPoolDrawQueued();
 
   glDepthMask(GL_TRUE);
   glEnable(GL_CULL_FACE);
@@ -431,11 +505,12 @@ void MapRenderChunksRaw(vec4 frustumPlanes[6])
   {
     if(c->isGenerated && ChunkIsVisible(c->x, c->z, frustumPlanes))
     {
-      glBindVertexArray(c->VAOLand);
-      glDrawArrays(GL_TRIANGLES, 0, (uint32_t)c->vertexLandCount);
+      MeshPoolQueueDraw(&c->meshLand);
+      map->numTrianglesDrawn += (int32_t)c->meshLand.count / 3;
     }
   }
   MAP_FOREACH_ACTIVE_CHUNK_END()
+  MeshPoolDrawQueued();
 }
 
 static void SetBlockHelper(int32_t cX, int32_t cZ, int32_t bX, int32_t bY, int32_t bZ, int32_t block)
@@ -617,6 +692,7 @@ static void HandleWorkers(Camera* cam)
       else
       {
         c = ChunkInit(bestCx, bestCz);
+        c->lod = ChunkSelectLod(0, ChunkPlayerDistSquared(bestCx, bestCz, ChunkedCam(cam->pos[0]), ChunkedCam(cam->pos[2])));
         HashMapChunksInsert(map->chunksActive, c);
         worker->generateTerrain = true;
       }
@@ -635,14 +711,79 @@ static void HandleWorkers(Camera* cam)
   }
 }
 
-static void LoadChunk(int32_t cX, int32_t cZ)
+static void GenerateTileBatchItem(void* data, int32_t index)
+{
+  WorldGenJob** jobs = (WorldGenJob**)data;
+  const int32_t tileCount = WorldGeneratorGetTileCount();
+
+  WorldGeneratorGenerateTile(jobs[index / tileCount], index % tileCount);
+}
+
+static void GenerateMeshBatchItem(void* data, int32_t index)
 {
-  Chunk* c = ChunkInit(cX, cZ);
-  ChunkGenerateTerrain(c);
-  ChunkGenerateMesh(c);
-  ChunkUploadMeshToGPU(c);
+  Chunk** chunks = (Chunk**)data;
+
+  ChunkGenerateMesh(chunks[index]);
+}
+
+/* Loads urgently needed chunks right away. Instead of one chunk after another, the column tiles of all chunks
+ * and afterwards their meshes are spread over the main thread and every idle worker. */
+void MapLoadChunksNow(Chunk** chunks, int32_t count, Worker* workers, int32_t numWorkers)
+{
+  //The chunks the jobs are for follow the jobs.
+  WorldGenJob** jobs = (WorldGenJob**)OwnMalloc(count * (sizeof(WorldGenJob*) + sizeof(Chunk*)), false);
+
+  if(jobs == NULL)
+  {
+    LogError("Variable \"jobs\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
 
-  HashMapChunksInsert(map->chunksActive, c);
+    return;
+  }
+
+  Chunk** generated = (Chunk**)&jobs[count];
+
+  //Only the chunks that are not stored have to be generated.
+  int32_t numJobs = 0;
+  for(int32_t i = 0; i < count; ++i)
+  {
+    ChunkAllocBlocks(chunks[i]);
+    if(ChunkStoreLoad(chunks[i]))
+      continue;
+
+    //Without a job (out of memory), the chunk stays empty rather than be stored.
+    WorldGenJob* job = WorldGeneratorBeginChunk(chunks[i]);
+
+    if(job == NULL)
+    {
+      LogError("Variable \"job\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+      continue;
+    }
+
+    generated[numJobs] = chunks[i];
+    jobs[numJobs++] = job;
+  }
+
+  ThreadWorkerRunBatch(workers, numWorkers, GenerateTileBatchItem, jobs, numJobs * WorldGeneratorGetTileCount());
+
+  //Trees and stored block edits are cheap in comparison and stay on this thread.
+  for(int32_t i = 0; i < numJobs; ++i)
+  {
+    WorldGeneratorFinishChunk(jobs[i]);
+    ChunkStoreKeepGenerated(generated[i]);
+  }
+
+  for(int32_t i = 0; i < count; ++i)
+    DatabaseGetBlocksForChunk(chunks[i]);
+
+  free(jobs);
+
+  MapMeshChunksNow(chunks, count, workers, numWorkers);
+}
+
+void MapMeshChunksNow(Chunk** chunks, int32_t count, Worker* workers, int32_t numWorkers)
+{
+  ThreadWorkerRunBatch(workers, numWorkers, GenerateMeshBatchItem, chunks, count);
 }
 
 void MapForceChunksNearPlayer(vec3 currPos)
@@ -652,6 +793,9 @@ void MapForceChunksNearPlayer(vec3 currPos)
   int32_t playerCx = ChunkedCam(currPos[0]);
   int32_t playerCz = ChunkedCam(currPos[2]);
 
+  Chunk* missing[9]; //(2 * "dist" + 1)^2 chunks at most
+  int32_t numMissing = 0;
+
   for(int32_t dX = -dist; dX <= dist; ++dX)
   {
     for(int32_t dZ = -dist; dZ <= dist; ++dZ)
@@ -660,9 +804,41 @@ void MapForceChunksNearPlayer(vec3 currPos)
       const int32_t cZ = playerCz + dZ;
 
       if(MapGetChunk(cX, cZ) == NULL)
-        LoadChunk(cX, cZ);
+        missing[numMissing++] = ChunkInit(cX, cZ);
     }
   }
+
+  if(numMissing == 0)
+    return;
+
+  MapLoadChunksNow(missing, numMissing, map->workers, map->numWorkers);
+
+  for(int32_t i = 0; i < numMissing; ++i)
+  {
+    ChunkUploadMeshToGPU(missing[i]);
+    HashMapChunksInsert(map->chunksActive, missing[i]);
+  }
+}
+
+//Chunks which have crossed a ring are meshed again at their new level of detail.
+static void UpdateChunkLods(vec3 currPos)
+{
+  int32_t playerCx = ChunkedCam(currPos[0]);
+  int32_t playerCz = ChunkedCam(currPos[2]);
+
+  MAP_FOREACH_ACTIVE_CHUNK_BEGIN(c)
+  {
+    if(!c->isSafeToModify || !c->isGenerated)
+      continue;
+
+    int32_t lod = ChunkSelectLod(c->lod, ChunkPlayerDistSquared(c->x, c->z, playerCx, playerCz));
+    if(lod != c->lod)
+    {
+      c->lod = lod;
+      c->isDirty = true;
+    }
+  }
+  MAP_FOREACH_ACTIVE_CHUNK_END()
 }
 
 static void AddChunksToRenderList(Camera* cam)
@@ -677,27 +853,23 @@ static void AddChunksToRenderList(Camera* cam)
 
 void MapUpdate(Camera* cam)
 {
+  map->numTrianglesDrawn = 0;
+  map->playerCx = ChunkedCam(cam->pos[0]);
+  map->playerCz = ChunkedCam(cam->pos[2]);
+
   TryToDeleteFarChunks(cam->pos);
+  UpdateChunkLods(cam->pos);
   HandleWorkers(cam);
   MapForceChunksNearPlayer(cam->pos);
   AddChunksToRenderList(cam);
-}
-
-void MapSetSeed(int32_t newSeed)
-{
-  map->seed = newSeed;
 
-  LogInfo("%sSeed = %d%s (0 - %d)", true, LINE, newSeed, NOLINE, RAND_MAX);
+  if(FAR_TERRAIN_ENABLED)
+    FarTerrainUpdate(cam);
 }
 
-int32_t MapGetSeed()
+int32_t MapGetTrianglesDrawn()
 {
-  return map->seed;
-}
-
-void MapSetTime(double newTime)
-{
-  glfwSetTime(DAY_LENGTH / 2.0 + newTime * DAY_LENGTH);
+  return map->numTrianglesDrawn;
 }
 
 int32_t MapGetHighestBlock(int32_t bX, int32_t bZ)
@@ -744,6 +916,7 @@ void MapGetLightDir(vec3 res)
 
 void MapSave()
 {
+  DatabaseFlush();
   DatabaseSaveMapInfo();
 }
 
@@ -751,11 +924,17 @@ void MapFree()
 {
   MapSave();
 
+  if(FAR_TERRAIN_ENABLED)
+    FarTerrainFree();
+
   //Workers:
   for(int32_t i = 0; i < map->numWorkers; ++i)
     ThreadWorkerDestroy(&map->workers[i]);
   free(map->workers);
 
+  //Once the workers are gone, no chunk changes any more.
+  SaveMeshCache();
+
   //Chunk hash maps and linked lists:
   LinkedListChunks* toDelete = LinkedListChunksCreate();
   MAP_FOREACH_ACTIVE_CHUNK_BEGIN(c)
@@ -765,6 +944,7 @@ void MapFree()
   while(toDelete->size)
   {
     Chunk* c = LinkedListChunksPopFront(toDelete);
+    ChunkReleaseMeshes(c);
     ChunkDelete(c);
   }
 
@@ -772,6 +952,12 @@ void MapFree()
   LinkedListChunksDelete(map->chunksToRender);
   LinkedListChunksDelete(toDelete);
 
+  MeshPoolStats stats;
+  MeshPoolGetStats(&stats);
+  LogInfo("The chunk meshes took %d pages of GPU memory (%.1f MB); the free memory at the end was %d ranges, %.1f%% of it outside of the largest.", true,
+          stats.pages, stats.capacity * sizeof(Vertex) / 1048576.0, stats.freeRanges, stats.fragmentation * 100.0f);
+  MeshPoolFree();
+
   free(map);
   map = NULL;
 }
\ No newline at end of file
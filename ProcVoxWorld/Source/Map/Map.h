@@ -4,6 +4,7 @@
 #include "../HashMap.h"
 
 #include "Chunk.h"
+#include "ThreadWorker.h"
 #include "../Camera/Camera.h"
 
 //Define data structures for chunks:
@@ -22,8 +23,16 @@ void MapRenderChunks(Camera* cam, mat4 nearShadowMapMat, mat4 farShadowMapMat);
 
 void MapRenderChunksRaw(vec4 frustumPlanes[6]);
 
+//Triangles of all chunk draws (including the shadow maps) since the last "MapUpdate()", i.e. of the last frame.
+int32_t MapGetTrianglesDrawn();
+
 void MapForceChunksNearPlayer(vec3 currPos);
 
+void MapLoadChunksNow(Chunk** chunks, int32_t count, Worker* workers, int32_t numWorkers);
+
+//Meshes chunks whose blocks are loaded already, spread over the main thread and every idle worker.
+void MapMeshChunksNow(Chunk** chunks, int32_t count, Worker* workers, int32_t numWorkers);
+
 void MapSetBlock(int32_t x, int32_t y, int32_t z, uint8_t block);
 
 uint8_t MapGetBlock(int32_t x, int32_t y, int32_t z);
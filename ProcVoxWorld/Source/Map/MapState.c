@@ -0,0 +1,55 @@
+#include "Map.h"
+
+#include "../CLIFormat.h"
+#include "../TimeMeasurement.h"
+
+#include <math.h>
+
+/* Seed and time of day of the map. Outside of "Map.c", as world generation and storage also work without a loaded map
+ * or an OpenGL context (e.g. for benchmarks and the headless build). */
+static int32_t sSeed;
+
+//Wall-clock time at which the clock of the day passed zero.
+static double sDayStart;
+
+void MapSetSeed(int32_t newSeed)
+{
+  sSeed = newSeed;
+
+  LogInfo("%sSeed = %d%s (0 - %d)", true, LINE, newSeed, NOLINE, RAND_MAX);
+}
+
+int32_t MapGetSeed()
+{
+  return sSeed;
+}
+
+void MapSetTime(double newTime)
+{
+  sDayStart = TimeMeasurementNow() - (DAY_LENGTH / 2.0 + newTime * DAY_LENGTH);
+}
+
+//[0.0 - 1.0]
+double MapGetTime()
+{
+  if(DISABLE_TIME_FLOW)
+    return 0.1;
+  else
+    return 0.5 + remainder(TimeMeasurementNow() - sDayStart, DAY_LENGTH) / (double)DAY_LENGTH;
+
+  //Manual control for debugging (time lapse):
+  /*double static time = 0.0;
+
+  if(WindowIsKeyPressed(GLFW_KEY_T))
+    time += 0.0001;
+  else if(WindowIsKeyPressed(GLFW_KEY_L))
+    time -= 0.0001;
+
+  if(time < 0.0)
+    time += 1.0;
+  else if(time > 1.0)
+    time -= 1.0;
+  //LogInfo("Time: %8.3f", true, time);
+
+  return time;*/
+}
\ No newline at end of file
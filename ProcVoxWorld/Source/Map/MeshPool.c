@@ -0,0 +1,353 @@
+#include "MeshPool.h"
+
+#include "glad/glad.h"
+
+//Bytes of a page; a mesh larger than that gets a page of its own size.
+#define MESH_POOL_PAGE_SIZE (64 * 1024 * 1024)
+
+//Ranges are multiples of it (in vertices), so leftovers too small for any mesh do not pile up between them.
+#define MESH_POOL_GRANULE 128
+
+typedef struct
+{
+  uint32_t first;
+  uint32_t count;
+} MeshRange;
+
+typedef struct
+{
+  GLuint VAO;
+  GLuint VBO;
+  uint32_t capacity; //Vertices
+
+  MeshRange* free; //Sorted by "first"; two of them never touch.
+  int32_t numFree, capacityFree;
+
+  GLint* drawFirsts;
+  GLsizei* drawCounts;
+  int32_t numDraws, capacityDraws;
+} MeshPage;
+
+static MeshPage* sPages;
+static int32_t sNumPages;
+
+static int32_t sVertexSize;
+static void (*sSetLayout)(); //"NULL" without the GPU
+
+static int32_t sAllocations;
+static int64_t sAllocated;
+static int64_t sDrawn;
+
+static bool GrowArray(void** array, int32_t* capacity, int32_t needed, size_t elementSize)
+{
+  if(needed <= *capacity)
+    return true;
+
+  const int32_t grown = MAX(16, MAX(needed, *capacity * 2));
+  void* res = realloc(*array, (size_t)grown * elementSize);
+
+  if(res == NULL)
+  {
+    LogError("Variable \"res\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return false;
+  }
+
+  *array = res;
+  *capacity = grown;
+
+  return true;
+}
+
+static uint32_t RoundToGranule(uint32_t count)
+{
+  return (count + MESH_POOL_GRANULE - 1) / MESH_POOL_GRANULE * MESH_POOL_GRANULE;
+}
+
+static bool AddPage(uint32_t capacity)
+{
+  MeshPage* pages = (MeshPage*)realloc(sPages, (sNumPages + 1) * sizeof(MeshPage));
+
+  if(pages == NULL)
+  {
+    LogError("Variable \"pages\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return false;
+  }
+
+  sPages = pages;
+
+  MeshPage* p = &sPages[sNumPages];
+  memset(p, 0, sizeof(MeshPage));
+  p->capacity = capacity;
+
+  if(!GrowArray((void**)&p->free, &p->capacityFree, 1, sizeof(MeshRange)))
+    return false;
+
+  p->free[0] = (MeshRange){0, capacity};
+  p->numFree = 1;
+
+  if(sSetLayout != NULL)
+  {
+    p->VAO = OpenGLCreateVAO();
+
+    //Written in parts over and over, unlike the buffers of "OpenGLCreateVBO()".
+    glGenBuffers(1, &p->VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, p->VBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sVertexSize, NULL, GL_DYNAMIC_DRAW);
+
+    sSetLayout();
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  ++sNumPages;
+
+  return true;
+}
+
+//Best fit over all pages; a new page only if no free range is large enough.
+static bool AllocateRange(uint32_t size, int32_t* page, uint32_t* first)
+{
+  int32_t bestPage = -1, bestRange = -1;
+  uint32_t bestCount = UINT32_MAX;
+
+  for(int32_t i = 0; i < sNumPages && bestCount != size; ++i)
+  {
+    for(int32_t r = 0; r < sPages[i].numFree; ++r)
+    {
+      const uint32_t count = sPages[i].free[r].count;
+      if(count >= size && count < bestCount)
+      {
+        bestPage = i;
+        bestRange = r;
+        bestCount = count;
+      }
+    }
+  }
+
+  if(bestPage < 0)
+  {
+    const uint32_t pageVertices = MESH_POOL_PAGE_SIZE / sVertexSize / MESH_POOL_GRANULE * MESH_POOL_GRANULE;
+    if(!AddPage(MAX(pageVertices, size)))
+      return false;
+
+    bestPage = sNumPages - 1;
+    bestRange = 0;
+  }
+
+  MeshPage* p = &sPages[bestPage];
+  MeshRange* r = &p->free[bestRange];
+
+  *page = bestPage;
+  *first = r->first;
+
+  r->first += size;
+  r->count -= size;
+
+  if(r->count == 0)
+  {
+    memmove(r, r + 1, (p->numFree - bestRange - 1) * sizeof(MeshRange));
+    --p->numFree;
+  }
+
+  return true;
+}
+
+//Merged with the free ranges right before and after it.
+static void ReleaseRange(int32_t page, uint32_t first, uint32_t count)
+{
+  MeshPage* p = &sPages[page];
+
+  //First free range behind the released one:
+  int32_t next = 0, end = p->numFree;
+  while(next < end)
+  {
+    const int32_t mid = (next + end) / 2;
+    if(p->free[mid].first < first)
+      next = mid + 1;
+    else
+      end = mid;
+  }
+
+  const bool joinsPrev = next > 0 && p->free[next - 1].first + p->free[next - 1].count == first;
+  const bool joinsNext = next < p->numFree && first + count == p->free[next].first;
+
+  if(joinsPrev && joinsNext)
+  {
+    p->free[next - 1].count += count + p->free[next].count;
+    memmove(&p->free[next], &p->free[next + 1], (p->numFree - next - 1) * sizeof(MeshRange));
+    --p->numFree;
+  }
+  else if(joinsPrev)
+    p->free[next - 1].count += count;
+  else if(joinsNext)
+  {
+    p->free[next].first = first;
+    p->free[next].count += count;
+  }
+  else
+  {
+    //Otherwise, the range is lost until the pool is freed.
+    if(!GrowArray((void**)&p->free, &p->capacityFree, p->numFree + 1, sizeof(MeshRange)))
+      return;
+
+    memmove(&p->free[next + 1], &p->free[next], (p->numFree - next) * sizeof(MeshRange));
+    p->free[next] = (MeshRange){first, count};
+    ++p->numFree;
+  }
+}
+
+void MeshPoolInit(int32_t vertexSize, void (*setLayout)())
+{
+  sPages = NULL;
+  sNumPages = 0;
+
+  sVertexSize = vertexSize;
+  sSetLayout = setLayout;
+
+  sAllocations = 0;
+  sAllocated = 0;
+  sDrawn = 0;
+}
+
+bool MeshPoolUpload(MeshAllocation* a, const void* vertices, uint32_t count)
+{
+  const uint32_t size = RoundToGranule(count);
+
+  //A mesh which shrank to less than half of its range gives the rest back rather than keep it from other meshes.
+  if(a->page < 0 || size > a->capacity || size * 2 < a->capacity)
+  {
+    MeshPoolRelease(a);
+
+    if(count == 0)
+      return true;
+
+    if(!AllocateRange(size, &a->page, &a->first))
+    {
+      a->page = -1;
+
+      return false;
+    }
+
+    a->capacity = size;
+    sAllocated += size;
+    ++sAllocations;
+  }
+
+  sDrawn += (int64_t)count - a->count;
+  a->count = count;
+
+  if(sSetLayout != NULL)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, sPages[a->page].VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)a->first * sVertexSize, (GLsizeiptr)count * sVertexSize, vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  return true;
+}
+
+void MeshPoolDownload(const MeshAllocation* a, void* vertices)
+{
+  if(a->count == 0 || sSetLayout == NULL)
+    return;
+
+  glBindBuffer(GL_ARRAY_BUFFER, sPages[a->page].VBO);
+  glGetBufferSubData(GL_ARRAY_BUFFER, (GLintptr)a->first * sVertexSize, (GLsizeiptr)a->count * sVertexSize, vertices);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshPoolRelease(MeshAllocation* a)
+{
+  if(a->page < 0)
+    return;
+
+  ReleaseRange(a->page, a->first, a->capacity);
+
+  sAllocated -= a->capacity;
+  sDrawn -= a->count;
+  --sAllocations;
+
+  MeshPoolInitAllocation(a);
+}
+
+void MeshPoolQueueDraw(const MeshAllocation* a)
+{
+  if(a->count == 0)
+    return;
+
+  MeshPage* p = &sPages[a->page];
+
+  int32_t capacityFirsts = p->capacityDraws, capacityCounts = p->capacityDraws;
+  if(!GrowArray((void**)&p->drawFirsts, &capacityFirsts, p->numDraws + 1, sizeof(GLint)) ||
+     !GrowArray((void**)&p->drawCounts, &capacityCounts, p->numDraws + 1, sizeof(GLsizei)))
+    return;
+
+  p->capacityDraws = MIN(capacityFirsts, capacityCounts);
+
+  p->drawFirsts[p->numDraws] = (GLint)a->first;
+  p->drawCounts[p->numDraws] = (GLsizei)a->count;
+  ++p->numDraws;
+}
+
+void MeshPoolDrawQueued()
+{
+  for(int32_t i = 0; i < sNumPages; ++i)
+  {
+    MeshPage* p = &sPages[i];
+    if(p->numDraws == 0)
+      continue;
+
+    if(sSetLayout != NULL)
+    {
+      glBindVertexArray(p->VAO);
+      glMultiDrawArrays(GL_TRIANGLES, p->drawFirsts, p->drawCounts, p->numDraws);
+    }
+
+    p->numDraws = 0;
+  }
+}
+
+void MeshPoolGetStats(MeshPoolStats* stats)
+{
+  memset(stats, 0, sizeof(MeshPoolStats));
+
+  stats->pages = sNumPages;
+  stats->allocations = sAllocations;
+  stats->allocated = sAllocated;
+  stats->drawn = sDrawn;
+
+  for(int32_t i = 0; i < sNumPages; ++i)
+  {
+    stats->capacity += sPages[i].capacity;
+    stats->freeRanges += sPages[i].numFree;
+
+    for(int32_t r = 0; r < sPages[i].numFree; ++r)
+      stats->largestFree = MAX(stats->largestFree, (int64_t)sPages[i].free[r].count);
+  }
+
+  const int64_t freeVertices = stats->capacity - stats->allocated;
+  stats->fragmentation = freeVertices > 0 ? 1.0f - (float)stats->largestFree / freeVertices : 0.0f;
+}
+
+void MeshPoolFree()
+{
+  for(int32_t i = 0; i < sNumPages; ++i)
+  {
+    if(sSetLayout != NULL)
+    {
+      glDeleteVertexArrays(1, &sPages[i].VAO);
+      glDeleteBuffers(1, &sPages[i].VBO);
+    }
+
+    free(sPages[i].free);
+    free(sPages[i].drawFirsts);
+    free(sPages[i].drawCounts);
+  }
+
+  free(sPages);
+  sPages = NULL;
+  sNumPages = 0;
+}
\ No newline at end of file
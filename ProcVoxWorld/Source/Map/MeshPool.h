@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../Utils.h"
+
+/* Vertex memory of all chunk meshes: a few large vertex buffers ("pages"), each with the one vertex array object
+ * reading it, out of which every mesh gets a range of vertices. Free ranges are kept per page, sorted and merged with
+ * their neighbours; a mesh takes the smallest one it fits into (best fit), and a new page is only created if none is
+ * large enough. Draws are queued and issued with one "glMultiDrawArrays()" per page, so a frame binds a vertex array
+ * object per page instead of per chunk. Only ever used by the thread with the OpenGL context (the main thread). */
+
+//Range of vertices of a mesh; "page" is -1 without one.
+typedef struct
+{
+  int32_t page;
+  uint32_t first;
+  uint32_t count; //Drawn
+  uint32_t capacity; //Allocated
+} MeshAllocation;
+
+typedef struct
+{
+  int32_t pages;
+  int32_t allocations;
+  int64_t capacity; //Vertices of all pages
+  int64_t allocated; //Vertices of all ranges, rounded up to the granule
+  int64_t drawn; //Vertices of all meshes
+  int32_t freeRanges;
+  int64_t largestFree; //Vertices
+  float fragmentation; //Share of the free vertices outside of the largest free range
+} MeshPoolStats;
+
+/* "setLayout" sets the attributes of the bound vertex array object for vertices of "vertexSize" bytes. Without it,
+ * nothing reaches the GPU and only the ranges are kept (e.g. for benchmarks). */
+void MeshPoolInit(int32_t vertexSize, void (*setLayout)());
+
+/* Replaces the mesh of "a" by "count" vertices: they are written into its range if they fit and fill at least half of it,
+ * otherwise it is released and a new one is taken. Returns "false" (with "a" empty) if there was no memory left. */
+bool MeshPoolUpload(MeshAllocation* a, const void* vertices, uint32_t count);
+
+//Copies the mesh of "a" from the GPU into "vertices" (room for "a->count" vertices).
+void MeshPoolDownload(const MeshAllocation* a, void* vertices);
+
+void MeshPoolRelease(MeshAllocation* a);
+
+//Draws the mesh of "a" with the next "MeshPoolDrawQueued()", in the order of the calls within its page.
+void MeshPoolQueueDraw(const MeshAllocation* a);
+
+//Draws the queued meshes as triangles with the current program and state.
+void MeshPoolDrawQueued();
+
+void MeshPoolGetStats(MeshPoolStats* stats);
+
+//All allocations have to be released before.
+void MeshPoolFree();
+
+//----- Inline -----
+
+//The empty allocation; "MeshPoolUpload()" and "MeshPoolRelease()" keep it up to date afterwards.
+static inline void MeshPoolInitAllocation(MeshAllocation* a)
+{
+  a->page = -1;
+  a->first = 0;
+  a->count = 0;
+  a->capacity = 0;
+}
\ No newline at end of file
@@ -7,10 +7,26 @@ void ThreadWorkerCreate(Worker* worker, thrd_start_t func)
   worker->data.state = WORKER_IDLE;
   worker->data.chunk = NULL;
   worker->data.generateTerrain = false;
+  worker->data.batch = NULL;
 
   thrd_create(&worker->thread, func, &worker->data);
 }
 
+static void ProcessBatch(WorkerBatch* batch)
+{
+  while(true)
+  {
+    mtx_lock(&batch->nextMtx);
+    int32_t index = batch->next++;
+    mtx_unlock(&batch->nextMtx);
+
+    if(index >= batch->count)
+      return;
+
+    batch->func(batch->data, index);
+  }
+}
+
 int32_t ThreadWorkerLoop(void* data)
 {
   WorkerData* dataInt = (WorkerData*)data;
@@ -26,6 +42,22 @@ int32_t ThreadWorkerLoop(void* data)
 
     mtx_unlock(&dataInt->stateMtx);
 
+    if(dataInt->batch != NULL)
+    {
+      ProcessBatch(dataInt->batch);
+
+      mtx_lock(&dataInt->stateMtx);
+      if(dataInt->state == WORKER_EXIT)
+        break;
+
+      //There is no chunk to hand over, so the worker is immediately available again.
+      dataInt->state = WORKER_IDLE;
+      mtx_unlock(&dataInt->stateMtx);
+      cnd_signal(&dataInt->condVar);
+
+      continue;
+    }
+
     if(dataInt->generateTerrain)
       ChunkGenerateTerrain(dataInt->chunk);
     ChunkGenerateMesh(dataInt->chunk);
@@ -44,6 +76,49 @@ int32_t ThreadWorkerLoop(void* data)
   return 0; //Against "C4716": "function" must return a value.
 }
 
+void ThreadWorkerRunBatch(Worker* workers, int32_t numWorkers, WorkerBatchFunc func, void* data, int32_t count)
+{
+  WorkerBatch batch = {.func = func, .data = data, .count = count, .next = 0};
+  mtx_init(&batch.nextMtx, mtx_plain);
+
+  //Recruit idle workers; the state stays "WORKER_BUSY" until they have left the batch.
+  for(int32_t i = 0; i < numWorkers; ++i)
+  {
+    WorkerData* worker = &workers[i].data;
+
+    mtx_lock(&worker->stateMtx);
+    if(worker->state == WORKER_IDLE)
+    {
+      worker->batch = &batch;
+      worker->state = WORKER_BUSY;
+      mtx_unlock(&worker->stateMtx);
+      cnd_signal(&worker->condVar);
+    }
+    else
+      mtx_unlock(&worker->stateMtx);
+  }
+
+  ProcessBatch(&batch);
+
+  //"batch" lives on this stack frame, so every recruited worker has to be finished with it.
+  for(int32_t i = 0; i < numWorkers; ++i)
+  {
+    WorkerData* worker = &workers[i].data;
+
+    mtx_lock(&worker->stateMtx);
+    if(worker->batch == &batch)
+    {
+      while(worker->state == WORKER_BUSY)
+        cnd_wait(&worker->condVar, &worker->stateMtx);
+
+      worker->batch = NULL;
+    }
+    mtx_unlock(&worker->stateMtx);
+  }
+
+  mtx_destroy(&batch.nextMtx);
+}
+
 void ThreadWorkerDestroy(Worker* worker)
 {
   mtx_lock(&worker->data.stateMtx);
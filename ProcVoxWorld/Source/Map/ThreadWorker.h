@@ -17,10 +17,24 @@ typedef enum
   WORKER_EXIT
 } WorkerState;
 
+//A batch of independent work items, which is shared by the calling thread and all idle workers.
+typedef void (*WorkerBatchFunc)(void* data, int32_t index);
+
+typedef struct
+{
+  WorkerBatchFunc func;
+  void* data;
+  int32_t count;
+
+  int32_t next;
+  mtx_t nextMtx;
+} WorkerBatch;
+
 typedef struct
 {
   Chunk* chunk;
   bool generateTerrain;
+  WorkerBatch* batch; //If set, the worker helps with the batch instead of processing "chunk".
 
   WorkerState state;
   mtx_t stateMtx;
@@ -37,4 +51,8 @@ void ThreadWorkerCreate(Worker* worker, thrd_start_t func);
 
 int32_t ThreadWorkerLoop(void* data);
 
+/* Processes "count" items of "func" on the calling thread and on every worker that is currently idle.
+ * Returns once all items are done; busy workers are not disturbed. */
+void ThreadWorkerRunBatch(Worker* workers, int32_t numWorkers, WorkerBatchFunc func, void* data, int32_t count);
+
 void ThreadWorkerDestroy(Worker* worker);
\ No newline at end of file
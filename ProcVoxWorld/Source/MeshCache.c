@@ -0,0 +1,288 @@
+#include "MeshCache.h"
+
+#include "ChunkStore.h"
+#include "Database.h"
+#include "WorldGenerator.h"
+
+#include "Map/Map.h"
+
+#define MESH_CACHE_MAGIC "PVWMESH2"
+
+typedef struct
+{
+  char magic[8];
+  int32_t seed;
+  int32_t chunkWidth, chunkHeight;
+  float blockSize;
+  uint32_t generatorVersion;
+  uint32_t vertexLayout; //"ChunkGetVertexLayoutHash()"
+  int32_t centerX, centerZ;
+  int32_t numChunks;
+} MeshCacheHeader;
+
+typedef struct
+{
+  int32_t x, z;
+  int32_t lod;
+  uint32_t blocksSize; //Encoded
+  uint64_t editsVersion;
+} MeshCacheEntry;
+
+static char sPath[1100]; //Empty without a cache
+static char sTempPath[1100];
+
+static FILE* sFile;
+static uint8_t* sEncoded; //Room for the blocks of a chunk encoded by "ChunkStoreEncodeBlocks()"
+static MeshCacheHeader sHeader;
+
+static int32_t sChunks; //Written or returned so far
+static int32_t sEntries; //Read so far
+static int32_t sOutdated;
+static int64_t sBytes;
+static bool sFailed;
+
+static bool RenameFile(const char* from, const char* to)
+{
+#ifdef PLATFORM_WINDOWS
+  return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+#else
+  return rename(from, to) == 0;
+#endif
+}
+
+static void FillHeader(MeshCacheHeader* header)
+{
+  memset(header, 0, sizeof(MeshCacheHeader));
+  memcpy(header->magic, MESH_CACHE_MAGIC, sizeof(header->magic));
+  header->seed = MapGetSeed();
+  header->chunkWidth = CHUNK_WIDTH;
+  header->chunkHeight = CHUNK_HEIGHT;
+  header->blockSize = BLOCK_SIZE;
+  header->generatorVersion = WorldGeneratorGetVersion();
+  header->vertexLayout = ChunkGetVertexLayoutHash();
+}
+
+static bool AllocEncoded()
+{
+  sEncoded = (uint8_t*)OwnMalloc(BLOCKS_MEMORY_SIZE * 2, false);
+
+  if(sEncoded == NULL)
+  {
+    LogError("Variable \"sEncoded\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return false;
+  }
+
+  return true;
+}
+
+static void CloseFile()
+{
+  if(sFile != NULL)
+    fclose(sFile);
+  sFile = NULL;
+
+  free(sEncoded);
+  sEncoded = NULL;
+}
+
+void MeshCacheInit(const char* mapPath, bool enabled)
+{
+  sPath[0] = '\0';
+  if(mapPath == NULL || !enabled || strcmp(mapPath, ":memory:") == 0)
+    return;
+
+  snprintf(sPath, ARRAY_SIZE(sPath), "%s.meshes", mapPath);
+  snprintf(sTempPath, ARRAY_SIZE(sTempPath), "%s.tmp", sPath);
+}
+
+bool MeshCacheBeginSave(int32_t centerX, int32_t centerZ)
+{
+  if(sPath[0] == '\0' || !AllocEncoded())
+    return false;
+
+  if(fopen_s(&sFile, sTempPath, "wb") != 0 || sFile == NULL)
+  {
+    LogWarning("The mesh cache \"%s\" could not be created, hence the map starts without it next time.", true, sTempPath);
+    CloseFile();
+
+    return false;
+  }
+
+  FillHeader(&sHeader);
+  sHeader.centerX = centerX;
+  sHeader.centerZ = centerZ;
+
+  //Written again with the number of chunks at the end.
+  sFailed = fwrite(&sHeader, sizeof(MeshCacheHeader), 1, sFile) != 1;
+  sChunks = 0;
+  sBytes = sizeof(MeshCacheHeader);
+
+  return true;
+}
+
+void MeshCacheSaveChunk(const Chunk* c)
+{
+  if(sFile == NULL || sFailed)
+    return;
+
+  MeshCacheEntry entry =
+  {
+    .x = c->x,
+    .z = c->z,
+    .lod = c->lod,
+    .blocksSize = (uint32_t)ChunkStoreEncodeBlocks(c->blocks, sEncoded),
+    .editsVersion = DatabaseGetChunkEditsVersion(c->x, c->z)
+  };
+
+  sFailed = fwrite(&entry, sizeof(MeshCacheEntry), 1, sFile) != 1 || fwrite(sEncoded, entry.blocksSize, 1, sFile) != 1;
+
+  ++sChunks;
+  sBytes += sizeof(MeshCacheEntry) + entry.blocksSize;
+}
+
+bool MeshCacheEndSave(int32_t* chunks, int64_t* bytes)
+{
+  *chunks = 0;
+  *bytes = 0;
+
+  if(sFile == NULL)
+    return false;
+
+  sHeader.numChunks = sChunks;
+  sFailed = sFailed || fseek(sFile, 0, SEEK_SET) != 0 || fwrite(&sHeader, sizeof(MeshCacheHeader), 1, sFile) != 1;
+  sFailed = fclose(sFile) != 0 || sFailed;
+  sFile = NULL;
+  CloseFile();
+
+  //An incomplete cache must not replace the one before.
+  if(sFailed || !RenameFile(sTempPath, sPath))
+  {
+    LogWarning("The mesh cache \"%s\" could not be written, hence the map starts without it next time.", true, sPath);
+    remove(sTempPath);
+
+    return false;
+  }
+
+  *chunks = sChunks;
+  *bytes = sBytes;
+
+  return true;
+}
+
+bool MeshCacheBeginLoad()
+{
+  sChunks = 0;
+  sEntries = 0;
+  sOutdated = 0;
+
+  if(sPath[0] == '\0' || fopen_s(&sFile, sPath, "rb") != 0 || sFile == NULL)
+  {
+    sFile = NULL;
+
+    return false;
+  }
+
+  MeshCacheHeader expected;
+  FillHeader(&expected);
+
+  const bool matches = fread(&sHeader, sizeof(MeshCacheHeader), 1, sFile) == 1 && memcmp(sHeader.magic, expected.magic, sizeof(expected.magic)) == 0 &&
+                       sHeader.seed == expected.seed && sHeader.chunkWidth == expected.chunkWidth && sHeader.chunkHeight == expected.chunkHeight &&
+                       sHeader.blockSize == expected.blockSize && sHeader.generatorVersion == expected.generatorVersion &&
+                       sHeader.vertexLayout == expected.vertexLayout;
+
+  if(!matches)
+  {
+    LogInfo("The mesh cache \"%s\" was made for another seed, chunk size, world generation or vertex layout, hence it is not used.", true, sPath);
+    CloseFile();
+
+    return false;
+  }
+
+  if(!AllocEncoded())
+  {
+    CloseFile();
+
+    return false;
+  }
+
+  return true;
+}
+
+static Chunk* ReadChunk(const MeshCacheEntry* entry)
+{
+  Chunk* c = ChunkInit(entry->x, entry->z);
+
+  if(c == NULL)
+    return NULL;
+
+  ChunkAllocBlocks(c);
+  c->lod = entry->lod;
+
+  const bool complete = c->blocks != NULL && fread(sEncoded, entry->blocksSize, 1, sFile) == 1 &&
+                        ChunkStoreDecodeBlocks(sEncoded, entry->blocksSize, c->blocks);
+
+  if(!complete)
+  {
+    //The chunk never reached the GPU, hence "ChunkDelete()" would not free the blocks.
+    free(c->blocks);
+    c->blocks = NULL;
+    ChunkDelete(c);
+
+    return NULL;
+  }
+
+  return c;
+}
+
+Chunk* MeshCacheLoadNext()
+{
+  if(sFile == NULL)
+    return NULL;
+
+  MeshCacheEntry entry;
+  while(fread(&entry, sizeof(MeshCacheEntry), 1, sFile) == 1)
+  {
+    const bool valid = entry.lod >= 0 && entry.lod <= CHUNK_MAX_LOD && entry.blocksSize <= BLOCKS_MEMORY_SIZE * 2;
+
+    if(!valid)
+      break;
+
+    ++sEntries;
+
+    //Skipped if edited since or beyond a render radius lowered since.
+    const bool inView = ChunkPlayerDistSquared(entry.x, entry.z, sHeader.centerX, sHeader.centerZ) <= CHUNK_RENDER_RADIUS_SQUARED;
+    if(!inView || DatabaseGetChunkEditsVersion(entry.x, entry.z) != entry.editsVersion)
+    {
+      sOutdated += inView;
+
+      if(fseek(sFile, (long)entry.blocksSize, SEEK_CUR) != 0)
+        break;
+
+      continue;
+    }
+
+    Chunk* c = ReadChunk(&entry);
+    if(c == NULL)
+      break;
+
+    ++sChunks;
+
+    return c;
+  }
+
+  if(sEntries < sHeader.numChunks)
+    LogWarning("The mesh cache \"%s\" is damaged, hence only %d of its %d chunks are used.", true, sPath, sChunks, sHeader.numChunks);
+
+  CloseFile();
+
+  return NULL;
+}
+
+void MeshCacheEndLoad(int32_t* loaded, int32_t* outdated)
+{
+  CloseFile();
+
+  *loaded = sChunks;
+  *outdated = sOutdated;
+}
\ No newline at end of file
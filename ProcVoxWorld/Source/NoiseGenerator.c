@@ -2,14 +2,7 @@
 
 #include "Map/Map.h"
 
-uint32_t OwnRand(uint32_t* prevValue)
-{
-  *prevValue = *prevValue * 1103515245 + 12345;
-
-  return *prevValue;
-}
-
-noiseState* NoiseGeneratorCreateState(int32_t cX, int32_t cZ)
+noiseState* NoiseGeneratorCreateState()
 {
   noiseState* state = (noiseState*)OwnMalloc(sizeof(noiseState), false);
 
@@ -20,18 +13,24 @@ noiseState* NoiseGeneratorCreateState(int32_t cX, int32_t cZ)
     return NULL;
   }
 
-  state->fnl = fnlCreateState();
-  state->fnl.fractal_type = FNL_FRACTAL_FBM;
-  state->fnl.cellular_distance_func = FNL_CELLULAR_DISTANCE_EUCLIDEAN;
-  state->fnl.domain_warp_amp = 100.0f;
-  state->fnl.domain_warp_type = FNL_DOMAIN_WARP_OPENSIMPLEX2;
-  state->fnl.seed = MapGetSeed();
-
-  state->randValue = (cX << 16) ^ cZ;
+  state->fnl = NoiseGeneratorCreateFnl(MapGetSeed());
+  state->seed = state->fnl.seed;
 
   return state;
 }
 
+fnl_state NoiseGeneratorCreateFnl(int32_t seed)
+{
+  fnl_state fnl = fnlCreateState();
+  fnl.fractal_type = FNL_FRACTAL_FBM;
+  fnl.cellular_distance_func = FNL_CELLULAR_DISTANCE_EUCLIDEAN;
+  fnl.domain_warp_amp = 100.0f;
+  fnl.domain_warp_type = FNL_DOMAIN_WARP_OPENSIMPLEX2;
+  fnl.seed = seed;
+
+  return fnl;
+}
+
 void NoiseGeneratorSetSettings(fnl_state* state, fnl_noise_type noiseType, float freq, int32_t octaves, float lacunarity, float gain)
 {
   state->noise_type = noiseType;
@@ -45,4 +44,10 @@ void NoiseGeneratorSetSettings(fnl_state* state, fnl_noise_type noiseType, float
 float NoiseGenerator2D(fnl_state* state, float x, float z)
 {
   return (fnlGetNoise2D(state, x, z) + 1.0f) / 2.0f;
+}
+
+//[0.0, 1.0]
+float NoiseGenerator3D(fnl_state* state, float x, float y, float z)
+{
+  return (fnlGetNoise3D(state, x, y, z) + 1.0f) / 2.0f;
 }
\ No newline at end of file
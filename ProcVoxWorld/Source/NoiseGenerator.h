@@ -2,17 +2,61 @@
 
 #include "FastNoiseLite/FastNoiseLite.h"
 
-//Simple thread-safe "rand()":
-uint32_t OwnRand(uint32_t* prevValue);
-
 typedef struct
 {
   fnl_state fnl;
-  uint32_t randValue;
+  int32_t seed;
 } noiseState;
 
-noiseState* NoiseGeneratorCreateState(int32_t cX, int32_t cZ);
+//Every random decision has its own purpose, so that draws never depend on each other.
+typedef enum
+{
+  RAND_TREE,
+  RAND_GRASS_PLANT,
+  RAND_FLOWER,
+  RAND_FLOWER_TYPE,
+  RAND_CACTUS,
+  RAND_CACTUS_HEIGHT,
+  RAND_DEAD_PLANT,
+  RAND_SNOW_LINE,
+  RAND_GRAVEL,
+  RAND_TREE_TYPE,
+  RAND_EROSION
+} RandPurpose;
+
+noiseState* NoiseGeneratorCreateState();
+
+//FastNoiseLite state with the settings all world generation shares.
+fnl_state NoiseGeneratorCreateFnl(int32_t seed);
 
 void NoiseGeneratorSetSettings(fnl_state* state, fnl_noise_type noiseType, float freq, int32_t octaves, float lacunarity, float gain);
 
-float NoiseGenerator2D(fnl_state* state, float x, float z);
\ No newline at end of file
+float NoiseGenerator2D(fnl_state* state, float x, float z);
+
+float NoiseGenerator3D(fnl_state* state, float x, float y, float z);
+
+//----- Inline -----
+
+//Final mixing step of MurmurHash3 - every input bit affects every output bit.
+static inline uint32_t NoiseGeneratorMix(uint32_t h)
+{
+  h ^= h >> 16;
+  h *= 0x85EBCA6B;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35;
+  h ^= h >> 16;
+
+  return h;
+}
+
+/* Stateless, thread-safe "rand()": The result only depends on the seed, the world position and the purpose of the draw.
+ * Thus, any column (or any subset of columns) of a chunk can be generated independently, in any order, and still yields the same world. */
+static inline uint32_t NoiseGeneratorPosRand(int32_t seed, int32_t bX, int32_t bY, int32_t bZ, uint32_t purpose)
+{
+  uint32_t h = NoiseGeneratorMix((uint32_t)seed ^ 0x9E3779B9);
+  h = NoiseGeneratorMix(h ^ (uint32_t)bX);
+  h = NoiseGeneratorMix(h ^ (uint32_t)bY);
+  h = NoiseGeneratorMix(h ^ (uint32_t)bZ);
+
+  return NoiseGeneratorMix(h ^ purpose);
+}
\ No newline at end of file
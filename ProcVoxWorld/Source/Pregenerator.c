@@ -0,0 +1,250 @@
+#include "Pregenerator.h"
+
+#include "ChunkStore.h"
+#include "Database.h"
+#include "TimeMeasurement.h"
+#include "WorldGenerator.h"
+
+#include "Map/Map.h"
+
+//Chunks per transaction and checkpoint; an interrupted run repeats at most this many chunks.
+#define PREGENERATOR_BATCH_SIZE 64
+
+//Progress is reported at most this often (in seconds).
+#define PREGENERATOR_REPORT_INTERVAL 2.0
+
+typedef struct
+{
+  int32_t dX, dZ;
+} ChunkOffset;
+
+//Nearest chunks first, so that the spawn area is complete early; ties are broken by coordinates to keep the order (and with it the checkpoints) fixed.
+static int32_t CompareOffsets(const void* a, const void* b)
+{
+  const ChunkOffset* offA = (const ChunkOffset*)a;
+  const ChunkOffset* offB = (const ChunkOffset*)b;
+
+  int32_t distA = ChunkPlayerDistSquared(offA->dX, offA->dZ, 0, 0);
+  int32_t distB = ChunkPlayerDistSquared(offB->dX, offB->dZ, 0, 0);
+
+  if(distA != distB)
+    return distA < distB ? -1 : 1;
+
+  if(offA->dX != offB->dX)
+    return offA->dX < offB->dX ? -1 : 1;
+
+  return (offA->dZ > offB->dZ) - (offA->dZ < offB->dZ);
+}
+
+static ChunkOffset* CreateOffsets(int32_t radius, int32_t* count)
+{
+  const int32_t side = 2 * radius + 1;
+  ChunkOffset* offsets = (ChunkOffset*)OwnMalloc((size_t)side * side * sizeof(ChunkOffset), false);
+
+  if(offsets == NULL)
+  {
+    LogError("Variable \"offsets\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return NULL;
+  }
+
+  //The same circle the game loads chunks in.
+  *count = 0;
+  for(int32_t dX = -radius; dX <= radius; ++dX)
+  {
+    for(int32_t dZ = -radius; dZ <= radius; ++dZ)
+    {
+      if(ChunkPlayerDistSquared(dX, dZ, 0, 0) <= radius * radius)
+        offsets[(*count)++] = (ChunkOffset){dX, dZ};
+    }
+  }
+
+  qsort(offsets, *count, sizeof(ChunkOffset), CompareOffsets);
+
+  return offsets;
+}
+
+static void GenerateChunk(void* data, int32_t index)
+{
+  Chunk* c = ((Chunk**)data)[index];
+
+  ChunkAllocBlocks(c);
+  if(c->blocks != NULL)
+    WorldGeneratorGenerateChunk(c);
+}
+
+static void FormatDuration(double seconds, char* result, size_t size)
+{
+  int32_t total = (int32_t)(seconds + 0.5);
+
+  snprintf(result, size, "%d:%02d:%02d", total / 3600, total / 60 % 60, total % 60);
+}
+
+//Opens the map and sets its seed; returns "false" if the map already has another seed.
+static bool OpenMap(const char* mapName, int32_t seed)
+{
+  MAP_NAME = (int8_t*)mapName;
+
+  char mapPath[256];
+  snprintf(mapPath, ARRAY_SIZE(mapPath), "Maps/%s", mapName);
+  DatabaseInit(mapPath);
+  ChunkStoreInit(mapPath, REGION_STORE);
+
+  if(DatabaseHasMapInfo())
+  {
+    DatabaseLoadMapInfo();
+
+    if(seed != -1 && seed != MapGetSeed())
+    {
+      LogError("The map \"%s\" already exists with the seed %d, hence it cannot be pregenerated with the seed %d.", true, mapName, MapGetSeed(), seed);
+
+      return false;
+    }
+
+    LogInfo("The existing map \"%s\" is used.", true, mapName);
+  }
+  else
+  {
+    if(seed != -1)
+      MapSetSeed(seed);
+    else if(MAP_SEED != -1)
+      MapSetSeed(MAP_SEED);
+    else
+      MapSetSeed(rand());
+
+    DatabaseSaveMapInfo();
+    LogInfo("A new map \"%s\" is being created.", true, mapName);
+  }
+
+  return true;
+}
+
+bool PregeneratorRun(const char* mapName, int32_t seed, int32_t centerX, int32_t centerZ, int32_t radius)
+{
+  if(radius < 0)
+  {
+    LogError("The radius of the pregeneration must not be negative (%d).", true, radius);
+
+    return false;
+  }
+
+  if(!OpenMap(mapName, seed))
+  {
+    ChunkStoreFree();
+    DatabaseFree();
+
+    return false;
+  }
+
+  int32_t total;
+  ChunkOffset* offsets = CreateOffsets(radius, &total);
+
+  if(offsets == NULL)
+  {
+    ChunkStoreFree();
+    DatabaseFree();
+
+    return false;
+  }
+
+  //All processor cores; the calling thread takes part, too.
+  const int32_t numWorkers = MAX(1, (int32_t)GetProcessorsCount()) - 1;
+  Worker* workers = (Worker*)OwnMalloc(MAX(1, numWorkers) * sizeof(Worker), false);
+
+  if(workers == NULL)
+  {
+    LogError("Variable \"workers\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    free(offsets);
+    ChunkStoreFree();
+    DatabaseFree();
+
+    return false;
+  }
+
+  for(int32_t i = 0; i < numWorkers; ++i)
+    ThreadWorkerCreate(&workers[i], ThreadWorkerLoop);
+
+  const int32_t resumeAt = MIN(DatabaseLoadPregenerationProgress(centerX, centerZ, radius), total);
+  if(resumeAt > 0)
+    LogInfo("Resuming the pregeneration at chunk %d of %d.", true, resumeAt + 1, total);
+
+  LogInfo("Pregenerating %d chunks around chunk (%d, %d) with %d thread%s.", true, total - resumeAt, centerX, centerZ, numWorkers + 1, numWorkers > 0 ? "s" : "");
+
+  int32_t numGenerated = 0;
+  int32_t numStored = 0;
+
+  const double start = TimeMeasurementNow();
+  double lastReport = start;
+
+  for(int32_t done = resumeAt; done < total;)
+  {
+    const int32_t batchSize = MIN(PREGENERATOR_BATCH_SIZE, total - done);
+
+    //Chunks of earlier runs (e.g. with a smaller radius) are kept.
+    Chunk* chunks[PREGENERATOR_BATCH_SIZE];
+    int32_t count = 0;
+    for(int32_t i = done; i < done + batchSize; ++i)
+    {
+      const int32_t cX = centerX + offsets[i].dX;
+      const int32_t cZ = centerZ + offsets[i].dZ;
+
+      if(ChunkStoreHas(cX, cZ))
+        ++numStored;
+      else
+        chunks[count++] = ChunkInit(cX, cZ);
+    }
+
+    ThreadWorkerRunBatch(workers, numWorkers, GenerateChunk, chunks, count);
+
+    //Chunks and checkpoint are committed together, so a resumed run never misses a chunk.
+    DatabaseBeginTransaction();
+    for(int32_t i = 0; i < count; ++i)
+    {
+      //Terrain only, as "ChunkStoreKeepGenerated()" stores it; edits are applied on every load anyway.
+      if(chunks[i]->blocks != NULL)
+        ChunkStoreSave(chunks[i]);
+
+      //Chunks never reach the GPU here, hence "ChunkDelete()" would not free the blocks.
+      free(chunks[i]->blocks);
+      chunks[i]->blocks = NULL;
+      ChunkDelete(chunks[i]);
+    }
+
+    done += batchSize;
+    numGenerated += count;
+
+    DatabaseSavePregenerationProgress(centerX, centerZ, radius, done);
+    DatabaseCommitTransaction();
+
+    const double now = TimeMeasurementNow();
+    if(now - lastReport >= PREGENERATOR_REPORT_INTERVAL && done < total)
+    {
+      const double chunksPerSecond = (done - resumeAt) / (now - start);
+
+      char eta[32];
+      FormatDuration((total - done) / chunksPerSecond, eta, ARRAY_SIZE(eta));
+
+      LogInfo("%d / %d chunks (%5.1f%%) | %8.1f chunks/s | ETA %s", true, done, total, done * 100.0 / total, chunksPerSecond, eta);
+      lastReport = now;
+    }
+  }
+
+  const double duration = TimeMeasurementNow() - start;
+
+  char elapsed[32];
+  FormatDuration(duration, elapsed, ARRAY_SIZE(elapsed));
+
+  LogSuccess("Pregeneration of %d chunks finished in %s: %d generated, %d already stored, %.1f chunks/s.", true,
+             total, elapsed, numGenerated, numStored, duration > 0.0 ? numGenerated / duration : 0.0);
+
+  for(int32_t i = 0; i < numWorkers; ++i)
+    ThreadWorkerDestroy(&workers[i]);
+  free(workers);
+
+  free(offsets);
+  ChunkStoreFree();
+  DatabaseFree();
+
+  return true;
+}
\ No newline at end of file
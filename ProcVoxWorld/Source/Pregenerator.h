@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Headless pregeneration: every chunk within "radius" chunks around the chunk ("centerX", "centerZ") of the map "mapName"
+ * is generated with all processor cores and stored in the map, so that the game loads instead of generating it.
+ * Start with: ProcVoxWorld [configuration path] --pregenerate <map name> <seed> <center chunk x> <center chunk z> <radius>
+ * A seed of -1 keeps the seed of an existing map (a new map uses "MapSeed" of the configuration).
+ * An interrupted run continues where it stopped, if it is started again with the same map, center and radius. */
+bool PregeneratorRun(const char* mapName, int32_t seed, int32_t centerX, int32_t centerZ, int32_t radius);
\ No newline at end of file
@@ -0,0 +1,612 @@
+#include "RegionStore.h"
+
+#include "ChunkStore.h"
+
+#include "TinyCThread/tinycthread.h"
+
+#ifdef PLATFORM_WINDOWS
+#include <share.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define REGION_CHUNKS (REGION_SIDE * REGION_SIDE)
+
+typedef struct Mapping
+{
+  const uint8_t* base;
+  size_t size;
+#ifdef PLATFORM_WINDOWS
+  HANDLE mapping;
+#endif
+  int32_t readers;      //Loads decoding a payload from it right now
+  struct Mapping* next; //Next replaced mapping, which is kept until its last reader is done
+} Mapping;
+
+typedef struct
+{
+  int32_t x, z;
+  char path[1100];
+
+  RegionEntry table[REGION_CHUNKS];
+  uint32_t numSectors;  //Length of the file (0 while there is none)
+  uint32_t usedSectors; //Sectors of the current payloads
+  bool unusable;        //Damaged or made for other chunk dimensions, thus neither read nor written
+
+  FILE* file;       //Opened on the first save
+  Mapping* mapping; //Mapped on the first load
+  Mapping* retired; //Replaced by "mapping", but still read from
+
+  mtx_t mtx;
+} Region;
+
+static char sMapPath[1024];
+static uint32_t sGeneratorVersion;
+static bool sInitialized;
+
+static Region** sRegions;
+static int32_t sNumRegions;
+static int32_t sRegionsCapacity;
+static mtx_t sRegionsMtx;
+
+static int32_t FloorDiv(int32_t a, int32_t b)
+{
+  return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+static uint32_t SectorsOf(uint32_t size)
+{
+  return (size + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+}
+
+static void Unmap(Mapping* mapping)
+{
+  if(mapping == NULL)
+    return;
+
+#ifdef PLATFORM_WINDOWS
+  UnmapViewOfFile(mapping->base);
+  CloseHandle(mapping->mapping);
+#else
+  munmap((void*)mapping->base, mapping->size);
+#endif
+
+  free(mapping);
+}
+
+//Maps the whole file as it is now; returns "NULL" on failure.
+static Mapping* Map(const char* path)
+{
+  Mapping* mapping = (Mapping*)OwnMalloc(sizeof(Mapping), false);
+
+  if(mapping == NULL)
+  {
+    LogError("Variable \"mapping\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return NULL;
+  }
+
+  memset(mapping, 0, sizeof(Mapping));
+
+#ifdef PLATFORM_WINDOWS
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+
+  LARGE_INTEGER size;
+  if(file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size))
+  {
+    mapping->size = (size_t)size.QuadPart;
+    mapping->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mapping->mapping != NULL)
+      mapping->base = (const uint8_t*)MapViewOfFile(mapping->mapping, FILE_MAP_READ, 0, 0, 0);
+  }
+
+  if(file != INVALID_HANDLE_VALUE)
+    CloseHandle(file); //The mapping keeps the file open.
+
+  if(mapping->base == NULL)
+  {
+    LogError("Region file \"%s\" could not be mapped (error code: %lu).", true, path, GetLastError());
+
+    if(mapping->mapping != NULL)
+      CloseHandle(mapping->mapping);
+    free(mapping);
+
+    return NULL;
+  }
+#else
+  const int fd = open(path, O_RDONLY);
+
+  struct stat st;
+  void* view = MAP_FAILED;
+  if(fd != -1 && fstat(fd, &st) == 0)
+  {
+    mapping->size = (size_t)st.st_size;
+    view = mmap(NULL, mapping->size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+
+  if(fd != -1)
+    close(fd); //The mapping keeps the file open.
+
+  if(view == MAP_FAILED)
+  {
+    char errMsg[94];
+    strerror_s(errMsg, ARRAY_SIZE(errMsg), errno);
+    LogError("Region file \"%s\" could not be mapped.\nError message: %s", true, path, errMsg);
+
+    free(mapping);
+
+    return NULL;
+  }
+
+  //Chunks are loaded in any order.
+  madvise(view, mapping->size, MADV_RANDOM);
+  mapping->base = (const uint8_t*)view;
+#endif
+
+  return mapping;
+}
+
+//Reads header and offset table; a missing file is an empty region.
+static void ReadRegionFile(Region* r)
+{
+  FILE* f = NULL;
+  if(fopen_s(&f, r->path, "rb") != 0 || f == NULL)
+    return;
+
+  RegionHeader header;
+  bool valid = fread(&header, sizeof(RegionHeader), 1, f) == 1 && fread(r->table, sizeof(r->table), 1, f) == 1 &&
+               memcmp(header.magic, REGION_MAGIC, sizeof(header.magic)) == 0 && header.regionX == r->x && header.regionZ == r->z;
+
+  fseek(f, 0, SEEK_END);
+  const long size = ftell(f);
+  fclose(f);
+
+  if(!valid || header.chunkWidth != CHUNK_WIDTH || header.chunkHeight != CHUNK_HEIGHT)
+  {
+    LogWarning("Region file \"%s\" is damaged or made for other chunk dimensions, hence it is ignored.", true, r->path);
+
+    memset(r->table, 0, sizeof(r->table));
+    r->unusable = true;
+
+    return;
+  }
+
+  //As if there was no file, so that the first save starts it anew.
+  if(header.generatorVersion != sGeneratorVersion)
+  {
+    LogInfo("Region file \"%s\" was made by another world generation, hence its chunks are generated anew.", true, r->path);
+    memset(r->table, 0, sizeof(r->table));
+
+    return;
+  }
+
+  r->numSectors = SectorsOf((uint32_t)size);
+
+  //Entries beyond the end of the file stem from an interrupted save.
+  for(int32_t i = 0; i < REGION_CHUNKS; ++i)
+  {
+    RegionEntry* entry = &r->table[i];
+
+    if(entry->size > 0 && (entry->sector < REGION_DATA_SECTOR || (uint64_t)entry->sector + SectorsOf(entry->size) > r->numSectors))
+      memset(entry, 0, sizeof(RegionEntry));
+
+    r->usedSectors += SectorsOf(entry->size);
+  }
+}
+
+static bool WriteRegionStart(Region* r, FILE* f, const RegionEntry* table)
+{
+  uint8_t start[REGION_DATA_SECTOR * REGION_SECTOR_SIZE];
+  memset(start, 0, sizeof(start));
+
+  RegionHeader header;
+  memset(&header, 0, sizeof(RegionHeader));
+  memcpy(header.magic, REGION_MAGIC, sizeof(header.magic));
+  header.regionX = r->x;
+  header.regionZ = r->z;
+  header.chunkWidth = CHUNK_WIDTH;
+  header.chunkHeight = CHUNK_HEIGHT;
+  header.generatorVersion = sGeneratorVersion;
+
+  memcpy(start, &header, sizeof(RegionHeader));
+  memcpy(start + sizeof(RegionHeader), table, sizeof(r->table));
+
+  return fwrite(start, sizeof(start), 1, f) == 1;
+}
+
+//Rewrites the file with the current payloads only, in the order of the table.
+static void CompactRegionFile(Region* r)
+{
+  const uint32_t oldSectors = r->numSectors;
+
+  char tempPath[1120];
+  snprintf(tempPath, sizeof(tempPath), "%s.compact", r->path);
+
+  FILE* src = NULL;
+  FILE* dst = NULL;
+  uint8_t* payload = (uint8_t*)OwnMalloc(BLOCKS_MEMORY_SIZE * 2 + REGION_SECTOR_SIZE, false);
+
+  RegionEntry table[REGION_CHUNKS];
+  memset(table, 0, sizeof(table));
+
+  bool success = payload != NULL && fopen_s(&src, r->path, "rb") == 0 && src != NULL && fopen_s(&dst, tempPath, "wb") == 0 && dst != NULL &&
+                 WriteRegionStart(r, dst, table);
+
+  uint32_t sector = REGION_DATA_SECTOR;
+  for(int32_t i = 0; i < REGION_CHUNKS && success; ++i)
+  {
+    const RegionEntry* entry = &r->table[i];
+    if(entry->size == 0)
+      continue;
+
+    const size_t bytes = (size_t)SectorsOf(entry->size) * REGION_SECTOR_SIZE;
+    success = entry->size <= BLOCKS_MEMORY_SIZE * 2 && fseek(src, (long)entry->sector * REGION_SECTOR_SIZE, SEEK_SET) == 0 &&
+              fread(payload, bytes, 1, src) == 1 && fwrite(payload, bytes, 1, dst) == 1;
+
+    table[i].sector = sector;
+    table[i].size = entry->size;
+    sector += SectorsOf(entry->size);
+  }
+
+  success = success && fseek(dst, sizeof(RegionHeader), SEEK_SET) == 0 && fwrite(table, sizeof(table), 1, dst) == 1;
+
+  if(src != NULL)
+    fclose(src);
+  if(dst != NULL && fclose(dst) != 0)
+    success = false;
+  free(payload);
+
+  //Replaced in one step, so the old file stays as it is if anything goes wrong.
+#ifdef PLATFORM_WINDOWS
+  success = success && MoveFileExA(tempPath, r->path, MOVEFILE_REPLACE_EXISTING);
+#else
+  success = success && rename(tempPath, r->path) == 0;
+#endif
+
+  if(!success)
+  {
+    LogWarning("Region file \"%s\" could not be compacted.", true, r->path);
+    remove(tempPath);
+
+    return;
+  }
+
+  memcpy(r->table, table, sizeof(table));
+  r->numSectors = sector;
+
+  LogInfo("Region file \"%s\" was compacted from %u to %u sectors.", true, r->path, oldSectors, sector);
+}
+
+//Opened (and compacted) on first use; "NULL" if the store is not initialized.
+static Region* GetRegion(int32_t chunkX, int32_t chunkZ, int32_t* index)
+{
+  const int32_t x = FloorDiv(chunkX, REGION_SIDE);
+  const int32_t z = FloorDiv(chunkZ, REGION_SIDE);
+  *index = (chunkX - x * REGION_SIDE) * REGION_SIDE + (chunkZ - z * REGION_SIDE);
+
+  if(!sInitialized)
+    return NULL;
+
+  mtx_lock(&sRegionsMtx);
+
+  for(int32_t i = 0; i < sNumRegions; ++i)
+  {
+    if(sRegions[i]->x == x && sRegions[i]->z == z)
+    {
+      Region* r = sRegions[i];
+      mtx_unlock(&sRegionsMtx);
+
+      return r;
+    }
+  }
+
+  if(sNumRegions == sRegionsCapacity)
+  {
+    const int32_t capacity = MAX(16, sRegionsCapacity * 2);
+    Region** regions = (Region**)realloc(sRegions, capacity * sizeof(Region*));
+
+    if(regions == NULL)
+    {
+      LogError("Variable \"regions\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+      mtx_unlock(&sRegionsMtx);
+
+      return NULL;
+    }
+
+    sRegions = regions;
+    sRegionsCapacity = capacity;
+  }
+
+  Region* r = (Region*)OwnMalloc(sizeof(Region), false);
+
+  if(r == NULL)
+  {
+    LogError("Variable \"r\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+    mtx_unlock(&sRegionsMtx);
+
+    return NULL;
+  }
+
+  memset(r, 0, sizeof(Region));
+  r->x = x;
+  r->z = z;
+  snprintf(r->path, sizeof(r->path), "%s.r.%d.%d", sMapPath, x, z);
+  mtx_init(&r->mtx, mtx_plain);
+
+  ReadRegionFile(r);
+
+  //Only sectors left behind by chunks stored again add up; a few of them are not worth rewriting a file.
+  const uint32_t unusedSectors = r->numSectors > 0 ? r->numSectors - REGION_DATA_SECTOR - r->usedSectors : 0;
+  if(!r->unusable && unusedSectors > r->usedSectors && unusedSectors >= 64)
+    CompactRegionFile(r);
+
+  sRegions[sNumRegions++] = r;
+  mtx_unlock(&sRegionsMtx);
+
+  return r;
+}
+
+/* The payload of "entry" in the mapping, which is renewed if the payload was appended after mapping; "r->mtx" has to be locked.
+ * The mapping is counted as read from until "ReleaseMapping()" is called with "*reading". A replaced mapping nobody reads
+ * from is unmapped right away, the others by their last reader, so a region has at most one mapping more than loads
+ * decoding from it at the same time. */
+static const uint8_t* GetPayload(Region* r, RegionEntry entry, Mapping** reading)
+{
+  const size_t end = (size_t)entry.sector * REGION_SECTOR_SIZE + entry.size;
+
+  if(r->mapping == NULL || r->mapping->size < end)
+  {
+    Mapping* mapping = Map(r->path);
+    if(mapping == NULL)
+      return NULL;
+
+    Mapping* replaced = r->mapping;
+    r->mapping = mapping;
+
+    if(replaced != NULL && replaced->readers > 0)
+    {
+      replaced->next = r->retired;
+      r->retired = replaced;
+    }
+    else
+      Unmap(replaced);
+
+    if(mapping->size < end)
+      return NULL;
+  }
+
+  ++r->mapping->readers;
+  *reading = r->mapping;
+
+  return r->mapping->base + (size_t)entry.sector * REGION_SECTOR_SIZE;
+}
+
+//Ends reading from a mapping handed out by "GetPayload()"; "r->mtx" has to be locked.
+static void ReleaseMapping(Region* r, Mapping* mapping)
+{
+  if(--mapping->readers > 0 || mapping == r->mapping)
+    return;
+
+  for(Mapping** retired = &r->retired; *retired != NULL; retired = &(*retired)->next)
+  {
+    if(*retired == mapping)
+    {
+      *retired = mapping->next;
+      break;
+    }
+  }
+
+  Unmap(mapping);
+}
+
+/* The file has to stay mappable while it is open for writing (and the other way round): on Windows, "fopen_s()" denies
+ * others write access to a file it opens and fails on a file somebody else may write to, which a mapping does. */
+static FILE* OpenShared(const char* path, const char* mode)
+{
+#ifdef PLATFORM_WINDOWS
+  return _fsopen(path, mode, _SH_DENYNO);
+#else
+  return fopen(path, mode);
+#endif
+}
+
+//"r->mtx" has to be locked.
+static bool OpenForWriting(Region* r)
+{
+  if(r->file != NULL)
+    return true;
+
+  if(r->numSectors > 0)
+  {
+    if((r->file = OpenShared(r->path, "r+b")) != NULL)
+      return true;
+  }
+  else if((r->file = OpenShared(r->path, "w+b")) != NULL)
+  {
+    if(WriteRegionStart(r, r->file, r->table) && fflush(r->file) == 0)
+    {
+      r->numSectors = REGION_DATA_SECTOR;
+
+      return true;
+    }
+
+    fclose(r->file);
+  }
+
+  r->file = NULL;
+  r->unusable = true;
+  LogError("Region file \"%s\" could not be opened for writing, so its chunks are not stored.", true, r->path);
+
+  return false;
+}
+
+bool RegionStoreInit(const char* mapPath, uint32_t generatorVersion)
+{
+  if(mapPath == NULL)
+    return false;
+
+  snprintf(sMapPath, sizeof(sMapPath), "%s", mapPath);
+  sGeneratorVersion = generatorVersion;
+  mtx_init(&sRegionsMtx, mtx_plain);
+  sInitialized = true;
+
+  return true;
+}
+
+void RegionStoreFree()
+{
+  if(!sInitialized)
+    return;
+
+  for(int32_t i = 0; i < sNumRegions; ++i)
+  {
+    Region* r = sRegions[i];
+
+    if(r->file != NULL)
+      fclose(r->file);
+    Unmap(r->mapping);
+    while(r->retired != NULL)
+    {
+      Mapping* next = r->retired->next;
+      Unmap(r->retired);
+      r->retired = next;
+    }
+    mtx_destroy(&r->mtx);
+    free(r);
+  }
+
+  free(sRegions);
+  sRegions = NULL;
+  sNumRegions = 0;
+  sRegionsCapacity = 0;
+
+  mtx_destroy(&sRegionsMtx);
+  sInitialized = false;
+}
+
+bool RegionStoreLoad(Chunk* c)
+{
+  int32_t index;
+  Region* r = GetRegion(c->x, c->z, &index);
+  if(r == NULL)
+    return false;
+
+  mtx_lock(&r->mtx);
+  const RegionEntry entry = r->table[index];
+  Mapping* mapping = NULL;
+  const uint8_t* payload = entry.size > 0 ? GetPayload(r, entry, &mapping) : NULL;
+  mtx_unlock(&r->mtx);
+
+  //Payloads are never overwritten, hence decoding needs no lock; the mapping stays until it is released.
+  if(payload == NULL)
+    return false;
+
+  const bool decoded = ChunkStoreDecodeBlocks(payload, entry.size, c->blocks);
+
+  mtx_lock(&r->mtx);
+  ReleaseMapping(r, mapping);
+  mtx_unlock(&r->mtx);
+
+  if(!decoded)
+  {
+    memset(c->blocks, 0, BLOCKS_MEMORY_SIZE);
+    LogWarning("The chunk (%d, %d) in region file \"%s\" is damaged, so it is generated anew.", true, c->x, c->z, r->path);
+
+    return false;
+  }
+
+  return true;
+}
+
+void RegionStoreSave(const Chunk* c)
+{
+  //The worst case (no two neighbouring blocks alike) doubles the size.
+  uint8_t* encoded = (uint8_t*)OwnMalloc(BLOCKS_MEMORY_SIZE * 2 + REGION_SECTOR_SIZE, false);
+
+  if(encoded == NULL)
+  {
+    LogError("Variable \"encoded\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return;
+  }
+
+  const uint32_t size = (uint32_t)ChunkStoreEncodeBlocks(c->blocks, encoded);
+  const uint32_t sectors = SectorsOf(size);
+  memset(encoded + size, 0, (size_t)sectors * REGION_SECTOR_SIZE - size);
+
+  int32_t index;
+  Region* r = GetRegion(c->x, c->z, &index);
+
+  if(r != NULL)
+  {
+    mtx_lock(&r->mtx);
+
+    if(!r->unusable && OpenForWriting(r))
+    {
+      //The payload is appended first; only then does the entry point to it.
+      const RegionEntry entry = {r->numSectors, size};
+      const bool written = fseek(r->file, (long)entry.sector * REGION_SECTOR_SIZE, SEEK_SET) == 0 && fwrite(encoded, (size_t)sectors * REGION_SECTOR_SIZE, 1, r->file) == 1 &&
+                           fseek(r->file, (long)(sizeof(RegionHeader) + index * sizeof(RegionEntry)), SEEK_SET) == 0 &&
+                           fwrite(&entry, sizeof(RegionEntry), 1, r->file) == 1 && fflush(r->file) == 0;
+
+      if(written)
+      {
+        r->usedSectors += sectors - SectorsOf(r->table[index].size);
+        r->numSectors += sectors;
+        r->table[index] = entry;
+      }
+      else
+        LogError("Chunk (%d, %d) could not be written to region file \"%s\".", true, c->x, c->z, r->path);
+    }
+
+    mtx_unlock(&r->mtx);
+  }
+
+  free(encoded);
+}
+
+bool RegionStoreHas(int32_t chunkX, int32_t chunkZ)
+{
+  int32_t index;
+  Region* r = GetRegion(chunkX, chunkZ, &index);
+  if(r == NULL)
+    return false;
+
+  mtx_lock(&r->mtx);
+  const bool stored = r->table[index].size > 0;
+  mtx_unlock(&r->mtx);
+
+  return stored;
+}
+
+int64_t RegionStoreGetFileSize(int32_t chunkX, int32_t chunkZ)
+{
+  int32_t index;
+  Region* r = GetRegion(chunkX, chunkZ, &index);
+  if(r == NULL)
+    return 0;
+
+  mtx_lock(&r->mtx);
+  const int64_t size = (int64_t)r->numSectors * REGION_SECTOR_SIZE;
+  mtx_unlock(&r->mtx);
+
+  return size;
+}
+
+int32_t RegionStoreGetNumMappings(int32_t chunkX, int32_t chunkZ)
+{
+  int32_t index;
+  Region* r = GetRegion(chunkX, chunkZ, &index);
+  if(r == NULL)
+    return 0;
+
+  mtx_lock(&r->mtx);
+  int32_t numMappings = r->mapping != NULL;
+  for(const Mapping* retired = r->retired; retired != NULL; retired = retired->next)
+    ++numMappings;
+  mtx_unlock(&r->mtx);
+
+  return numMappings;
+}
\ No newline at end of file
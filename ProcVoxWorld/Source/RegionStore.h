@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Map/Chunk.h"
+
+/* Generated chunks in region files of "REGION_SIDE" x "REGION_SIDE" chunks, named "<map path>.r.<region x>.<region z>".
+ *
+ * Layout (little-endian): "RegionHeader" at offset 0, the offset table of all chunks of the region (row by row along
+ * the x-axis) right after it and the payloads from sector "REGION_DATA_SECTOR" on, each starting at a sector boundary.
+ * A payload is a chunk encoded by "ChunkStoreEncodeBlocks()"; an entry of the table holds its first sector and its size
+ * (0 if the chunk is not stored). A file made by another world generation ("WorldGeneratorGetVersion()") counts as empty
+ * and is started anew with the first chunk stored.
+ *
+ * Payloads are only ever appended: a chunk stored again gets new sectors and its entry is updated afterwards, so
+ * the old payload stays intact for anybody still reading it. Files are memory-mapped for reading (and mapped anew
+ * once they have grown; a replaced mapping is unmapped as soon as no load decodes from it any more). The sectors left behind are dropped by compacting a file while it is opened, as soon as
+ * they outnumber the ones in use. */
+#define REGION_SIDE        32
+#define REGION_SECTOR_SIZE 4096
+#define REGION_DATA_SECTOR 3
+#define REGION_MAGIC       "PVWREGN1"
+
+typedef struct
+{
+  char magic[8];
+  int32_t regionX, regionZ;
+  int32_t chunkWidth, chunkHeight; //Payloads only fit chunks of these dimensions.
+  uint32_t generatorVersion; //Was "reserved[0]", so 0 in files from before.
+  uint32_t reserved;
+} RegionHeader;
+
+typedef struct
+{
+  uint32_t sector;
+  uint32_t size;
+} RegionEntry;
+
+/* Returns "false" if "mapPath" is "NULL"; region files are only created once a chunk is saved. Only files of the world
+ * generation "generatorVersion" are read. */
+bool RegionStoreInit(const char* mapPath, uint32_t generatorVersion);
+
+void RegionStoreFree();
+
+//Returns "false" if the chunk is not stored; "c->blocks" has to be allocated. Thread-safe, like the other functions.
+bool RegionStoreLoad(Chunk* c);
+
+void RegionStoreSave(const Chunk* c);
+
+bool RegionStoreHas(int32_t chunkX, int32_t chunkZ);
+
+//Size of the region file of the chunk in bytes (0 if there is none).
+int64_t RegionStoreGetFileSize(int32_t chunkX, int32_t chunkZ);
+
+//Mappings of the region file of the chunk, the current one and the replaced ones still read from (for benchmarks).
+int32_t RegionStoreGetNumMappings(int32_t chunkX, int32_t chunkZ);
\ No newline at end of file
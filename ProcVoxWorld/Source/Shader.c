@@ -15,6 +15,7 @@ GLuint SHADER_DEFERRED2;
 GLuint SHADER_SHADOW;
 GLuint SHADER_PIP;
 GLuint SHADER_HAND_ITEM;
+GLuint SHADER_FAR_TERRAIN;
 
 static int8_t* GetFileData(const char* path)
 {
@@ -166,6 +167,8 @@ void ShaderInitAll()
 
   SHADER_PIP = CreateShaderProgram("Source/Shaders/PiP.vert", "Source/Shaders/PiP.frag");
 
+  SHADER_FAR_TERRAIN = CreateShaderProgram("Source/Shaders/FarTerrain.vert", "Source/Shaders/FarTerrain.frag");
+
   //Not used at the moment: SHADER_HAND_ITEM = CreateShaderProgram("Source/Shaders/HandItem.vert", "Source/Shaders/HandItem.frag");
 }
 
@@ -249,4 +252,5 @@ void ShaderFreeAll()
   ShaderFreeOne(&SHADER_SHADOW);
   ShaderFreeOne(&SHADER_PIP);
   ShaderFreeOne(&SHADER_HAND_ITEM);
+  ShaderFreeOne(&SHADER_FAR_TERRAIN);
 }
\ No newline at end of file
@@ -13,6 +13,7 @@ extern GLuint SHADER_DEFERRED2;
 extern GLuint SHADER_SHADOW;
 extern GLuint SHADER_PIP;
 extern GLuint SHADER_HAND_ITEM;
+extern GLuint SHADER_FAR_TERRAIN;
 
 void ShaderInitAll();
 
@@ -0,0 +1,31 @@
+#version 430 core
+
+in vec3 vPos;
+in vec3 vColor;
+in vec3 vNormal;
+in float vFogAmount;
+
+out vec4 outColor;
+
+uniform vec3 camPos;
+uniform float blockLight;
+uniform vec3 fogColor;
+uniform vec3 uLightDir;
+uniform float uHoleRadius;
+
+void main()
+{
+  //Within the render radius, the chunks are drawn instead.
+  if(distance(camPos.xz, vPos.xz) < uHoleRadius)
+    discard;
+
+  //No shadow maps reach this far; simple diffuse lighting has to do.
+  float diffuse = max(dot(-uLightDir, normalize(vNormal)), 0.0);
+
+  vec3 color = vColor * (0.6 + 0.4 * diffuse);
+  color *= blockLight;
+
+  color = mix(color, fogColor, vFogAmount);
+
+  outColor = vec4(color, 1.0);
+}
\ No newline at end of file
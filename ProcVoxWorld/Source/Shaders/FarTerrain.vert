@@ -0,0 +1,26 @@
+#version 430 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in uvec4 aColor;
+layout (location = 2) in ivec4 aNormal;
+
+out vec3 vPos;
+out vec3 vColor;
+out vec3 vNormal;
+out float vFogAmount;
+
+uniform mat4 MVPMatrix;
+uniform vec3 camPos;
+uniform float fogDist;
+
+void main()
+{
+  gl_Position = MVPMatrix * vec4(aPos, 1.0);
+  vPos = aPos;
+  vColor = vec3(aColor.rgb) / 255.0;
+  vNormal = vec3(aNormal.xyz) / 127.0;
+
+  //The same fog as on the chunks (see "Block.vert").
+  float distToCam = distance(camPos.xz, aPos.xz);
+  vFogAmount = pow(clamp(distToCam / fogDist, 0.0, 1.0), 4.0);
+}
\ No newline at end of file
@@ -4,6 +4,8 @@ glslangValidator.exe Deferred.vert
 glslangValidator.exe Deferred.frag
 glslangValidator.exe Deferred2.vert
 glslangValidator.exe Deferred2.frag
+glslangValidator.exe FarTerrain.vert
+glslangValidator.exe FarTerrain.frag
 glslangValidator.exe HandItem.vert
 glslangValidator.exe HandItem.frag
 glslangValidator.exe Line.vert
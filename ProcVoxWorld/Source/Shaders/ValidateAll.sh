@@ -4,6 +4,8 @@ glslangValidator Deferred.vert
 glslangValidator Deferred.frag
 glslangValidator Deferred2.vert
 glslangValidator Deferred2.frag
+glslangValidator FarTerrain.vert
+glslangValidator FarTerrain.frag
 glslangValidator HandItem.vert
 glslangValidator HandItem.frag
 glslangValidator Line.vert
@@ -0,0 +1,421 @@
+#include "Snapshot.h"
+
+#include "Database.h"
+#include "TimeMeasurement.h"
+#include "Utils.h"
+
+#include "SQLite/sqlite3.h"
+#include "TinyCThread/tinycthread.h"
+
+static char sMapPath[1024];
+static int32_t sInterval;
+
+static thrd_t sThread;
+static mtx_t sMtx;
+static cnd_t sCondVar;     //Wakes the snapshot thread
+static cnd_t sDoneCondVar; //Wakes the threads waiting for snapshots
+static bool sRequested;
+static bool sBusy;
+static bool sStop;
+static bool sRunning;
+static int32_t sLastSnapshot;
+
+static bool RunStatement(sqlite3* connection, const char* statement)
+{
+  char* error = NULL;
+  if(sqlite3_exec(connection, statement, NULL, NULL, &error) == SQLITE_OK)
+    return true;
+
+  LogError("Snapshot statement failed.\nThe used statement was: %s.\nThe resulting error is: %s.", true, statement, error);
+  sqlite3_free(error);
+
+  return false;
+}
+
+static int64_t QueryInteger(sqlite3* connection, const char* statement)
+{
+  sqlite3_stmt* stmt = NULL;
+  int64_t value = -1;
+
+  if(sqlite3_prepare_v2(connection, statement, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+    value = sqlite3_column_int64(stmt, 0);
+  sqlite3_finalize(stmt);
+
+  return value;
+}
+
+static bool Attach(sqlite3* connection, const char* path)
+{
+  sqlite3_stmt* stmt = NULL;
+
+  const bool success = sqlite3_prepare_v2(connection, "ATTACH ? AS snap", -1, &stmt, NULL) == SQLITE_OK &&
+                       sqlite3_bind_text(stmt, 1, path, -1, SQLITE_STATIC) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_DONE;
+  sqlite3_finalize(stmt);
+
+  if(!success)
+    LogError("Snapshot file \"%s\" could not be attached.\nSignaled SQLite-error: %s", true, path, sqlite3_errmsg(connection));
+
+  return success;
+}
+
+static bool ReplaceFile(const char* from, const char* to)
+{
+#ifdef PLATFORM_WINDOWS
+  return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+#else
+  return rename(from, to) == 0;
+#endif
+}
+
+static bool FileExists(const char* path)
+{
+  FILE* f = NULL;
+  if(fopen_s(&f, path, "rb") != 0 || f == NULL)
+    return false;
+
+  fclose(f);
+
+  return true;
+}
+
+//Copies everything changed up to "lastChange" in one read transaction; returns the number of chunks or -1.
+static int32_t WriteSnapshot(sqlite3* connection, int32_t id, int32_t previous, int64_t* lastChange)
+{
+  if(!RunStatement(connection, "CREATE TABLE snap.ChunkEdits(chunkX INTEGER NOT NULL, chunkZ INTEGER NOT NULL, edits BLOB, PRIMARY KEY(chunkX, chunkZ));"
+                               "CREATE TABLE snap.SnapshotInfo(id INTEGER NOT NULL, previous INTEGER NOT NULL, lastChange INTEGER NOT NULL, time REAL NOT NULL);"
+                               "CREATE TABLE snap.MapInfo AS SELECT * FROM main.MapInfo WHERE 0;"
+                               "CREATE TABLE snap.PlayerInfo AS SELECT * FROM main.PlayerInfo WHERE 0;"))
+    return -1;
+
+  //From here on, the map is read as it is now, whatever the writer thread commits meanwhile.
+  if(!RunStatement(connection, "BEGIN"))
+    return -1;
+
+  *lastChange = QueryInteger(connection, "SELECT IFNULL(MAX(change), 0) FROM main.ChangedChunks");
+  const int32_t chunks = (int32_t)QueryInteger(connection, "SELECT COUNT(*) FROM main.ChangedChunks");
+
+  //Nothing new since the last snapshot.
+  if(chunks == 0 && previous > 0)
+  {
+    RunStatement(connection, "ROLLBACK");
+
+    return 0;
+  }
+
+  sqlite3_stmt* stmt = NULL;
+  bool success = sqlite3_prepare_v2(connection, "INSERT INTO snap.SnapshotInfo (id, previous, lastChange, time) VALUES (?, ?, ?, ?)", -1, &stmt, NULL) == SQLITE_OK;
+  if(success)
+  {
+    sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt, 2, previous);
+    sqlite3_bind_int64(stmt, 3, *lastChange);
+    sqlite3_bind_double(stmt, 4, (double)time(NULL));
+    success = sqlite3_step(stmt) == SQLITE_DONE;
+  }
+  sqlite3_finalize(stmt);
+
+  //Chunks whose row was deleted since keep "NULL", so that a restore deletes their edits as well.
+  success = success && RunStatement(connection, "INSERT INTO snap.ChunkEdits (chunkX, chunkZ, edits) SELECT c.chunkX, c.chunkZ, e.edits FROM main.ChangedChunks c "
+                                                "LEFT JOIN main.ChunkEdits e ON e.chunkX = c.chunkX AND e.chunkZ = c.chunkZ;"
+                                                "INSERT INTO snap.MapInfo SELECT * FROM main.MapInfo;"
+                                                "INSERT INTO snap.PlayerInfo SELECT * FROM main.PlayerInfo;");
+
+  //Only the attached file is written; the transaction on the map itself ends as it began.
+  if(!RunStatement(connection, success ? "COMMIT" : "ROLLBACK") || !success)
+    return -1;
+
+  return chunks;
+}
+
+//Returns the number of the snapshot, 0 if there was nothing new or -1 if it failed.
+static int32_t TakeSnapshot()
+{
+  const double start = TimeMeasurementNow();
+
+  //"SQLITE_OPEN_CREATE" is for the attached snapshot file; the map itself exists while it is open.
+  sqlite3* connection = NULL;
+  if(sqlite3_open_v2(sMapPath, &connection, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK)
+  {
+    LogError("There was a problem trying to open database file: %s.\nSignaled SQLite-error: %s", true, sMapPath, sqlite3_errmsg(connection));
+    sqlite3_close(connection);
+
+    return -1;
+  }
+  sqlite3_busy_timeout(connection, 1000); //Only while the writer checkpoints
+
+  //Only this thread adds snapshots, thus the number cannot change before the snapshot is finished.
+  const int32_t previous = (int32_t)QueryInteger(connection, "SELECT IFNULL(MAX(id), 0) FROM Snapshots");
+  const int32_t id = previous + 1;
+
+  char path[1100], tempPath[1104];
+  snprintf(path, ARRAY_SIZE(path), "%s.snapshot.%d", sMapPath, id);
+  snprintf(tempPath, ARRAY_SIZE(tempPath), "%s.tmp", path);
+  remove(tempPath); //Left behind by a crash
+
+  int32_t chunks = -1;
+  int64_t lastChange = 0;
+
+  //The temporary file is only renamed once complete, so it needs neither a journal nor to be synced more than once.
+  if(previous >= 0 && Attach(connection, tempPath))
+  {
+    if(RunStatement(connection, "PRAGMA snap.journal_mode = off; PRAGMA snap.synchronous = full"))
+      chunks = WriteSnapshot(connection, id, previous, &lastChange);
+
+    RunStatement(connection, "DETACH snap");
+  }
+  sqlite3_close(connection);
+
+  if(chunks > 0 || (chunks == 0 && previous == 0))
+  {
+    if(!ReplaceFile(tempPath, path))
+    {
+      LogError("Snapshot file \"%s\" could not be renamed to \"%s\".", true, tempPath, path);
+      remove(tempPath);
+
+      return -1;
+    }
+
+    DatabaseFinishSnapshot(id, lastChange, chunks);
+    LogInfo("Snapshot %d of the map with %d changed chunks was taken in %.1f ms.", true, id, chunks, (TimeMeasurementNow() - start) * 1000.0);
+
+    return id;
+  }
+
+  remove(tempPath);
+
+  if(chunks < 0)
+    LogWarning("Snapshot %d of the map could not be taken; it is tried again with the next one.", true, id);
+
+  return chunks < 0 ? -1 : 0;
+}
+
+static int32_t SnapshotLoop(void* arg)
+{
+  (void)arg;
+
+  mtx_lock(&sMtx);
+  while(!sStop)
+  {
+    if(!sRequested)
+    {
+      if(sInterval <= 0)
+        cnd_wait(&sCondVar, &sMtx);
+      else
+      {
+        struct timespec until;
+        timespec_get(&until, TIME_UTC);
+        until.tv_sec += sInterval;
+
+        if(cnd_timedwait(&sCondVar, &sMtx, &until) == thrd_timedout)
+          sRequested = true;
+      }
+
+      continue;
+    }
+
+    sRequested = false;
+    sBusy = true;
+    mtx_unlock(&sMtx);
+
+    const int32_t id = TakeSnapshot();
+
+    mtx_lock(&sMtx);
+    sBusy = false;
+    if(id > 0)
+      sLastSnapshot = id;
+    cnd_broadcast(&sDoneCondVar);
+  }
+  mtx_unlock(&sMtx);
+
+  return 0;
+}
+
+void SnapshotInit(const char* mapPath, int32_t interval)
+{
+  sRunning = false;
+  sLastSnapshot = 0;
+
+  if(mapPath == NULL || !strcmp(mapPath, ":memory:"))
+    return;
+
+  snprintf(sMapPath, ARRAY_SIZE(sMapPath), "%s", mapPath);
+  sInterval = interval;
+  sRequested = false;
+  sBusy = false;
+  sStop = false;
+
+  mtx_init(&sMtx, mtx_plain);
+  cnd_init(&sCondVar);
+  cnd_init(&sDoneCondVar);
+
+  sRunning = thrd_create(&sThread, SnapshotLoop, NULL) == thrd_success;
+
+  if(!sRunning)
+  {
+    LogWarning("The thread of the snapshots could not be created, hence no snapshots are taken.", true);
+    mtx_destroy(&sMtx);
+    cnd_destroy(&sCondVar);
+    cnd_destroy(&sDoneCondVar);
+  }
+}
+
+void SnapshotFree()
+{
+  if(!sRunning)
+    return;
+
+  mtx_lock(&sMtx);
+  sStop = true;
+  mtx_unlock(&sMtx);
+  cnd_signal(&sCondVar);
+
+  thrd_join(sThread, NULL);
+  mtx_destroy(&sMtx);
+  cnd_destroy(&sCondVar);
+  cnd_destroy(&sDoneCondVar);
+  sRunning = false;
+}
+
+void SnapshotRequest()
+{
+  if(!sRunning)
+    return;
+
+  mtx_lock(&sMtx);
+  sRequested = true;
+  mtx_unlock(&sMtx);
+  cnd_signal(&sCondVar);
+}
+
+void SnapshotWait()
+{
+  if(!sRunning)
+    return;
+
+  mtx_lock(&sMtx);
+  while(sRequested || sBusy)
+    cnd_wait(&sDoneCondVar, &sMtx);
+  mtx_unlock(&sMtx);
+}
+
+int32_t SnapshotGetLast()
+{
+  if(!sRunning)
+    return sLastSnapshot;
+
+  mtx_lock(&sMtx);
+  const int32_t id = sLastSnapshot;
+  mtx_unlock(&sMtx);
+
+  return id;
+}
+
+//Applies one snapshot to the map being restored; the chain has to be unbroken.
+static bool ApplySnapshot(sqlite3* connection, const char* mapPath, int32_t id)
+{
+  char path[1100];
+  snprintf(path, ARRAY_SIZE(path), "%s.snapshot.%d", mapPath, id);
+
+  if(!FileExists(path))
+  {
+    LogError("Snapshot file \"%s\" does not exist.", true, path);
+
+    return false;
+  }
+
+  if(!Attach(connection, path))
+    return false;
+
+  bool success = QueryInteger(connection, "SELECT COUNT(*) FROM snap.SnapshotInfo") == 1 &&
+                 QueryInteger(connection, "SELECT id FROM snap.SnapshotInfo") == id &&
+                 QueryInteger(connection, "SELECT previous FROM snap.SnapshotInfo") == id - 1;
+
+  if(!success)
+    LogError("Snapshot file \"%s\" does not follow snapshot %d.", true, path, id - 1);
+
+  success = success && RunStatement(connection, "BEGIN;"
+                                                "INSERT OR REPLACE INTO ChunkEdits (chunkX, chunkZ, edits) SELECT chunkX, chunkZ, edits FROM snap.ChunkEdits WHERE edits IS NOT NULL;"
+                                                "DELETE FROM ChunkEdits WHERE EXISTS(SELECT 1 FROM snap.ChunkEdits s WHERE s.edits IS NULL "
+                                                "AND s.chunkX = ChunkEdits.chunkX AND s.chunkZ = ChunkEdits.chunkZ);"
+                                                "DELETE FROM MapInfo; INSERT INTO MapInfo SELECT * FROM snap.MapInfo;"
+                                                "DELETE FROM PlayerInfo; INSERT INTO PlayerInfo SELECT * FROM snap.PlayerInfo;"
+                                                "INSERT OR REPLACE INTO Snapshots (id, time, chunks) SELECT id, time, (SELECT COUNT(*) FROM snap.ChunkEdits) FROM snap.SnapshotInfo;"
+                                                "COMMIT");
+
+  if(!success)
+    sqlite3_exec(connection, "ROLLBACK", NULL, NULL, NULL);
+  RunStatement(connection, "DETACH snap");
+
+  return success;
+}
+
+bool SnapshotRestore(const char* mapPath, int32_t id)
+{
+  if(id < 1)
+  {
+    LogError("There is no snapshot %d; snapshots are numbered from 1 on.", true, id);
+
+    return false;
+  }
+
+  char restoringPath[1100], beforePath[1100], walPath[1120], beforeWalPath[1120];
+  snprintf(restoringPath, ARRAY_SIZE(restoringPath), "%s.restoring", mapPath);
+  snprintf(beforePath, ARRAY_SIZE(beforePath), "%s.before-restore", mapPath);
+
+  snprintf(walPath, ARRAY_SIZE(walPath), "%s-wal", restoringPath);
+  remove(restoringPath);
+  remove(walPath);
+
+  //An empty map with all tables; "ChangedChunks" stays empty, so the next snapshot only holds what changes from here on.
+  DatabaseInit(restoringPath);
+  DatabaseFree();
+
+  sqlite3* connection = NULL;
+  bool success = sqlite3_open_v2(restoringPath, &connection, SQLITE_OPEN_READWRITE, NULL) == SQLITE_OK;
+
+  for(int32_t i = 1; success && i <= id; ++i)
+    success = ApplySnapshot(connection, mapPath, i);
+
+  const int32_t chunks = success ? (int32_t)QueryInteger(connection, "SELECT COUNT(*) FROM ChunkEdits") : 0;
+
+  //The last connection checkpoints the journal into the file.
+  sqlite3_close(connection);
+
+  if(!success)
+  {
+    LogError("The map \"%s\" could not be restored from its snapshots; it was left as it is.", true, mapPath);
+    remove(restoringPath);
+    remove(walPath);
+
+    return false;
+  }
+
+  //The current map (with its journal, which may hold its last commits) is kept aside.
+  if(FileExists(mapPath))
+  {
+    snprintf(walPath, ARRAY_SIZE(walPath), "%s-wal", mapPath);
+    snprintf(beforeWalPath, ARRAY_SIZE(beforeWalPath), "%s-wal", beforePath);
+    remove(beforeWalPath);
+
+    if(!ReplaceFile(mapPath, beforePath) || (FileExists(walPath) && !ReplaceFile(walPath, beforeWalPath)))
+    {
+      LogError("The map \"%s\" could not be moved aside; the restored map was left as \"%s\".", true, mapPath, restoringPath);
+
+      return false;
+    }
+
+    snprintf(walPath, ARRAY_SIZE(walPath), "%s-shm", mapPath);
+    remove(walPath);
+  }
+
+  if(!ReplaceFile(restoringPath, mapPath))
+  {
+    LogError("The restored map \"%s\" could not be renamed to \"%s\".", true, restoringPath, mapPath);
+
+    return false;
+  }
+
+  LogSuccess("The map \"%s\" was restored from snapshots 1 to %d with %d edited chunks; the map before is kept as \"%s\".", true, mapPath, id, chunks, beforePath);
+
+  return true;
+}
\ No newline at end of file
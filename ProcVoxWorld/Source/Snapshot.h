@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Incremental snapshots of the edits of a map, taken on a thread of their own while the game goes on.
+ *
+ * Snapshot "n" is the SQLite file "<map path>.snapshot.<n>": the edits of every chunk changed since snapshot "n - 1"
+ * ("NULL" for chunks left without edits), the map and player information and "SnapshotInfo" (its number and the one
+ * before); the first snapshot of a map holds all of its edits. A snapshot reads the map within one read transaction
+ * of its own connection, which sees the map as it was when the snapshot began, while the writer thread goes on
+ * appending to the WAL journal. It is written to a temporary file, which only takes the final name once complete.
+ * Generated chunks are not part of snapshots, as they can be generated again. */
+
+//Snapshots every "interval" seconds (0 = only on request); in-memory maps have none.
+void SnapshotInit(const char* mapPath, int32_t interval);
+
+//Has to be called before "DatabaseFree()"; waits for a snapshot being taken.
+void SnapshotFree();
+
+//Wakes the snapshot thread and returns at once.
+void SnapshotRequest();
+
+//Waits until all requested snapshots are taken.
+void SnapshotWait();
+
+//Number of the last snapshot taken since "SnapshotInit()" (0 if none).
+int32_t SnapshotGetLast();
+
+/* Rebuilds the map at "mapPath" from its snapshots 1 to "id"; the map there before is kept as "<map path>.before-restore".
+ * The map must not be open. */
+bool SnapshotRestore(const char* mapPath, int32_t id);
\ No newline at end of file
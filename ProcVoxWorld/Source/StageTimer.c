@@ -0,0 +1,256 @@
+#include "StageTimer.h"
+
+#if STAGE_TIMERS
+
+#include "TinyCThread/tinycthread.h"
+
+//Quarter powers of two of nanoseconds, up to 2^38 ns (about four and a half minutes).
+#define NUM_BUCKETS (38 * 4)
+
+typedef struct
+{
+  uint64_t count[AMOUNT_STAGES];
+  uint64_t totalNs[AMOUNT_STAGES];
+  uint32_t buckets[AMOUNT_STAGES][NUM_BUCKETS];
+} StageTimings;
+
+typedef struct
+{
+  StageTimings pending;   //Written by the owning thread only
+  StageTimings published; //Guarded by "sMtx"
+  bool inUse;
+} ThreadSlot;
+
+static const char* stageNames[AMOUNT_STAGES] = {"Biome", "Height", "Erosion", "Interpolate", "Fill", "Caves", "Structures"};
+
+static ThreadSlot sSlots[STAGE_TIMER_MAX_THREADS];
+static int32_t sNumSlots;
+static mtx_t sMtx;
+static tss_t sSlotKey; //Only for its destructor, which releases the slot of a finished thread.
+static double sNsPerTick = 1.0;
+static once_flag sInitFlag = ONCE_FLAG_INIT;
+
+static _Thread_local ThreadSlot* tSlot;
+static _Thread_local bool tNoSlot;
+
+static void AddTimings(StageTimings* dst, const StageTimings* src)
+{
+  for(int32_t stage = 0; stage < AMOUNT_STAGES; ++stage)
+  {
+    if(src->count[stage] == 0)
+      continue;
+
+    dst->count[stage] += src->count[stage];
+    dst->totalNs[stage] += src->totalNs[stage];
+    for(int32_t i = 0; i < NUM_BUCKETS; ++i)
+      dst->buckets[stage][i] += src->buckets[stage][i];
+  }
+}
+
+//Called on the exit of a thread with a slot; the next new thread takes the slot over (worker pools are recreated with the same size).
+static void ReleaseSlot(void* data)
+{
+  ThreadSlot* slot = (ThreadSlot*)data;
+
+  mtx_lock(&sMtx);
+  AddTimings(&slot->published, &slot->pending);
+  memset(&slot->pending, 0, sizeof(StageTimings));
+  slot->inUse = false;
+  mtx_unlock(&sMtx);
+}
+
+static void Init()
+{
+  mtx_init(&sMtx, mtx_plain);
+  tss_create(&sSlotKey, ReleaseSlot);
+
+#ifdef PLATFORM_WINDOWS
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  sNsPerTick = 1e9 / (double)frequency.QuadPart;
+#endif
+}
+
+static ThreadSlot* AcquireSlot()
+{
+  if(tSlot != NULL || tNoSlot)
+    return tSlot;
+
+  call_once(&sInitFlag, Init);
+
+  mtx_lock(&sMtx);
+
+  for(int32_t i = 0; i < sNumSlots && tSlot == NULL; ++i)
+  {
+    if(!sSlots[i].inUse)
+      tSlot = &sSlots[i];
+  }
+
+  if(tSlot == NULL && sNumSlots < STAGE_TIMER_MAX_THREADS)
+    tSlot = &sSlots[sNumSlots++];
+
+  if(tSlot != NULL)
+    tSlot->inUse = true;
+
+  mtx_unlock(&sMtx);
+
+  if(tSlot == NULL)
+  {
+    LogWarning("All %d stage timer slots are taken, hence the timings of this thread are dropped.", true, STAGE_TIMER_MAX_THREADS);
+    tNoSlot = true;
+  }
+  else
+    tss_set(sSlotKey, tSlot);
+
+  return tSlot;
+}
+
+static int32_t Bucket(uint64_t ns)
+{
+  if(ns < 4)
+    return (int32_t)ns;
+
+  int32_t log2 = 0;
+  for(int32_t shift = 32; shift > 0; shift >>= 1)
+  {
+    if(ns >> (log2 + shift))
+      log2 += shift;
+  }
+
+  return MIN(log2 * 4 + (int32_t)((ns >> (log2 - 2)) & 3), NUM_BUCKETS - 1);
+}
+
+//Exclusive upper bound of "bucket" in nanoseconds.
+static double BucketLimit(int32_t bucket)
+{
+  if(bucket < 4)
+    return bucket + 1.0;
+
+  return (double)(5 + bucket % 4) * (double)(1ULL << (bucket / 4 - 2));
+}
+
+void StageTimerRecord(StageTimerStage stage, uint64_t startTicks)
+{
+  const uint64_t ticks = StageTimerTicks() - startTicks;
+
+  ThreadSlot* slot = AcquireSlot();
+  if(slot == NULL)
+    return;
+
+  const uint64_t ns = (uint64_t)(ticks * sNsPerTick);
+
+  ++slot->pending.count[stage];
+  slot->pending.totalNs[stage] += ns;
+  ++slot->pending.buckets[stage][Bucket(ns)];
+}
+
+void StageTimerFlush()
+{
+  if(tSlot == NULL)
+    return;
+
+  mtx_lock(&sMtx);
+  AddTimings(&tSlot->published, &tSlot->pending);
+  mtx_unlock(&sMtx);
+
+  memset(&tSlot->pending, 0, sizeof(StageTimings));
+}
+
+int32_t StageTimerGetThreadCount()
+{
+  call_once(&sInitFlag, Init);
+
+  mtx_lock(&sMtx);
+  const int32_t numSlots = sNumSlots;
+  mtx_unlock(&sMtx);
+
+  return numSlots;
+}
+
+void StageTimerGetStats(int32_t thread, StageTimerStage stage, StageTimerStats* stats)
+{
+  call_once(&sInitFlag, Init);
+
+  uint64_t count = 0;
+  uint64_t totalNs = 0;
+  uint64_t buckets[NUM_BUCKETS] = {0};
+
+  mtx_lock(&sMtx);
+  for(int32_t i = 0; i < sNumSlots; ++i)
+  {
+    if(thread != -1 && thread != i)
+      continue;
+
+    count += sSlots[i].published.count[stage];
+    totalNs += sSlots[i].published.totalNs[stage];
+    for(int32_t j = 0; j < NUM_BUCKETS; ++j)
+      buckets[j] += sSlots[i].published.buckets[stage][j];
+  }
+  mtx_unlock(&sMtx);
+
+  stats->count = count;
+  stats->totalMs = totalNs / 1e6;
+  stats->meanUs = count > 0 ? totalNs / 1e3 / count : 0.0;
+  stats->p99Us = 0.0;
+
+  //Smallest bucket limit below which at least 99 % of the timings lie
+  const uint64_t target = count - count / 100;
+  uint64_t sum = 0;
+  for(int32_t i = 0; i < NUM_BUCKETS && count > 0; ++i)
+  {
+    sum += buckets[i];
+    if(sum >= target)
+    {
+      stats->p99Us = BucketLimit(i) / 1e3;
+
+      break;
+    }
+  }
+}
+
+const char* StageTimerGetName(StageTimerStage stage)
+{
+  return stageNames[stage];
+}
+
+void StageTimerLog()
+{
+  StageTimerFlush();
+
+  const int32_t numThreads = StageTimerGetThreadCount();
+
+  LogInfo("Stage       | thread |      count | total (ms) | mean (us) |  p99 (us)\n", false);
+  for(int32_t stage = 0; stage < AMOUNT_STAGES; ++stage)
+  {
+    for(int32_t thread = -1; thread < numThreads; ++thread)
+    {
+      StageTimerStats stats;
+      StageTimerGetStats(thread, (StageTimerStage)stage, &stats);
+
+      if(stats.count == 0)
+        continue;
+
+      if(thread == -1)
+        LogInfo("%-11s |    all | %10llu | %10.2f | %9.2f | %9.2f\n", false, stageNames[stage], (unsigned long long)stats.count, stats.totalMs, stats.meanUs, stats.p99Us);
+      else
+        LogInfo("            | %6d | %10llu | %10.2f | %9.2f | %9.2f\n", false, thread, (unsigned long long)stats.count, stats.totalMs, stats.meanUs, stats.p99Us);
+    }
+  }
+
+  LogInfo("World generation stages of %d thread%s (timings of running threads up to their last finished tile).", true, numThreads, numThreads != 1 ? "s" : "");
+}
+
+void StageTimerReset()
+{
+  call_once(&sInitFlag, Init);
+
+  mtx_lock(&sMtx);
+  for(int32_t i = 0; i < sNumSlots; ++i)
+    memset(&sSlots[i].published, 0, sizeof(StageTimings));
+  mtx_unlock(&sMtx);
+
+  if(tSlot != NULL)
+    memset(&tSlot->pending, 0, sizeof(StageTimings));
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Utils.h"
+
+/* Scoped timers of the world generation stages. Every thread accumulates its timings locally and adds them to its own slot
+ * on "StageTimerFlush()" (after every tile and chunk), where they can be merged at any time. Durations are sorted into
+ * histogram buckets a quarter of a power of two wide, so the 99th percentile is accurate to about 19 %.
+ * With "STAGE_TIMERS" set to 0 (the default; define it as 1 for the whole build to profile), all timers are compiled out. */
+#ifndef STAGE_TIMERS
+#define STAGE_TIMERS 0
+#endif
+
+//Threads with a slot of their own; timings of further threads are dropped.
+#define STAGE_TIMER_MAX_THREADS 64
+
+typedef enum
+{
+  STAGE_BIOME,       //"GetBiomeRow()"
+  STAGE_HEIGHT,      //"GetHeightRow()" (the lattice or, with a raster, every column)
+  STAGE_EROSION,     //Eroded deltas of a chunk
+  STAGE_INTERPOLATE, //Heights between the lattice points ("Blerp()")
+  STAGE_FILL,        //Biome columns with their plants ("Gen*()")
+  STAGE_CAVES,
+  STAGE_STRUCTURES,  //Trees ("StructureGeneratorStampChunk()")
+  AMOUNT_STAGES
+} StageTimerStage;
+
+typedef struct
+{
+  uint64_t count;
+  double totalMs;
+  double meanUs;
+  double p99Us;
+} StageTimerStats;
+
+#if STAGE_TIMERS
+
+#ifndef PLATFORM_WINDOWS
+#include <time.h>
+#endif
+
+//Monotonic ticks; "StageTimerRecord()" converts them.
+static inline uint64_t StageTimerTicks()
+{
+#ifdef PLATFORM_WINDOWS
+  LARGE_INTEGER ticks;
+  QueryPerformanceCounter(&ticks);
+
+  return (uint64_t)ticks.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#define STAGE_TIMER_BEGIN(name)      const uint64_t name = StageTimerTicks()
+#define STAGE_TIMER_END(name, stage) StageTimerRecord(stage, name)
+
+//Adds the time since "startTicks" to "stage" of the calling thread.
+void StageTimerRecord(StageTimerStage stage, uint64_t startTicks);
+
+//Publishes the timings of the calling thread.
+void StageTimerFlush();
+
+//Number of threads which have published timings.
+int32_t StageTimerGetThreadCount();
+
+//"thread" from 0 to "StageTimerGetThreadCount()" - 1 (in order of their first timing) or -1 for all threads merged.
+void StageTimerGetStats(int32_t thread, StageTimerStage stage, StageTimerStats* stats);
+
+const char* StageTimerGetName(StageTimerStage stage);
+
+//Logs every stage for all threads merged and for each thread.
+void StageTimerLog();
+
+void StageTimerReset();
+
+#else
+
+#define STAGE_TIMER_BEGIN(name)      ((void)0)
+#define STAGE_TIMER_END(name, stage) ((void)0)
+#define StageTimerFlush()            ((void)0)
+#define StageTimerLog()              ((void)0)
+#define StageTimerReset()            ((void)0)
+
+#endif
\ No newline at end of file
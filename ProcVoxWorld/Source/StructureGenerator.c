@@ -0,0 +1,378 @@
+#include "StructureGenerator.h"
+
+#include "WorldGenerator.h"
+
+#include "Map/Block.h"
+
+#include "TinyCThread/tinycthread.h"
+
+#include <assert.h>
+
+//Space around the origin (the ground block below a structure) every template has to fit in.
+#define STRUCTURE_GRID_WIDTH  16
+#define STRUCTURE_GRID_HEIGHT 16
+#define STRUCTURE_MAX_RUNS    256
+
+typedef enum
+{
+  STRUCTURE_TREE,
+  STRUCTURE_BIG_TREE,
+  AMOUNT_STRUCTURES
+} StructureType;
+
+//Templates are described by boxes; blocks of "onlyAir" boxes never replace anything.
+typedef struct
+{
+  int8_t x0, y0, z0;
+  int8_t x1, y1, z1;
+
+  uint8_t block;
+  bool onlyAir;
+} StructureBox;
+
+//Equal blocks in a row along the z-axis, which is contiguous in "Chunk->blocks".
+typedef struct
+{
+  int8_t dX, dY, dZ;
+  uint8_t length;
+
+  uint8_t block;
+  bool onlyAir;
+} StructureRun;
+
+typedef struct
+{
+  const StructureBox* boxes;
+  int32_t numBoxes;
+
+  int32_t radius; //Horizontal reach from the origin
+
+  //Runs that overwrite blocks come first, followed by the ones that only fill air.
+  StructureRun runs[STRUCTURE_MAX_RUNS];
+  int32_t numRuns;
+  int32_t numOverwriteRuns;
+} StructureTemplate;
+
+typedef struct
+{
+  int32_t bX, bY, bZ;
+  StructureType type;
+} Structure;
+
+typedef struct
+{
+  int32_t seed;
+  int32_t rX, rZ;
+  bool valid;
+
+  int32_t numStructures;
+  Structure structures[STRUCTURE_MAX_PER_REGION];
+} StructureRegion;
+
+static const StructureBox treeBoxes[] =
+{
+  //Trunk:
+  { 0, 1,  0,   0, 5, 0,  WOOD_BLOCK,   false },
+  //Leaves:
+  { -2, 4, -1,  2, 5, 1,  LEAVES_BLOCK, true },
+  { -1, 4, -2,  1, 5, 2,  LEAVES_BLOCK, true },
+  { -1, 3, -1,  1, 6, 1,  LEAVES_BLOCK, true },
+  { 0, 7,  0,   0, 7, 0,  LEAVES_BLOCK, true }
+};
+
+static const StructureBox bigTreeBoxes[] =
+{
+  //Trunk:
+  { 0, 1,  0,   0, 8,  0,  WOOD_BLOCK,   false },
+  //Leaves:
+  { -3, 5, -1,  3, 7,  1,  LEAVES_BLOCK, true },
+  { -1, 5, -3,  1, 7,  3,  LEAVES_BLOCK, true },
+  { -2, 4, -2,  2, 8,  2,  LEAVES_BLOCK, true },
+  { -1, 9, -1,  1, 9,  1,  LEAVES_BLOCK, true },
+  { 0, 10, 0,   0, 10, 0,  LEAVES_BLOCK, true }
+};
+
+static StructureTemplate sTemplates[AMOUNT_STRUCTURES] =
+{
+  //"radius" is set by "CompileTemplate()".
+  { treeBoxes, sizeof(treeBoxes) / sizeof(treeBoxes[0]), 0 },
+  { bigTreeBoxes, sizeof(bigTreeBoxes) / sizeof(bigTreeBoxes[0]), 0 }
+};
+
+static int32_t sMaxRadius;
+
+static StructureRegion sRegionCache[STRUCTURE_REGION_CACHE_SIZE];
+static mtx_t sRegionCacheMtx;
+
+static once_flag sInitFlag = ONCE_FLAG_INIT;
+
+static void ExtractRuns(StructureTemplate* t, uint8_t blocks[STRUCTURE_GRID_WIDTH][STRUCTURE_GRID_HEIGHT][STRUCTURE_GRID_WIDTH],
+                        bool onlyAir[STRUCTURE_GRID_WIDTH][STRUCTURE_GRID_HEIGHT][STRUCTURE_GRID_WIDTH], bool extractOnlyAir)
+{
+  const int32_t offset = STRUCTURE_GRID_WIDTH / 2;
+
+  for(int32_t x = 0; x < STRUCTURE_GRID_WIDTH; ++x)
+  {
+    for(int32_t y = 0; y < STRUCTURE_GRID_HEIGHT; ++y)
+    {
+      int32_t z = 0;
+      while(z < STRUCTURE_GRID_WIDTH)
+      {
+        if(blocks[x][y][z] == AIR_BLOCK || onlyAir[x][y][z] != extractOnlyAir)
+        {
+          ++z;
+          continue;
+        }
+
+        int32_t end = z + 1;
+        while(end < STRUCTURE_GRID_WIDTH && blocks[x][y][end] == blocks[x][y][z] && onlyAir[x][y][end] == extractOnlyAir)
+          ++end;
+
+        assert(t->numRuns < STRUCTURE_MAX_RUNS);
+
+        StructureRun* run = &t->runs[t->numRuns++];
+        run->dX = (int8_t)(x - offset);
+        run->dY = (int8_t)y;
+        run->dZ = (int8_t)(z - offset);
+        run->length = (uint8_t)(end - z);
+        run->block = blocks[x][y][z];
+        run->onlyAir = extractOnlyAir;
+
+        z = end;
+      }
+    }
+  }
+}
+
+//Rasterizes the boxes of a template and merges them into as few runs as possible.
+static void CompileTemplate(StructureTemplate* t)
+{
+  const int32_t offset = STRUCTURE_GRID_WIDTH / 2;
+
+  static uint8_t blocks[STRUCTURE_GRID_WIDTH][STRUCTURE_GRID_HEIGHT][STRUCTURE_GRID_WIDTH];
+  static bool onlyAir[STRUCTURE_GRID_WIDTH][STRUCTURE_GRID_HEIGHT][STRUCTURE_GRID_WIDTH];
+
+  memset(blocks, AIR_BLOCK, sizeof(blocks));
+  memset(onlyAir, false, sizeof(onlyAir));
+
+  t->radius = 0;
+
+  for(int32_t i = 0; i < t->numBoxes; ++i)
+  {
+    const StructureBox* box = &t->boxes[i];
+
+    assert(box->x0 >= -offset && box->x1 < offset && box->z0 >= -offset && box->z1 < offset);
+    assert(box->y0 >= 0 && box->y1 < STRUCTURE_GRID_HEIGHT);
+
+    for(int32_t x = box->x0; x <= box->x1; ++x)
+    {
+      for(int32_t y = box->y0; y <= box->y1; ++y)
+      {
+        for(int32_t z = box->z0; z <= box->z1; ++z)
+        {
+          //Overwriting blocks take precedence over blocks that only fill air.
+          if(box->onlyAir && blocks[x + offset][y][z + offset] != AIR_BLOCK)
+            continue;
+
+          blocks[x + offset][y][z + offset] = box->block;
+          onlyAir[x + offset][y][z + offset] = box->onlyAir;
+        }
+      }
+    }
+
+    t->radius = MAX(t->radius, MAX(MAX(-box->x0, box->x1), MAX(-box->z0, box->z1)));
+  }
+
+  t->numRuns = 0;
+  ExtractRuns(t, blocks, onlyAir, false);
+  t->numOverwriteRuns = t->numRuns;
+  ExtractRuns(t, blocks, onlyAir, true);
+}
+
+static void StructureGeneratorInit()
+{
+  for(int32_t i = 0; i < AMOUNT_STRUCTURES; ++i)
+  {
+    CompileTemplate(&sTemplates[i]);
+    sMaxRadius = MAX(sMaxRadius, sTemplates[i].radius);
+  }
+
+  mtx_init(&sRegionCacheMtx, mtx_plain);
+}
+
+static int32_t RegionOf(int32_t worldBlockCoord)
+{
+  if(worldBlockCoord >= 0)
+    return worldBlockCoord / STRUCTURE_REGION_WIDTH;
+
+  return (worldBlockCoord + 1) / STRUCTURE_REGION_WIDTH - 1;
+}
+
+/* The candidates of a region only depend on the seed and the world position; the few candidates are then checked
+ * against the terrain by sampling just their own column. */
+static void FindRegionStructures(noiseState* noiseState, int32_t rX, int32_t rZ, StructureRegion* region)
+{
+  region->seed = noiseState->seed;
+  region->rX = rX;
+  region->rZ = rZ;
+  region->valid = true;
+  region->numStructures = 0;
+
+  for(int32_t x = 0; x < STRUCTURE_REGION_WIDTH; ++x)
+  {
+    for(int32_t z = 0; z < STRUCTURE_REGION_WIDTH; ++z)
+    {
+      const int32_t bX = rX * STRUCTURE_REGION_WIDTH + x;
+      const int32_t bZ = rZ * STRUCTURE_REGION_WIDTH + z;
+
+      if(NoiseGeneratorPosRand(noiseState->seed, bX, 0, bZ, RAND_TREE) % 1000 <= 975)
+        continue;
+
+      Biome biome;
+      int32_t height;
+      WorldGeneratorSampleColumn(noiseState, bX, bZ, &biome, &height);
+
+      if(biome != BIOME_FOREST && biome != BIOME_FLOWER_FOREST)
+        continue;
+
+      //No trees under water.
+      if(height < WORLD_GEN_WATER_LEVEL)
+        continue;
+
+      if(region->numStructures == STRUCTURE_MAX_PER_REGION)
+        return;
+
+      Structure* s = &region->structures[region->numStructures++];
+      s->bX = bX;
+      s->bY = height;
+      s->bZ = bZ;
+
+      if(biome == BIOME_FOREST && NoiseGeneratorPosRand(noiseState->seed, bX, 0, bZ, RAND_TREE_TYPE) % 10 == 0)
+        s->type = STRUCTURE_BIG_TREE;
+      else
+        s->type = STRUCTURE_TREE;
+    }
+  }
+}
+
+static void GetRegionStructures(noiseState* noiseState, int32_t rX, int32_t rZ, StructureRegion* region)
+{
+  const uint32_t slot = NoiseGeneratorMix(((uint32_t)rX * 73856093) ^ ((uint32_t)rZ * 19349663)) % STRUCTURE_REGION_CACHE_SIZE;
+
+  mtx_lock(&sRegionCacheMtx);
+  const StructureRegion* cached = &sRegionCache[slot];
+  if(cached->valid && cached->seed == noiseState->seed && cached->rX == rX && cached->rZ == rZ)
+  {
+    memcpy(region, cached, sizeof(StructureRegion));
+    mtx_unlock(&sRegionCacheMtx);
+
+    return;
+  }
+  mtx_unlock(&sRegionCacheMtx);
+
+  //Computed without the lock; should two threads need the same region, both yield the same result anyway.
+  FindRegionStructures(noiseState, rX, rZ, region);
+
+  mtx_lock(&sRegionCacheMtx);
+  memcpy(&sRegionCache[slot], region, sizeof(StructureRegion));
+  mtx_unlock(&sRegionCacheMtx);
+}
+
+static void StampRuns(Chunk* c, const Structure* s, const StructureRun* runs, int32_t numRuns)
+{
+  const int32_t cStartX = c->x * CHUNK_WIDTH;
+  const int32_t cStartZ = c->z * CHUNK_WIDTH;
+
+  for(int32_t i = 0; i < numRuns; ++i)
+  {
+    const StructureRun* run = &runs[i];
+
+    //Columns from -1 to "CHUNK_WIDTH" (inclusive) are stored.
+    const int32_t x = s->bX + run->dX - cStartX;
+    const int32_t y = s->bY + run->dY;
+    if(x < -1 || x > CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT)
+      continue;
+
+    const int32_t zStart = MAX(s->bZ + run->dZ - cStartZ, -1);
+    const int32_t zEnd = MIN(s->bZ + run->dZ + run->length - 1 - cStartZ, CHUNK_WIDTH);
+    if(zStart > zEnd)
+      continue;
+
+    uint8_t* row = &c->blocks[XYZ(x, y, zStart)];
+    if(!run->onlyAir)
+      memset(row, run->block, (size_t)zEnd - zStart + 1);
+    else
+    {
+      for(int32_t z = 0; z <= zEnd - zStart; ++z)
+      {
+        if(row[z] == AIR_BLOCK)
+          row[z] = run->block;
+      }
+    }
+  }
+}
+
+void StructureGeneratorStampChunk(noiseState* noiseState, Chunk* c)
+{
+  call_once(&sInitFlag, StructureGeneratorInit);
+
+  const int32_t cStartX = c->x * CHUNK_WIDTH;
+  const int32_t cStartZ = c->z * CHUNK_WIDTH;
+
+  //Every structure reaching into the stored columns (-1 to "CHUNK_WIDTH") matters.
+  const int32_t rX0 = RegionOf(cStartX - 1 - sMaxRadius);
+  const int32_t rZ0 = RegionOf(cStartZ - 1 - sMaxRadius);
+  const int32_t rX1 = RegionOf(cStartX + CHUNK_WIDTH + sMaxRadius);
+  const int32_t rZ1 = RegionOf(cStartZ + CHUNK_WIDTH + sMaxRadius);
+
+  const int32_t numRegions = (rX1 - rX0 + 1) * (rZ1 - rZ0 + 1);
+  StructureRegion* regions = (StructureRegion*)OwnMalloc(numRegions * sizeof(StructureRegion), false);
+
+  if(regions == NULL)
+  {
+    LogError("Variable \"regions\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return;
+  }
+
+  for(int32_t rX = rX0; rX <= rX1; ++rX)
+  {
+    for(int32_t rZ = rZ0; rZ <= rZ1; ++rZ)
+      GetRegionStructures(noiseState, rX, rZ, &regions[(rX - rX0) * (rZ1 - rZ0 + 1) + (rZ - rZ0)]);
+  }
+
+  /* All overwriting runs are stamped before the runs that only fill air, and structures are always visited in the same
+   * (world) order. Hence, neighbouring chunks agree on every block, no matter which chunk is generated first. */
+  for(int32_t pass = 0; pass < 2; ++pass)
+  {
+    for(int32_t i = 0; i < numRegions; ++i)
+    {
+      for(int32_t j = 0; j < regions[i].numStructures; ++j)
+      {
+        const Structure* s = &regions[i].structures[j];
+        const StructureTemplate* t = &sTemplates[s->type];
+
+        if(s->bX + t->radius < cStartX - 1 || s->bX - t->radius > cStartX + CHUNK_WIDTH ||
+           s->bZ + t->radius < cStartZ - 1 || s->bZ - t->radius > cStartZ + CHUNK_WIDTH)
+          continue;
+
+        if(pass == 0)
+          StampRuns(c, s, t->runs, t->numOverwriteRuns);
+        else
+          StampRuns(c, s, t->runs + t->numOverwriteRuns, t->numRuns - t->numOverwriteRuns);
+      }
+    }
+  }
+
+  free(regions);
+}
+
+void StructureGeneratorFree()
+{
+  call_once(&sInitFlag, StructureGeneratorInit);
+
+  mtx_lock(&sRegionCacheMtx);
+  for(int32_t i = 0; i < STRUCTURE_REGION_CACHE_SIZE; ++i)
+    sRegionCache[i].valid = false;
+  mtx_unlock(&sRegionCacheMtx);
+}
\ No newline at end of file
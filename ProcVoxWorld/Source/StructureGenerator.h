@@ -0,0 +1,23 @@
+#pragma once
+
+#include "NoiseGenerator.h"
+
+#include "Map/Chunk.h"
+
+/* Structures (trees, ...) may reach across chunk borders. Their positions are chosen per region of
+ * "STRUCTURE_REGION_WIDTH" x "STRUCTURE_REGION_WIDTH" columns, only from the seed and the region coordinates, 
+ * so every chunk knows the structures of its neighbourhood without generating any neighbour chunk. */
+#define STRUCTURE_REGION_WIDTH 16
+
+//Upper bound of the structures of a region; further candidates are dropped.
+#define STRUCTURE_MAX_PER_REGION 32
+
+//Regions whose structures are kept (direct-mapped); several chunks share the structures of a region.
+#define STRUCTURE_REGION_CACHE_SIZE 1024
+
+//Stamps every part of nearby structures that intersects chunk "c" (including its neighbour data); thread-safe.
+void StructureGeneratorStampChunk(noiseState* noiseState, Chunk* c);
+
+/* Forgets the cached regions, whose structures were placed on the terrain of the current world generator (it is done by
+ * "WorldGeneratorFree()"). */
+void StructureGeneratorFree();
\ No newline at end of file
@@ -0,0 +1,722 @@
+#include "TerrainGraph.h"
+
+#include "NoiseGenerator.h"
+
+#include <ctype.h>
+
+#define TERRAIN_GRAPH_MAX_NODES         64
+#define TERRAIN_GRAPH_MAX_REGISTERS     96
+#define TERRAIN_GRAPH_MAX_TOKENS        24
+#define TERRAIN_GRAPH_MAX_SPLINE_POINTS 8
+#define TERRAIN_GRAPH_NAME_LENGTH       32
+
+//Registers of the world column every program starts with.
+#define REGISTER_X 0
+#define REGISTER_Z 1
+
+typedef enum
+{
+  OP_CONST,
+  OP_NOISE,
+  OP_WARP,
+  OP_ADD,
+  OP_MUL,
+  OP_DIV,
+  OP_CLAMP,
+  OP_TRUNC,
+  OP_SELECT,
+  OP_SPLINE
+} TerrainOp;
+
+typedef struct
+{
+  TerrainOp op;
+
+  int32_t dst; //A warp writes the warped x to "dst" and the warped z to "dst" + 1.
+  int32_t src[4];
+
+  float value;   //"OP_CONST"
+  fnl_state fnl; //"OP_NOISE" and "OP_WARP"; the seed is set on evaluation.
+
+  int32_t numPoints; //"OP_SPLINE"
+  float points[TERRAIN_GRAPH_MAX_SPLINE_POINTS][2];
+} TerrainInstruction;
+
+typedef struct
+{
+  char name[TERRAIN_GRAPH_NAME_LENGTH];
+  bool isWarp;
+
+  TerrainInstruction instr;
+} TerrainNode;
+
+typedef struct
+{
+  TerrainInstruction* code;
+  int32_t length;
+
+  int32_t result;
+} TerrainProgram;
+
+struct TerrainGraph
+{
+  TerrainProgram programs[AMOUNT_TERRAIN_GRAPH_OUTPUTS];
+};
+
+//Everything only needed while a file is loaded.
+typedef struct
+{
+  const char* path;
+  int32_t line;
+
+  TerrainNode nodes[TERRAIN_GRAPH_MAX_NODES];
+  int32_t numNodes;
+  int32_t numRegisters;
+
+  int32_t registerNode[TERRAIN_GRAPH_MAX_REGISTERS]; //Node writing the register; -1 for the world column.
+} TerrainParser;
+
+static const char* outputNames[AMOUNT_TERRAIN_GRAPH_OUTPUTS] =
+{
+  "biome",
+  "heightPlains",
+  "heightForest",
+  "heightFlowerForest",
+  "heightMountains",
+  "heightDesert",
+  "heightWater"
+};
+
+static const struct
+{
+  const char* name;
+  fnl_noise_type type;
+} noiseTypes[] =
+{
+  {"opensimplex2", FNL_NOISE_OPENSIMPLEX2},
+  {"opensimplex2s", FNL_NOISE_OPENSIMPLEX2S},
+  {"cellular", FNL_NOISE_CELLULAR},
+  {"perlin", FNL_NOISE_PERLIN},
+  {"valuecubic", FNL_NOISE_VALUE_CUBIC},
+  {"value", FNL_NOISE_VALUE}
+};
+
+static const struct
+{
+  const char* name;
+  fnl_domain_warp_type type;
+} warpTypes[] =
+{
+  {"opensimplex2", FNL_DOMAIN_WARP_OPENSIMPLEX2},
+  {"opensimplex2reduced", FNL_DOMAIN_WARP_OPENSIMPLEX2_REDUCED},
+  {"basicgrid", FNL_DOMAIN_WARP_BASICGRID}
+};
+
+static int32_t FindNode(TerrainParser* p, const char* name)
+{
+  for(int32_t i = 0; i < p->numNodes; ++i)
+  {
+    if(strcmp(p->nodes[i].name, name) == 0)
+      return i;
+  }
+
+  return -1;
+}
+
+static bool ParseNumber(const char* token, float* value)
+{
+  char* end;
+  *value = strtof(token, &end);
+
+  return end != token && *end == '\0';
+}
+
+//Appends a node and assigns its register(s); returns its index or -1.
+static int32_t AddNode(TerrainParser* p, const char* name, TerrainOp op, bool isWarp)
+{
+  const int32_t numRegisters = isWarp ? 2 : 1;
+  if(p->numNodes == TERRAIN_GRAPH_MAX_NODES || p->numRegisters + numRegisters > TERRAIN_GRAPH_MAX_REGISTERS)
+  {
+    LogError("Terrain graph \"%s\", line %d: Too many nodes (at most %d).", true, p->path, p->line, TERRAIN_GRAPH_MAX_NODES);
+
+    return -1;
+  }
+
+  TerrainNode* node = &p->nodes[p->numNodes];
+  memset(node, 0, sizeof(TerrainNode));
+  strcpy_s(node->name, ARRAY_SIZE(node->name), name);
+  node->isWarp = isWarp;
+  node->instr.op = op;
+  node->instr.dst = p->numRegisters;
+
+  for(int32_t i = 0; i < numRegisters; ++i)
+    p->registerNode[p->numRegisters++] = p->numNodes;
+
+  return p->numNodes++;
+}
+
+//Register of a scalar operand: a number, an earlier node or a built-in input.
+static int32_t ParseOperand(TerrainParser* p, const char* token)
+{
+  float value;
+  if(ParseNumber(token, &value) || strcmp(token, "chunkHeight") == 0)
+  {
+    if(strcmp(token, "chunkHeight") == 0)
+      value = (float)CHUNK_HEIGHT;
+
+    //Constants become unnamed nodes, so that every operand is a register.
+    int32_t node = AddNode(p, "", OP_CONST, false);
+    if(node < 0)
+      return -1;
+
+    p->nodes[node].instr.value = value;
+
+    return p->nodes[node].instr.dst;
+  }
+
+  if(strcmp(token, "x") == 0)
+    return REGISTER_X;
+
+  if(strcmp(token, "z") == 0)
+    return REGISTER_Z;
+
+  int32_t node = FindNode(p, token);
+  if(node < 0 || p->nodes[node].isWarp)
+  {
+    LogError("Terrain graph \"%s\", line %d: \"%s\" is neither a number nor a previously defined (non-warp) node.", true, p->path, p->line, token);
+
+    return -1;
+  }
+
+  return p->nodes[node].instr.dst;
+}
+
+//Register of the (x, z) pair a noise source or warp samples at: a warp node or, if omitted, the world column.
+static int32_t ParseCoordinates(TerrainParser* p, const char* token)
+{
+  if(token == NULL)
+    return REGISTER_X;
+
+  int32_t node = FindNode(p, token);
+  if(node < 0 || !p->nodes[node].isWarp)
+  {
+    LogError("Terrain graph \"%s\", line %d: \"%s\" is not a previously defined warp node.", true, p->path, p->line, token);
+
+    return -1;
+  }
+
+  return p->nodes[node].instr.dst;
+}
+
+/* "<type> <frequency> <octaves> <lacunarity> <gain>" of noise sources and warps.
+ * Apart from that, the settings equal those of "NoiseGeneratorCreateState()". */
+static bool ParseNoiseSettings(TerrainParser* p, char** tokens, fnl_state* fnl)
+{
+  float freq, octaves, lacunarity, gain;
+  if(!ParseNumber(tokens[1], &freq) || !ParseNumber(tokens[2], &octaves) || !ParseNumber(tokens[3], &lacunarity) || !ParseNumber(tokens[4], &gain))
+  {
+    LogError("Terrain graph \"%s\", line %d: Frequency, octaves, lacunarity and gain have to be numbers.", true, p->path, p->line);
+
+    return false;
+  }
+
+  *fnl = NoiseGeneratorCreateFnl(0);
+  NoiseGeneratorSetSettings(fnl, FNL_NOISE_OPENSIMPLEX2, freq, (int32_t)octaves, lacunarity, gain);
+
+  return true;
+}
+
+static bool ParseLine(TerrainParser* p, char** tokens, int32_t numTokens)
+{
+  if(numTokens < 3 || strcmp(tokens[1], "=") != 0)
+  {
+    LogError("Terrain graph \"%s\", line %d: Expected \"<name> = <operation> <operands ...>\".", true, p->path, p->line);
+
+    return false;
+  }
+
+  const char* name = tokens[0];
+  const char* op = tokens[2];
+  char** args = tokens + 3;
+  const int32_t numArgs = numTokens - 3;
+
+  if(strlen(name) >= TERRAIN_GRAPH_NAME_LENGTH || FindNode(p, name) >= 0 || !strcmp(name, "x") || !strcmp(name, "z") || !strcmp(name, "chunkHeight"))
+  {
+    LogError("Terrain graph \"%s\", line %d: \"%s\" is already defined or too long.", true, p->path, p->line, name);
+
+    return false;
+  }
+
+  //Operands are parsed first, so that they end up in front of the node using them.
+  int32_t src[4] = {0};
+  fnl_state fnl;
+  TerrainOp terrainOp;
+  bool isWarp = false;
+  int32_t numPoints = 0;
+  float points[TERRAIN_GRAPH_MAX_SPLINE_POINTS][2];
+
+  if(!strcmp(op, "noise") || !strcmp(op, "warp"))
+  {
+    isWarp = !strcmp(op, "warp");
+    const int32_t numSettings = isWarp ? 6 : 5;
+
+    if(numArgs != numSettings && numArgs != numSettings + 1)
+    {
+      LogError("Terrain graph \"%s\", line %d: \"%s\" expects %d or %d operands.", true, p->path, p->line, op, numSettings, numSettings + 1);
+
+      return false;
+    }
+
+    if(!ParseNoiseSettings(p, args, &fnl))
+      return false;
+
+    bool knownType = false;
+    if(isWarp)
+    {
+      float amp;
+      if(!ParseNumber(args[5], &amp))
+      {
+        LogError("Terrain graph \"%s\", line %d: The warp amplitude has to be a number.", true, p->path, p->line);
+
+        return false;
+      }
+
+      fnl.domain_warp_amp = amp;
+
+      for(size_t i = 0; i < ARRAY_SIZE(warpTypes); ++i)
+      {
+        if(!strcmp(args[0], warpTypes[i].name))
+        {
+          fnl.domain_warp_type = warpTypes[i].type;
+          knownType = true;
+        }
+      }
+    }
+    else
+    {
+      for(size_t i = 0; i < ARRAY_SIZE(noiseTypes); ++i)
+      {
+        if(!strcmp(args[0], noiseTypes[i].name))
+        {
+          fnl.noise_type = noiseTypes[i].type;
+          knownType = true;
+        }
+      }
+
+      //Cellular noise yields the value of its cell (Voronoi diagram), like the biome noise always did.
+      fnl.cellular_return_type = FNL_CELLULAR_RETURN_VALUE_CELLVALUE;
+    }
+
+    if(!knownType)
+    {
+      LogError("Terrain graph \"%s\", line %d: Unknown %s type \"%s\".", true, p->path, p->line, op, args[0]);
+
+      return false;
+    }
+
+    src[0] = ParseCoordinates(p, numArgs > numSettings ? args[numSettings] : NULL);
+    if(src[0] < 0)
+      return false;
+
+    terrainOp = isWarp ? OP_WARP : OP_NOISE;
+  }
+  else
+  {
+    static const struct
+    {
+      const char* name;
+      TerrainOp op;
+      int32_t numArgs;
+    } arithmetic[] =
+    {
+      {"add", OP_ADD, 2},
+      {"mul", OP_MUL, 2},
+      {"div", OP_DIV, 2},
+      {"clamp", OP_CLAMP, 3},
+      {"trunc", OP_TRUNC, 1},
+      {"select", OP_SELECT, 4},
+      {"spline", OP_SPLINE, -1}
+    };
+
+    int32_t found = -1;
+    for(int32_t i = 0; i < (int32_t)ARRAY_SIZE(arithmetic); ++i)
+    {
+      if(!strcmp(op, arithmetic[i].name))
+        found = i;
+    }
+
+    if(found < 0)
+    {
+      LogError("Terrain graph \"%s\", line %d: Unknown operation \"%s\".", true, p->path, p->line, op);
+
+      return false;
+    }
+
+    terrainOp = arithmetic[found].op;
+
+    if(terrainOp == OP_SPLINE)
+    {
+      //"spline <value> <x0> <y0> <x1> <y1> ..." with ascending x.
+      numPoints = (numArgs - 1) / 2;
+      if(numArgs < 3 || (numArgs - 1) % 2 != 0 || numPoints > TERRAIN_GRAPH_MAX_SPLINE_POINTS)
+      {
+        LogError("Terrain graph \"%s\", line %d: \"spline\" expects a value and 1 to %d points.", true, p->path, p->line, TERRAIN_GRAPH_MAX_SPLINE_POINTS);
+
+        return false;
+      }
+
+      for(int32_t i = 0; i < numPoints; ++i)
+      {
+        if(!ParseNumber(args[1 + 2 * i], &points[i][0]) || !ParseNumber(args[2 + 2 * i], &points[i][1]) || (i > 0 && points[i][0] <= points[i - 1][0]))
+        {
+          LogError("Terrain graph \"%s\", line %d: Spline points have to be numbers with ascending x.", true, p->path, p->line);
+
+          return false;
+        }
+      }
+
+      src[0] = ParseOperand(p, args[0]);
+      if(src[0] < 0)
+        return false;
+    }
+    else
+    {
+      if(numArgs != arithmetic[found].numArgs)
+      {
+        LogError("Terrain graph \"%s\", line %d: \"%s\" expects %d operands.", true, p->path, p->line, op, arithmetic[found].numArgs);
+
+        return false;
+      }
+
+      for(int32_t i = 0; i < numArgs; ++i)
+      {
+        src[i] = ParseOperand(p, args[i]);
+        if(src[i] < 0)
+          return false;
+      }
+    }
+  }
+
+  int32_t node = AddNode(p, name, terrainOp, isWarp);
+  if(node < 0)
+    return false;
+
+  TerrainInstruction* instr = &p->nodes[node].instr;
+  memcpy(instr->src, src, sizeof(src));
+
+  if(terrainOp == OP_NOISE || terrainOp == OP_WARP)
+    instr->fnl = fnl;
+
+  instr->numPoints = numPoints;
+  memcpy(instr->points, points, sizeof(float) * 2 * numPoints);
+
+  return true;
+}
+
+static void MarkUsed(const TerrainParser* p, int32_t node, bool* used)
+{
+  if(used[node])
+    return;
+
+  used[node] = true;
+
+  const TerrainInstruction* instr = &p->nodes[node].instr;
+
+  int32_t numSrc;
+  switch(instr->op)
+  {
+    case OP_CONST:
+      numSrc = 0;
+      break;
+    case OP_NOISE:
+    case OP_WARP:
+    case OP_TRUNC:
+    case OP_SPLINE:
+      numSrc = 1;
+      break;
+    case OP_CLAMP:
+      numSrc = 3;
+      break;
+    case OP_SELECT:
+      numSrc = 4;
+      break;
+    default:
+      numSrc = 2;
+      break;
+  }
+
+  for(int32_t i = 0; i < numSrc; ++i)
+  {
+    const int32_t srcNode = p->registerNode[instr->src[i]];
+    if(srcNode >= 0)
+      MarkUsed(p, srcNode, used);
+  }
+}
+
+/* Compiles one output: only the nodes it depends on are kept, in file order - as every operand has to be defined
+ * before it is used, this is already a valid evaluation order. */
+static bool CompileOutput(const TerrainParser* p, TerrainGraphOutput output, TerrainProgram* program)
+{
+  const int32_t resultNode = FindNode((TerrainParser*)p, outputNames[output]);
+  if(resultNode < 0 || p->nodes[resultNode].isWarp)
+  {
+    LogError("Terrain graph \"%s\": The output \"%s\" is missing (or is a warp).", true, p->path, outputNames[output]);
+
+    return false;
+  }
+
+  bool used[TERRAIN_GRAPH_MAX_NODES] = {false};
+  MarkUsed(p, resultNode, used);
+
+  program->length = 0;
+  for(int32_t i = 0; i < p->numNodes; ++i)
+    program->length += used[i];
+
+  program->code = (TerrainInstruction*)OwnMalloc(program->length * sizeof(TerrainInstruction), false);
+
+  if(program->code == NULL)
+  {
+    LogError("Variable \"program->code\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return false;
+  }
+
+  int32_t length = 0;
+  for(int32_t i = 0; i < p->numNodes; ++i)
+  {
+    if(used[i])
+      program->code[length++] = p->nodes[i].instr;
+  }
+
+  program->result = p->nodes[resultNode].instr.dst;
+
+  return true;
+}
+
+//Splits "line" in place at whitespace; a '#' starts a comment.
+static int32_t Tokenize(char* line, char** tokens)
+{
+  int32_t numTokens = 0;
+  char* c = line;
+
+  while(*c != '\0' && *c != '#')
+  {
+    if(isspace((unsigned char)*c))
+    {
+      *c++ = '\0';
+      continue;
+    }
+
+    if(numTokens == TERRAIN_GRAPH_MAX_TOKENS)
+      return -1;
+
+    tokens[numTokens++] = c;
+    while(*c != '\0' && *c != '#' && !isspace((unsigned char)*c))
+      ++c;
+  }
+
+  *c = '\0';
+
+  return numTokens;
+}
+
+TerrainGraph* TerrainGraphLoad(const char* path)
+{
+  FILE* f = NULL;
+  errno_t err = fopen_s(&f, path, "r");
+
+  if(err != 0 || f == NULL)
+  {
+    char errMsg[94];
+    strerror_s(errMsg, ARRAY_SIZE(errMsg), err);
+    LogError("Terrain graph \"%s\" could not be opened.\nError message from \"fopen_s()\": %s", true, path, errMsg);
+
+    return NULL;
+  }
+
+  TerrainParser* p = (TerrainParser*)OwnMalloc(sizeof(TerrainParser), false);
+  TerrainGraph* graph = (TerrainGraph*)OwnMalloc(sizeof(TerrainGraph), false);
+
+  if(p == NULL || graph == NULL)
+  {
+    LogError("Variables \"p\" and \"graph\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    free(p);
+    free(graph);
+    fclose(f);
+
+    return NULL;
+  }
+
+  p->path = path;
+  p->registerNode[REGISTER_X] = -1;
+  p->registerNode[REGISTER_Z] = -1;
+  p->numRegisters = 2;
+
+  bool valid = true;
+  char line[512];
+  while(valid && fgets(line, sizeof(line), f) != NULL)
+  {
+    ++p->line;
+
+    char* tokens[TERRAIN_GRAPH_MAX_TOKENS];
+    int32_t numTokens = Tokenize(line, tokens);
+
+    if(numTokens < 0)
+    {
+      LogError("Terrain graph \"%s\", line %d: Too many tokens (at most %d).", true, path, p->line, TERRAIN_GRAPH_MAX_TOKENS);
+      valid = false;
+    }
+    else if(numTokens > 0)
+      valid = ParseLine(p, tokens, numTokens);
+  }
+
+  fclose(f);
+
+  for(int32_t i = 0; valid && i < AMOUNT_TERRAIN_GRAPH_OUTPUTS; ++i)
+    valid = CompileOutput(p, (TerrainGraphOutput)i, &graph->programs[i]);
+
+  free(p);
+
+  if(!valid)
+  {
+    TerrainGraphFree(graph);
+
+    return NULL;
+  }
+
+  int32_t totalLength = 0;
+  for(int32_t i = 0; i < AMOUNT_TERRAIN_GRAPH_OUTPUTS; ++i)
+    totalLength += graph->programs[i].length;
+
+  LogSuccess("Terrain graph \"%s\" was loaded (%d instructions for %d outputs).", true, path, totalLength, AMOUNT_TERRAIN_GRAPH_OUTPUTS);
+
+  return graph;
+}
+
+static float Spline(const TerrainInstruction* instr, float v)
+{
+  if(v <= instr->points[0][0])
+    return instr->points[0][1];
+
+  for(int32_t i = 1; i < instr->numPoints; ++i)
+  {
+    if(v < instr->points[i][0])
+    {
+      const float t = (v - instr->points[i - 1][0]) / (instr->points[i][0] - instr->points[i - 1][0]);
+
+      return instr->points[i - 1][1] + (instr->points[i][1] - instr->points[i - 1][1]) * t;
+    }
+  }
+
+  return instr->points[instr->numPoints - 1][1];
+}
+
+static void Execute(const TerrainProgram* program, int32_t seed, float regs[][TERRAIN_GRAPH_BATCH], int32_t n)
+{
+  for(int32_t pc = 0; pc < program->length; ++pc)
+  {
+    const TerrainInstruction* instr = &program->code[pc];
+
+    float* dst = regs[instr->dst];
+    const float* a = regs[instr->src[0]];
+    const float* b = regs[instr->src[1]];
+    const float* c = regs[instr->src[2]];
+    const float* d = regs[instr->src[3]];
+
+    switch(instr->op)
+    {
+      case OP_CONST:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = instr->value;
+        break;
+      case OP_NOISE:
+      {
+        fnl_state fnl = instr->fnl;
+        fnl.seed = seed;
+
+        //Coordinates are a pair of registers. Same range as "NoiseGenerator2D()": [0.0, 1.0]
+        const float* coordZ = regs[instr->src[0] + 1];
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = (fnlGetNoise2D(&fnl, a[i], coordZ[i]) + 1.0f) / 2.0f;
+        break;
+      }
+      case OP_WARP:
+      {
+        fnl_state fnl = instr->fnl;
+        fnl.seed = seed;
+
+        const float* coordZ = regs[instr->src[0] + 1];
+        float* dstZ = regs[instr->dst + 1];
+        for(int32_t i = 0; i < n; ++i)
+        {
+          float wX = a[i];
+          float wZ = coordZ[i];
+          fnlDomainWarp2D(&fnl, &wX, &wZ);
+
+          dst[i] = wX;
+          dstZ[i] = wZ;
+        }
+        break;
+      }
+      case OP_ADD:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = a[i] + b[i];
+        break;
+      case OP_MUL:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = a[i] * b[i];
+        break;
+      case OP_DIV:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = a[i] / b[i];
+        break;
+      case OP_CLAMP:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = MIN(MAX(a[i], b[i]), c[i]);
+        break;
+      case OP_TRUNC:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = (float)(int32_t)a[i];
+        break;
+      case OP_SELECT:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = a[i] < b[i] ? c[i] : d[i];
+        break;
+      case OP_SPLINE:
+        for(int32_t i = 0; i < n; ++i)
+          dst[i] = Spline(instr, a[i]);
+        break;
+    }
+  }
+}
+
+void TerrainGraphEvaluate(const TerrainGraph* graph, TerrainGraphOutput output, int32_t seed, const float* x, const float* z, int32_t count, float* result)
+{
+  const TerrainProgram* program = &graph->programs[output];
+
+  float regs[TERRAIN_GRAPH_MAX_REGISTERS][TERRAIN_GRAPH_BATCH];
+
+  for(int32_t start = 0; start < count; start += TERRAIN_GRAPH_BATCH)
+  {
+    const int32_t n = MIN(TERRAIN_GRAPH_BATCH, count - start);
+
+    memcpy(regs[REGISTER_X], x + start, n * sizeof(float));
+    memcpy(regs[REGISTER_Z], z + start, n * sizeof(float));
+
+    Execute(program, seed, regs, n);
+
+    memcpy(result + start, regs[program->result], n * sizeof(float));
+  }
+}
+
+void TerrainGraphFree(TerrainGraph* graph)
+{
+  if(graph == NULL)
+    return;
+
+  for(int32_t i = 0; i < AMOUNT_TERRAIN_GRAPH_OUTPUTS; ++i)
+    free(graph->programs[i].code);
+
+  free(graph);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Utils.h"
+
+/* Data-driven terrain: a small graph of operations (noise sources, domain warp, arithmetic, select, spline, ...)
+ * described in a text file (see "Terrain.graph"). Each output of the graph is compiled into a flat array of
+ * instructions, which is evaluated over a batch of columns - every instruction processes the whole batch at once. */
+
+//Columns evaluated at once; longer batches are split.
+#define TERRAIN_GRAPH_BATCH 64
+
+//Outputs: the biome (as its "Biome" value) and the column height of every biome, in order of "Biome".
+typedef enum
+{
+  TERRAIN_GRAPH_BIOME,
+  TERRAIN_GRAPH_HEIGHT_PLAINS,
+  TERRAIN_GRAPH_HEIGHT_FOREST,
+  TERRAIN_GRAPH_HEIGHT_FLOWER_FOREST,
+  TERRAIN_GRAPH_HEIGHT_MOUNTAINS,
+  TERRAIN_GRAPH_HEIGHT_DESERT,
+  TERRAIN_GRAPH_HEIGHT_WATER,
+  AMOUNT_TERRAIN_GRAPH_OUTPUTS
+} TerrainGraphOutput;
+
+typedef struct TerrainGraph TerrainGraph;
+
+//Returns "NULL" (and logs the reason) if the file cannot be read or is not a valid graph.
+TerrainGraph* TerrainGraphLoad(const char* path);
+
+//"x" and "z" are world block coordinates of "count" columns; thread-safe.
+void TerrainGraphEvaluate(const TerrainGraph* graph, TerrainGraphOutput output, int32_t seed, const float* x, const float* z, int32_t count, float* result);
+
+void TerrainGraphFree(TerrainGraph* graph);
\ No newline at end of file
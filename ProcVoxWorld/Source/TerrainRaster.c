@@ -0,0 +1,336 @@
+#include "TerrainRaster.h"
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct TerrainRaster
+{
+  TerrainRasterHeader header;
+
+  const uint8_t* base; //The whole file
+  size_t size;
+
+  size_t tileBytes;
+  int32_t tileShift;
+  int32_t tilesZ;
+
+#ifdef PLATFORM_WINDOWS
+  HANDLE file;
+  HANDLE mapping;
+#endif
+};
+
+static size_t TileBytes(int32_t tileWidth)
+{
+  const size_t bytes = (size_t)tileWidth * tileWidth * (sizeof(uint16_t) + sizeof(uint8_t));
+
+  return (bytes + TERRAIN_RASTER_ALIGNMENT - 1) / TERRAIN_RASTER_ALIGNMENT * TERRAIN_RASTER_ALIGNMENT;
+}
+
+static int32_t NumTiles(int32_t columns, int32_t tileWidth)
+{
+  return (int32_t)(((int64_t)columns + tileWidth - 1) / tileWidth);
+}
+
+//Everything but the mapping itself; the file has to hold at least a header.
+static bool ValidateHeader(const char* path, const TerrainRasterHeader* header, size_t fileSize)
+{
+  if(memcmp(header->magic, TERRAIN_RASTER_MAGIC, sizeof(header->magic)) != 0)
+  {
+    LogError("\"%s\" is not a terrain raster.", true, path);
+
+    return false;
+  }
+
+  const int32_t tileWidth = header->tileWidth;
+  if(tileWidth < 16 || tileWidth > 4096 || (tileWidth & (tileWidth - 1)) != 0 || header->width <= 0 || header->depth <= 0)
+  {
+    LogError("Terrain raster \"%s\" has an invalid size (%d x %d columns in tiles of %d).", true, path, header->width, header->depth, tileWidth);
+
+    return false;
+  }
+
+  const uint64_t expected = TERRAIN_RASTER_ALIGNMENT + (uint64_t)NumTiles(header->width, tileWidth) * NumTiles(header->depth, tileWidth) * TileBytes(tileWidth);
+  if(fileSize < expected)
+  {
+    LogError("Terrain raster \"%s\" is truncated (%llu of %llu bytes).", true, path, (unsigned long long)fileSize, (unsigned long long)expected);
+
+    return false;
+  }
+
+  return true;
+}
+
+static void Unmap(TerrainRaster* raster)
+{
+#ifdef PLATFORM_WINDOWS
+  if(raster->base != NULL)
+    UnmapViewOfFile(raster->base);
+  if(raster->mapping != NULL)
+    CloseHandle(raster->mapping);
+  if(raster->file != INVALID_HANDLE_VALUE)
+    CloseHandle(raster->file);
+#else
+  if(raster->base != NULL)
+    munmap((void*)raster->base, raster->size);
+#endif
+}
+
+//Maps the whole file read-only; pages are only read once they are touched.
+static bool Map(TerrainRaster* raster, const char* path)
+{
+#ifdef PLATFORM_WINDOWS
+  raster->mapping = NULL;
+  raster->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+
+  LARGE_INTEGER size;
+  if(raster->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(raster->file, &size))
+  {
+    LogError("Terrain raster \"%s\" could not be opened (error code: %lu).", true, path, GetLastError());
+
+    return false;
+  }
+
+  raster->size = (size_t)size.QuadPart;
+  if(raster->size < sizeof(TerrainRasterHeader))
+  {
+    LogError("\"%s\" is not a terrain raster.", true, path);
+
+    return false;
+  }
+
+  raster->mapping = CreateFileMappingA(raster->file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if(raster->mapping != NULL)
+    raster->base = (const uint8_t*)MapViewOfFile(raster->mapping, FILE_MAP_READ, 0, 0, 0);
+
+  if(raster->base == NULL)
+  {
+    LogError("Terrain raster \"%s\" could not be mapped (error code: %lu).", true, path, GetLastError());
+
+    return false;
+  }
+#else
+  const int fd = open(path, O_RDONLY);
+
+  struct stat st;
+  if(fd == -1 || fstat(fd, &st) != 0)
+  {
+    char errMsg[94];
+    strerror_s(errMsg, ARRAY_SIZE(errMsg), errno);
+    LogError("Terrain raster \"%s\" could not be opened.\nError message: %s", true, path, errMsg);
+
+    if(fd != -1)
+      close(fd);
+
+    return false;
+  }
+
+  raster->size = (size_t)st.st_size;
+  if(raster->size < sizeof(TerrainRasterHeader))
+  {
+    LogError("\"%s\" is not a terrain raster.", true, path);
+    close(fd);
+
+    return false;
+  }
+
+  void* view = mmap(NULL, raster->size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); //The mapping keeps the file open.
+
+  if(view == MAP_FAILED)
+  {
+    char errMsg[94];
+    strerror_s(errMsg, ARRAY_SIZE(errMsg), errno);
+    LogError("Terrain raster \"%s\" could not be mapped.\nError message: %s", true, path, errMsg);
+
+    return false;
+  }
+
+  //Chunks sample a few tiles scattered over the file; reading ahead would only page in tiles nobody asked for.
+  madvise(view, raster->size, MADV_RANDOM);
+  raster->base = (const uint8_t*)view;
+#endif
+
+  return true;
+}
+
+TerrainRaster* TerrainRasterOpen(const char* path)
+{
+  TerrainRaster* raster = (TerrainRaster*)OwnMalloc(sizeof(TerrainRaster), false);
+
+  if(raster == NULL)
+  {
+    LogError("Variable \"raster\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return NULL;
+  }
+
+  memset(raster, 0, sizeof(TerrainRaster));
+
+  if(!Map(raster, path))
+  {
+    Unmap(raster);
+    free(raster);
+
+    return NULL;
+  }
+
+  memcpy(&raster->header, raster->base, sizeof(TerrainRasterHeader));
+
+  if(!ValidateHeader(path, &raster->header, raster->size))
+  {
+    Unmap(raster);
+    free(raster);
+
+    return NULL;
+  }
+
+  raster->tileBytes = TileBytes(raster->header.tileWidth);
+  raster->tilesZ = NumTiles(raster->header.depth, raster->header.tileWidth);
+  while((1 << raster->tileShift) < raster->header.tileWidth)
+    ++raster->tileShift;
+
+  LogInfo("Terrain raster \"%s\": %d x %d columns from (%d, %d) in tiles of %d x %d (%.1f MB mapped).", true, path, raster->header.width, raster->header.depth,
+          raster->header.originX, raster->header.originZ, raster->header.tileWidth, raster->header.tileWidth, raster->size / 1048576.0);
+
+  return raster;
+}
+
+void TerrainRasterSampleRow(const TerrainRaster* raster, int32_t bX, int32_t bZ, int32_t step, int32_t count, uint16_t* heights, uint8_t* biomes)
+{
+  const TerrainRasterHeader* header = &raster->header;
+  const int32_t shift = raster->tileShift;
+  const int32_t mask = header->tileWidth - 1;
+  const size_t biomeOffset = (size_t)header->tileWidth * header->tileWidth * sizeof(uint16_t);
+
+  const int64_t x = (int64_t)bX - header->originX;
+  const bool rowInside = x >= 0 && x < header->width;
+
+  //The tile column and the row within its tiles are the same for all columns.
+  const uint8_t* tileColumn = rowInside ? raster->base + TERRAIN_RASTER_ALIGNMENT + (size_t)(x >> shift) * raster->tilesZ * raster->tileBytes : NULL;
+  const int32_t rowIndex = ((int32_t)x & mask) << shift;
+
+  for(int32_t i = 0; i < count; ++i)
+  {
+    const int64_t z = (int64_t)bZ + (int64_t)i * step - header->originZ;
+
+    if(!rowInside || z < 0 || z >= header->depth)
+    {
+      if(heights != NULL)
+        heights[i] = header->fillHeight;
+      if(biomes != NULL)
+        biomes[i] = header->fillBiome;
+
+      continue;
+    }
+
+    const uint8_t* tile = tileColumn + (size_t)(z >> shift) * raster->tileBytes;
+    const int32_t index = rowIndex + ((int32_t)z & mask);
+
+    if(heights != NULL)
+      heights[i] = ((const uint16_t*)tile)[index];
+    if(biomes != NULL)
+      biomes[i] = tile[biomeOffset + index];
+  }
+}
+
+const TerrainRasterHeader* TerrainRasterGetHeader(const TerrainRaster* raster)
+{
+  return &raster->header;
+}
+
+void TerrainRasterClose(TerrainRaster* raster)
+{
+  if(raster == NULL)
+    return;
+
+  Unmap(raster);
+  free(raster);
+}
+
+bool TerrainRasterWrite(const char* path, const TerrainRasterHeader* header, TerrainRasterSource source, void* data)
+{
+  TerrainRasterHeader fileHeader = *header;
+  memcpy(fileHeader.magic, TERRAIN_RASTER_MAGIC, sizeof(fileHeader.magic));
+
+  //Any size is enough for the header to be validated.
+  if(!ValidateHeader(path, &fileHeader, SIZE_MAX))
+    return false;
+
+  FILE* f = NULL;
+  errno_t err = fopen_s(&f, path, "wb");
+
+  if(err != 0 || f == NULL)
+  {
+    char errMsg[94];
+    strerror_s(errMsg, ARRAY_SIZE(errMsg), err);
+    LogError("Terrain raster \"%s\" could not be created.\nError message from \"fopen_s()\": %s", true, path, errMsg);
+
+    return false;
+  }
+
+  const int32_t tileWidth = fileHeader.tileWidth;
+  const size_t tileBytes = TileBytes(tileWidth);
+  uint8_t* tile = (uint8_t*)OwnMalloc(MAX(tileBytes, TERRAIN_RASTER_ALIGNMENT), false);
+
+  if(tile == NULL)
+  {
+    LogError("Variable \"tile\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    fclose(f);
+
+    return false;
+  }
+
+  memset(tile, 0, TERRAIN_RASTER_ALIGNMENT);
+  memcpy(tile, &fileHeader, sizeof(TerrainRasterHeader));
+  bool success = fwrite(tile, TERRAIN_RASTER_ALIGNMENT, 1, f) == 1;
+
+  uint16_t* heights = (uint16_t*)tile;
+  uint8_t* biomes = tile + (size_t)tileWidth * tileWidth * sizeof(uint16_t);
+
+  const int32_t tilesX = NumTiles(fileHeader.width, tileWidth);
+  const int32_t tilesZ = NumTiles(fileHeader.depth, tileWidth);
+
+  for(int32_t tX = 0; tX < tilesX && success; ++tX)
+  {
+    for(int32_t tZ = 0; tZ < tilesZ && success; ++tZ)
+    {
+      memset(tile, 0, tileBytes);
+
+      for(int32_t lX = 0; lX < tileWidth; ++lX)
+      {
+        const int32_t x = tX * tileWidth + lX;
+        const int32_t z = tZ * tileWidth;
+        const int32_t count = x < fileHeader.width ? MIN(tileWidth, fileHeader.depth - z) : 0;
+
+        if(count > 0)
+          source(data, x, z, count, &heights[lX * tileWidth], &biomes[lX * tileWidth]);
+
+        //Padding beyond the raster
+        for(int32_t lZ = count; lZ < tileWidth; ++lZ)
+        {
+          heights[lX * tileWidth + lZ] = fileHeader.fillHeight;
+          biomes[lX * tileWidth + lZ] = fileHeader.fillBiome;
+        }
+      }
+
+      success = fwrite(tile, tileBytes, 1, f) == 1;
+    }
+  }
+
+  free(tile);
+
+  if(fclose(f) != 0 || !success)
+  {
+    LogError("Terrain raster \"%s\" could not be written completely.", true, path);
+    remove(path);
+
+    return false;
+  }
+
+  return true;
+}
\ No newline at end of file
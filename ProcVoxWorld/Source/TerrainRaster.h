@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Utils.h"
+
+/* Authored terrain: a raster of 16-bit heights and 8-bit biome indices (in order of "Biome") in a raw tiled file, which is
+ * memory-mapped as a whole. The file is never read up front; the operating system pages in the tiles that are actually
+ * sampled and may drop them again under memory pressure, so rasters can be far larger than the RAM. Sampling takes
+ * no locks, thus any number of threads can read at once.
+ *
+ * Layout (little-endian): "TerrainRasterHeader" at offset 0, the tiles from offset "TERRAIN_RASTER_ALIGNMENT" on.
+ * Tiles are stored tile column by tile column (all tiles along the z-axis of the first tile column, then the next one),
+ * each one as "tileWidth" x "tileWidth" heights followed by as many biomes, both row by row along the z-axis.
+ * Every tile is padded to a multiple of "TERRAIN_RASTER_ALIGNMENT" bytes, so it never shares a page with another one;
+ * the tiles at the far edges are full-sized as well. */
+#define TERRAIN_RASTER_MAGIC     "PVWRAST1"
+#define TERRAIN_RASTER_ALIGNMENT 4096
+
+typedef struct
+{
+  char magic[8];
+  int32_t originX, originZ; //World column of the first raster column
+  int32_t width, depth;     //Columns along the x- and the z-axis
+  int32_t tileWidth;        //Power of two from 16 to 4096
+  uint16_t fillHeight;      //Height and biome of all columns outside of the raster
+  uint8_t fillBiome;
+  uint8_t reserved;
+} TerrainRasterHeader;
+
+typedef struct TerrainRaster TerrainRaster;
+
+//Returns "NULL" (and logs the reason) if the file cannot be mapped or is not a valid raster.
+TerrainRaster* TerrainRasterOpen(const char* path);
+
+/* Heights and biomes of "count" columns starting at world column ("bX", "bZ"), "step" blocks apart along the z-axis;
+ * both are stored without gaps and may be "NULL" if not needed. Thread-safe. */
+void TerrainRasterSampleRow(const TerrainRaster* raster, int32_t bX, int32_t bZ, int32_t step, int32_t count, uint16_t* heights, uint8_t* biomes);
+
+const TerrainRasterHeader* TerrainRasterGetHeader(const TerrainRaster* raster);
+
+void TerrainRasterClose(TerrainRaster* raster);
+
+//Fills the raster columns ("x", "z") to ("x", "z" + "count" - 1), counted from the first raster column.
+typedef void (*TerrainRasterSource)(void* data, int32_t x, int32_t z, int32_t count, uint16_t* heights, uint8_t* biomes);
+
+//Writes a raster tile by tile (only one tile is held in memory); "header->magic" is set by this function.
+bool TerrainRasterWrite(const char* path, const TerrainRasterHeader* header, TerrainRasterSource source, void* data);
\ No newline at end of file
@@ -1,10 +1,8 @@
 #include "TimeMeasurement.h"
 
-#define GLFW_INCLUDE_NONE //Prevent the GLFW-header from including the OpenGL-header.
-#include "GLFW/glfw3.h"
-
 #include <stdbool.h>
 #include <assert.h>
+#include <time.h>
 
 static bool noLastTime = true;
 static double lastTime = 0.0;
@@ -14,11 +12,11 @@ void TimeMeasurementOnNewFrame()
 {
   if(noLastTime)
   {
-    lastTime = glfwGetTime();
+    lastTime = TimeMeasurementNow();
     noLastTime = 0;
   }
 
-  double currTime = glfwGetTime();
+  double currTime = TimeMeasurementNow();
   dt = currTime - lastTime;
   lastTime = currTime;
 }
@@ -28,4 +26,12 @@ double TimeMeasurementGet()
   assert(!noLastTime);
 
   return dt;
+}
+
+double TimeMeasurementNow()
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC); //C11 and, in contrast to "clock_gettime()", also available with MSVC.
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
 }
\ No newline at end of file
@@ -2,4 +2,7 @@
 
 void TimeMeasurementOnNewFrame();
 
-double TimeMeasurementGet();
\ No newline at end of file
+double TimeMeasurementGet();
+
+//Wall-clock time in seconds; unlike "glfwGetTime()" usable without GLFW (e.g. for headless benchmarks).
+double TimeMeasurementNow();
\ No newline at end of file
@@ -1,5 +1,14 @@
 #include "Utils.h"
 
+#ifdef PLATFORM_WINDOWS
+#include <psapi.h>
+#elif defined PLATFORM_POSIX
+#include <sys/resource.h>
+#if defined __GNUC__ || defined __GNUG__
+#include <cpuid.h>
+#endif
+#endif
+
 CPUInfo GetCPUInfo()
 {
   CPUInfo result = {0};
@@ -85,6 +94,25 @@ CPUInfo GetCPUInfo()
   return result;
 }
 
+size_t GetPeakMemoryUsage()
+{
+#ifdef PLATFORM_WINDOWS
+  PROCESS_MEMORY_COUNTERS counters;
+  if(K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize;
+
+  return 0;
+#elif defined PLATFORM_POSIX
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+    return (size_t)usage.ru_maxrss * 1024; //Kilobytes on Linux
+
+  return 0;
+#else
+  return 0;
+#endif
+}
+
 const char* StringReplace(const char* search, const char* replace, int8_t* string)
 {
   int8_t* tempString, * searchStart;
@@ -119,110 +147,4 @@ const char* StringReplace(const char* search, const char* replace, int8_t* strin
   free(tempString);
 
   return string;
-}
-
-GLuint OpenGLCreateVAO()
-{
-  GLuint VAO;
-
-  glGenVertexArrays(1, &VAO);
-  glBindVertexArray(VAO);
-
-  //Newer OpenGL: glCreateVertexArrays(1, &VAO); //"glCreateVertexArrays()" (like other "glCreateX()" from DSA) also takes over the initialization, whereby "glBindVertexArray()" is rendered obsolete, however, only in this context.
-
-  return VAO;
-}
-
-GLuint OpenGLCreateVBO(const void* vertices, GLsizeiptr bufSize)
-{
-  GLuint VBO;
-
-  glGenBuffers(1, &VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, bufSize, vertices, GL_STATIC_DRAW);
-
- /* Newer OpenGL:
-  * glCreateBuffers(1, &VBO);
-  * glBindBuffer(GL_ARRAY_BUFFER, VBO); //Without this: Buffer object X is bound to "NONE".
-  * glNamedBufferData(VBO, bufSize, vertices, GL_STATIC_DRAW); //void glNamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage); */
-
-  return VBO;
-}
-
-GLuint OpenGLCreateVBOCube()
-{
-  static const float vertices[] = 
-  {
-    -1.0f,  1.0f, -1.0f,
-    -1.0f, -1.0f, -1.0f,
-     1.0f, -1.0f, -1.0f,
-     1.0f, -1.0f, -1.0f,
-     1.0f,  1.0f, -1.0f,
-    -1.0f,  1.0f, -1.0f,
-
-    -1.0f, -1.0f,  1.0f,
-    -1.0f, -1.0f, -1.0f,
-    -1.0f,  1.0f, -1.0f,
-    -1.0f,  1.0f, -1.0f,
-    -1.0f,  1.0f,  1.0f,
-    -1.0f, -1.0f,  1.0f,
-
-     1.0f, -1.0f, -1.0f,
-     1.0f, -1.0f,  1.0f,
-     1.0f,  1.0f,  1.0f,
-     1.0f,  1.0f,  1.0f,
-     1.0f,  1.0f, -1.0f,
-     1.0f, -1.0f, -1.0f,
-
-    -1.0f, -1.0f,  1.0f,
-    -1.0f,  1.0f,  1.0f,
-     1.0f,  1.0f,  1.0f,
-     1.0f,  1.0f,  1.0f,
-     1.0f, -1.0f,  1.0f,
-    -1.0f, -1.0f,  1.0f,
-
-    -1.0f,  1.0f, -1.0f,
-     1.0f,  1.0f, -1.0f,
-     1.0f,  1.0f,  1.0f,
-     1.0f,  1.0f,  1.0f,
-    -1.0f,  1.0f,  1.0f,
-    -1.0f,  1.0f, -1.0f,
-
-    -1.0f, -1.0f, -1.0f,
-    -1.0f, -1.0f,  1.0f,
-     1.0f, -1.0f, -1.0f,
-     1.0f, -1.0f, -1.0f,
-    -1.0f, -1.0f,  1.0f,
-     1.0f, -1.0f,  1.0f
-  };
-
-  return OpenGLCreateVBO(vertices, sizeof(vertices));
-}
-
-GLuint OpenGLCreateVBOQuad()
-{
-  static const float vertices[] = 
-  {
-    -0.5f, -0.5f, 0.0f,  0.0f, 0.0f,
-     0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
-    -0.5f,  0.5f, 0.0f,  0.0f, 1.0f,
-
-    -0.5f,  0.5f, 0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
-     0.5f,  0.5f, 0.0f,  1.0f, 1.0f
-  };
-
-  return OpenGLCreateVBO(vertices, sizeof(vertices));
-}
-
-GLuint OpenGLCreateFBO()
-{
-  GLuint FBO;
-
-  glGenFramebuffers(1, &FBO);
-  glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-
-  //Newer OpenGL: glCreateFramebuffers(1, &FBO);
- 
-  return FBO;
 }
\ No newline at end of file
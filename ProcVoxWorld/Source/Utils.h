@@ -18,10 +18,51 @@
 #define PLATFORM_WINDOWS
 #define PATH_SLASHES '//'
 #include "Windows.h"
-#elif defined _POSIX_VERSION //POSIX and UNIX are not operating systems. Rather they are formal or de facto standards followed to some degree by all UNIX-style OSes.
+#elif defined __unix__ || defined __APPLE__ //POSIX and UNIX are not operating systems. Rather they are formal or de facto standards followed to some degree by all UNIX-style OSes.
 #define PLATFORM_POSIX
-#define PATH_SLASHES '\\'
-#include "unistd.h"
+#define PATH_SLASHES '/'
+#include <unistd.h> //Defines "_POSIX_VERSION", hence it cannot be used to detect POSIX before.
+#endif
+
+#ifndef PLATFORM_WINDOWS
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+//The bounds-checked functions of Annex K are only provided by MSVC; these cover the way they are used here.
+typedef int errno_t;
+
+#define sprintf_s snprintf
+#define sscanf_s(str, fmt, dst, dstSize) sscanf(str, fmt, dst)
+
+static inline errno_t fopen_s(FILE** file, const char* path, const char* mode)
+{
+  *file = fopen(path, mode);
+
+  return *file == NULL ? errno : 0;
+}
+
+static inline errno_t strcpy_s(char* dest, size_t destSize, const char* src)
+{
+  snprintf(dest, destSize, "%s", src);
+
+  return 0;
+}
+
+static inline errno_t strcat_s(char* dest, size_t destSize, const char* src)
+{
+  const size_t length = strnlen(dest, destSize);
+  snprintf(dest + length, destSize - length, "%s", src);
+
+  return 0;
+}
+
+static inline errno_t strerror_s(char* buf, size_t bufSize, errno_t error)
+{
+  snprintf(buf, bufSize, "%s", strerror(error));
+
+  return 0;
+}
 #endif
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -50,6 +91,9 @@ typedef struct
 
 CPUInfo GetCPUInfo();
 
+//Largest resident set (working set) of the process so far in bytes; 0 if unknown.
+size_t GetPeakMemoryUsage();
+
 const char* StringReplace(const char* search, const char* replace, int8_t* string);
 
 GLuint OpenGLCreateVAO();
@@ -164,6 +208,26 @@ static inline uint32_t GetProcessorsCount()
 #endif
 }
 
+/* Acquire load and release store of a counter shared between threads; MSVC has no "<stdatomic.h>" in C mode.
+ * Loads and stores before the release store are visible to a thread once its acquire load sees the stored value. */
+static inline int64_t AtomicLoadAcquire(volatile int64_t* value)
+{
+#ifdef PLATFORM_WINDOWS
+  return InterlockedCompareExchange64(value, 0, 0);
+#else
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void AtomicStoreRelease(volatile int64_t* value, int64_t newValue)
+{
+#ifdef PLATFORM_WINDOWS
+  InterlockedExchange64(value, newValue);
+#else
+  __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+#endif
+}
+
 static inline void OwnGLMVec3Set(vec3 vec, float f0, float f1, float f2)
 {
   vec[0] = f0;
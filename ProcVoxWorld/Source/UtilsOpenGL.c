@@ -0,0 +1,108 @@
+#include "Utils.h"
+
+//Separate from "Utils.c", so that builds without OpenGL (e.g. the headless one) do not need these.
+GLuint OpenGLCreateVAO()
+{
+  GLuint VAO;
+
+  glGenVertexArrays(1, &VAO);
+  glBindVertexArray(VAO);
+
+  //Newer OpenGL: glCreateVertexArrays(1, &VAO); //"glCreateVertexArrays()" (like other "glCreateX()" from DSA) also takes over the initialization, whereby "glBindVertexArray()" is rendered obsolete, however, only in this context.
+
+  return VAO;
+}
+
+GLuint OpenGLCreateVBO(const void* vertices, GLsizeiptr bufSize)
+{
+  GLuint VBO;
+
+  glGenBuffers(1, &VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glBufferData(GL_ARRAY_BUFFER, bufSize, vertices, GL_STATIC_DRAW);
+
+ /* Newer OpenGL:
+  * glCreateBuffers(1, &VBO);
+  * glBindBuffer(GL_ARRAY_BUFFER, VBO); //Without this: Buffer object X is bound to "NONE".
+  * glNamedBufferData(VBO, bufSize, vertices, GL_STATIC_DRAW); //void glNamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage); */
+
+  return VBO;
+}
+
+GLuint OpenGLCreateVBOCube()
+{
+  static const float vertices[] = 
+  {
+    -1.0f,  1.0f, -1.0f,
+    -1.0f, -1.0f, -1.0f,
+     1.0f, -1.0f, -1.0f,
+     1.0f, -1.0f, -1.0f,
+     1.0f,  1.0f, -1.0f,
+    -1.0f,  1.0f, -1.0f,
+
+    -1.0f, -1.0f,  1.0f,
+    -1.0f, -1.0f, -1.0f,
+    -1.0f,  1.0f, -1.0f,
+    -1.0f,  1.0f, -1.0f,
+    -1.0f,  1.0f,  1.0f,
+    -1.0f, -1.0f,  1.0f,
+
+     1.0f, -1.0f, -1.0f,
+     1.0f, -1.0f,  1.0f,
+     1.0f,  1.0f,  1.0f,
+     1.0f,  1.0f,  1.0f,
+     1.0f,  1.0f, -1.0f,
+     1.0f, -1.0f, -1.0f,
+
+    -1.0f, -1.0f,  1.0f,
+    -1.0f,  1.0f,  1.0f,
+     1.0f,  1.0f,  1.0f,
+     1.0f,  1.0f,  1.0f,
+     1.0f, -1.0f,  1.0f,
+    -1.0f, -1.0f,  1.0f,
+
+    -1.0f,  1.0f, -1.0f,
+     1.0f,  1.0f, -1.0f,
+     1.0f,  1.0f,  1.0f,
+     1.0f,  1.0f,  1.0f,
+    -1.0f,  1.0f,  1.0f,
+    -1.0f,  1.0f, -1.0f,
+
+    -1.0f, -1.0f, -1.0f,
+    -1.0f, -1.0f,  1.0f,
+     1.0f, -1.0f, -1.0f,
+     1.0f, -1.0f, -1.0f,
+    -1.0f, -1.0f,  1.0f,
+     1.0f, -1.0f,  1.0f
+  };
+
+  return OpenGLCreateVBO(vertices, sizeof(vertices));
+}
+
+GLuint OpenGLCreateVBOQuad()
+{
+  static const float vertices[] = 
+  {
+    -0.5f, -0.5f, 0.0f,  0.0f, 0.0f,
+     0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f, 0.0f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, 0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, 0.0f,  1.0f, 1.0f
+  };
+
+  return OpenGLCreateVBO(vertices, sizeof(vertices));
+}
+
+GLuint OpenGLCreateFBO()
+{
+  GLuint FBO;
+
+  glGenFramebuffers(1, &FBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+
+  //Newer OpenGL: glCreateFramebuffers(1, &FBO);
+ 
+  return FBO;
+}
\ No newline at end of file
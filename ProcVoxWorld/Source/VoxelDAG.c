@@ -0,0 +1,655 @@
+#include "VoxelDAG.h"
+
+#include "NoiseGenerator.h"
+
+#include "Map/Block.h"
+
+#include <float.h>
+
+//A child is either the index of a node (of a leaf, if the parent is two blocks wide) or a whole cell of a single block type.
+#define DAG_UNIFORM 0x80000000u
+#define DAG_UNIFORM_REF(block) (DAG_UNIFORM | (uint32_t)(block))
+
+//Order of the children of a node and of the blocks of a leaf.
+#define DAG_CHILD(x, y, z) (((x) << 2) | ((y) << 1) | (z))
+
+//Regions of up to 2^30 blocks, which keeps all coordinates within "int32_t".
+#define DAG_MAX_DEPTH 30
+
+static const char fileMagic[8] = "PVW-DAG";
+
+struct VoxelDAG
+{
+  int32_t originX, originZ; //Lowest corner of the region (in blocks)
+  int32_t depth;
+  uint32_t root;
+
+  uint64_t* leaves; //One byte per block
+  uint32_t* nodes; //Eight children per node
+  int32_t numLeaves;
+  int32_t numNodes;
+};
+
+//Open addressing; every level has its own table, as equal children mean different cells on different levels.
+typedef struct
+{
+  uint32_t* slots; //Index + 1 of a leaf or node; zero is free.
+  uint32_t capacity; //Power of two
+  uint32_t count;
+} InternTable;
+
+struct VoxelDAGBuilder
+{
+  VoxelDAG* dag;
+  int32_t cX, cZ;
+  int32_t numChunks;
+
+  //Cubes of one chunk width; the grid only reaches as high as the chunks.
+  int32_t chunkLevel;
+  int32_t gridSide;
+  int32_t gridHeight;
+  uint32_t* grid;
+
+  int32_t capacityLeaves;
+  int32_t capacityNodes;
+  InternTable tables[DAG_MAX_DEPTH + 1]; //Index 1 holds the leaves.
+};
+
+typedef struct
+{
+  char magic[8];
+  int32_t originX, originZ;
+  int32_t depth;
+  uint32_t root;
+  int32_t numLeaves;
+  int32_t numNodes;
+} VoxelDAGFileHeader;
+
+static void* GrowArray(void* array, int32_t* capacity, size_t elementSize)
+{
+  *capacity = MAX(1024, *capacity * 2);
+  void* res = realloc(array, (size_t)*capacity * elementSize);
+
+  if(res == NULL)
+  {
+    LogError("RAM size is insufficient for the voxel DAG; a smaller region should help!", true);
+
+    exit(EXIT_FAILURE);
+  }
+
+  return res;
+}
+
+static uint32_t HashLeaf(uint64_t leaf)
+{
+  return NoiseGeneratorMix((uint32_t)leaf ^ NoiseGeneratorMix((uint32_t)(leaf >> 32)));
+}
+
+static uint32_t HashNode(const uint32_t* children)
+{
+  uint32_t h = 0;
+  for(int32_t i = 0; i < 8; ++i)
+    h = NoiseGeneratorMix(h ^ children[i]);
+
+  return h;
+}
+
+static uint32_t HashEntry(const VoxelDAG* dag, int32_t level, uint32_t index)
+{
+  return level == 1 ? HashLeaf(dag->leaves[index]) : HashNode(&dag->nodes[(size_t)index * 8]);
+}
+
+//Keeps the table at most half full.
+static void ReserveTableSlot(VoxelDAGBuilder* b, int32_t level)
+{
+  InternTable* table = &b->tables[level];
+  if(2 * (table->count + 1) <= table->capacity)
+    return;
+
+  const uint32_t capacity = MAX(4096, table->capacity * 2);
+  uint32_t* slots = (uint32_t*)OwnMalloc(capacity * sizeof(uint32_t), false);
+
+  if(slots == NULL)
+  {
+    LogError("RAM size is insufficient for the voxel DAG; a smaller region should help!", true);
+
+    exit(EXIT_FAILURE);
+  }
+
+  //"OwnMalloc()" does not clear large tables.
+  memset(slots, 0, capacity * sizeof(uint32_t));
+
+  for(uint32_t i = 0; i < table->capacity; ++i)
+  {
+    if(table->slots[i] == 0)
+      continue;
+
+    uint32_t h = HashEntry(b->dag, level, table->slots[i] - 1) & (capacity - 1);
+    while(slots[h] != 0)
+      h = (h + 1) & (capacity - 1);
+
+    slots[h] = table->slots[i];
+  }
+
+  free(table->slots);
+  table->slots = slots;
+  table->capacity = capacity;
+}
+
+static uint32_t InternLeaf(VoxelDAGBuilder* b, uint64_t leaf)
+{
+  VoxelDAG* dag = b->dag;
+  InternTable* table = &b->tables[1];
+  ReserveTableSlot(b, 1);
+
+  uint32_t h = HashLeaf(leaf) & (table->capacity - 1);
+  while(table->slots[h] != 0)
+  {
+    if(dag->leaves[table->slots[h] - 1] == leaf)
+      return table->slots[h] - 1;
+
+    h = (h + 1) & (table->capacity - 1);
+  }
+
+  if(dag->numLeaves == b->capacityLeaves)
+    dag->leaves = (uint64_t*)GrowArray(dag->leaves, &b->capacityLeaves, sizeof(uint64_t));
+
+  dag->leaves[dag->numLeaves] = leaf;
+  table->slots[h] = (uint32_t)++dag->numLeaves;
+  ++table->count;
+
+  return (uint32_t)dag->numLeaves - 1;
+}
+
+static uint32_t InternNode(VoxelDAGBuilder* b, int32_t level, const uint32_t children[8])
+{
+  VoxelDAG* dag = b->dag;
+  InternTable* table = &b->tables[level];
+  ReserveTableSlot(b, level);
+
+  uint32_t h = HashNode(children) & (table->capacity - 1);
+  while(table->slots[h] != 0)
+  {
+    if(memcmp(&dag->nodes[(size_t)(table->slots[h] - 1) * 8], children, 8 * sizeof(uint32_t)) == 0)
+      return table->slots[h] - 1;
+
+    h = (h + 1) & (table->capacity - 1);
+  }
+
+  if(dag->numNodes == b->capacityNodes)
+    dag->nodes = (uint32_t*)GrowArray(dag->nodes, &b->capacityNodes, 8 * sizeof(uint32_t));
+
+  memcpy(&dag->nodes[(size_t)dag->numNodes * 8], children, 8 * sizeof(uint32_t));
+  table->slots[h] = (uint32_t)++dag->numNodes;
+  ++table->count;
+
+  return (uint32_t)dag->numNodes - 1;
+}
+
+//Children of a node at "level"; cells whose children are all of the same block type are not stored.
+static uint32_t CombineChildren(VoxelDAGBuilder* b, int32_t level, const uint32_t children[8])
+{
+  bool uniform = (children[0] & DAG_UNIFORM) != 0;
+  for(int32_t i = 1; i < 8 && uniform; ++i)
+    uniform = children[i] == children[0];
+
+  return uniform ? children[0] : InternNode(b, level, children);
+}
+
+static uint32_t BuildSubtree(VoxelDAGBuilder* b, const uint8_t* blocks, int32_t x0, int32_t y0, int32_t z0, int32_t level)
+{
+  if(level == 1)
+  {
+    uint64_t leaf = 0;
+    bool uniform = true;
+    const uint8_t first = blocks[XYZ(x0, y0, z0)];
+
+    for(int32_t dX = 0; dX < 2; ++dX)
+    {
+      for(int32_t dY = 0; dY < 2; ++dY)
+      {
+        for(int32_t dZ = 0; dZ < 2; ++dZ)
+        {
+          const uint8_t block = blocks[XYZ(x0 + dX, y0 + dY, z0 + dZ)];
+          leaf |= (uint64_t)block << (8 * DAG_CHILD(dX, dY, dZ));
+          uniform &= block == first;
+        }
+      }
+    }
+
+    return uniform ? DAG_UNIFORM_REF(first) : InternLeaf(b, leaf);
+  }
+
+  const int32_t half = 1 << (level - 1);
+  uint32_t children[8];
+
+  for(int32_t dX = 0; dX < 2; ++dX)
+  {
+    for(int32_t dY = 0; dY < 2; ++dY)
+    {
+      for(int32_t dZ = 0; dZ < 2; ++dZ)
+        children[DAG_CHILD(dX, dY, dZ)] = BuildSubtree(b, blocks, x0 + dX * half, y0 + dY * half, z0 + dZ * half, level - 1);
+    }
+  }
+
+  return CombineChildren(b, level, children);
+}
+
+VoxelDAGBuilder* VoxelDAGBegin(int32_t cX, int32_t cZ, int32_t numChunks)
+{
+  if(CHUNK_WIDTH < 2 || (CHUNK_WIDTH & (CHUNK_WIDTH - 1)) != 0 || CHUNK_HEIGHT % CHUNK_WIDTH != 0)
+  {
+    LogError("A voxel DAG needs a chunk width which is a power of two and a chunk height which is a multiple of it (%d x %d).", true, CHUNK_WIDTH, CHUNK_HEIGHT);
+
+    return NULL;
+  }
+
+  VoxelDAGBuilder* b = (VoxelDAGBuilder*)OwnMalloc(sizeof(VoxelDAGBuilder), false);
+  VoxelDAG* dag = (VoxelDAG*)OwnMalloc(sizeof(VoxelDAG), false);
+
+  if(b == NULL || dag == NULL)
+  {
+    LogError("Variables \"b\" and \"dag\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    free(b);
+    free(dag);
+
+    return NULL;
+  }
+
+  b->dag = dag;
+  b->cX = cX;
+  b->cZ = cZ;
+  b->numChunks = MAX(1, numChunks);
+
+  while((1 << b->chunkLevel) < CHUNK_WIDTH)
+    ++b->chunkLevel;
+
+  dag->depth = b->chunkLevel;
+  while(dag->depth < DAG_MAX_DEPTH && ((1 << dag->depth) < b->numChunks * CHUNK_WIDTH || (1 << dag->depth) < CHUNK_HEIGHT))
+    ++dag->depth;
+
+  dag->originX = cX * CHUNK_WIDTH;
+  dag->originZ = cZ * CHUNK_WIDTH;
+
+  b->gridSide = 1 << (dag->depth - b->chunkLevel);
+  b->gridHeight = CHUNK_HEIGHT / CHUNK_WIDTH;
+  b->grid = (uint32_t*)OwnMalloc((size_t)b->gridSide * b->gridHeight * b->gridSide * sizeof(uint32_t), false);
+
+  if(b->grid == NULL)
+  {
+    LogError("Variable \"b->grid\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    free(b);
+    free(dag);
+
+    return NULL;
+  }
+
+  for(size_t i = 0; i < (size_t)b->gridSide * b->gridHeight * b->gridSide; ++i)
+    b->grid[i] = DAG_UNIFORM_REF(AIR_BLOCK);
+
+  return b;
+}
+
+bool VoxelDAGAddChunk(VoxelDAGBuilder* builder, const Chunk* c)
+{
+  const int32_t x = c->x - builder->cX;
+  const int32_t z = c->z - builder->cZ;
+
+  if(x < 0 || x >= builder->numChunks || z < 0 || z >= builder->numChunks)
+    return false;
+
+  for(int32_t y = 0; y < builder->gridHeight; ++y)
+    builder->grid[((size_t)x * builder->gridHeight + y) * builder->gridSide + z] = BuildSubtree(builder, c->blocks, 0, y * CHUNK_WIDTH, 0, builder->chunkLevel);
+
+  return true;
+}
+
+VoxelDAG* VoxelDAGFinish(VoxelDAGBuilder* builder)
+{
+  VoxelDAG* dag = builder->dag;
+
+  //Merges the grid level by level up to the root; above the chunks there is only air.
+  int32_t side = builder->gridSide;
+  int32_t height = builder->gridHeight;
+  int32_t level = builder->chunkLevel;
+  uint32_t* grid = builder->grid;
+
+  while(side > 1)
+  {
+    const int32_t nextSide = side / 2;
+    const int32_t nextHeight = (height + 1) / 2;
+    ++level;
+
+    for(int32_t x = 0; x < nextSide; ++x)
+    {
+      for(int32_t y = 0; y < nextHeight; ++y)
+      {
+        for(int32_t z = 0; z < nextSide; ++z)
+        {
+          uint32_t children[8];
+          for(int32_t dX = 0; dX < 2; ++dX)
+          {
+            for(int32_t dY = 0; dY < 2; ++dY)
+            {
+              for(int32_t dZ = 0; dZ < 2; ++dZ)
+              {
+                const int32_t cY = 2 * y + dY;
+                children[DAG_CHILD(dX, dY, dZ)] = cY < height ? grid[((size_t)(2 * x + dX) * height + cY) * side + 2 * z + dZ] : DAG_UNIFORM_REF(AIR_BLOCK);
+              }
+            }
+          }
+
+          //Written behind the cells which are still to be read.
+          grid[((size_t)x * nextHeight + y) * nextSide + z] = CombineChildren(builder, level, children);
+        }
+      }
+    }
+
+    side = nextSide;
+    height = nextHeight;
+  }
+
+  dag->root = grid[0];
+
+  for(int32_t i = 0; i < (int32_t)ARRAY_SIZE(builder->tables); ++i)
+    free(builder->tables[i].slots);
+  free(builder->grid);
+  free(builder);
+
+  //Read-only from now on.
+  uint64_t* leaves = (uint64_t*)realloc(dag->leaves, MAX(1, dag->numLeaves) * sizeof(uint64_t));
+  if(leaves != NULL)
+    dag->leaves = leaves;
+
+  uint32_t* nodes = (uint32_t*)realloc(dag->nodes, MAX(1, dag->numNodes) * 8 * sizeof(uint32_t));
+  if(nodes != NULL)
+    dag->nodes = nodes;
+
+  return dag;
+}
+
+//Block at the region coordinates ("x", "y", "z") and the level of the largest cell of a single block type around it (zero within a leaf).
+static uint8_t LookUp(const VoxelDAG* dag, int32_t x, int32_t y, int32_t z, int32_t* level)
+{
+  uint32_t ref = dag->root;
+  int32_t l = dag->depth;
+
+  while(!(ref & DAG_UNIFORM))
+  {
+    const int32_t bit = l - 1;
+    const int32_t child = DAG_CHILD((x >> bit) & 1, (y >> bit) & 1, (z >> bit) & 1);
+
+    if(l == 1)
+    {
+      *level = 0;
+
+      return (uint8_t)(dag->leaves[ref] >> (8 * child));
+    }
+
+    ref = dag->nodes[(size_t)ref * 8 + child];
+    --l;
+  }
+
+  *level = l;
+
+  return (uint8_t)ref;
+}
+
+uint8_t VoxelDAGGetBlock(const VoxelDAG* dag, int32_t bX, int32_t bY, int32_t bZ)
+{
+  const int32_t side = 1 << dag->depth;
+  const int32_t x = bX - dag->originX;
+  const int32_t z = bZ - dag->originZ;
+
+  if(x < 0 || x >= side || bY < 0 || bY >= side || z < 0 || z >= side)
+    return AIR_BLOCK;
+
+  int32_t level;
+  return LookUp(dag, x, bY, z, &level);
+}
+
+bool VoxelDAGRaycast(const VoxelDAG* dag, const float origin[3], const float dir[3], float maxDist, int32_t hit[3], uint8_t* hitBlock)
+{
+  const int32_t side = 1 << dag->depth;
+  const double o[3] = {(double)origin[0] - dag->originX, origin[1], (double)origin[2] - dag->originZ};
+
+  //Only the part of the ray within the region is traversed.
+  double tEnter = 0.0;
+  double tExit = maxDist;
+  for(int32_t a = 0; a < 3; ++a)
+  {
+    if(dir[a] == 0.0f)
+    {
+      if(o[a] < 0.0 || o[a] >= side)
+        return false;
+
+      continue;
+    }
+
+    const double t0 = -o[a] / dir[a];
+    const double t1 = (side - o[a]) / dir[a];
+    tEnter = MAX(tEnter, MIN(t0, t1));
+    tExit = MIN(tExit, MAX(t0, t1));
+  }
+
+  //Cells are looked up slightly behind the boundary the ray has just crossed.
+  const double epsilon = 1e-6;
+
+  double t = tEnter;
+  while(t <= tExit)
+  {
+    int32_t cell[3];
+    for(int32_t a = 0; a < 3; ++a)
+      cell[a] = glm_clamp((int32_t)floor(o[a] + dir[a] * (t + epsilon)), 0, side - 1);
+
+    int32_t level;
+    const uint8_t block = LookUp(dag, cell[0], cell[1], cell[2], &level);
+
+    if(block != AIR_BLOCK)
+    {
+      hit[0] = cell[0] + dag->originX;
+      hit[1] = cell[1];
+      hit[2] = cell[2] + dag->originZ;
+      *hitBlock = block;
+
+      return true;
+    }
+
+    //The whole cell is air, so the ray continues where it leaves the cell.
+    const int32_t size = 1 << level;
+    double tNext = DBL_MAX;
+    for(int32_t a = 0; a < 3; ++a)
+    {
+      if(dir[a] != 0.0f)
+      {
+        const int32_t bound = (cell[a] & ~(size - 1)) + (dir[a] > 0.0f ? size : 0);
+        tNext = MIN(tNext, (bound - o[a]) / dir[a]);
+      }
+    }
+
+    t = MAX(tNext, t + epsilon);
+  }
+
+  return false;
+}
+
+static int64_t CountInCell(const VoxelDAG* dag, uint32_t ref, int32_t level, const int32_t corner[3], const int32_t min[3], const int32_t max[3])
+{
+  const int32_t size = 1 << level;
+
+  int64_t overlap = 1;
+  for(int32_t a = 0; a < 3; ++a)
+  {
+    const int32_t lo = MAX(corner[a], min[a]);
+    const int32_t hi = MIN(corner[a] + size, max[a]);
+    if(lo >= hi)
+      return 0;
+
+    overlap *= hi - lo;
+  }
+
+  if(ref & DAG_UNIFORM)
+    return (uint8_t)ref != AIR_BLOCK ? overlap : 0;
+
+  const int32_t half = size / 2;
+  int64_t count = 0;
+
+  for(int32_t dX = 0; dX < 2; ++dX)
+  {
+    for(int32_t dY = 0; dY < 2; ++dY)
+    {
+      for(int32_t dZ = 0; dZ < 2; ++dZ)
+      {
+        const int32_t child = DAG_CHILD(dX, dY, dZ);
+        const int32_t childCorner[3] = {corner[0] + dX * half, corner[1] + dY * half, corner[2] + dZ * half};
+
+        if(level == 1)
+        {
+          const bool inside = childCorner[0] >= min[0] && childCorner[0] < max[0] && childCorner[1] >= min[1] && childCorner[1] < max[1] &&
+                              childCorner[2] >= min[2] && childCorner[2] < max[2];
+          count += inside && (uint8_t)(dag->leaves[ref] >> (8 * child)) != AIR_BLOCK;
+        }
+        else
+          count += CountInCell(dag, dag->nodes[(size_t)ref * 8 + child], level - 1, childCorner, min, max);
+      }
+    }
+  }
+
+  return count;
+}
+
+int64_t VoxelDAGCountBlocks(const VoxelDAG* dag, const int32_t min[3], const int32_t max[3])
+{
+  const int32_t corner[3] = {0, 0, 0};
+  const int32_t localMin[3] = {min[0] - dag->originX, min[1], min[2] - dag->originZ};
+  const int32_t localMax[3] = {max[0] - dag->originX, max[1], max[2] - dag->originZ};
+
+  return CountInCell(dag, dag->root, dag->depth, corner, localMin, localMax);
+}
+
+void VoxelDAGGetStats(const VoxelDAG* dag, int32_t* numLeaves, int32_t* numNodes, size_t* numBytes)
+{
+  *numLeaves = dag->numLeaves;
+  *numNodes = dag->numNodes;
+  *numBytes = sizeof(VoxelDAG) + (size_t)dag->numLeaves * sizeof(uint64_t) + (size_t)dag->numNodes * 8 * sizeof(uint32_t);
+}
+
+bool VoxelDAGWrite(const VoxelDAG* dag, FILE* f)
+{
+  VoxelDAGFileHeader header = {0};
+  memcpy(header.magic, fileMagic, sizeof(fileMagic));
+  header.originX = dag->originX;
+  header.originZ = dag->originZ;
+  header.depth = dag->depth;
+  header.root = dag->root;
+  header.numLeaves = dag->numLeaves;
+  header.numNodes = dag->numNodes;
+
+  return fwrite(&header, sizeof(header), 1, f) == 1 &&
+         fwrite(dag->leaves, sizeof(uint64_t), dag->numLeaves, f) == (size_t)dag->numLeaves &&
+         fwrite(dag->nodes, 8 * sizeof(uint32_t), dag->numNodes, f) == (size_t)dag->numNodes;
+}
+
+//Every child has to exist, be of the level below and contain valid blocks; "levels" remembers the level of every node that was checked.
+static bool IsValidSubtree(const VoxelDAG* dag, uint32_t ref, int32_t level, uint8_t* levels)
+{
+  if(ref & DAG_UNIFORM)
+    return (ref & ~DAG_UNIFORM) < AMOUNT_BLOCKS;
+
+  if(level == 1)
+  {
+    if(ref >= (uint32_t)dag->numLeaves)
+      return false;
+
+    for(int32_t i = 0; i < 8; ++i)
+    {
+      if((uint8_t)(dag->leaves[ref] >> (8 * i)) >= AMOUNT_BLOCKS)
+        return false;
+    }
+
+    return true;
+  }
+
+  if(ref >= (uint32_t)dag->numNodes)
+    return false;
+
+  if(levels[ref] != 0)
+    return levels[ref] == level;
+
+  levels[ref] = (uint8_t)level;
+  for(int32_t i = 0; i < 8; ++i)
+  {
+    if(!IsValidSubtree(dag, dag->nodes[(size_t)ref * 8 + i], level - 1, levels))
+      return false;
+  }
+
+  return true;
+}
+
+VoxelDAG* VoxelDAGRead(FILE* f)
+{
+  VoxelDAGFileHeader header;
+  if(fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 ||
+     header.depth < 1 || header.depth > DAG_MAX_DEPTH || header.numLeaves < 0 || header.numNodes < 0)
+  {
+    LogError("The file is not a voxel DAG.", true);
+
+    return NULL;
+  }
+
+  VoxelDAG* dag = (VoxelDAG*)OwnMalloc(sizeof(VoxelDAG), false);
+  uint64_t* leaves = (uint64_t*)OwnMalloc(MAX(1, (size_t)header.numLeaves) * sizeof(uint64_t), false);
+  uint32_t* nodes = (uint32_t*)OwnMalloc(MAX(1, (size_t)header.numNodes) * 8 * sizeof(uint32_t), false);
+  uint8_t* levels = (uint8_t*)OwnMalloc(MAX(1, (size_t)header.numNodes), false);
+
+  if(dag == NULL || leaves == NULL || nodes == NULL || levels == NULL)
+  {
+    LogError("RAM size is insufficient for the voxel DAG (%d leaves, %d nodes).", true, header.numLeaves, header.numNodes);
+
+    free(dag);
+    free(leaves);
+    free(nodes);
+    free(levels);
+
+    return NULL;
+  }
+
+  memset(levels, 0, MAX(1, (size_t)header.numNodes));
+
+  dag->originX = header.originX;
+  dag->originZ = header.originZ;
+  dag->depth = header.depth;
+  dag->root = header.root;
+  dag->leaves = leaves;
+  dag->nodes = nodes;
+  dag->numLeaves = header.numLeaves;
+  dag->numNodes = header.numNodes;
+
+  bool valid = fread(leaves, sizeof(uint64_t), header.numLeaves, f) == (size_t)header.numLeaves &&
+               fread(nodes, 8 * sizeof(uint32_t), header.numNodes, f) == (size_t)header.numNodes &&
+               IsValidSubtree(dag, dag->root, dag->depth, levels);
+
+  free(levels);
+
+  if(!valid)
+  {
+    LogError("The voxel DAG is truncated or corrupt.", true);
+    VoxelDAGFree(dag);
+
+    return NULL;
+  }
+
+  return dag;
+}
+
+void VoxelDAGFree(VoxelDAG* dag)
+{
+  if(dag == NULL)
+    return;
+
+  free(dag->leaves);
+  free(dag->nodes);
+  free(dag);
+}
\ No newline at end of file
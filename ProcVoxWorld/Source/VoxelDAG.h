@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Utils.h"
+
+#include "Map/Chunk.h"
+
+#include <stdio.h>
+
+/* Sparse voxel DAG: a read-only octree of a square region of generated chunks, in which identical subtrees are stored only once
+ * and subtrees of a single block type are not stored at all. Its leaves hold 2 x 2 x 2 block types, so it serves far rendering
+ * as well as queries. The region is a cube of "1 << depth" blocks whose lowest corner lies at height zero; everything above the
+ * chunks and every chunk which was not added is air. Chunks have to be a power of two wide and "CHUNK_HEIGHT" a multiple of it. */
+typedef struct VoxelDAG VoxelDAG;
+
+//Converts chunks one at a time, so only the finished DAG (and never the whole region) has to fit into memory.
+typedef struct VoxelDAGBuilder VoxelDAGBuilder;
+
+//Region of "numChunks" x "numChunks" chunks starting at chunk ("cX", "cZ"); returns "NULL" (and logs the reason) if the chunk size is not supported.
+VoxelDAGBuilder* VoxelDAGBegin(int32_t cX, int32_t cZ, int32_t numChunks);
+
+//The generated chunk "c" can be freed right afterwards; returns "false" if it lies outside of the region.
+bool VoxelDAGAddChunk(VoxelDAGBuilder* builder, const Chunk* c);
+
+//Frees "builder".
+VoxelDAG* VoxelDAGFinish(VoxelDAGBuilder* builder);
+
+//World block coordinates; blocks outside of the region are air.
+uint8_t VoxelDAGGetBlock(const VoxelDAG* dag, int32_t bX, int32_t bY, int32_t bZ);
+
+/* First block which is not air along the ray from "origin" (world block coordinates) in direction "dir" (normalised) within "maxDist" blocks.
+ * Cells of a single block type are skipped as a whole. */
+bool VoxelDAGRaycast(const VoxelDAG* dag, const float origin[3], const float dir[3], float maxDist, int32_t hit[3], uint8_t* hitBlock);
+
+//Blocks which are not air within the box ["min", "max") of world block coordinates.
+int64_t VoxelDAGCountBlocks(const VoxelDAG* dag, const int32_t min[3], const int32_t max[3]);
+
+void VoxelDAGGetStats(const VoxelDAG* dag, int32_t* numLeaves, int32_t* numNodes, size_t* numBytes);
+
+/* The nodes are written in the order they were built (children first) straight from memory, and read back the same way;
+ * a file which is not a valid DAG is rejected ("NULL"). */
+bool VoxelDAGWrite(const VoxelDAG* dag, FILE* f);
+
+VoxelDAG* VoxelDAGRead(FILE* f);
+
+void VoxelDAGFree(VoxelDAG* dag);
\ No newline at end of file
@@ -249,7 +249,7 @@ bool WindowIsKeyPressed(int32_t GLFWKeyCode)
   return glfwGetKey(WND->GLFW, GLFWKeyCode) == GLFW_PRESS;
 }
 
-void WindowUpdateTitleFPS()
+void WindowUpdateTitleFPS(int32_t numTriangles)
 {
   const float updateIntervalSec = 0.5f;
 
@@ -264,9 +264,10 @@ void WindowUpdateTitleFPS()
   if(currTime - lastTime >= updateIntervalSec)
   {
     int32_t FPS = (int32_t)lroundf(numFrames / updateIntervalSec);
+    double frameTimeMs = (currTime - lastTime) * 1000.0 / numFrames;
 
     char title[128];
-    sprintf_s(title, ARRAY_SIZE(title), "%s (%d FPS)", WINDOW_TITLE, FPS);
+    sprintf_s(title, ARRAY_SIZE(title), "%s (%d FPS | %.2f ms | %d k triangles)", WINDOW_TITLE, FPS, frameTimeMs, numTriangles / 1000);
     glfwSetWindowTitle(WND->GLFW, title);
 
     numFrames = 0;
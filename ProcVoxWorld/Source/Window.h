@@ -45,6 +45,7 @@ void WindowPollEvents();
 
 bool WindowIsKeyPressed(int32_t GLFWKeyCode);
 
-void WindowUpdateTitleFPS();
+//Shows the frame rate, the mean frame time and "numTriangles" (drawn in the last frame) in the title.
+void WindowUpdateTitleFPS(int32_t numTriangles);
 
 void WindowFree();
\ No newline at end of file
@@ -1,24 +1,56 @@
 #include "WorldGenerator.h"
 
-#include "NoiseGenerator.h"
+#include "Erosion.h"
+#include "StageTimer.h"
+#include "StructureGenerator.h"
+#include "TerrainGraph.h"
+#include "TerrainRaster.h"
 
 #include "Map/Block.h"
 
-#include <assert.h>
+#include "TinyCThread/tinycthread.h"
 
-static const int32_t waterLevel = 50;
+static const int32_t waterLevel = WORLD_GEN_WATER_LEVEL;
 
-//The following biomes are created:
-typedef enum
+//Caves: 3D noise is only sampled on a coarse lattice with cells of this size and interpolated in between.
+#define CAVE_CELL_WIDTH  4
+#define CAVE_CELL_HEIGHT 8
+
+static const float caveThreshold = 0.76f; //Blocks with a higher cave density are carved out.
+
+/* Biome blending: the height of a lattice point is the weighted average of the heights of all biomes within
+ * "BLEND_RADIUS" lattice points. The blended lattice is computed in tiles of "BLEND_TILE_WIDTH" x "BLEND_TILE_WIDTH"
+ * lattice points, which are cached; a biome's heights are only sampled for tiles it has weight in. */
+#define BLEND_RADIUS       2
+#define BLEND_TILE_WIDTH   8
+#define BLEND_APRON_WIDTH  (BLEND_TILE_WIDTH + 2 * BLEND_RADIUS)
+#define BLEND_CACHE_SIZE   1024
+#define BLEND_NUM_BIOMES   (BIOME_WATER + 1)
+
+typedef struct
 {
-  BIOME_PLAINS,
-  BIOME_FOREST,
-  BIOME_FLOWER_FOREST,
-  BIOME_MOUNTAINS,
-  BIOME_DESERT,
-  BIOME_WATER
-} Biome;
-//Additionally, "WorldGenerator" creates trees procedurally.
+  int32_t seed;
+  int32_t tX, tZ;
+  bool valid;
+  int32_t heights[BLEND_TILE_WIDTH * BLEND_TILE_WIDTH];
+} BlendTile;
+
+static BlendTile sBlendCache[BLEND_CACHE_SIZE];
+static mtx_t sBlendCacheMtx;
+static once_flag sBlendInitFlag = ONCE_FLAG_INIT;
+
+//Tiles computed so far, split into those of a single biome (no blending needed) and all others.
+static int32_t sBlendSingleTiles;
+static int32_t sBlendMixedTiles;
+
+//Data-driven biomes and heights; without a graph, the built-in terrain ("GetBiome()" and "GetHeight()") is used.
+static TerrainGraph* sTerrainGraph;
+
+//Authored biomes and heights; if loaded, neither the graph nor the built-in terrain is used.
+static TerrainRaster* sTerrainRaster;
+
+//Columns sampled from the raster at once; longer rows are split.
+#define RASTER_BATCH 64
 
 /* Noise types of FastNoiseLite:
  * typedef enum
@@ -57,70 +89,10 @@ static Biome GetBiome(noiseState* noiseState, int32_t bX, int32_t bZ)
     return BIOME_DESERT;
 }
 
-/* Does not work the edges of a chunk, as some leaves could be in other chunks,
- * but blocks can only be placed in the current chunk. */
-static void MakeTree(Chunk* c, int32_t x, int32_t y, int32_t z)
+//Random value for block ("x", "y", "z") of chunk "c", keyed by its world position - independent of the generation order.
+static uint32_t BlockRand(noiseState* noiseState, Chunk* c, int32_t x, int32_t y, int32_t z, RandPurpose purpose)
 {
-  assert(x >= 2 && x <= CHUNK_WIDTH - 3 && z >= 2 && z <= CHUNK_WIDTH - 3);
-
-  for(uint32_t i = 1; i <= 5; ++i)
-    c->blocks[XYZ(x, y + i, z)] = WOOD_BLOCK;
-
-  c->blocks[XYZ(x, y + 7, z)] = LEAVES_BLOCK;
-
-  for(int32_t dX = -2; dX <= 2; ++dX)
-  {
-    for(int32_t dZ = -1; dZ <= 1; ++dZ)
-    {
-      for(uint32_t dY = 4; dY <= 5; ++dY)
-      {
-        int32_t bX = x + dX;
-        int32_t bY = y + dY;
-        int32_t bZ = z + dZ;
-
-        if(c->blocks[XYZ(bX, bY, bZ)] != AIR_BLOCK)
-          continue;
-
-        c->blocks[XYZ(bX, bY, bZ)] = LEAVES_BLOCK;
-      }
-    }
-  }
-
-  for(int32_t dX = -1; dX <= 1; ++dX)
-  {
-    for(int32_t dZ = -2; dZ <= 2; ++dZ)
-    {
-      for(uint32_t dY = 4; dY <= 5; ++dY)
-      {
-        int32_t bX = x + dX;
-        int32_t bY = y + dY;
-        int32_t bZ = z + dZ;
-
-        if(c->blocks[XYZ(bX, bY, bZ)] != AIR_BLOCK)
-          continue;
-
-        c->blocks[XYZ(bX, bY, bZ)] = LEAVES_BLOCK;
-      }
-    }
-  }
-
-  for(int32_t dX = -1; dX <= 1; ++dX)
-  {
-    for(int32_t dZ = -1; dZ <= 1; ++dZ)
-    {
-      for(uint32_t dY = 3; dY <= 6; ++dY)
-      {
-        int32_t bX = x + dX;
-        int32_t bY = y + dY;
-        int32_t bZ = z + dZ;
-
-        if(c->blocks[XYZ(bX, bY, bZ)] != AIR_BLOCK)
-          continue;
-
-        c->blocks[XYZ(bX, bY, bZ)] = LEAVES_BLOCK;
-      }
-    }
-  }
+  return NoiseGeneratorPosRand(noiseState->seed, c->x * CHUNK_WIDTH + x, y, c->z * CHUNK_WIDTH + z, purpose);
 }
 
 static void GenPlains(noiseState* noiseState, Chunk* c, int32_t x, int32_t z, int32_t h)
@@ -137,11 +109,11 @@ static void GenPlains(noiseState* noiseState, Chunk* c, int32_t x, int32_t z, in
   if(c->blocks[XYZ(x, h + 1, z)] == WATER_BLOCK)
     return;
 
-  if(OwnRand(&noiseState->randValue) % 10 >= 7)
+  if(BlockRand(noiseState, c, x, h + 1, z, RAND_GRASS_PLANT) % 10 >= 7)
     c->blocks[XYZ(x, h + 1, z)] = GRASS_PLANT_BLOCK;
-  else if(OwnRand(&noiseState->randValue) % 100 > 97)
+  else if(BlockRand(noiseState, c, x, h + 1, z, RAND_FLOWER) % 100 > 97)
   {
-    if(OwnRand(&noiseState->randValue) % 2)
+    if(BlockRand(noiseState, c, x, h + 1, z, RAND_FLOWER_TYPE) % 2)
       c->blocks[XYZ(x, h + 1, z)] = FLOWER_DANDELION_BLOCK;
     else
       c->blocks[XYZ(x, h + 1, z)] = FLOWER_ROSE_BLOCK;
@@ -161,13 +133,12 @@ static void GenForest(noiseState* noiseState, Chunk* c, int32_t x, int32_t z, in
   if(c->blocks[XYZ(x, h + 1, z)] == WATER_BLOCK)
     return;
 
-  if(OwnRand(&noiseState->randValue) % 1000 > 975 && x >= 2 && z >= 2 && x <= CHUNK_WIDTH - 3 && z <= CHUNK_WIDTH - 3)
-    MakeTree(c, x, h, z);
-  else if(OwnRand(&noiseState->randValue) % 10 >= 9)
+  //Trees are stamped by "StructureGeneratorStampChunk()" once all columns are filled; their trunks replace any plant.
+  if(BlockRand(noiseState, c, x, h + 1, z, RAND_GRASS_PLANT) % 10 >= 9)
     c->blocks[XYZ(x, h + 1, z)] = GRASS_PLANT_BLOCK;
-  else if(OwnRand(&noiseState->randValue) % 100 > 97)
+  else if(BlockRand(noiseState, c, x, h + 1, z, RAND_FLOWER) % 100 > 97)
   {
-    if(OwnRand(&noiseState->randValue) % 2)
+    if(BlockRand(noiseState, c, x, h + 1, z, RAND_FLOWER_TYPE) % 2)
       c->blocks[XYZ(x, h + 1, z)] = FLOWER_DANDELION_BLOCK;
     else
       c->blocks[XYZ(x, h + 1, z)] = FLOWER_ROSE_BLOCK;
@@ -187,11 +158,9 @@ static void GenFlowerForest(noiseState* noiseState, Chunk* c, int32_t x, int32_t
   if(c->blocks[XYZ(x, h + 1, z)] == WATER_BLOCK)
     return;
 
-  if(OwnRand(&noiseState->randValue) % 1000 > 975 && x >= 2 && z >= 2 && x <= CHUNK_WIDTH - 3 && z <= CHUNK_WIDTH - 3)
-    MakeTree(c, x, h, z);
-  else if(OwnRand(&noiseState->randValue) % 10 >= 7)
+  if(BlockRand(noiseState, c, x, h + 1, z, RAND_GRASS_PLANT) % 10 >= 7)
   {
-    int32_t r = OwnRand(&noiseState->randValue) % 3;
+    int32_t r = BlockRand(noiseState, c, x, h + 1, z, RAND_FLOWER_TYPE) % 3;
     switch(r)
     {
       case 0:
@@ -211,9 +180,9 @@ static void GenMountains(noiseState* noiseState, Chunk* c, int32_t x, int32_t z,
 {
   for(uint32_t y = 0; y <= h; ++y)
   {
-    if(y < 100 + OwnRand(&noiseState->randValue) % 10 - 5)
+    if(y < 100 + BlockRand(noiseState, c, x, y, z, RAND_SNOW_LINE) % 10 - 5)
     {
-      if(OwnRand(&noiseState->randValue) % 10 == 0)
+      if(BlockRand(noiseState, c, x, y, z, RAND_GRAVEL) % 10 == 0)
         c->blocks[XYZ(x, y, z)] = GRAVEL_BLOCK;
       else
         c->blocks[XYZ(x, y, z)] = STONE_BLOCK;
@@ -239,13 +208,13 @@ static void GenDesert(noiseState* noiseState, Chunk* c, int32_t x, int32_t z, in
   if(c->blocks[XYZ(x, h + 1, z)] == WATER_BLOCK)
     return;
 
-  if(OwnRand(&noiseState->randValue) % 1000 > 995)
+  if(BlockRand(noiseState, c, x, h + 1, z, RAND_CACTUS) % 1000 > 995)
   {
-    int32_t cactusHeight = OwnRand(&noiseState->randValue) % 6;
+    int32_t cactusHeight = BlockRand(noiseState, c, x, h + 1, z, RAND_CACTUS_HEIGHT) % 6;
     for(int32_t y = 0; y < cactusHeight; ++y)
       c->blocks[XYZ(x, h + 1 + y, z)] = CACTUS_BLOCK;
   }
-  else if(OwnRand(&noiseState->randValue) % 1000 > 995)
+  else if(BlockRand(noiseState, c, x, h + 1, z, RAND_DEAD_PLANT) % 1000 > 995)
     c->blocks[XYZ(x, h + 1, z)] = DEAD_PLANT_BLOCK;
 }
 
@@ -253,7 +222,7 @@ static void GenWater(noiseState* noiseState, Chunk* c, int32_t x, int32_t z, int
 {
   for(int32_t y = 0; y <= h; ++y)
   {
-    if(OwnRand(&noiseState->randValue) % 4 == 0)
+    if(BlockRand(noiseState, c, x, y, z, RAND_GRAVEL) % 4 == 0)
       c->blocks[XYZ(x, y, z)] = GRAVEL_BLOCK;
     else
       c->blocks[XYZ(x, y, z)] = SAND_BLOCK;
@@ -303,83 +272,858 @@ static int32_t Blerp(int32_t h11, int32_t h12, int32_t h21, int32_t h22, float x
   return (int32_t)(h11 * (1 - x) * (1 - y) + h21 * x * (1 - y) + h12 * (1 - x) * y + h22 * x * y);
 }
 
+static int32_t ApplyErosion(int32_t height, int32_t delta)
+{
+  //Deposits must leave room for plants and structures above the surface.
+  return MIN(MAX(height + delta, 1), CHUNK_HEIGHT - 16);
+}
+
+/* Biomes of "count" columns starting at ("bX", "bZ"), "step" blocks apart along the z-axis. "biomes" is written
+ * "stride" entries apart: "step" matches the "XZ" layout, 1 stores coarse samples without gaps. */
+static void GetBiomeRow(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t step, int32_t count, int32_t stride, Biome* biomes)
+{
+  STAGE_TIMER_BEGIN(timerStart);
+
+  if(sTerrainRaster != NULL)
+  {
+    uint8_t raster[RASTER_BATCH];
+    for(int32_t start = 0; start < count; start += RASTER_BATCH)
+    {
+      const int32_t n = MIN(RASTER_BATCH, count - start);
+      TerrainRasterSampleRow(sTerrainRaster, bX, bZ + start * step, step, n, NULL, raster);
+
+      //Unknown indices become water rather than failing.
+      for(int32_t i = 0; i < n; ++i)
+        biomes[(start + i) * stride] = (Biome)MIN(raster[i], BIOME_WATER);
+    }
+
+    STAGE_TIMER_END(timerStart, STAGE_BIOME);
+
+    return;
+  }
+
+  if(sTerrainGraph == NULL)
+  {
+    for(int32_t i = 0; i < count; ++i)
+      biomes[i * stride] = GetBiome(noiseState, bX, bZ + i * step);
+
+    STAGE_TIMER_END(timerStart, STAGE_BIOME);
+
+    return;
+  }
+
+  float x[TERRAIN_GRAPH_BATCH], z[TERRAIN_GRAPH_BATCH], result[TERRAIN_GRAPH_BATCH];
+  for(int32_t start = 0; start < count; start += TERRAIN_GRAPH_BATCH)
+  {
+    const int32_t n = MIN(TERRAIN_GRAPH_BATCH, count - start);
+    for(int32_t i = 0; i < n; ++i)
+    {
+      x[i] = (float)bX;
+      z[i] = (float)(bZ + (start + i) * step);
+    }
+
+    TerrainGraphEvaluate(sTerrainGraph, TERRAIN_GRAPH_BIOME, noiseState->seed, x, z, n, result);
+
+    for(int32_t i = 0; i < n; ++i)
+      biomes[(start + i) * stride] = (Biome)MIN(MAX((int32_t)result[i], BIOME_PLAINS), BIOME_WATER);
+  }
+
+  STAGE_TIMER_END(timerStart, STAGE_BIOME);
+}
+
+//Heights of the columns of "GetBiomeRow()" with their biomes already known.
+static void GetHeightRow(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t step, int32_t count, int32_t stride, const Biome* biomes, int32_t* heights)
+{
+  STAGE_TIMER_BEGIN(timerStart);
+
+  if(sTerrainRaster != NULL)
+  {
+    uint16_t raster[RASTER_BATCH];
+    for(int32_t start = 0; start < count; start += RASTER_BATCH)
+    {
+      const int32_t n = MIN(RASTER_BATCH, count - start);
+      TerrainRasterSampleRow(sTerrainRaster, bX, bZ + start * step, step, n, raster, NULL);
+
+      //The same bounds as after erosion.
+      for(int32_t i = 0; i < n; ++i)
+        heights[(start + i) * stride] = ApplyErosion(raster[i], 0);
+    }
+
+    STAGE_TIMER_END(timerStart, STAGE_HEIGHT);
+
+    return;
+  }
+
+  if(sTerrainGraph == NULL)
+  {
+    for(int32_t i = 0; i < count; ++i)
+      heights[i * stride] = GetHeight(&noiseState->fnl, biomes[i * stride], bX, bZ + i * step);
+
+    STAGE_TIMER_END(timerStart, STAGE_HEIGHT);
+
+    return;
+  }
+
+  //Every biome has its own program, so the columns are grouped by biome.
+  float x[TERRAIN_GRAPH_BATCH], z[TERRAIN_GRAPH_BATCH], result[TERRAIN_GRAPH_BATCH];
+  int32_t index[TERRAIN_GRAPH_BATCH];
+
+  for(int32_t biome = BIOME_PLAINS; biome <= BIOME_WATER; ++biome)
+  {
+    int32_t n = 0;
+    for(int32_t i = 0; i <= count; ++i)
+    {
+      if(i < count && biomes[i * stride] == (Biome)biome)
+      {
+        index[n] = i;
+        x[n] = (float)bX;
+        z[n] = (float)(bZ + i * step);
+        ++n;
+      }
+
+      if(n > 0 && (n == TERRAIN_GRAPH_BATCH || i == count))
+      {
+        TerrainGraphEvaluate(sTerrainGraph, (TerrainGraphOutput)(TERRAIN_GRAPH_HEIGHT_PLAINS + biome), noiseState->seed, x, z, n, result);
+
+        for(int32_t j = 0; j < n; ++j)
+          heights[index[j] * stride] = (int32_t)result[j];
+
+        n = 0;
+      }
+    }
+  }
+
+  STAGE_TIMER_END(timerStart, STAGE_HEIGHT);
+}
+
+//Next smaller multiple of "step" (works for negative values as well).
+static int32_t FloorStep(int32_t a, int32_t step)
+{
+  if(a >= 0)
+    return (a / step) * step;
+
+  return ((a + 1) / step - 1) * step;
+}
+
+static void BlendCacheInit()
+{
+  mtx_init(&sBlendCacheMtx, mtx_plain);
+}
+
+//Weight of a biome sample ("dX", "dZ") lattice points away; falls off with the distance, but stays positive in the whole square.
+static int32_t BlendWeight(int32_t dX, int32_t dZ)
+{
+  return (BLEND_RADIUS + 1) * (BLEND_RADIUS + 1) - dX * dX - dZ * dZ;
+}
+
+/* Blended heights of the lattice points of tile ("tX", "tZ"), stored row by row along the z-axis. Tiles of a single
+ * biome (including the apron around them) yield exactly the unblended heights, without sampling any other biome. */
+static void ComputeBlendTile(noiseState* noiseState, int32_t tX, int32_t tZ, int32_t* heights)
+{
+  const int32_t bX = tX * BLEND_TILE_WIDTH * 8;
+  const int32_t bZ = tZ * BLEND_TILE_WIDTH * 8;
+
+  //Biomes of the tile and the apron, one lattice point per entry.
+  Biome biomes[BLEND_APRON_WIDTH][BLEND_APRON_WIDTH];
+  Biome biomeRow[(BLEND_APRON_WIDTH - 1) * 8 + 1];
+  bool present[BLEND_NUM_BIOMES] = {false};
+
+  for(int32_t i = 0; i < BLEND_APRON_WIDTH; ++i)
+  {
+    GetBiomeRow(noiseState, bX + (i - BLEND_RADIUS) * 8, bZ - BLEND_RADIUS * 8, 8, BLEND_APRON_WIDTH, 8, biomeRow);
+
+    for(int32_t j = 0; j < BLEND_APRON_WIDTH; ++j)
+    {
+      biomes[i][j] = biomeRow[j * 8];
+      present[biomes[i][j]] = true;
+    }
+  }
+
+  int32_t numPresent = 0;
+  for(int32_t b = 0; b < BLEND_NUM_BIOMES; ++b)
+    numPresent += present[b];
+
+  Biome heightBiomes[(BLEND_TILE_WIDTH - 1) * 8 + 1];
+  int32_t heightRow[(BLEND_TILE_WIDTH - 1) * 8 + 1];
+
+  if(numPresent == 1)
+  {
+    for(int32_t i = 0; i < BLEND_TILE_WIDTH; ++i)
+    {
+      for(int32_t j = 0; j < BLEND_TILE_WIDTH; ++j)
+        heightBiomes[j * 8] = biomes[0][0];
+
+      GetHeightRow(noiseState, bX + i * 8, bZ, 8, BLEND_TILE_WIDTH, 8, heightBiomes, heightRow);
+
+      for(int32_t j = 0; j < BLEND_TILE_WIDTH; ++j)
+        heights[i * BLEND_TILE_WIDTH + j] = heightRow[j * 8];
+    }
+
+    mtx_lock(&sBlendCacheMtx);
+    ++sBlendSingleTiles;
+    mtx_unlock(&sBlendCacheMtx);
+
+    return;
+  }
+
+  //Weighted sums of the biomes' heights; every biome is sampled once per tile, and only if it is in the tile's surroundings.
+  int64_t sums[BLEND_TILE_WIDTH * BLEND_TILE_WIDTH] = {0};
+  int32_t weights[BLEND_TILE_WIDTH * BLEND_TILE_WIDTH][BLEND_NUM_BIOMES] = {{0}};
+  int32_t totalWeight = 0;
+
+  for(int32_t dX = -BLEND_RADIUS; dX <= BLEND_RADIUS; ++dX)
+  {
+    for(int32_t dZ = -BLEND_RADIUS; dZ <= BLEND_RADIUS; ++dZ)
+      totalWeight += BlendWeight(dX, dZ);
+  }
+
+  for(int32_t i = 0; i < BLEND_TILE_WIDTH; ++i)
+  {
+    for(int32_t j = 0; j < BLEND_TILE_WIDTH; ++j)
+    {
+      for(int32_t dX = -BLEND_RADIUS; dX <= BLEND_RADIUS; ++dX)
+      {
+        for(int32_t dZ = -BLEND_RADIUS; dZ <= BLEND_RADIUS; ++dZ)
+          weights[i * BLEND_TILE_WIDTH + j][biomes[i + BLEND_RADIUS + dX][j + BLEND_RADIUS + dZ]] += BlendWeight(dX, dZ);
+      }
+    }
+  }
+
+  for(int32_t b = 0; b < BLEND_NUM_BIOMES; ++b)
+  {
+    if(!present[b])
+      continue;
+
+    for(int32_t i = 0; i < BLEND_TILE_WIDTH; ++i)
+    {
+      //Rows without any weight of this biome are skipped.
+      bool needed = false;
+      for(int32_t j = 0; j < BLEND_TILE_WIDTH && !needed; ++j)
+        needed = weights[i * BLEND_TILE_WIDTH + j][b] > 0;
+
+      if(!needed)
+        continue;
+
+      for(int32_t j = 0; j < BLEND_TILE_WIDTH; ++j)
+        heightBiomes[j * 8] = (Biome)b;
+
+      GetHeightRow(noiseState, bX + i * 8, bZ, 8, BLEND_TILE_WIDTH, 8, heightBiomes, heightRow);
+
+      for(int32_t j = 0; j < BLEND_TILE_WIDTH; ++j)
+        sums[i * BLEND_TILE_WIDTH + j] += (int64_t)weights[i * BLEND_TILE_WIDTH + j][b] * heightRow[j * 8];
+    }
+  }
+
+  //Rounded to the nearest block (integer arithmetic, thus the same on every platform).
+  for(int32_t p = 0; p < BLEND_TILE_WIDTH * BLEND_TILE_WIDTH; ++p)
+  {
+    const int64_t sum = sums[p] * 2 + totalWeight;
+    heights[p] = (int32_t)(sum >= 0 ? sum / (2 * totalWeight) : -((-sum + 2 * totalWeight - 1) / (2 * totalWeight)));
+  }
+
+  mtx_lock(&sBlendCacheMtx);
+  ++sBlendMixedTiles;
+  mtx_unlock(&sBlendCacheMtx);
+}
+
+//Blended height of the lattice point ("lX", "lZ") (in units of eight blocks).
+static int32_t GetBlendedHeight(noiseState* noiseState, int32_t lX, int32_t lZ)
+{
+  call_once(&sBlendInitFlag, BlendCacheInit);
+
+  const int32_t tX = FloorStep(lX, BLEND_TILE_WIDTH) / BLEND_TILE_WIDTH;
+  const int32_t tZ = FloorStep(lZ, BLEND_TILE_WIDTH) / BLEND_TILE_WIDTH;
+  const int32_t index = (lX - tX * BLEND_TILE_WIDTH) * BLEND_TILE_WIDTH + (lZ - tZ * BLEND_TILE_WIDTH);
+
+  const uint32_t slot = NoiseGeneratorMix(((uint32_t)tX * 73856093) ^ ((uint32_t)tZ * 19349663)) % BLEND_CACHE_SIZE;
+
+  mtx_lock(&sBlendCacheMtx);
+  const BlendTile* cached = &sBlendCache[slot];
+  if(cached->valid && cached->seed == noiseState->seed && cached->tX == tX && cached->tZ == tZ)
+  {
+    const int32_t height = cached->heights[index];
+    mtx_unlock(&sBlendCacheMtx);
+
+    return height;
+  }
+  mtx_unlock(&sBlendCacheMtx);
+
+  //Computed without the lock; should two threads need the same tile, both yield the same result anyway.
+  BlendTile tile = {0};
+  tile.seed = noiseState->seed;
+  tile.tX = tX;
+  tile.tZ = tZ;
+  tile.valid = true;
+  ComputeBlendTile(noiseState, tX, tZ, tile.heights);
+
+  mtx_lock(&sBlendCacheMtx);
+  memcpy(&sBlendCache[slot], &tile, sizeof(BlendTile));
+  mtx_unlock(&sBlendCacheMtx);
+
+  return tile.heights[index];
+}
+
+/* Heights of "count" lattice points starting at ("bX", "bZ") (multiples of eight), eight blocks apart along the z-axis;
+ * "biomes" and "heights" are written with a stride of eight. The biomes are only sampled without blending.
+ * Authored heights are never blended: they are continuous across biome borders already. */
+static void GetLatticeRow(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t count, Biome* biomes, int32_t* heights)
+{
+  if(!BIOME_BLENDING || sTerrainRaster != NULL)
+  {
+    GetBiomeRow(noiseState, bX, bZ, 8, count, 8, biomes);
+    GetHeightRow(noiseState, bX, bZ, 8, count, 8, biomes, heights);
+
+    return;
+  }
+
+  for(int32_t i = 0; i < count; ++i)
+    heights[i * 8] = GetBlendedHeight(noiseState, bX / 8, bZ / 8 + i);
+}
+
+void WorldGeneratorInit()
+{
+  if(TERRAIN_RASTER[0] != '\0')
+  {
+    sTerrainRaster = TerrainRasterOpen(TERRAIN_RASTER);
+    if(sTerrainRaster != NULL)
+      return;
+
+    LogWarning("The terrain raster \"%s\" could not be loaded, hence the terrain graph or the built-in terrain is used.", true, TERRAIN_RASTER);
+  }
+
+  if(TERRAIN_GRAPH[0] == '\0')
+  {
+    LogInfo("No terrain graph is set, hence the built-in terrain is used.", true);
+
+    return;
+  }
+
+  sTerrainGraph = TerrainGraphLoad(TERRAIN_GRAPH);
+  if(sTerrainGraph == NULL)
+    LogWarning("The terrain graph \"%s\" could not be loaded, hence the built-in terrain is used.", true, TERRAIN_GRAPH);
+}
+
+void WorldGeneratorFree()
+{
+  TerrainGraphFree(sTerrainGraph);
+  sTerrainGraph = NULL;
+
+  TerrainRasterClose(sTerrainRaster);
+  sTerrainRaster = NULL;
+
+  //Eroded and blended tiles as well as structure positions were computed from the terrain just freed.
+  ErosionFree();
+  StructureGeneratorFree();
+
+  call_once(&sBlendInitFlag, BlendCacheInit);
+
+  mtx_lock(&sBlendCacheMtx);
+  for(int32_t i = 0; i < BLEND_CACHE_SIZE; ++i)
+    sBlendCache[i].valid = false;
+
+  sBlendSingleTiles = 0;
+  sBlendMixedTiles = 0;
+  mtx_unlock(&sBlendCacheMtx);
+}
+
+bool WorldGeneratorUsesTerrainGraph()
+{
+  return sTerrainGraph != NULL;
+}
+
+bool WorldGeneratorUsesTerrainRaster()
+{
+  return sTerrainRaster != NULL;
+}
+
+static uint32_t HashBytes(uint32_t hash, const void* data, size_t size)
+{
+  const uint8_t* bytes = (const uint8_t*)data;
+  for(size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
+
+uint32_t WorldGeneratorGetVersion()
+{
+  const int32_t settings[5] = {WORLD_GEN_VERSION, CAVES_ENABLED, EROSION_ENABLED, BIOME_BLENDING, sTerrainRaster != NULL ? 2 : sTerrainGraph != NULL};
+  uint32_t hash = HashBytes(2166136261U, settings, sizeof(settings));
+
+  //A raster is far too large to be read for this; it is only ever replaced as a whole, which changes its header or its path.
+  if(sTerrainRaster != NULL)
+  {
+    hash = HashBytes(hash, TERRAIN_RASTER, strlen(TERRAIN_RASTER));
+
+    return HashBytes(hash, TerrainRasterGetHeader(sTerrainRaster), sizeof(TerrainRasterHeader));
+  }
+
+  if(sTerrainGraph == NULL)
+    return hash;
+
+  FILE* f = NULL;
+  if(fopen_s(&f, TERRAIN_GRAPH, "rb") != 0 || f == NULL)
+    return HashBytes(hash, TERRAIN_GRAPH, strlen(TERRAIN_GRAPH));
+
+  uint8_t buffer[4096];
+  size_t read;
+  while((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    hash = HashBytes(hash, buffer, read);
+  fclose(f);
+
+  return hash;
+}
+
+void WorldGeneratorGetBlendStats(int32_t* singleBiomeTiles, int32_t* mixedTiles)
+{
+  call_once(&sBlendInitFlag, BlendCacheInit);
+
+  mtx_lock(&sBlendCacheMtx);
+  *singleBiomeTiles = sBlendSingleTiles;
+  *mixedTiles = sBlendMixedTiles;
+  mtx_unlock(&sBlendCacheMtx);
+}
+
+void WorldGeneratorSampleRow(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t count, Biome* biomes, int32_t* heights)
+{
+  GetBiomeRow(noiseState, bX, bZ, 1, count, 1, biomes);
+  GetHeightRow(noiseState, bX, bZ, 1, count, 1, biomes, heights);
+}
+
+void WorldGeneratorSampleCoarseRow(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t step, int32_t count, Biome* biomes, int32_t* heights)
+{
+  GetBiomeRow(noiseState, bX, bZ, step, count, 1, biomes);
+  GetHeightRow(noiseState, bX, bZ, step, count, 1, biomes, heights);
+}
+
+void WorldGeneratorSampleHeightmap(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t width, int32_t* heights)
+{
+  //Authored heights are sampled for every column, just like in "WorldGeneratorGenerateTile()".
+  if(sTerrainRaster != NULL)
+  {
+    Biome rowBiomes[RASTER_BATCH];
+    for(int32_t x = 0; x < width; ++x)
+    {
+      for(int32_t z = 0; z < width; z += RASTER_BATCH)
+      {
+        const int32_t n = MIN(RASTER_BATCH, width - z);
+        GetBiomeRow(noiseState, bX + x, bZ + z, 1, n, 1, rowBiomes);
+        GetHeightRow(noiseState, bX + x, bZ + z, 1, n, 1, rowBiomes, &heights[x * width + z]);
+      }
+    }
+
+    return;
+  }
+
+  const int32_t latticeCount = width / 8 + 1;
+  const int32_t rowLength = (latticeCount - 1) * 8 + 1;
+
+  Biome* rowBiomes = (Biome*)OwnMalloc(rowLength * sizeof(Biome), false);
+  int32_t* rowHeights = (int32_t*)OwnMalloc(rowLength * sizeof(int32_t), false);
+  int32_t* lattice = (int32_t*)OwnMalloc((size_t)latticeCount * latticeCount * sizeof(int32_t), false);
+
+  if(rowBiomes == NULL || rowHeights == NULL || lattice == NULL)
+  {
+    LogError("Variables \"rowBiomes\", \"rowHeights\" and \"lattice\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    memset(heights, 0, (size_t)width * width * sizeof(int32_t));
+    free(rowBiomes);
+    free(rowHeights);
+    free(lattice);
+
+    return;
+  }
+
+  for(int32_t i = 0; i < latticeCount; ++i)
+  {
+    GetLatticeRow(noiseState, bX + i * 8, bZ, latticeCount, rowBiomes, rowHeights);
+
+    for(int32_t j = 0; j < latticeCount; ++j)
+      lattice[i * latticeCount + j] = rowHeights[j * 8];
+  }
+
+  //The same interpolation as in "WorldGeneratorGenerateTile()".
+  for(int32_t x = 0; x < width; ++x)
+  {
+    const int32_t i = x / 8;
+    for(int32_t z = 0; z < width; ++z)
+    {
+      const int32_t j = z / 8;
+      heights[x * width + z] = Blerp(lattice[i * latticeCount + j], lattice[i * latticeCount + j + 1], lattice[(i + 1) * latticeCount + j],
+                                     lattice[(i + 1) * latticeCount + j + 1], (x - i * 8) / 8.0f, (z - j * 8) / 8.0f);
+    }
+  }
+
+  free(rowBiomes);
+  free(rowHeights);
+  free(lattice);
+}
+
+void WorldGeneratorSampleColumn(noiseState* noiseState, int32_t bX, int32_t bZ, Biome* biome, int32_t* height)
+{
+  GetBiomeRow(noiseState, bX, bZ, 1, 1, 1, biome);
+
+  /* Chunks start at multiples of eight (as long as "CHUNK_WIDTH" is one), thus their lattice is the world lattice
+   * and the interpolation below yields exactly the heights of the generated chunk. */
+  const int32_t xLeft = FloorEight(bX);
+  const int32_t zTop = FloorEight(bZ);
+
+  if(sTerrainRaster != NULL)
+    GetHeightRow(noiseState, bX, bZ, 1, 1, 1, biome, height);
+  else if(xLeft == bX && zTop == bZ)
+  {
+    if(BIOME_BLENDING)
+      *height = GetBlendedHeight(noiseState, bX / 8, bZ / 8);
+    else
+      GetHeightRow(noiseState, bX, bZ, 1, 1, 1, biome, height);
+  }
+  else
+  {
+    //Two lattice points of each row, eight entries apart.
+    Biome b[2][9];
+    int32_t h[2][9];
+    for(int32_t i = 0; i < 2; ++i)
+      GetLatticeRow(noiseState, xLeft + i * 8, zTop, 2, b[i], h[i]);
+
+    *height = Blerp(h[0][0], h[0][8], h[1][0], h[1][8], (bX - xLeft) / 8.0f, (bZ - zTop) / 8.0f);
+  }
+
+  if(EROSION_ENABLED)
+  {
+    int32_t delta;
+    ErosionSampleDeltas(noiseState, bX, bZ, 1, &delta);
+    *height = ApplyErosion(*height, delta);
+  }
+}
+
+static float CaveDensity(fnl_state* noiseState, int32_t bX, int32_t bY, int32_t bZ)
+{
+  NoiseGeneratorSetSettings(noiseState, FNL_NOISE_OPENSIMPLEX2, 0.025f, 1, 2.0f, 0.5f);
+
+  //Stretched vertically, thus caves are rather wide than high.
+  return NoiseGenerator3D(noiseState, (float)bX, bY * 1.6f, (float)bZ);
+}
+
+static float Lerp(float a, float b, float t)
+{
+  return a + (b - a) * t;
+}
+
 //Indexing into "biomes" and "heightmap" arrays:
 #define XZ(x, z) ((((x) + 8) * ((CHUNK_WIDTH + 1) + 8 + 8)) + ((z) + 8))
 
-void WorldGeneratorGenerateChunk(Chunk* c)
+struct WorldGenJob
+{
+  Chunk* chunk;
+  noiseState* noiseState;
+
+  Biome* biomes;
+  int32_t* heightmap;
+  int32_t* surface; //Heights after erosion; "heightmap" keeps the lattice the tiles interpolate from.
+  int32_t* erosion; //Height changes of the columns -1 to "CHUNK_WIDTH" (if erosion is enabled)
+};
+
+static int32_t TilesPerSide()
+{
+  return (CHUNK_WIDTH + WORLD_GEN_TILE_WIDTH - 1) / WORLD_GEN_TILE_WIDTH;
+}
+
+/* Columns from -1 to "CHUNK_WIDTH" (inclusive) are generated; the two neighbour data columns belong to the outer tiles.
+ * Thereby, tiles start at multiples of the cave cell width and share as few lattice points as possible. */
+static void TileRange(int32_t index, int32_t* start, int32_t* end)
+{
+  *start = index == 0 ? -1 : index * WORLD_GEN_TILE_WIDTH;
+  *end = index == TilesPerSide() - 1 ? CHUNK_WIDTH : (index + 1) * WORLD_GEN_TILE_WIDTH - 1;
+}
+
+int32_t WorldGeneratorGetTileCount()
+{
+  return TilesPerSide() * TilesPerSide();
+}
+
+WorldGenJob* WorldGeneratorBeginChunk(Chunk* c)
 {
-  noiseState* noiseState = NoiseGeneratorCreateState(c->x, c->z);
+  WorldGenJob* job = (WorldGenJob*)OwnMalloc(sizeof(WorldGenJob), false);
+
+  if(job == NULL)
+  {
+    LogError("Variable \"job\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+
+    return NULL;
+  }
+
+  job->chunk = c;
+  job->noiseState = NoiseGeneratorCreateState();
 
   /* Space for "CHUNK_WIDTH" - 1 normal chunk blocks
    * Two blocks are stored as neighbour data; 8 + 8 blocks are used for interpolation. */
   const int32_t sideLen = (CHUNK_WIDTH - 1) + 2 + 8 + 8;
 
-  Biome* biomes = (Biome*)OwnMalloc((uintmax_t)sideLen * sideLen * sizeof(Biome), false);
-  int32_t* heightmap = (int32_t*)OwnMalloc((uintmax_t)sideLen * sideLen * sizeof(int32_t), false);
+  job->biomes = (Biome*)OwnMalloc((uintmax_t)sideLen * sideLen * sizeof(Biome), false);
+  job->heightmap = (int32_t*)OwnMalloc((uintmax_t)sideLen * sideLen * sizeof(int32_t), false);
+  job->surface = (int32_t*)OwnMalloc((uintmax_t)sideLen * sideLen * sizeof(int32_t), false);
+  job->erosion = NULL;
 
-  if(biomes == NULL || heightmap == NULL) 
+  if(job->noiseState == NULL || job->biomes == NULL || job->heightmap == NULL || job->surface == NULL)
   {
-    LogError("Variables \"biomes\" and \"heightmap\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+    LogError("Variables \"noiseState\", \"biomes\", \"heightmap\" and \"surface\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
 
-    return;
+    free(job->noiseState);
+    free(job->biomes);
+    free(job->heightmap);
+    free(job->surface);
+    free(job);
+
+    return NULL;
   }
 
   int32_t cStartX = c->x * CHUNK_WIDTH;
   int32_t cStartZ = c->z * CHUNK_WIDTH;
 
-  for(int32_t x = -8; x <= CHUNK_WIDTH + 8; ++x)
+  //Only the heights on the lattice (every eighth block) are sampled; everything in between is interpolated by the tiles.
+  const int32_t latticeCount = (CHUNK_WIDTH + 8 + 8) / 8 + 1;
+  for(int32_t x = -8; x <= CHUNK_WIDTH + 8; x += 8)
+    GetLatticeRow(job->noiseState, cStartX + x, cStartZ - 8, latticeCount, &job->biomes[XZ(x, -8)], &job->heightmap[XZ(x, -8)]);
+
+  //The eroded tiles are shared by many chunks; the chunk only picks its columns (and erodes missing tiles first).
+  if(EROSION_ENABLED)
   {
-    for(int32_t z = -8; z <= CHUNK_WIDTH + 8; ++z)
+    job->erosion = (int32_t*)OwnMalloc((size_t)(CHUNK_WIDTH + 2) * (CHUNK_WIDTH + 2) * sizeof(int32_t), false);
+
+    if(job->erosion == NULL)
+      LogError("Variable \"job->erosion\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
+    else
     {
-      int32_t bX = cStartX + x;
-      int32_t bZ = cStartZ + z;
+      STAGE_TIMER_BEGIN(erosionStart);
+      ErosionSampleDeltas(job->noiseState, cStartX - 1, cStartZ - 1, CHUNK_WIDTH + 2, job->erosion);
+      STAGE_TIMER_END(erosionStart, STAGE_EROSION);
+    }
+  }
+
+  StageTimerFlush();
+
+  return job;
+}
+
+/* Carves caves into the columns "xStart" to "xEnd" and "zStart" to "zEnd". The density is sampled on the lattice only and
+ * trilinearly interpolated; lattice cells above the surface are never sampled, and cells whose corners are all below 
+ * "caveThreshold" cannot contain a cave (the interpolation never exceeds its corners), so they are skipped entirely. */
+static void CarveCaves(noiseState* noiseState, Chunk* c, const int32_t* heightmap, int32_t xStart, int32_t xEnd, int32_t zStart, int32_t zEnd)
+{
+  int32_t maxHeight = 0;
+  for(int32_t x = xStart; x <= xEnd; ++x)
+  {
+    for(int32_t z = zStart; z <= zEnd; ++z)
+      maxHeight = MAX(maxHeight, heightmap[XZ(x, z)]);
+  }
+
+  maxHeight = MIN(maxHeight, CHUNK_HEIGHT - 1);
 
-      biomes[XZ(x, z)] = GetBiome(noiseState, bX, bZ);
+  //Chunks start at multiples of the cell width, thus neighbouring chunks share the lattice.
+  const int32_t latX = FloorStep(xStart, CAVE_CELL_WIDTH);
+  const int32_t latZ = FloorStep(zStart, CAVE_CELL_WIDTH);
+  const int32_t numX = (FloorStep(xEnd, CAVE_CELL_WIDTH) - latX) / CAVE_CELL_WIDTH + 2;
+  const int32_t numZ = (FloorStep(zEnd, CAVE_CELL_WIDTH) - latZ) / CAVE_CELL_WIDTH + 2;
+  const int32_t numY = maxHeight / CAVE_CELL_HEIGHT + 2;
+
+  float* lattice = (float*)OwnMalloc((size_t)numX * numY * numZ * sizeof(float), false);
+
+  if(lattice == NULL)
+  {
+    LogError("Variable \"lattice\" in function \"%s\" (error output line: %d) from file \"%s\" must not be \"NULL\".", true, __func__, __LINE__, __FILE__);
 
-      if(x % 8 == 0 && z % 8 == 0)
-        heightmap[XZ(x, z)] = GetHeight(&noiseState->fnl, biomes[XZ(x, z)], bX, bZ);
+    return;
+  }
+
+#define LATTICE(i, j, k) lattice[((i) * numY + (j)) * numZ + (k)]
+
+  const int32_t cStartX = c->x * CHUNK_WIDTH;
+  const int32_t cStartZ = c->z * CHUNK_WIDTH;
+
+  for(int32_t i = 0; i < numX; ++i)
+  {
+    for(int32_t j = 0; j < numY; ++j)
+    {
+      for(int32_t k = 0; k < numZ; ++k)
+        LATTICE(i, j, k) = CaveDensity(&noiseState->fnl, cStartX + latX + i * CAVE_CELL_WIDTH, j * CAVE_CELL_HEIGHT, cStartZ + latZ + k * CAVE_CELL_WIDTH);
     }
   }
 
-  for(int32_t x = -1; x <= CHUNK_WIDTH; ++x)
+  for(int32_t i = 0; i < numX - 1; ++i)
   {
-    for(int32_t z = -1; z <= CHUNK_WIDTH; ++z)
+    for(int32_t k = 0; k < numZ - 1; ++k)
     {
-      if(x % 8 || z % 8)
+      for(int32_t j = 0; j < numY - 1; ++j)
       {
-        const int32_t xLeft = FloorEight(x);
-        const int32_t zTop = FloorEight(z);
+        float cellMax = LATTICE(i, j, k);
+        for(int32_t corner = 1; corner < 8; ++corner)
+          cellMax = MAX(cellMax, LATTICE(i + (corner & 1), j + ((corner >> 1) & 1), k + (corner >> 2)));
+
+        if(cellMax <= caveThreshold)
+          continue;
+
+        const int32_t cellX = latX + i * CAVE_CELL_WIDTH;
+        const int32_t cellY = j * CAVE_CELL_HEIGHT;
+        const int32_t cellZ = latZ + k * CAVE_CELL_WIDTH;
+
+        for(int32_t x = MAX(cellX, xStart); x <= MIN(cellX + CAVE_CELL_WIDTH - 1, xEnd); ++x)
+        {
+          const float fX = (float)(x - cellX) / CAVE_CELL_WIDTH;
 
-        heightmap[XZ(x, z)] = Blerp(heightmap[XZ(xLeft, zTop)], heightmap[XZ(xLeft, zTop + 8)], heightmap[XZ(xLeft + 8, zTop)],
-                                    heightmap[XZ(xLeft + 8, zTop + 8)], (x - xLeft) / 8.0f, (z - zTop) / 8.0f);
+          for(int32_t z = MAX(cellZ, zStart); z <= MIN(cellZ + CAVE_CELL_WIDTH - 1, zEnd); ++z)
+          {
+            const int32_t h = heightmap[XZ(x, z)];
+
+            //No air pockets under water.
+            if(h < waterLevel)
+              continue;
+
+            const float fZ = (float)(z - cellZ) / CAVE_CELL_WIDTH;
+
+            const float d00 = Lerp(LATTICE(i, j, k), LATTICE(i + 1, j, k), fX);
+            const float d01 = Lerp(LATTICE(i, j, k + 1), LATTICE(i + 1, j, k + 1), fX);
+            const float d10 = Lerp(LATTICE(i, j + 1, k), LATTICE(i + 1, j + 1, k), fX);
+            const float d11 = Lerp(LATTICE(i, j + 1, k + 1), LATTICE(i + 1, j + 1, k + 1), fX);
+            const float bottom = Lerp(d00, d01, fZ);
+            const float top = Lerp(d10, d11, fZ);
+
+            /* The surface block itself is kept, so plants and trees never float; caves only open up where they
+             * cut through slopes, which results in overhangs. The bottom layer is never carved. */
+            for(int32_t y = MAX(cellY, 1); y <= MIN(cellY + CAVE_CELL_HEIGHT - 1, h - 1); ++y)
+            {
+              if(Lerp(bottom, top, (float)(y - cellY) / CAVE_CELL_HEIGHT) > caveThreshold)
+                c->blocks[XYZ(x, y, z)] = AIR_BLOCK;
+            }
+          }
+        }
+      }
+    }
+  }
+
+#undef LATTICE
+
+  free(lattice);
+}
+
+void WorldGeneratorGenerateTile(WorldGenJob* job, int32_t tile)
+{
+  Chunk* c = job->chunk;
+  Biome* biomes = job->biomes;
+  int32_t* heightmap = job->heightmap;
+  int32_t* surface = job->surface;
+
+  //The noise settings are changed on every call, so each tile needs its own copy of the state.
+  noiseState tileState = *job->noiseState;
+
+  int32_t xStart, xEnd, zStart, zEnd;
+  TileRange(tile / TilesPerSide(), &xStart, &xEnd);
+  TileRange(tile % TilesPerSide(), &zStart, &zEnd);
+
+  int32_t cStartX = c->x * CHUNK_WIDTH;
+  int32_t cStartZ = c->z * CHUNK_WIDTH;
+
+  for(int32_t x = xStart; x <= xEnd; ++x)
+  {
+    //A whole row at once (lattice points yield the same biome again).
+    GetBiomeRow(&tileState, cStartX + x, cStartZ + zStart, 1, zEnd - zStart + 1, 1, &biomes[XZ(x, zStart)]);
+
+    //Authored heights are not interpolated, their detail below the lattice spacing would be lost.
+    if(sTerrainRaster != NULL)
+      GetHeightRow(&tileState, cStartX + x, cStartZ + zStart, 1, zEnd - zStart + 1, 1, &biomes[XZ(x, zStart)], &heightmap[XZ(x, zStart)]);
+    else
+    {
+      STAGE_TIMER_BEGIN(interpolateStart);
+
+      //Lattice heights were already sampled by "WorldGeneratorBeginChunk()".
+      for(int32_t z = zStart; z <= zEnd; ++z)
+      {
+        if(x % 8 || z % 8)
+        {
+          const int32_t xLeft = FloorEight(x);
+          const int32_t zTop = FloorEight(z);
+
+          heightmap[XZ(x, z)] = Blerp(heightmap[XZ(xLeft, zTop)], heightmap[XZ(xLeft, zTop + 8)], heightmap[XZ(xLeft + 8, zTop)],
+                                      heightmap[XZ(xLeft + 8, zTop + 8)], (x - xLeft) / 8.0f, (z - zTop) / 8.0f);
+        }
       }
 
+      STAGE_TIMER_END(interpolateStart, STAGE_INTERPOLATE);
+    }
+
+    STAGE_TIMER_BEGIN(fillStart);
+
+    for(int32_t z = zStart; z <= zEnd; ++z)
+    {
+      int32_t h = heightmap[XZ(x, z)];
+      if(job->erosion != NULL)
+        h = ApplyErosion(h, job->erosion[(x + 1) * (CHUNK_WIDTH + 2) + (z + 1)]);
+
+      surface[XZ(x, z)] = h;
+
       switch(biomes[XZ(x, z)])
       {
         case BIOME_PLAINS:   
-          GenPlains(noiseState, c, x, z, heightmap[XZ(x, z)]); 
+          GenPlains(&tileState, c, x, z, h); 
           break;
         case BIOME_FOREST:
-          GenForest(noiseState, c, x, z, heightmap[XZ(x, z)]); 
+          GenForest(&tileState, c, x, z, h); 
           break;
         case BIOME_FLOWER_FOREST: 
-          GenFlowerForest(noiseState, c, x, z, heightmap[XZ(x, z)]); 
+          GenFlowerForest(&tileState, c, x, z, h); 
           break;
         case BIOME_MOUNTAINS:
-          GenMountains(noiseState, c, x, z, heightmap[XZ(x, z)]); 
+          GenMountains(&tileState, c, x, z, h); 
           break;
         case BIOME_DESERT:
-          GenDesert(noiseState, c, x, z, heightmap[XZ(x, z)]); 
+          GenDesert(&tileState, c, x, z, h); 
           break;
         case BIOME_WATER:   
-          GenWater(noiseState, c, x, z, heightmap[XZ(x, z)]); 
+          GenWater(&tileState, c, x, z, h); 
           break;
       }
     }
+
+    STAGE_TIMER_END(fillStart, STAGE_FILL);
+  }
+
+  if(CAVES_ENABLED)
+  {
+    STAGE_TIMER_BEGIN(cavesStart);
+    CarveCaves(&tileState, c, surface, xStart, xEnd, zStart, zEnd);
+    STAGE_TIMER_END(cavesStart, STAGE_CAVES);
   }
 
-  free(biomes);
-  free(heightmap);
+  StageTimerFlush();
+}
+
+void WorldGeneratorFinishChunk(WorldGenJob* job)
+{
+  STAGE_TIMER_BEGIN(structuresStart);
+  StructureGeneratorStampChunk(job->noiseState, job->chunk);
+  STAGE_TIMER_END(structuresStart, STAGE_STRUCTURES);
+
+  free(job->biomes);
+  free(job->heightmap);
+  free(job->surface);
+  free(job->erosion);
+  free(job->noiseState);
+  free(job);
+
+  StageTimerFlush();
+}
+
+void WorldGeneratorGenerateChunk(Chunk* c)
+{
+  WorldGenJob* job = WorldGeneratorBeginChunk(c);
+  if(job == NULL)
+    return;
+
+  const int32_t tileCount = WorldGeneratorGetTileCount();
+  for(int32_t tile = 0; tile < tileCount; ++tile)
+    WorldGeneratorGenerateTile(job, tile);
 
-  free(noiseState);
+  WorldGeneratorFinishChunk(job);
 }
\ No newline at end of file
@@ -1,5 +1,71 @@
 #pragma once
 
+#include "NoiseGenerator.h"
+
 #include "Map/Chunk.h"
 
-void WorldGeneratorGenerateChunk(Chunk* c);
\ No newline at end of file
+//Edge length (in columns) of the tiles a chunk is split into; tiles can be generated in parallel.
+#define WORLD_GEN_TILE_WIDTH 8
+
+#define WORLD_GEN_WATER_LEVEL 50
+
+//Raise with every change of the built-in generation, so that whatever was derived from generated chunks is made anew.
+#define WORLD_GEN_VERSION 1
+
+//The following biomes are created:
+typedef enum
+{
+  BIOME_PLAINS,
+  BIOME_FOREST,
+  BIOME_FLOWER_FOREST,
+  BIOME_MOUNTAINS,
+  BIOME_DESERT,
+  BIOME_WATER
+} Biome;
+//Additionally, "StructureGenerator" places trees across chunk borders.
+
+typedef struct WorldGenJob WorldGenJob;
+
+void WorldGeneratorGenerateChunk(Chunk* c);
+
+/* Generating a chunk piece by piece: "WorldGeneratorBeginChunk()" samples the coarse lattice, afterwards every tile
+ * ("0" to "WorldGeneratorGetTileCount()" - 1) can be generated on any thread and in any order.
+ * "WorldGeneratorFinishChunk()" stamps the structures and frees the job, once all tiles are done. */
+WorldGenJob* WorldGeneratorBeginChunk(Chunk* c);
+
+int32_t WorldGeneratorGetTileCount();
+
+void WorldGeneratorGenerateTile(WorldGenJob* job, int32_t tile);
+
+void WorldGeneratorFinishChunk(WorldGenJob* job);
+
+/* Loads the terrain raster or else the terrain graph set in the configuration (if any); otherwise, the built-in terrain is generated.
+ * The biomes of a raster are decorated like all others, its heights are neither interpolated nor blended. */
+void WorldGeneratorInit();
+
+void WorldGeneratorFree();
+
+bool WorldGeneratorUsesTerrainGraph();
+
+bool WorldGeneratorUsesTerrainRaster();
+
+/* Changes with anything that changes the generated terrain: "WORLD_GEN_VERSION", the generation settings and the terrain
+ * graph or raster in use (after "WorldGeneratorInit()"). */
+uint32_t WorldGeneratorGetVersion();
+
+//Number of blended lattice tiles computed since the start (or the last "WorldGeneratorFree()") with one and with several biomes.
+void WorldGeneratorGetBlendStats(int32_t* singleBiomeTiles, int32_t* mixedTiles);
+
+//Biomes and (not interpolated) heights of "count" columns starting at ("bX", "bZ") along the z-axis.
+void WorldGeneratorSampleRow(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t count, Biome* biomes, int32_t* heights);
+
+/* Biomes and heights of "count" columns "step" blocks apart along the z-axis, stored without gaps. Neither blended nor eroded,
+ * since both only matter below the spacing of such coarse samples (e.g. for the far terrain). */
+void WorldGeneratorSampleCoarseRow(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t step, int32_t count, Biome* biomes, int32_t* heights);
+
+/* Terrain heights before erosion of "width" x "width" columns starting at ("bX", "bZ"), which have to be multiples of eight;
+ * stored row by row along the z-axis. */
+void WorldGeneratorSampleHeightmap(noiseState* noiseState, int32_t bX, int32_t bZ, int32_t width, int32_t* heights);
+
+//Biome and terrain height of a single world column without generating its chunk - the same values the chunk generation yields.
+void WorldGeneratorSampleColumn(noiseState* noiseState, int32_t bX, int32_t bZ, Biome* biome, int32_t* height);
\ No newline at end of file
@@ -1,5 +1,12 @@
+#include "ChunkStore.h"
 #include "Database.h"
+#include "EditCompactor.h"
+#include "Headless.h"
+#include "MeshCache.h"
+#include "Snapshot.h"
+#include "StageTimer.h"
 #include "TimeMeasurement.h"
+#include "WorldGenerator.h"
 
 #include "Window.h"
 #include "Shader.h"
@@ -9,16 +16,11 @@
 #include "Player/PlayerController.h"
 
 #include <time.h>
-#if PLATFORM_POSIX
-#include <unistd.h>
-#endif
 
 //Tell the Nvidia or AMD driver to prefer the discrete GPU rather than the CPU integrated one.
 extern __declspec(dllexport) DWORD NvOptimusEnablement = 1;
 extern __declspec(dllexport) int32_t AmdPowerXpressRequestHighPerformance = 1;
 
-extern bool STDOUT_SUPPORTS_COLORS = false;
-extern bool STDERR_SUPPORTS_COLORS = false;
 //Global for this file:
 static mat4 nearShadowMapMat;
 static mat4 farShadowMapMat;
@@ -384,112 +386,37 @@ static void Render(Player* p, Camera* cam, float dt)
  * The argument vector "argVec" is a tokenized representation of the command line that the program was invoked with. */
 int32_t main(int32_t argCount, const char* argVec[])
 {
-  //Registers the function given as argument to be called on normal program termination (via "exit()" or returning from the main function).
-  atexit(PressEnterToContinue);
+  HeadlessCommandLine cmd;
+  if(!HeadlessParseCommandLine(argCount, argVec, &cmd))
+    return EXIT_FAILURE;
+
+  /* Registers the function given as argument to be called on normal program termination (via "exit()" or returning from the main function).
+   * Headless runs must not wait for a key press at the end (scripts, CI). */
+  if(!HeadlessIsRequested(&cmd))
+    atexit(PressEnterToContinue);
 
   //Initialize random seed:
   srand((uint32_t)time(NULL));
 
-#ifdef PLATFORM_WINDOWS
-  HANDLE stdOutHandle = GetStdHandle(STD_OUTPUT_HANDLE);
-  if(stdOutHandle == INVALID_HANDLE_VALUE)
-    LogWarning("The standard output handle could not be retrieved.", true); //Only warnings (no errors with abort), for it is not really severe if the CLI is without colors.
-  else
-  {
-    DWORD conModeOut;
-    if(!GetConsoleMode(stdOutHandle, &conModeOut))
-      LogWarning("The console mode for the standard output (stdout) could not be fetched.", true);
-    else
-    {
-      STDOUT_SUPPORTS_COLORS = true;
-      if(conModeOut & ENABLE_PROCESSED_OUTPUT && conModeOut & ENABLE_VIRTUAL_TERMINAL_PROCESSING) //-> C Operator Precedence: https://en.cppreference.com/w/c/language/operator_precedence
-        LogInfo("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" are already active, allowing colored output for the standard output (stdout).\n", false);
-      else
-      {
-        conModeOut |= ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-        if(!SetConsoleMode(stdOutHandle, conModeOut))
-        {
-          LogWarning("The console mode for the standard output (stdout) could not be set.", true);
-          STDOUT_SUPPORTS_COLORS = false;
-        }
-        else
-          LogSuccess("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" were activated, allowing colored output for the standard output (stdout).\n", false);
-      }
-
-      if(STDOUT_SUPPORTS_COLORS)
-      {
-        LogInfo("Color meaning: Information |", false);
-        LogSuccess("| Success", true);
-      }  
-    }
-  }
-
-  HANDLE stdErrHandle = GetStdHandle(STD_ERROR_HANDLE);
-  if(stdErrHandle == INVALID_HANDLE_VALUE)
-    LogWarning("The standard error handle could not be retrieved.", true);
-  else
-  {
-    DWORD conModeErr;
-    if(!GetConsoleMode(stdErrHandle, &conModeErr))
-      LogWarning("The console mode for standard error (stderr) could not be fetched.", true);
-    else
-    {
-      STDERR_SUPPORTS_COLORS = true;
-      if(conModeErr & ENABLE_PROCESSED_OUTPUT && conModeErr & ENABLE_VIRTUAL_TERMINAL_PROCESSING)
-        LogInfo("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" are already active, allowing colored output for standard error (stderr).\n", false);
-      else
-      {
-        conModeErr |= ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-        if(!SetConsoleMode(stdErrHandle, conModeErr))
-        {
-          LogWarning("The console mode for standard error (stderr) could not be set.", true);
-          STDERR_SUPPORTS_COLORS = false;
-        }
-        else
-          LogSuccess("\"ENABLE_PROCESSED_OUTPUT\" and \"ENABLE_VIRTUAL_TERMINAL_PROCESSING\" were activated, allowing colored output for standard error (stderr).\n", false);
-      }
-
-      if(STDERR_SUPPORTS_COLORS)
-      {
-        LogInfo("Color meaning: ", false);
-        LogError("Error |", false);
-        LogWarning("| Warning", true);
-      }
-    }
-  }
+  LogInitConsole();
 
+#ifdef PLATFORM_WINDOWS
   //The following is just a remnant of an approach that no longer works, hence, this is for Windows only.
   char modulePath[1024];
   if(!GetModuleFileNameA(NULL, modulePath, ARRAY_SIZE(modulePath))) //If the first parameter is "NULL", "GetModuleFileName()" retrieves the path of the executable file of the current process.
     LogWarning("The fully qualified path for the executable file of the current process could not be obtained.", true);
   else
     LogInfo("The fully qualified path for the executable file of the current process is \"%s\".", true, modulePath);
-#elif PLATFORM_POSIX
-  if(isatty(STDOUT_FILENO))
-  {
-    STDOUT_SUPPORTS_COLORS = true; //Standard output is a "tty" (https://www.linusakesson.net/programming/tty/). In 2021, even more so in 2022, most terminal emulators support ANSI TTY escape codes.
-    LogInfo("Colored output for the standard output (stdout) is active.\n", false);
-    LogInfo("Color meaning: Information |", false);
-    LogSuccess("| Success", true);
-  }
-  
-  if(isatty(STDERR_FILENO))
-  {
-    STDERR_SUPPORTS_COLORS = true;
-    LogInfo("Colored output for standard error (stderr) is active.\n", false);
-    LogInfo("Color meaning: ", false);
-    LogError("Error |", false);
-    LogWarning("| Warning", true);
-  }
 #endif
 
-  const char* configPath = "config.ini";
-  if(argCount >= 2)
-    configPath = argVec[1];
-  else
-    LogInfo("No command line arguments were provided, therefore the default configuration path \"%s\" is used.", true, configPath);
+  if(!cmd.hasConfigPath)
+    LogInfo("No configuration path was provided, therefore the default configuration path \"%s\" is used.", true, cmd.configPath);
 
-  ConfigurationLoad(configPath);
+  ConfigurationLoad(cmd.configPath);
+  WorldGeneratorInit();
+
+  if(HeadlessIsRequested(&cmd))
+    return HeadlessRun(&cmd);
 
   WindowInit();
   //Ensure this is disabled on startup.
@@ -566,16 +493,21 @@ int32_t main(int32_t argCount, const char* argVec[])
   }
 
   //Start at the beginning of the day.
-  glfwSetTime(DAY_LENGTH / 2.0);
+  MapSetTime(0.0);
 
   WindowInitFb();
 
   char mapPath[256];
   snprintf(mapPath, ARRAY_SIZE(mapPath), "Maps/%s", MAP_NAME);
   DatabaseInit(mapPath);
+  ChunkStoreInit(mapPath, REGION_STORE);
+  MeshCacheInit(mapPath, MESH_CACHE);
+  SnapshotInit(mapPath, SNAPSHOT_INTERVAL);
   ShaderInitAll();
   TextureInitAll();
   MapInit();
+  if(EDIT_COMPACTION)
+    EditCompactorStart(); //After "MapInit()", which sets the seed of the map.
   UIInit((float)WINDOW_WIDTH / WINDOW_HEIGHT);
 
   Player* player = PlayerCreate();
@@ -608,15 +540,27 @@ int32_t main(int32_t argCount, const char* argVec[])
   };
   CameraControllerSetTrackObject(cC, &info);
 
+  double lastAutosave = TimeMeasurementNow();
+
   while(!glfwWindowShouldClose(WND->GLFW))
   {
-    WindowUpdateTitleFPS();
+    WindowUpdateTitleFPS(MapGetTrianglesDrawn());
 
     TimeMeasurementOnNewFrame();
     float dt = (float)TimeMeasurementGet();
 
     Update(pC, cC, dt);
 
+    //Only a copy of the values is made here; the writer thread stores them with the edits queued so far.
+    if(AUTOSAVE_INTERVAL > 0 && TimeMeasurementNow() - lastAutosave >= AUTOSAVE_INTERVAL)
+    {
+      const double start = TimeMeasurementNow();
+      DatabaseSaveAsync(player);
+      lastAutosave = TimeMeasurementNow();
+
+      LogInfo("Autosave handed to the writer thread in %.1f us.", true, (lastAutosave - start) * 1e6);
+    }
+
     Render(player, cam, dt);
 
     glfwSwapBuffers(WND->GLFW);
@@ -626,10 +570,15 @@ int32_t main(int32_t argCount, const char* argVec[])
 
   PlayerDestroy(player);
 
+  EditCompactorStop();
   UIFree();
   MapFree();
+  StageTimerLog(); //After "MapFree()", which ends the threads, so all of their timings are published.
+  WorldGeneratorFree();
   TextureFreeAll();
   ShaderFreeAll();
+  ChunkStoreFree();
+  SnapshotFree();
   DatabaseFree();
 
   WindowFree();